@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Turn sleep residency profiles printed by app_pwr_mgmt_profile_dump()
+(APP_PWR_MGMT_PROFILE_ENABLE defined) into a residency report.
+
+The "PWRP," lines are picked out of a log capture, any other output and
+log prefixes are skipped. With several dumps in the capture the last one is
+reported, or with --delta the difference between the first and the last.
+
+Usage:
+    python pwr_profile_report.py <log.txt>
+    python pwr_profile_report.py --delta <log.txt>
+    python pwr_profile_report.py --sleep-ua 2.5 --active-ua 3200 <log.txt>   (average current estimate)
+    python pwr_profile_report.py -                                             (read log from stdin)
+"""
+
+import argparse
+import sys
+
+# periph_device_number_t of gr533x_hal_pwr_mgmt.h, the bit numbers of g_devices_state.
+DEVICE_NAMES = ['SPIM', 'SPIS', 'I2C0', 'I2C1', 'UART0', 'UART1', 'PWM0', 'PWM1', 'DMA0',
+                'AES', 'RNG', 'SNSADC', 'CLK_CALIB', 'TIM0', 'TIM1', 'DUAL_TIM0', 'DUAL_TIM1']
+
+HIST_NAMES = ['sleep', 'awake', 'deadline']
+BAR_WIDTH  = 40
+
+
+class Profile:
+    def __init__(self, hist_num):
+        self.hist_num    = hist_num
+        self.attempt     = 0
+        self.blocked     = 0
+        self.sleep       = 0
+        self.no_deadline = 0
+        self.sleep_ms    = 0
+        self.awake_ms    = 0
+        self.blocker     = {}
+        self.hist        = {name: [0] * hist_num for name in HIST_NAMES}
+
+    def __sub__(self, other):
+        out             = Profile(self.hist_num)
+        out.attempt     = self.attempt - other.attempt
+        out.blocked     = self.blocked - other.blocked
+        out.sleep       = self.sleep - other.sleep
+        out.no_deadline = self.no_deadline - other.no_deadline
+        out.sleep_ms    = self.sleep_ms - other.sleep_ms
+        out.awake_ms    = self.awake_ms - other.awake_ms
+        out.blocker     = {dev: cnt - other.blocker.get(dev, 0) for dev, cnt in self.blocker.items()}
+        out.hist        = {name: [a - b for a, b in zip(self.hist[name], other.hist[name])] for name in HIST_NAMES}
+        return out
+
+
+def parse(lines):
+    """Yield every complete dump, a dump broken off by a reset is dropped."""
+    prof = None
+
+    for line in lines:
+        pos = line.find('PWRP,')
+        if pos < 0:
+            continue
+        fields = line[pos:].strip().split(',')
+        key    = fields[1] if len(fields) > 1 else ''
+
+        try:
+            values = [int(v) for v in fields[2:]]
+        except ValueError:
+            prof = None
+            continue
+
+        if key == 'begin':
+            prof = Profile(values[1])
+        elif prof is None:
+            continue
+        elif key == 'count':
+            prof.attempt, prof.blocked, prof.sleep, prof.no_deadline = values
+        elif key == 'total_ms':
+            prof.sleep_ms, prof.awake_ms = values
+        elif key == 'blocker':
+            prof.blocker[values[0]] = values[1]
+        elif key in HIST_NAMES and len(values) == prof.hist_num:
+            prof.hist[key] = values
+        elif key == 'end':
+            yield prof
+            prof = None
+
+
+def bin_label(idx, hist_num):
+    def fmt(us):
+        if us >= 1000000:
+            return '%gs' % (us / 1000000.0)
+        if us >= 1000:
+            return '%gms' % (us / 1000.0)
+        return '%dus' % us
+
+    low = 0 if idx == 0 else 1 << idx
+    if idx == hist_num - 1:
+        return '>= %s' % fmt(low)
+    return '%s - %s' % (fmt(low), fmt(1 << (idx + 1)))
+
+
+def print_hist(title, hist):
+    total = sum(hist)
+    print('\n%s (%d samples)' % (title, total))
+    if not total:
+        return
+
+    first = next(i for i, v in enumerate(hist) if v)
+    last  = len(hist) - 1 - next(i for i, v in enumerate(reversed(hist)) if v)
+    peak  = max(hist)
+    for idx in range(first, last + 1):
+        bar = '#' * ((hist[idx] * BAR_WIDTH + peak - 1) // peak)
+        print('  %-18s %8d %5.1f%% %s' % (bin_label(idx, len(hist)), hist[idx], 100.0 * hist[idx] / total, bar))
+
+
+def report(prof, sleep_ua, active_ua):
+    total_ms = prof.sleep_ms + prof.awake_ms
+
+    print('Sleep attempts      : %d' % prof.attempt)
+    print('Blocked by devices  : %d (%.1f%%)' % (prof.blocked, 100.0 * prof.blocked / prof.attempt if prof.attempt else 0))
+    print('Sleeps              : %d' % prof.sleep)
+    if total_ms:
+        print('Time asleep         : %.3f s (%.2f%%)' % (prof.sleep_ms / 1000.0, 100.0 * prof.sleep_ms / total_ms))
+        print('Time awake          : %.3f s (%.2f%%)' % (prof.awake_ms / 1000.0, 100.0 * prof.awake_ms / total_ms))
+    if prof.sleep:
+        print('Mean sleep / awake  : %.2f ms / %.2f ms' % (float(prof.sleep_ms) / prof.sleep, float(prof.awake_ms) / prof.sleep))
+    if total_ms and sleep_ua is not None and active_ua is not None:
+        avg_ua = (prof.sleep_ms * sleep_ua + prof.awake_ms * active_ua) / total_ms
+        print('Average current     : %.2f uA' % avg_ua)
+
+    blockers = sorted(((cnt, dev) for dev, cnt in prof.blocker.items() if cnt), reverse=True)
+    if blockers:
+        print('\nSleep blockers (a check may count several devices)')
+        for cnt, dev in blockers:
+            name = DEVICE_NAMES[dev] if dev < len(DEVICE_NAMES) else 'BIT%d' % dev
+            print('  %-10s %8d %5.1f%%' % (name, cnt, 100.0 * cnt / prof.blocked if prof.blocked else 0))
+
+    print_hist('Sleep duration', prof.hist['sleep'])
+    print_hist('Awake duration', prof.hist['awake'])
+    print_hist('Next app_timer deadline at sleep, %d sleeps with no timer' % prof.no_deadline, prof.hist['deadline'])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Report sleep residency from app_pwr_mgmt profile dumps.')
+    parser.add_argument('--delta', action='store_true', help='report the last dump minus the first one')
+    parser.add_argument('--sleep-ua', type=float, help='sleep current in uA, for average current estimate')
+    parser.add_argument('--active-ua', type=float, help='awake current in uA, for average current estimate')
+    parser.add_argument('log')
+    args = parser.parse_args()
+
+    if args.log == '-':
+        dumps = list(parse(sys.stdin))
+    else:
+        with open(args.log, 'r', errors='replace') as f:
+            dumps = list(parse(f))
+
+    if not dumps:
+        print('no complete PWRP dump found', file=sys.stderr)
+        return 1
+
+    prof = dumps[-1]
+    if args.delta:
+        if len(dumps) < 2:
+            print('--delta needs two dumps', file=sys.stderr)
+            return 1
+        prof = dumps[-1] - dumps[0]
+
+    report(prof, args.sleep_ua, args.active_ua)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -40,6 +40,9 @@
 #include <string.h>
 #include "grx_hal.h"
 #include "gr55xx_spi_flash.h"
+#if SPI_FLASH_ASYNC_ENABLE
+#include "app_timer.h"
+#endif
 
 /*
  * SPI Master DEFINES
@@ -82,6 +85,64 @@
 
 #define FLASH_SIZE_16M                   0x1000000
 
+#define SPI_FLASH_STATUS_WIP             0x01
+
+#define SPI_FLASH_SR1_QE                 0x40       /* quad enable in status register 1 */
+#define SPI_FLASH_SR2_QE                 0x02       /* quad enable in status register 2 */
+
+#define SPI_FLASH_SFDP_SIGNATURE         0x50444653 /* "SFDP" */
+#define SPI_FLASH_SFDP_BFPT_DW_MIN       9          /* JESD216 BFPT, up to the erase types */
+#define SPI_FLASH_SFDP_BFPT_DW_MAX       16         /* BFPT DWORDs used by the driver */
+#define SPI_FLASH_ERASE_TYPE_MAX         4          /* erase types described by SFDP */
+#define SPI_FLASH_SECTOR_SHIFT           12         /* log2 of EXFLASH_SIZE_SECTOR_BYTES */
+#define SPI_FLASH_QE_UNKNOWN             0xFF       /* BFPT without quad enable requirement */
+
+#define SFDP_DW(p, n)                    ((p)[(n) * 4] | ((p)[(n) * 4 + 1] << 8) | ((p)[(n) * 4 + 2] << 16) | ((uint32_t)(p)[(n) * 4 + 3] << 24))
+
+#if SPI_FLASH_ASYNC_ENABLE
+#define SPI_FLASH_ASYNC_EVT_TX           0    /* command or data sent */
+#define SPI_FLASH_ASYNC_EVT_RX           1    /* status received */
+#define SPI_FLASH_ASYNC_EVT_ERROR        2    /* transfer error */
+
+typedef enum
+{
+    SPI_FLASH_ASYNC_IDLE,                     /* no request in progress */
+    SPI_FLASH_ASYNC_WREN,                     /* write enable being sent */
+    SPI_FLASH_ASYNC_CMD,                      /* page program or sector erase being sent */
+    SPI_FLASH_ASYNC_WAIT,                     /* WIP poll timer running */
+    SPI_FLASH_ASYNC_RDSR,                     /* status being read */
+} spi_flash_async_state_t;
+
+#endif
+
+#if SPI_FLASH_ASYNC_ENABLE
+typedef struct
+{
+    spi_flash_async_op_t op;
+    uint32_t             address;
+    uint8_t             *buffer;
+    uint32_t             nbytes;
+    spi_flash_async_cb_t callback;
+} spi_flash_async_req_t;
+
+typedef struct
+{
+    spi_flash_async_req_t            queue[SPI_FLASH_ASYNC_QUEUE_SIZE];
+    uint8_t                          head;
+    volatile uint8_t                 count;
+    volatile spi_flash_async_state_t state;
+    uint32_t                         address;       /* address of the current page or sector */
+    uint8_t                         *buffer;
+    uint32_t                         remain;
+    uint32_t                         step;          /* bytes of the current page or erase block */
+    uint8_t                          erase_cmd;     /* opcode of the current erase block */
+    uint8_t                          cmd[5];
+    uint8_t                          status;
+    bool                             timer_created;
+    app_timer_id_t                   timer_id;
+} spi_flash_async_env_t;
+#endif
+
 /*
  * LOCAL VARIABLE DEFINITIONS
  *****************************************************************************************
@@ -146,12 +207,44 @@ static uint32_t          g_flash_size;
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
 static uint32_t          g_addr_size;
 #endif
+/* Used as is if the flash has no SFDP: legacy page size, 4KB sector erase, single or dual out read. */
+static const spi_flash_sfdp_info_t s_sfdp_default = {
+    .page_size      = EXFLASH_SIZE_PAGE_BYTES,
+    .addr_bytes     = 3,
+    .quad_enable    = SPI_FLASH_QE_UNKNOWN,
+    .read_modes     = (1 << SPI_FLASH_READ_1_1_1) | (1 << SPI_FLASH_READ_1_1_2),
+    .read_cmd       = {
+        [SPI_FLASH_READ_1_1_1] = {SPI_FLASH_CMD_READ,  0, 0},
+        [SPI_FLASH_READ_1_1_2] = {SPI_FLASH_CMD_DREAD, 8, 0},
+    },
+    .read_mode      = SPI_FLASH_READ_1_1_1,
+    .erase_type_num = 1,
+    .erase_type     = {{SPI_FLASH_SECTOR_SHIFT, SPI_FLASH_CMD_SE}},
+};
+static spi_flash_sfdp_info_t g_sfdp_info;
+#if (SPI_FLASH_USING_SFDP == 1)
+/* BFPT byte offset of the read description of every spi_flash_read_mode_t */
+static const uint8_t s_sfdp_read_desc_ofs[SPI_FLASH_READ_MODE_MAX] = {0, 12, 14, 10, 8, 26};
+#endif
+#if SPI_FLASH_ASYNC_ENABLE
+static spi_flash_async_env_t s_flash_async;
+
+static void spi_flash_async_evt_handler(uint8_t evt);
+#endif
 /*
  * LOCAL FUNCTION DEFINITIONS
  *****************************************************************************************
  */
 static void spi_app_spim_callback(app_spi_evt_t *p_evt)
 {
+#if SPI_FLASH_ASYNC_ENABLE
+    if (SPI_FLASH_ASYNC_IDLE != s_flash_async.state)
+    {
+        spi_flash_async_evt_handler((APP_SPI_EVT_ERROR == p_evt->type)      ? SPI_FLASH_ASYNC_EVT_ERROR :
+                                    (APP_SPI_EVT_TX_RX_CPLT == p_evt->type) ? SPI_FLASH_ASYNC_EVT_RX : SPI_FLASH_ASYNC_EVT_TX);
+        return;
+    }
+#endif
     if (p_evt->type == APP_SPI_EVT_TX_CPLT)
     {
         g_qspi_ctl.spi_tmt_done = 1;
@@ -176,6 +269,14 @@ static void spi_app_spim_callback(app_spi_evt_t *p_evt)
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
 static void app_qspi_callback(app_qspi_evt_t *p_evt)
 {
+#if SPI_FLASH_ASYNC_ENABLE
+    if (SPI_FLASH_ASYNC_IDLE != s_flash_async.state)
+    {
+        spi_flash_async_evt_handler((APP_QSPI_EVT_ERROR == p_evt->type)   ? SPI_FLASH_ASYNC_EVT_ERROR :
+                                    (APP_QSPI_EVT_RX_DATA == p_evt->type) ? SPI_FLASH_ASYNC_EVT_RX : SPI_FLASH_ASYNC_EVT_TX);
+        return;
+    }
+#endif
     if (p_evt->type == APP_QSPI_EVT_TX_CPLT)
     {
         g_qspi_ctl.qspi_tmt_done = 1;
@@ -315,6 +416,205 @@ static uint32_t spi_flash_device_size(void)
     return flash_size;
 }
 
+#if (SPI_FLASH_USING_SFDP == 1)
+static bool spi_flash_sfdp_read(uint32_t address, uint8_t *p_data, uint32_t nbytes)
+{
+    uint32_t ret;
+
+    if (FLASH_SPIM_ID == g_flash_init.spi_type)
+    {
+        uint8_t control_frame[5] = {SPI_FLASH_CMD_SFDP, (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF, DUMMY_BYTE};
+
+        g_qspi_ctl.spi_tx_rx_done = 0;
+        ret = app_spi_dma_read_eeprom_async(g_qspi_ctl.spi_id, control_frame, p_data, sizeof(control_frame), nbytes);
+        if (ret != APP_DRV_SUCCESS)
+        {
+            return false;
+        }
+        while(g_qspi_ctl.spi_tx_rx_done == 0);
+    }
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    else
+    {
+        qspi_command_t command = {
+            .instruction      = SPI_FLASH_CMD_SFDP,
+            .address          = address,
+            .instruction_size = QSPI_INSTSIZE_08_BITS,
+            .address_size     = QSPI_ADDRSIZE_24_BITS,
+            .data_size        = QSPI_DATASIZE_08_BITS,
+            .dummy_cycles     = 8,
+            .instruction_address_mode = QSPI_INST_ADDR_ALL_IN_SPI,
+            .data_mode        = QSPI_DATA_MODE_SPI,
+            .length           = nbytes,
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+            .clock_stretch_en = 1,
+#endif
+        };
+
+        g_qspi_ctl.qspi_rcv_done = 0;
+        ret = app_qspi_dma_command_receive_async(g_qspi_ctl.qspi_id, &command, p_data);
+        if (ret != APP_DRV_SUCCESS)
+        {
+            return false;
+        }
+        while(g_qspi_ctl.qspi_rcv_done == 0);
+    }
+#endif
+    return true;
+}
+
+/* Parse the JEDEC basic flash parameter table on top of the defaults in p_info. */
+static bool spi_flash_sfdp_bfpt_parse(const uint8_t *p_bfpt, uint8_t dw_num, spi_flash_sfdp_info_t *p_info)
+{
+    uint32_t dw;
+    uint8_t  shift;
+    uint8_t  i, j;
+
+    if (dw_num < SPI_FLASH_SFDP_BFPT_DW_MIN)
+    {
+        return false;
+    }
+
+    /* DWORD 1: address bytes and the fast read modes described in DWORD 3 and 4 */
+    dw = SFDP_DW(p_bfpt, 0);
+    p_info->addr_bytes = (2 == ((dw >> 17) & 0x03)) ? 4 : 3;
+    p_info->read_modes = (1 << SPI_FLASH_READ_1_1_1);
+    if (dw & (1UL << 16))
+    {
+        p_info->read_modes |= (1 << SPI_FLASH_READ_1_1_2);
+    }
+    if (dw & (1UL << 20))
+    {
+        p_info->read_modes |= (1 << SPI_FLASH_READ_1_2_2);
+    }
+    if (dw & (1UL << 21))
+    {
+        p_info->read_modes |= (1 << SPI_FLASH_READ_1_4_4);
+    }
+    if (dw & (1UL << 22))
+    {
+        p_info->read_modes |= (1 << SPI_FLASH_READ_1_1_4);
+    }
+
+    /* DWORD 2: density in bits, 2^N bits if bit 31 is set */
+    dw = SFDP_DW(p_bfpt, 1);
+    if (dw & 0x80000000UL)
+    {
+        dw &= 0x7FFFFFFF;
+        p_info->size = (dw >= 3 && dw < 35) ? (1UL << (dw - 3)) : 0;
+    }
+    else
+    {
+        p_info->size = (dw + 1) / 8;
+    }
+
+    /* DWORD 5 bit 4: 4-4-4 read */
+    if (SFDP_DW(p_bfpt, 4) & (1UL << 4))
+    {
+        p_info->read_modes |= (1 << SPI_FLASH_READ_4_4_4);
+    }
+
+    /* DWORD 3, 4 and 7: 16-bit read descriptions, wait states in bits 4:0, mode clocks in 7:5, opcode in 15:8 */
+    p_info->read_cmd[SPI_FLASH_READ_1_1_1].opcode       = SPI_FLASH_CMD_READ;
+    p_info->read_cmd[SPI_FLASH_READ_1_1_1].dummy_cycles = 0;
+    p_info->read_cmd[SPI_FLASH_READ_1_1_1].mode_cycles  = 0;
+    for (i = SPI_FLASH_READ_1_1_2; i < SPI_FLASH_READ_MODE_MAX; i++)
+    {
+        if (!(p_info->read_modes & (1 << i)))
+        {
+            continue;
+        }
+        p_info->read_cmd[i].opcode       = p_bfpt[s_sfdp_read_desc_ofs[i] + 1];
+        p_info->read_cmd[i].dummy_cycles = p_bfpt[s_sfdp_read_desc_ofs[i]] & 0x1F;
+        p_info->read_cmd[i].mode_cycles  = p_bfpt[s_sfdp_read_desc_ofs[i]] >> 5;
+        if (0 == p_info->read_cmd[i].opcode || 0xFF == p_info->read_cmd[i].opcode)
+        {
+            p_info->read_modes &= ~(1 << i);
+        }
+    }
+
+    /* DWORD 8 and 9: erase types, size as 2^N bytes and opcode */
+    p_info->erase_type[0].size_shift = SPI_FLASH_SECTOR_SHIFT;
+    p_info->erase_type[0].cmd        = SPI_FLASH_CMD_SE;
+    p_info->erase_type_num           = 1;
+    for (i = 0; i < SPI_FLASH_ERASE_TYPE_MAX; i++)
+    {
+        shift = p_bfpt[7 * 4 + i * 2];
+        if (shift <= SPI_FLASH_SECTOR_SHIFT || shift > 24 || 0 == p_bfpt[7 * 4 + i * 2 + 1] || 0xFF == p_bfpt[7 * 4 + i * 2 + 1])
+        {
+            continue;
+        }
+
+        /* insert sorted by size, the sector erase keeps the first place */
+        for (j = p_info->erase_type_num; j > 1 && p_info->erase_type[j - 1].size_shift > shift; j--)
+        {
+            p_info->erase_type[j] = p_info->erase_type[j - 1];
+        }
+        p_info->erase_type[j].size_shift = shift;
+        p_info->erase_type[j].cmd        = p_bfpt[7 * 4 + i * 2 + 1];
+        p_info->erase_type_num++;
+    }
+
+    /* JESD216A and later: DWORD 11 page size, DWORD 15 quad enable requirement */
+    if (dw_num >= 11)
+    {
+        shift = (SFDP_DW(p_bfpt, 10) >> 4) & 0x0F;
+        p_info->page_size = (shift >= 4) ? (1UL << shift) : EXFLASH_SIZE_PAGE_BYTES;
+    }
+    if (dw_num >= 15)
+    {
+        p_info->quad_enable = (SFDP_DW(p_bfpt, 14) >> 20) & 0x07;
+    }
+
+    return true;
+}
+
+static void spi_flash_sfdp_detect(void)
+{
+    uint8_t  header[16] = {0};
+    uint8_t  bfpt[SPI_FLASH_SFDP_BFPT_DW_MAX * 4];
+    uint32_t bfpt_addr;
+    uint8_t  dw_num;
+
+    memcpy(&g_sfdp_info, &s_sfdp_default, sizeof(g_sfdp_info));
+
+    /* SFDP header and parameter header 0, which points to the JEDEC basic flash parameter table */
+    if (!spi_flash_sfdp_read(0, header, sizeof(header)) ||
+        SPI_FLASH_SFDP_SIGNATURE != (header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24)))
+    {
+        return;
+    }
+
+    dw_num    = (header[11] > SPI_FLASH_SFDP_BFPT_DW_MAX) ? SPI_FLASH_SFDP_BFPT_DW_MAX : header[11];
+    bfpt_addr = header[12] | (header[13] << 8) | (header[14] << 16);
+    if (dw_num < SPI_FLASH_SFDP_BFPT_DW_MIN || !spi_flash_sfdp_read(bfpt_addr, bfpt, dw_num * 4))
+    {
+        return;
+    }
+
+    spi_flash_sfdp_bfpt_parse(bfpt, dw_num, &g_sfdp_info);
+}
+#endif
+
+/* Largest erase aligned at address and inside [address, end), address and end are sector aligned. */
+static uint32_t spi_flash_erase_plan(uint32_t address, uint32_t end, uint8_t *p_erase_cmd)
+{
+    uint32_t size;
+
+    for (uint8_t i = g_sfdp_info.erase_type_num; i > 0; i--)
+    {
+        size = 1UL << g_sfdp_info.erase_type[i - 1].size_shift;
+        if (0 == (address & (size - 1)) && end - address >= size)
+        {
+            *p_erase_cmd = g_sfdp_info.erase_type[i - 1].cmd;
+            return size;
+        }
+    }
+
+    *p_erase_cmd = SPI_FLASH_CMD_SE;
+    return EXFLASH_SIZE_SECTOR_BYTES;
+}
+
 static bool spim_flash_wakeup(void)
 {
     uint8_t control_frame[1] = {SPI_FLASH_CMD_RDP};
@@ -350,7 +650,7 @@ static uint32_t spim_flash_write(uint32_t address, uint8_t *buffer, uint32_t nby
     uint32_t ret;
     g_qspi_ctl.spi_tmt_done = 0;
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X)
-    if(g_flash_size > FLASH_SIZE_16M)
+    if(4 == g_sfdp_info.addr_bytes)
     {
         ret = app_spim_dma_transmit_with_ia_32addr(g_qspi_ctl.spi_id, SPI_FLASH_CMD_PP, address, buffer, nbytes);
     }
@@ -377,7 +677,7 @@ static uint32_t spim_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbyt
     uint8_t addr_size;
     uint8_t control_frame[5] = {0};
     control_frame[0] = SPI_FLASH_CMD_READ;
-    if(g_flash_size > FLASH_SIZE_16M)
+    if(4 == g_sfdp_info.addr_bytes)
     {
         control_frame[1] = (address >> 24) & 0xFF;
         control_frame[2] = (address >> 16) & 0xFF;
@@ -407,13 +707,13 @@ static uint32_t spim_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbyt
     }
 }
 
-static bool spim_flash_sector_erase(uint32_t address)
+static bool spim_flash_erase(uint8_t erase_cmd, uint32_t address)
 {
     uint32_t ret ;
     uint8_t addr_size;
     uint8_t control_frame[5] = {0};
-    control_frame[0] = SPI_FLASH_CMD_SE;
-    if(g_flash_size > FLASH_SIZE_16M)
+    control_frame[0] = erase_cmd;
+    if(4 == g_sfdp_info.addr_bytes)
     {
         control_frame[1] = (address >> 24) & 0xFF;
         control_frame[2] = (address >> 16) & 0xFF;
@@ -533,14 +833,15 @@ static uint32_t qspi_flash_dual_write(uint32_t address, uint8_t *buffer, uint32_
 
 static uint32_t qspi_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbytes)
 {
+    const spi_flash_read_cmd_t *p_cmd = &g_sfdp_info.read_cmd[g_sfdp_info.read_mode];
     uint32_t ret ;
     qspi_command_t command = {
-        .instruction      = SPI_FLASH_CMD_READ,
+        .instruction      = p_cmd->opcode,
         .address          = address,
         .instruction_size = QSPI_INSTSIZE_08_BITS,
         .address_size     = g_addr_size,
         .data_size        = QSPI_DATASIZE_08_BITS,
-        .dummy_cycles     = 0,
+        .dummy_cycles     = p_cmd->mode_cycles + p_cmd->dummy_cycles,
         .instruction_address_mode = QSPI_INST_ADDR_ALL_IN_SPI,
         .data_mode        = QSPI_DATA_MODE_SPI,
         .length           = nbytes,
@@ -549,36 +850,32 @@ static uint32_t qspi_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbyt
 #endif
     };
 
-    g_qspi_ctl.qspi_rcv_done = 0;
-    ret = app_qspi_dma_command_receive_async(g_qspi_ctl.qspi_id, &command, &buffer[0]);
-    if(ret == APP_DRV_SUCCESS)
-    {
-        while(g_qspi_ctl.qspi_rcv_done == 0);
-        return nbytes;
-    }
-    else
+    switch (g_sfdp_info.read_mode)
     {
-        return SPI_FLASH_TRANSMIT_FAIL;
-    }
-}
+        case SPI_FLASH_READ_1_1_2:
+            command.data_mode = QSPI_DATA_MODE_DUALSPI;
+            break;
+
+        case SPI_FLASH_READ_1_1_4:
+            command.data_mode = QSPI_DATA_MODE_QUADSPI;
+            break;
+
+        case SPI_FLASH_READ_1_2_2:
+        case SPI_FLASH_READ_1_4_4:
+            command.data_mode = (SPI_FLASH_READ_1_2_2 == g_sfdp_info.read_mode) ? QSPI_DATA_MODE_DUALSPI : QSPI_DATA_MODE_QUADSPI;
+            command.instruction_address_mode = QSPI_INST_IN_SPI_ADDR_IN_SPIFRF;
+            if (p_cmd->mode_cycles)
+            {
+                /* 8 mode bits sent as a 0x00 byte behind the address, never entering continuous read */
+                command.address      = address << 8;
+                command.address_size = QSPI_ADDRSIZE_32_BITS;
+                command.dummy_cycles = p_cmd->dummy_cycles;
+            }
+            break;
 
-static uint32_t qspi_flash_dual_read(uint32_t address, uint8_t *buffer, uint32_t nbytes)
-{
-    uint32_t ret ;
-    qspi_command_t command = {
-        .instruction      = SPI_FLASH_CMD_DREAD,
-        .address          = address,
-        .instruction_size = QSPI_INSTSIZE_08_BITS,
-        .address_size     = g_addr_size,
-        .data_size        = QSPI_DATASIZE_08_BITS,
-        .dummy_cycles     = 8,
-        .instruction_address_mode = QSPI_INST_ADDR_ALL_IN_SPI,
-        .data_mode        = QSPI_DATA_MODE_DUALSPI,
-        .length           = nbytes,
-#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
-        .clock_stretch_en = 1,
-#endif
-    };
+        default:
+            break;
+    }
 
     g_qspi_ctl.qspi_rcv_done = 0;
     ret = app_qspi_dma_command_receive_async(g_qspi_ctl.qspi_id, &command, &buffer[0]);
@@ -593,13 +890,13 @@ static uint32_t qspi_flash_dual_read(uint32_t address, uint8_t *buffer, uint32_t
     }
 }
 
-static bool qspi_flash_sector_erase(uint32_t address)
+static bool qspi_flash_erase(uint8_t erase_cmd, uint32_t address)
 {
     uint32_t ret;
     uint8_t addr_size;
     uint8_t control_frame[5] = {0};
-    control_frame[0] = SPI_FLASH_CMD_SE;
-    if(g_flash_size > FLASH_SIZE_16M)
+    control_frame[0] = erase_cmd;
+    if(4 == g_sfdp_info.addr_bytes)
     {
         control_frame[1] = (address >> 24) & 0xFF;
         control_frame[2] = (address >> 16) & 0xFF;
@@ -627,6 +924,478 @@ static bool qspi_flash_sector_erase(uint32_t address)
         return SPI_FLASH_ERASE_FAIL;
     }
 }
+
+#if (SPI_FLASH_USING_SFDP == 1)
+static uint8_t qspi_flash_read_reg(uint8_t cmd)
+{
+    uint8_t value = 0;
+    qspi_command_t command = {
+        .instruction      = cmd,
+        .address          = 0,
+        .instruction_size = QSPI_INSTSIZE_08_BITS,
+        .address_size     = QSPI_ADDRSIZE_00_BITS,
+        .data_size        = QSPI_DATASIZE_08_BITS,
+        .dummy_cycles     = 0,
+        .instruction_address_mode = QSPI_INST_ADDR_ALL_IN_SPI,
+        .data_mode        = QSPI_DATA_MODE_SPI,
+        .length           = 1,
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+        .clock_stretch_en = 1,
+#endif
+    };
+
+    g_qspi_ctl.qspi_rcv_done = 0;
+    app_qspi_dma_command_receive_async(g_qspi_ctl.qspi_id, &command, &value);
+    while(g_qspi_ctl.qspi_rcv_done == 0);
+
+    return value;
+}
+
+static void qspi_flash_write_reg(uint8_t *p_frame, uint8_t len)
+{
+    spi_flash_write_enable();
+
+    g_qspi_ctl.qspi_tmt_done = 0;
+    app_qspi_dma_transmit_async_ex(g_qspi_ctl.qspi_id, QSPI_DATA_MODE_SPI, QSPI_DATASIZE_08_BITS, p_frame, len);
+    while(g_qspi_ctl.qspi_tmt_done == 0);
+
+    while(spi_flash_read_status() & SPI_FLASH_STATUS_WIP);
+}
+
+/* Set the quad enable bit the way BFPT DWORD 15 describes, the status register is only written if the bit is clear. */
+static bool qspi_flash_quad_enable(uint8_t qe_type)
+{
+    uint8_t frame[3];
+
+    switch (qe_type)
+    {
+        case 0:
+            /* no QE bit, IO2/IO3 always usable in quad modes */
+            return true;
+
+        case 1:
+            /* QE is S9, 35h not available, writing one byte with 01h clears S15:S8 */
+            frame[0] = SPI_FLASH_CMD_WRSR;
+            frame[1] = spi_flash_read_status();
+            frame[2] = SPI_FLASH_SR2_QE;
+            qspi_flash_write_reg(frame, 3);
+            return true;
+
+        case 2:
+            /* QE is S6 */
+            frame[0] = SPI_FLASH_CMD_WRSR;
+            frame[1] = spi_flash_read_status();
+            if (!(frame[1] & SPI_FLASH_SR1_QE))
+            {
+                frame[1] |= SPI_FLASH_SR1_QE;
+                qspi_flash_write_reg(frame, 2);
+            }
+            return 0 != (spi_flash_read_status() & SPI_FLASH_SR1_QE);
+
+        case 4:
+        case 5:
+            /* QE is S9, both status registers written by 01h */
+            frame[0] = SPI_FLASH_CMD_WRSR;
+            frame[1] = spi_flash_read_status();
+            frame[2] = qspi_flash_read_reg(SPI_FLASH_CMD_RDSR1);
+            if (!(frame[2] & SPI_FLASH_SR2_QE))
+            {
+                frame[2] |= SPI_FLASH_SR2_QE;
+                qspi_flash_write_reg(frame, 3);
+            }
+            break;
+
+        case 6:
+            /* QE is S9, status register 2 written by 31h */
+            frame[0] = SPI_FLASH_CMD_WRSR1;
+            frame[1] = qspi_flash_read_reg(SPI_FLASH_CMD_RDSR1);
+            if (!(frame[1] & SPI_FLASH_SR2_QE))
+            {
+                frame[1] |= SPI_FLASH_SR2_QE;
+                qspi_flash_write_reg(frame, 2);
+            }
+            break;
+
+        default:
+            /* QE in S7 of status register 2 (type 3) or no description */
+            return false;
+    }
+
+    return 0 != (qspi_flash_read_reg(SPI_FLASH_CMD_RDSR1) & SPI_FLASH_SR2_QE);
+}
+#endif
+
+/* Pick the read mode with most data lines, then with fewest clocks ahead of the data. */
+static void qspi_flash_read_mode_select(void)
+{
+    static const uint8_t addr_lines[SPI_FLASH_READ_MODE_MAX] = {1, 1, 2, 1, 4, 4};
+    static const uint8_t data_lines[SPI_FLASH_READ_MODE_MAX] = {1, 2, 2, 4, 4, 4};
+    const spi_flash_read_cmd_t *p_cmd;
+    uint8_t  max_lines = 1;
+    uint8_t  best_lines = 1;
+    uint32_t best_clocks = 0xFFFFFFFF;
+    uint32_t clocks;
+    uint8_t  mode;
+
+    if (g_flash_init.is_quad_line)
+    {
+        max_lines = 4;
+    }
+    else if (g_flash_init.is_dual_line)
+    {
+        max_lines = 2;
+    }
+
+#if (SPI_FLASH_USING_SFDP == 1)
+    if (4 == max_lines &&
+        (g_sfdp_info.read_modes & ((1 << SPI_FLASH_READ_1_1_4) | (1 << SPI_FLASH_READ_1_4_4))) &&
+        !qspi_flash_quad_enable(g_sfdp_info.quad_enable))
+    {
+        max_lines = 2;
+    }
+#endif
+
+    g_sfdp_info.read_mode = SPI_FLASH_READ_1_1_1;
+
+    /* 4-4-4 needs QPI mode for all commands, it is not used */
+    for (mode = SPI_FLASH_READ_1_1_1; mode < SPI_FLASH_READ_4_4_4; mode++)
+    {
+        p_cmd = &g_sfdp_info.read_cmd[mode];
+        if (!(g_sfdp_info.read_modes & (1 << mode)) || data_lines[mode] > max_lines)
+        {
+            continue;
+        }
+
+        /* mode bits on several lines must fill exactly one byte behind a 3-byte address */
+        if (addr_lines[mode] > 1 && p_cmd->mode_cycles &&
+            (p_cmd->mode_cycles * addr_lines[mode] != 8 || 4 == g_sfdp_info.addr_bytes))
+        {
+            continue;
+        }
+
+        clocks = 8 + g_sfdp_info.addr_bytes * 8 / addr_lines[mode] + p_cmd->mode_cycles + p_cmd->dummy_cycles;
+        if (data_lines[mode] > best_lines || (data_lines[mode] == best_lines && clocks < best_clocks))
+        {
+            best_lines  = data_lines[mode];
+            best_clocks = clocks;
+            g_sfdp_info.read_mode = (spi_flash_read_mode_t)mode;
+        }
+    }
+}
+#endif
+
+#if SPI_FLASH_ASYNC_ENABLE
+static uint8_t spi_flash_addr_frame(uint8_t cmd, uint32_t address, uint8_t *p_frame)
+{
+    p_frame[0] = cmd;
+    if(4 == g_sfdp_info.addr_bytes)
+    {
+        p_frame[1] = (address >> 24) & 0xFF;
+        p_frame[2] = (address >> 16) & 0xFF;
+        p_frame[3] = (address >> 8) & 0xFF;
+        p_frame[4] = address & 0xFF;
+        return 5;
+    }
+
+    p_frame[1] = (address >> 16) & 0xFF;
+    p_frame[2] = (address >> 8) & 0xFF;
+    p_frame[3] = address & 0xFF;
+    return 4;
+}
+
+static uint16_t spi_flash_async_write_enable(void)
+{
+    s_flash_async.cmd[0] = SPI_FLASH_CMD_WREN;
+
+    if (FLASH_SPIM_ID == g_flash_init.spi_type)
+    {
+        return app_spi_dma_transmit_async(g_qspi_ctl.spi_id, s_flash_async.cmd, 1);
+    }
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    return app_qspi_dma_transmit_async_ex(g_qspi_ctl.qspi_id, QSPI_DATA_MODE_SPI, QSPI_DATASIZE_08_BITS, s_flash_async.cmd, 1);
+#else
+    return APP_DRV_ERR_INVALID_ID;
+#endif
+}
+
+static uint16_t spi_flash_async_command(void)
+{
+    spi_flash_async_req_t *p_req = &s_flash_async.queue[s_flash_async.head];
+    uint8_t                len;
+
+    if (SPI_FLASH_ASYNC_OP_ERASE == p_req->op)
+    {
+        len = spi_flash_addr_frame(s_flash_async.erase_cmd, s_flash_async.address, s_flash_async.cmd);
+        if (FLASH_SPIM_ID == g_flash_init.spi_type)
+        {
+            return app_spi_dma_transmit_async(g_qspi_ctl.spi_id, s_flash_async.cmd, len);
+        }
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+        return app_qspi_dma_transmit_async_ex(g_qspi_ctl.qspi_id, QSPI_DATA_MODE_SPI, QSPI_DATASIZE_08_BITS, s_flash_async.cmd, len);
+#else
+        return APP_DRV_ERR_INVALID_ID;
+#endif
+    }
+
+    if (FLASH_SPIM_ID == g_flash_init.spi_type)
+    {
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X)
+        if(4 == g_sfdp_info.addr_bytes)
+        {
+            return app_spim_dma_transmit_with_ia_32addr(g_qspi_ctl.spi_id, SPI_FLASH_CMD_PP, s_flash_async.address, s_flash_async.buffer, s_flash_async.step);
+        }
+#endif
+        return app_spim_dma_transmit_with_ia(g_qspi_ctl.spi_id, SPI_FLASH_CMD_PP, s_flash_async.address, s_flash_async.buffer, s_flash_async.step);
+    }
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    else
+    {
+        qspi_command_t command = {
+            .instruction      = g_flash_init.is_dual_line ? SPI_FLASH_CMD_DPP : SPI_FLASH_CMD_PP,
+            .address          = s_flash_async.address,
+            .instruction_size = QSPI_INSTSIZE_08_BITS,
+            .address_size     = g_addr_size,
+            .data_size        = QSPI_DATASIZE_08_BITS,
+            .dummy_cycles     = 0,
+            .instruction_address_mode = QSPI_INST_ADDR_ALL_IN_SPI,
+            .data_mode        = g_flash_init.is_dual_line ? QSPI_DATA_MODE_DUALSPI : QSPI_DATA_MODE_SPI,
+            .length           = s_flash_async.step,
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+            .clock_stretch_en = 1,
+#endif
+        };
+
+        return app_qspi_dma_command_transmit_async(g_qspi_ctl.qspi_id, &command, s_flash_async.buffer);
+    }
+#else
+    return APP_DRV_ERR_INVALID_ID;
+#endif
+}
+
+static uint16_t spi_flash_async_read_status(void)
+{
+    s_flash_async.cmd[0] = SPI_FLASH_CMD_RDSR;
+
+    if (FLASH_SPIM_ID == g_flash_init.spi_type)
+    {
+        return app_spi_dma_read_eeprom_async(g_qspi_ctl.spi_id, s_flash_async.cmd, &s_flash_async.status, 1, 1);
+    }
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    else
+    {
+        qspi_command_t command = {
+            .instruction      = SPI_FLASH_CMD_RDSR,
+            .address          = 0,
+            .instruction_size = QSPI_INSTSIZE_08_BITS,
+            .address_size     = QSPI_ADDRSIZE_00_BITS,
+            .data_size        = QSPI_DATASIZE_08_BITS,
+            .dummy_cycles     = 0,
+            .instruction_address_mode = QSPI_INST_ADDR_ALL_IN_SPI,
+            .data_mode        = QSPI_DATA_MODE_SPI,
+            .length           = 1,
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+            .clock_stretch_en = 1,
+#endif
+        };
+
+        return app_qspi_dma_command_receive_async(g_qspi_ctl.qspi_id, &command, &s_flash_async.status);
+    }
+#else
+    return APP_DRV_ERR_INVALID_ID;
+#endif
+}
+
+static void spi_flash_async_next(void);
+
+static void spi_flash_async_done(bool success)
+{
+    spi_flash_async_req_t req = s_flash_async.queue[s_flash_async.head];
+
+    /* Retire the request before its callback, which may push another request or access the flash synchronously. */
+    GLOBAL_EXCEPTION_DISABLE();
+    s_flash_async.head = (s_flash_async.head + 1) % SPI_FLASH_ASYNC_QUEUE_SIZE;
+    s_flash_async.count--;
+    s_flash_async.state = SPI_FLASH_ASYNC_IDLE;
+    GLOBAL_EXCEPTION_ENABLE();
+
+    spi_flash_async_next();
+
+    if (req.callback)
+    {
+        req.callback(req.op, req.address, success);
+    }
+}
+
+/* Start the write enable of the next page or erase block, the command follows from its completion. */
+static void spi_flash_async_step(void)
+{
+    if (SPI_FLASH_ASYNC_OP_ERASE == s_flash_async.queue[s_flash_async.head].op)
+    {
+        s_flash_async.step = spi_flash_erase_plan(s_flash_async.address, s_flash_async.address + s_flash_async.remain, &s_flash_async.erase_cmd);
+    }
+    else
+    {
+        s_flash_async.step = g_sfdp_info.page_size - (s_flash_async.address & (g_sfdp_info.page_size - 1));
+        if (s_flash_async.step > s_flash_async.remain)
+        {
+            s_flash_async.step = s_flash_async.remain;
+        }
+    }
+
+    s_flash_async.state = SPI_FLASH_ASYNC_WREN;
+    if (APP_DRV_SUCCESS != spi_flash_async_write_enable())
+    {
+        spi_flash_async_done(false);
+    }
+}
+
+static void spi_flash_async_next(void)
+{
+    spi_flash_async_req_t *p_req;
+    bool                   start;
+
+    /* A running request starts the next one itself when it is done. */
+    GLOBAL_EXCEPTION_DISABLE();
+    start = (SPI_FLASH_ASYNC_IDLE == s_flash_async.state) && (0 != s_flash_async.count);
+    if (start)
+    {
+        s_flash_async.state = SPI_FLASH_ASYNC_WREN;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (!start)
+    {
+        return;
+    }
+
+    p_req = &s_flash_async.queue[s_flash_async.head];
+    s_flash_async.address = p_req->address;
+    s_flash_async.buffer  = p_req->buffer;
+    s_flash_async.remain  = p_req->nbytes;
+    spi_flash_async_step();
+}
+
+static void spi_flash_async_timeout_handler(void *p_ctx)
+{
+    s_flash_async.state = SPI_FLASH_ASYNC_RDSR;
+    if (APP_DRV_SUCCESS != spi_flash_async_read_status())
+    {
+        spi_flash_async_done(false);
+    }
+}
+
+static void spi_flash_async_poll_start(void)
+{
+    uint32_t poll_ms = (SPI_FLASH_ASYNC_OP_ERASE == s_flash_async.queue[s_flash_async.head].op) ?
+                       SPI_FLASH_ASYNC_ERASE_POLL_MS : SPI_FLASH_ASYNC_PROGRAM_POLL_MS;
+
+    s_flash_async.state = SPI_FLASH_ASYNC_WAIT;
+    if (SDK_SUCCESS != app_timer_start(s_flash_async.timer_id, poll_ms, NULL))
+    {
+        spi_flash_async_done(false);
+    }
+}
+
+static void spi_flash_async_evt_handler(uint8_t evt)
+{
+    if (SPI_FLASH_ASYNC_EVT_ERROR == evt)
+    {
+        spi_flash_async_done(false);
+        return;
+    }
+
+    switch (s_flash_async.state)
+    {
+        case SPI_FLASH_ASYNC_WREN:
+            s_flash_async.state = SPI_FLASH_ASYNC_CMD;
+            if (APP_DRV_SUCCESS != spi_flash_async_command())
+            {
+                spi_flash_async_done(false);
+            }
+            break;
+
+        case SPI_FLASH_ASYNC_CMD:
+            spi_flash_async_poll_start();
+            break;
+
+        case SPI_FLASH_ASYNC_RDSR:
+            if (SPI_FLASH_ASYNC_EVT_RX != evt)
+            {
+                break;
+            }
+
+            if (s_flash_async.status & SPI_FLASH_STATUS_WIP)
+            {
+                spi_flash_async_poll_start();
+                break;
+            }
+
+            s_flash_async.address += s_flash_async.step;
+            s_flash_async.remain  -= s_flash_async.step;
+            if (SPI_FLASH_ASYNC_OP_WRITE == s_flash_async.queue[s_flash_async.head].op)
+            {
+                s_flash_async.buffer += s_flash_async.step;
+            }
+
+            if (s_flash_async.remain)
+            {
+                spi_flash_async_step();
+            }
+            else
+            {
+                spi_flash_async_done(true);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static uint16_t spi_flash_async_push(spi_flash_async_op_t op, uint32_t address, uint8_t *buffer, uint32_t nbytes, spi_flash_async_cb_t callback)
+{
+    spi_flash_async_req_t *p_req;
+
+    if (0 == nbytes)
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    if (!s_flash_async.timer_created)
+    {
+        if (SDK_SUCCESS != app_timer_create(&s_flash_async.timer_id, ATIMER_ONE_SHOT, spi_flash_async_timeout_handler))
+        {
+            return APP_DRV_ERR_HAL;
+        }
+        s_flash_async.timer_created = true;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if (s_flash_async.count >= SPI_FLASH_ASYNC_QUEUE_SIZE)
+    {
+        p_req = NULL;
+    }
+    else
+    {
+        p_req = &s_flash_async.queue[(s_flash_async.head + s_flash_async.count) % SPI_FLASH_ASYNC_QUEUE_SIZE];
+        p_req->op       = op;
+        p_req->address  = address;
+        p_req->buffer   = buffer;
+        p_req->nbytes   = nbytes;
+        p_req->callback = callback;
+        s_flash_async.count++;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (NULL == p_req)
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    spi_flash_async_next();
+
+    return APP_DRV_SUCCESS;
+}
 #endif
 
 /*
@@ -797,22 +1566,25 @@ uint32_t spi_flash_init(flash_init_t *p_flash_init)
             return SPI_FLASH_SPI_DMA_FAIL;
         }
 
-        /* set qspi hold/wp pin to high */
-        app_io_init_t io_init = APP_IO_DEFAULT_CONFIG;
-        io_init.mode = APP_IO_MODE_OUTPUT;
-        io_init.pull = APP_IO_PULLUP;
-        io_init.pin  = qspi_params.pin_cfg.io_2.pin;
-        io_init.mux  = APP_IO_MUX;
-        app_io_init(qspi_params.pin_cfg.io_2.type, &io_init);
-
-        io_init.mode = APP_IO_MODE_OUTPUT;
-        io_init.pull = APP_IO_PULLUP;
-        io_init.pin  = qspi_params.pin_cfg.io_3.pin;
-        io_init.mux  = APP_IO_MUX;
-        app_io_init(qspi_params.pin_cfg.io_3.type , &io_init);
-
-        app_io_write_pin(qspi_params.pin_cfg.io_2.type, qspi_params.pin_cfg.io_2.pin, APP_IO_PIN_SET);
-        app_io_write_pin(qspi_params.pin_cfg.io_3.type, qspi_params.pin_cfg.io_3.pin, APP_IO_PIN_SET);
+        /* set qspi hold/wp pin to high, unless they are IO2/IO3 of quad read */
+        if (!p_flash_init->is_quad_line)
+        {
+            app_io_init_t io_init = APP_IO_DEFAULT_CONFIG;
+            io_init.mode = APP_IO_MODE_OUTPUT;
+            io_init.pull = APP_IO_PULLUP;
+            io_init.pin  = qspi_params.pin_cfg.io_2.pin;
+            io_init.mux  = APP_IO_MUX;
+            app_io_init(qspi_params.pin_cfg.io_2.type, &io_init);
+
+            io_init.mode = APP_IO_MODE_OUTPUT;
+            io_init.pull = APP_IO_PULLUP;
+            io_init.pin  = qspi_params.pin_cfg.io_3.pin;
+            io_init.mux  = APP_IO_MUX;
+            app_io_init(qspi_params.pin_cfg.io_3.type , &io_init);
+
+            app_io_write_pin(qspi_params.pin_cfg.io_2.type, qspi_params.pin_cfg.io_2.pin, APP_IO_PIN_SET);
+            app_io_write_pin(qspi_params.pin_cfg.io_3.type, qspi_params.pin_cfg.io_3.pin, APP_IO_PIN_SET);
+        }
 
         qspi_flash_wakeup();
 
@@ -822,11 +1594,18 @@ uint32_t spi_flash_init(flash_init_t *p_flash_init)
 
     /* Select address width according to flash size */
 #if (SPI_FLASH_USING_SFDP == 1)
-    g_flash_size = spi_flash_device_size();
+    spi_flash_sfdp_detect();
+    g_flash_size = g_sfdp_info.size ? g_sfdp_info.size : spi_flash_device_size();
+    if (g_flash_size > FLASH_SIZE_16M)
+    {
+        g_sfdp_info.addr_bytes = 4;
+    }
 #else
+    memcpy(&g_sfdp_info, &s_sfdp_default, sizeof(g_sfdp_info));
     g_flash_size = p_flash_init->spi_flash_addr_size;
+    g_sfdp_info.addr_bytes = (SPI_FLASH_USING_32BIT_ADDR == p_flash_init->spi_flash_addr_size) ? 4 : 3;
 #endif
-    if (g_flash_size > FLASH_SIZE_16M)
+    if (4 == g_sfdp_info.addr_bytes)
     {
         if (FLASH_SPIM_ID == p_flash_init->spi_type)
         {
@@ -840,6 +1619,13 @@ uint32_t spi_flash_init(flash_init_t *p_flash_init)
         }
 #endif
     }
+
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    if (FLASH_SPIM_ID != p_flash_init->spi_type)
+    {
+        qspi_flash_read_mode_select();
+    }
+#endif
     return SPI_FLASH_SPI_SUCCESS;
 }
 
@@ -848,7 +1634,7 @@ uint32_t spi_flash_deinit(void)
     uint16_t ret;
     if (FLASH_SPIM_ID == g_flash_init.spi_type)
     {
-        if(g_flash_size > FLASH_SIZE_16M)
+        if(4 == g_sfdp_info.addr_bytes)
         {
             spim_flash_addr_32bit_disable();
         }
@@ -868,7 +1654,7 @@ uint32_t spi_flash_deinit(void)
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
     else
     {
-        if(g_flash_size > FLASH_SIZE_16M)
+        if(4 == g_sfdp_info.addr_bytes)
         {
             qspi_flash_addr_32bit_disable();
         }
@@ -894,10 +1680,17 @@ uint32_t spi_flash_write(uint32_t address, uint8_t *buffer, uint32_t nbytes)
     uint32_t page_ofs, write_size, write_cont = nbytes;
     uint32_t count = 0;
 
+#if SPI_FLASH_ASYNC_ENABLE
+    if (spi_flash_async_busy())
+    {
+        return SPI_FLASH_TRANSMIT_FAIL;
+    }
+#endif
+
     while (write_cont)
     {
-        page_ofs = address & 0xFF;
-        write_size = EXFLASH_SIZE_PAGE_BYTES - page_ofs;
+        page_ofs = address & (g_sfdp_info.page_size - 1);
+        write_size = g_sfdp_info.page_size - page_ofs;
 
         if (write_cont < write_size)
         {
@@ -943,6 +1736,13 @@ uint32_t spi_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbytes)
 {
     uint32_t count = 0;
 
+#if SPI_FLASH_ASYNC_ENABLE
+    if (spi_flash_async_busy())
+    {
+        return SPI_FLASH_TRANSMIT_FAIL;
+    }
+#endif
+
     if (FLASH_SPIM_ID == g_flash_init.spi_type)
     {
         count = spim_flash_read(address, buffer, nbytes);
@@ -950,14 +1750,7 @@ uint32_t spi_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbytes)
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
     else
     {
-        if (g_flash_init.is_dual_line)
-        {
-            count = qspi_flash_dual_read(address, buffer, nbytes);
-        }
-        else
-        {
-            count = qspi_flash_read(address, buffer, nbytes);
-        }
+        count = qspi_flash_read(address, buffer, nbytes);
     }
 #endif
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
@@ -969,39 +1762,42 @@ uint32_t spi_flash_read(uint32_t address, uint8_t *buffer, uint32_t nbytes)
 
 bool spi_flash_sector_erase(uint32_t address, uint32_t size)
 {
-    bool status = true;
+    bool status = SPI_FLASH_ERASE_SUCCESS;
 
-    uint32_t erase_addr = address;
-    uint32_t sector_ofs, erase_size, erase_cont = size;
+    uint32_t erase_addr = address & ~(EXFLASH_SIZE_SECTOR_BYTES - 1);
+    uint32_t erase_end  = (address + size + EXFLASH_SIZE_SECTOR_BYTES - 1) & ~(EXFLASH_SIZE_SECTOR_BYTES - 1);
+    uint32_t erase_size;
+    uint8_t  erase_cmd;
 
-    while (erase_cont)
+#if SPI_FLASH_ASYNC_ENABLE
+    if (spi_flash_async_busy())
     {
-        sector_ofs = erase_addr & 0xFFF;
-        erase_size = EXFLASH_SIZE_SECTOR_BYTES - sector_ofs;
+        return SPI_FLASH_ERASE_FAIL;
+    }
+#endif
 
-        if (erase_cont < erase_size)
-        {
-            erase_size = erase_cont;
-            erase_cont = 0;
-        }
-        else
-        {
-            erase_cont -= erase_size;
-        }
+    /* Whole 32KB/64KB blocks in the region are erased by block erase, which is much faster per byte. */
+    while (size && erase_addr < erase_end)
+    {
+        erase_size = spi_flash_erase_plan(erase_addr, erase_end, &erase_cmd);
 
         spi_flash_write_enable();
         if (FLASH_SPIM_ID == g_flash_init.spi_type)
         {
-            status = spim_flash_sector_erase(erase_addr);
+            status = spim_flash_erase(erase_cmd, erase_addr);
         }
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
         else
         {
-            status = qspi_flash_sector_erase(erase_addr);
+            status = qspi_flash_erase(erase_cmd, erase_addr);
         }
 #endif
-        while(spi_flash_read_status() & 0x1);
+        while(spi_flash_read_status() & SPI_FLASH_STATUS_WIP);
 
+        if (SPI_FLASH_ERASE_SUCCESS != status)
+        {
+            break;
+        }
         erase_addr += erase_size;
     }
 
@@ -1013,6 +1809,14 @@ bool spi_flash_chip_erase(void)
     uint32_t ret;
 
     uint8_t control_frame[1] = {SPI_FLASH_CMD_CE};
+
+#if SPI_FLASH_ASYNC_ENABLE
+    if (spi_flash_async_busy())
+    {
+        return SPI_FLASH_ERASE_FAIL;
+    }
+#endif
+
     spi_flash_write_enable();
 
     if (FLASH_SPIM_ID == g_flash_init.spi_type)
@@ -1138,3 +1942,47 @@ void spi_flash_device_info(uint32_t *id, uint32_t *size)
 
     return;
 }
+
+#if (SPI_FLASH_USING_SFDP == 1)
+void spi_flash_sfdp_info_get(spi_flash_sfdp_info_t *p_info)
+{
+    if (NULL == p_info)
+    {
+        return;
+    }
+
+    memcpy(p_info, &g_sfdp_info, sizeof(spi_flash_sfdp_info_t));
+}
+#endif
+
+#if SPI_FLASH_ASYNC_ENABLE
+uint16_t spi_flash_write_async(uint32_t address, uint8_t *buffer, uint32_t nbytes, spi_flash_async_cb_t callback)
+{
+    if (NULL == buffer)
+    {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    return spi_flash_async_push(SPI_FLASH_ASYNC_OP_WRITE, address, buffer, nbytes, callback);
+}
+
+uint16_t spi_flash_sector_erase_async(uint32_t address, uint32_t size, spi_flash_async_cb_t callback)
+{
+    uint32_t erase_addr = address & ~(EXFLASH_SIZE_SECTOR_BYTES - 1);
+
+    if (0 == size)
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    /* whole sectors covering the region */
+    size = ((address + size + EXFLASH_SIZE_SECTOR_BYTES - 1) & ~(EXFLASH_SIZE_SECTOR_BYTES - 1)) - erase_addr;
+
+    return spi_flash_async_push(SPI_FLASH_ASYNC_OP_ERASE, erase_addr, NULL, size, callback);
+}
+
+bool spi_flash_async_busy(void)
+{
+    return (0 != s_flash_async.count);
+}
+#endif
@@ -107,6 +107,22 @@ extern "C" {
 
 #define SPI_FLASH_USING_SFDP            1
 
+/* Program/erase in background, WIP polled by app_timer, which is needed then.
+ * While async requests are queued or in progress, spi_flash_write/read/sector_erase/chip_erase fail at once,
+ * check spi_flash_async_busy() before a blocking call. */
+#ifndef SPI_FLASH_ASYNC_ENABLE
+#define SPI_FLASH_ASYNC_ENABLE          0
+#endif
+#ifndef SPI_FLASH_ASYNC_QUEUE_SIZE
+#define SPI_FLASH_ASYNC_QUEUE_SIZE      8 /* async requests queued at most */
+#endif
+#ifndef SPI_FLASH_ASYNC_PROGRAM_POLL_MS
+#define SPI_FLASH_ASYNC_PROGRAM_POLL_MS 1  /* WIP poll interval of page program */
+#endif
+#ifndef SPI_FLASH_ASYNC_ERASE_POLL_MS
+#define SPI_FLASH_ASYNC_ERASE_POLL_MS   10 /* WIP poll interval of sector erase */
+#endif
+
 #define SPI_FLASH_SPI_SUCCESS           ((uint32_t)0x00000000) /* spi/qspi init success */
 #define SPI_FLASH_SPI_FAIL              ((uint32_t)0x00000001) /* spi/qspi init fail */
 #define SPI_FLASH_SPI_DMA_FAIL          ((uint32_t)0x00000002) /* spi/qspi dma init fail */
@@ -177,6 +193,7 @@ typedef struct _flash_init
     flash_io_t  flash_io;
     bool        is_dual_line;
     bool        is_high_freq;
+    bool        is_quad_line;       /**< IO2/IO3 wired to the flash, quad read allowed if SFDP reports it. */
 #if (SPI_FLASH_USING_SFDP == 0)
     spi_addr_size_t spi_flash_addr_size;
 #endif
@@ -195,6 +212,55 @@ typedef struct flash_control
     app_spi_id_t    spi_id;
 } qspi_control_t;
 
+typedef enum
+{
+    SPI_FLASH_READ_1_1_1,            /**< Instruction, address and data on one line. */
+    SPI_FLASH_READ_1_1_2,            /**< Data on two lines. */
+    SPI_FLASH_READ_1_2_2,            /**< Address and data on two lines. */
+    SPI_FLASH_READ_1_1_4,            /**< Data on four lines. */
+    SPI_FLASH_READ_1_4_4,            /**< Address and data on four lines. */
+    SPI_FLASH_READ_4_4_4,            /**< QPI, reported only, the driver does not enter QPI mode. */
+    SPI_FLASH_READ_MODE_MAX,
+} spi_flash_read_mode_t;
+
+typedef struct
+{
+    uint8_t opcode;                  /**< Read instruction. */
+    uint8_t dummy_cycles;            /**< Wait state clocks. */
+    uint8_t mode_cycles;             /**< Mode bit clocks ahead of the wait states, sent as 0. */
+} spi_flash_read_cmd_t;
+
+typedef struct
+{
+    uint8_t size_shift;              /**< Log2 of erase size. */
+    uint8_t cmd;                     /**< Erase instruction. */
+} spi_flash_erase_type_t;
+
+/**@brief Flash parameters found in the JEDEC basic flash parameter table. */
+typedef struct
+{
+    uint32_t               size;                                      /**< Density in bytes, 0 if no SFDP found. */
+    uint32_t               page_size;                                 /**< Page program size in bytes. */
+    uint8_t                addr_bytes;                                /**< Address bytes in use, 3 or 4. */
+    uint8_t                quad_enable;                               /**< Quad enable requirement (BFPT DWORD 15 bits 22:20), 0xFF if unknown. */
+    uint8_t                read_modes;                                /**< Bit n set if @ref spi_flash_read_mode_t n is supported. */
+    spi_flash_read_cmd_t   read_cmd[SPI_FLASH_READ_MODE_MAX];         /**< Read command of every supported mode. */
+    spi_flash_read_mode_t  read_mode;                                 /**< Read mode selected by the driver. */
+    uint8_t                erase_type_num;                            /**< Number of erase types. */
+    spi_flash_erase_type_t erase_type[4];                             /**< Erase types sorted by size, the 4KB sector erase first. */
+} spi_flash_sfdp_info_t;
+
+#if SPI_FLASH_ASYNC_ENABLE
+typedef enum
+{
+    SPI_FLASH_ASYNC_OP_WRITE,        /**< Program, split into pages. */
+    SPI_FLASH_ASYNC_OP_ERASE,        /**< Sector erase, split into sectors. */
+} spi_flash_async_op_t;
+
+/**@brief Async request done callback, called in interrupt context after the next queued request is started. */
+typedef void (*spi_flash_async_cb_t)(spi_flash_async_op_t op, uint32_t address, bool success);
+#endif
+
 /** @} */
 
 /* Exported functions --------------------------------------------------------*/
@@ -309,6 +375,21 @@ uint32_t spi_flash_device_id(void);
  */
 void spi_flash_device_info(uint32_t *id, uint32_t *size);
 
+#if (SPI_FLASH_USING_SFDP == 1)
+/**
+ *******************************************************************************
+ * @brief Get the flash parameters read from SFDP by spi_flash_init.
+ *
+ * @note Reads use the fastest mode in the table the wiring allows:
+ *       1-1-4, 1-4-4 (is_quad_line and quad enable done), then 1-1-2, 1-2-2
+ *       (is_dual_line or is_quad_line), else 1-1-1. SPI master reads 1-1-1 only.
+ *
+ * @param[out] p_info: Pointer to flash parameters.
+ *******************************************************************************
+ */
+void spi_flash_sfdp_info_get(spi_flash_sfdp_info_t *p_info);
+#endif
+
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5332X)
 /**
  *******************************************************************************
@@ -327,6 +408,58 @@ void spi_flash_device_info(uint32_t *id, uint32_t *size);
 bool spi_flash_erase(uint32_t erase_type, uint32_t address, uint32_t size);
 #endif
 
+#if SPI_FLASH_ASYNC_ENABLE
+/**
+ *******************************************************************************
+ * @brief Queue a flash write done in background.
+ *
+ * @note Every page is programmed by DMA and the WIP bit is polled from an
+ *       app_timer, the next page is chained from the poll that finds it done,
+ *       so the CPU is free while the flash is busy. Requests are done in the
+ *       order queued, the buffer must be kept until the callback. Blocking
+ *       read/write/erase fail while a request is in progress.
+ *
+ * @param[in] address:  start address in flash to write data to.
+ * @param[in] buffer:   buffer of data to write.
+ * @param[in] nbytes:   number of bytes to write.
+ * @param[in] callback: called when the write is done or failed, can be NULL.
+ *
+ * @retval APP_DRV_SUCCESS: Request queued.
+ * @retval APP_DRV_ERR_BUSY: Queue is full.
+ * @retval APP_DRV_ERR_INVALID_PARAM: Empty request.
+ *******************************************************************************
+ */
+uint16_t spi_flash_write_async(uint32_t address, uint8_t *buffer, uint32_t nbytes, spi_flash_async_cb_t callback);
+
+/**
+ *******************************************************************************
+ * @brief Queue a flash region erase done in background.
+ *
+ * @note Sectors are erased as @ref spi_flash_sector_erase does, with WIP
+ *       polled as in @ref spi_flash_write_async.
+ *
+ * @param[in] address:  start address in flash to erase.
+ * @param[in] size:     number of bytes to erase.
+ * @param[in] callback: called when the erase is done or failed, can be NULL.
+ *
+ * @retval APP_DRV_SUCCESS: Request queued.
+ * @retval APP_DRV_ERR_BUSY: Queue is full.
+ * @retval APP_DRV_ERR_INVALID_PARAM: Empty request.
+ *******************************************************************************
+ */
+uint16_t spi_flash_sector_erase_async(uint32_t address, uint32_t size, spi_flash_async_cb_t callback);
+
+/**
+ *******************************************************************************
+ * @brief Check whether async requests are queued or in progress.
+ *
+ * @retval true: Flash is busy with async requests.
+ * @retval false: Flash is free for blocking operations.
+ *******************************************************************************
+ */
+bool spi_flash_async_busy(void);
+#endif
+
 /** @} */
 
 #ifdef __cplusplus
@@ -41,8 +41,10 @@
  */
 #include "app_key.h"
 #include "app_gpiote.h"
+#include "grx_hal.h"
 
 #include "app_timer.h"
+#include <string.h>
 /*
  * DEFINES
  *****************************************************************************************
@@ -58,6 +60,10 @@ static app_key_evt_cb_t   s_app_key_evt_cb;
 static uint8_t            s_app_key_reg_num;
 static app_timer_id_t     s_app_key_timer_id;
 static bool               s_is_timer_enabled;
+static app_key_matrix_t   s_app_key_matrix;
+static app_gpiote_param_t s_app_key_matrix_col_cfg[APP_KEY_MATRIX_COL_MAX];
+static uint8_t            s_app_key_matrix_base;         /**< Key index of matrix key at row 0, column 0. */
+static bool               s_is_matrix_scan_needed;       /**< Rows released for scanning, or a column interrupt seen. */
 
 /*
  * LOCAL FUNCTION DEFINITIONS
@@ -94,25 +100,130 @@ static void app_key_press_state_polling(void)
 
 /**
  *****************************************************************************************
- * @brief App key timing timeout handler.
+ * @brief Drive a matrix row low, or release it to input with pull-up.
  *****************************************************************************************
  */
-static void app_key_timeout_handler(void *p_arg)
+static void app_key_matrix_row_drive(uint8_t row, bool is_driven)
 {
-    app_key_press_state_polling();
-    app_key_core_polling_10ms();
+    app_io_init_t io_init;
+
+    io_init.pin  = s_app_key_matrix.row[row].gpio_pin;
+    io_init.mode = is_driven ? APP_IO_MODE_OUTPUT : APP_IO_MODE_INPUT;
+    io_init.pull = is_driven ? APP_IO_NOPULL : APP_IO_PULLUP;
+    io_init.mux  = APP_IO_MUX;
+    app_io_init(s_app_key_matrix.row[row].gpio_type, &io_init);
+
+    if (is_driven)
+    {
+        app_io_write_pin(s_app_key_matrix.row[row].gpio_type, s_app_key_matrix.row[row].gpio_pin, APP_IO_PIN_RESET);
+    }
 }
 
 /**
  *****************************************************************************************
- * @brief Start app key timer.
+ * @brief Drive all matrix rows low, any key press then triggers a column interrupt.
  *****************************************************************************************
  */
-static void app_key_timer_start(void)
+static void app_key_matrix_idle(void)
 {
-    app_timer_create(&s_app_key_timer_id, ATIMER_REPEAT, app_key_timeout_handler);
-    app_timer_start(s_app_key_timer_id, APP_KEY_TIMER_INTERVAL, NULL);
-    s_is_timer_enabled = true;
+    for (uint8_t row = 0; row < s_app_key_matrix.row_num; row++)
+    {
+        app_key_matrix_row_drive(row, true);
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Check two rows share two pressed columns, so that a ghost key may be seen.
+ *****************************************************************************************
+ */
+static bool app_key_matrix_is_ghost(const uint32_t *p_row_bits)
+{
+    uint32_t common;
+
+    for (uint8_t row = 0; row < s_app_key_matrix.row_num; row++)
+    {
+        for (uint8_t other = row + 1; other < s_app_key_matrix.row_num; other++)
+        {
+            common = p_row_bits[row] & p_row_bits[other];
+            if (common & (common - 1))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Scan app key matrix pressed state.
+ *****************************************************************************************
+ */
+static void app_key_matrix_scan(void)
+{
+    uint32_t row_bits[APP_KEY_MATRIX_ROW_MAX];
+    uint32_t pressed_bits = 0;
+    uint8_t  key_idx;
+    bool     is_pressed;
+
+    if (0 == s_app_key_matrix.row_num || !s_is_matrix_scan_needed)
+    {
+        return;
+    }
+
+    for (uint8_t row = 0; row < s_app_key_matrix.row_num; row++)
+    {
+        app_key_matrix_row_drive(row, false);
+    }
+
+    for (uint8_t row = 0; row < s_app_key_matrix.row_num; row++)
+    {
+        row_bits[row] = 0;
+
+        app_key_matrix_row_drive(row, true);
+        delay_us(APP_KEY_MATRIX_SETTLE_US);
+        for (uint8_t col = 0; col < s_app_key_matrix.col_num; col++)
+        {
+            if (APP_IO_PIN_RESET == app_io_read_pin(s_app_key_matrix.col[col].gpio_type, s_app_key_matrix.col[col].gpio_pin))
+            {
+                row_bits[row] |= (1u << col);
+            }
+        }
+        app_key_matrix_row_drive(row, false);
+
+        pressed_bits |= row_bits[row];
+    }
+
+    /* A ghost scan can not tell which keys are pressed, keep the former state. */
+    if (app_key_matrix_is_ghost(row_bits))
+    {
+        return;
+    }
+
+    key_idx = s_app_key_matrix_base;
+    for (uint8_t row = 0; row < s_app_key_matrix.row_num; row++)
+    {
+        for (uint8_t col = 0; col < s_app_key_matrix.col_num; col++, key_idx++)
+        {
+            is_pressed = (row_bits[row] >> col) & 1;
+
+            app_key_core_key_pressed_record(key_idx, is_pressed);
+            if (is_pressed)
+            {
+                app_key_core_key_wait_polling_record(key_idx);
+            }
+        }
+    }
+
+    /* All released: no scan till a column interrupt, while click timing goes on.
+     * The flag is cleared before the rows are driven, a key held meanwhile raises the interrupt again. */
+    if (0 == pressed_bits)
+    {
+        s_is_matrix_scan_needed = false;
+        app_key_matrix_idle();
+    }
 }
 
 /**
@@ -128,16 +239,44 @@ void app_key_timer_stop(void)
 
 /**
  *****************************************************************************************
- * @brief App key core event handler.
+ * @brief App key timing timeout handler.
  *****************************************************************************************
  */
-static void app_key_core_evt_handler(uint8_t key_idx, app_key_click_type_t key_click_type)
+static void app_key_timeout_handler(void *p_arg)
 {
-    if (app_key_core_is_all_release())
+    app_key_press_state_polling();
+    app_key_matrix_scan();
+    app_key_core_polling_10ms();
+
+    /* No click in progress and no matrix scan pending: stop polling, the next press interrupt starts it again.
+     * Checked with interrupts off, so that a column interrupt can not be missed between the check and the stop. */
+    GLOBAL_EXCEPTION_DISABLE();
+    if (app_key_core_is_all_idle() && !s_is_matrix_scan_needed)
     {
         app_key_timer_stop();
     }
+    GLOBAL_EXCEPTION_ENABLE();
+}
+
+/**
+ *****************************************************************************************
+ * @brief Start app key timer.
+ *****************************************************************************************
+ */
+static void app_key_timer_start(void)
+{
+    app_timer_create(&s_app_key_timer_id, ATIMER_REPEAT, app_key_timeout_handler);
+    app_timer_start(s_app_key_timer_id, APP_KEY_TIMER_INTERVAL, NULL);
+    s_is_timer_enabled = true;
+}
 
+/**
+ *****************************************************************************************
+ * @brief App key core event handler.
+ *****************************************************************************************
+ */
+static void app_key_core_evt_handler(uint8_t key_idx, app_key_click_type_t key_click_type)
+{
     s_app_key_evt_cb(s_app_key_info[key_idx], key_click_type);
 }
 
@@ -161,6 +300,19 @@ static void app_gpiote_event_handler(app_io_evt_t *p_evt)
     }
 }
 
+static void app_key_matrix_gpiote_event_handler(app_io_evt_t *p_evt)
+{
+    if (NULL == p_evt)
+        return;
+
+    /* The pressed key is found by the next scan. */
+    s_is_matrix_scan_needed = true;
+    if (!s_is_timer_enabled)
+    {
+        app_key_timer_start();
+    }
+}
+
 
 
 /*
@@ -208,4 +360,48 @@ bool app_key_init(app_key_gpio_t key_inst[], uint8_t key_num, app_key_evt_cb_t k
     return true;
 }
 
+bool app_key_matrix_init(const app_key_matrix_t *p_matrix, app_key_evt_cb_t key_evt_cb)
+{
+    uint8_t key_num;
+
+    if (NULL == p_matrix || NULL == key_evt_cb ||
+        0 == p_matrix->row_num || APP_KEY_MATRIX_ROW_MAX < p_matrix->row_num ||
+        0 == p_matrix->col_num || APP_KEY_MATRIX_COL_MAX < p_matrix->col_num || 32 < p_matrix->col_num)
+    {
+        return false;
+    }
+
+    key_num = p_matrix->row_num * p_matrix->col_num;
+    if (APP_KEY_REG_COUNT_MAX < s_app_key_reg_num + key_num)
+    {
+        return false;
+    }
+
+    memcpy(&s_app_key_matrix, p_matrix, sizeof(app_key_matrix_t));
+    s_app_key_matrix_base = s_app_key_reg_num;
+
+    for (uint8_t idx = 0; idx < key_num; idx++)
+    {
+        s_app_key_info[s_app_key_matrix_base + idx] = (NULL == p_matrix->p_key_id) ? idx : p_matrix->p_key_id[idx];
+    }
+
+    app_key_matrix_idle();
+
+    for (uint8_t col = 0; col < p_matrix->col_num; col++)
+    {
+        s_app_key_matrix_col_cfg[col].type      = p_matrix->col[col].gpio_type;
+        s_app_key_matrix_col_cfg[col].pin       = p_matrix->col[col].gpio_pin;
+        s_app_key_matrix_col_cfg[col].mode      = APP_IO_MODE_IT_FALLING;
+        s_app_key_matrix_col_cfg[col].pull      = APP_IO_PULLUP;
+        s_app_key_matrix_col_cfg[col].io_evt_cb = app_key_matrix_gpiote_event_handler;
+    }
+
+    app_gpiote_init(s_app_key_matrix_col_cfg, p_matrix->col_num);
+
+    s_app_key_evt_cb = key_evt_cb;
+    app_key_core_cb_register(app_key_core_evt_handler);
+
+    return true;
+}
+
 
@@ -43,6 +43,21 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/**
+ * @defgroup APP_KEY_MAROC Defines
+ * @{
+ */
+#ifndef APP_KEY_MATRIX_ROW_MAX
+#define APP_KEY_MATRIX_ROW_MAX        8    /**< Maximum rows of key matrix, which can be configurable. */
+#endif
+#ifndef APP_KEY_MATRIX_COL_MAX
+#define APP_KEY_MATRIX_COL_MAX        8    /**< Maximum columns of key matrix, no more than 32, which can be configurable. */
+#endif
+#ifndef APP_KEY_MATRIX_SETTLE_US
+#define APP_KEY_MATRIX_SETTLE_US      5    /**< Settle time of columns after driving a row (in units of 1us). */
+#endif
+/** @} */
+
 /**
  * @defgroup APP_KEY_STRUCT Structures
  * @{
@@ -56,6 +71,29 @@ typedef struct
     app_io_pull_t  pull;                 /**< Pull mode.*/
     uint8_t        key_id;               /**< Key register ID. */
 } app_key_gpio_t;
+
+/**@brief App key matrix pin. */
+typedef struct
+{
+    app_io_type_t  gpio_type;            /**< Gpio type. */
+    uint32_t       gpio_pin;             /**< Gpio pin. */
+} app_key_matrix_io_t;
+
+/**@brief App key matrix initialization variables.
+ *
+ * @details Rows are driven low one at a time, columns are read with pull-up. While no key is pressed
+ *          all rows are driven low, so that a key press triggers a column falling edge interrupt.
+ *          A matrix without diodes shows a ghost key at the fourth corner of three keys pressed on a
+ *          rectangle, such scans are dropped and the keys keep their former state.
+ */
+typedef struct
+{
+    app_key_matrix_io_t  row[APP_KEY_MATRIX_ROW_MAX];    /**< Row pins, driven. */
+    app_key_matrix_io_t  col[APP_KEY_MATRIX_COL_MAX];    /**< Column pins, sensed. */
+    uint8_t              row_num;                        /**< Number of rows. */
+    uint8_t              col_num;                        /**< Number of columns. */
+    const uint8_t       *p_key_id;                       /**< Key register IDs in row major order, NULL to use row * col_num + col. */
+} app_key_matrix_t;
 /** @} */
 
 /**
@@ -89,6 +127,22 @@ bool app_key_init(app_key_gpio_t key_inst[], uint8_t key_num, app_key_evt_cb_t k
  *****************************************************************************************
  */
 void app_key_pressed_handler(app_key_gpio_t *p_app_key_info);
+
+/**
+ *****************************************************************************************
+ * @brief App key matrix initialize.
+ *
+ * @note Matrix keys take the key indexes after the keys of @ref app_key_init, so call
+ *       app_key_init first if both are used. row_num * col_num keys together with them
+ *       must not exceed APP_KEY_REG_COUNT_MAX.
+ *
+ * @param[in] p_matrix:     Pointer to key matrix, copied.
+ * @param[in] key_click_cb: App key click event callback.
+ *
+ * @return Result of app key matrix initialization.
+ *****************************************************************************************
+ */
+bool app_key_matrix_init(const app_key_matrix_t *p_matrix, app_key_evt_cb_t key_click_cb);
 /** @} */
 
 #endif
@@ -43,21 +43,21 @@
 #include <string.h>
 
 /*
- * STRUCT DEFINE
+ * DEFINES
  *****************************************************************************************
  */
-/**@brief App key core variable. */
-struct app_key_core_t
-{
-    bool    is_pressed;
-    bool    is_in_polling;
-};
+#define APP_KEY_CORE_BITS_WORDS       ((APP_KEY_REG_COUNT_MAX + 31) / 32)   /**< Words of a bitset over all keys. */
+#define APP_KEY_CORE_BIT_GET(bits, idx)   (((bits)[(idx) >> 5] >> ((idx) & 0x1F)) & 1)
+#define APP_KEY_CORE_BIT_SET(bits, idx)   ((bits)[(idx) >> 5] |= (1u << ((idx) & 0x1F)))
+#define APP_KEY_CORE_BIT_CLR(bits, idx)   ((bits)[(idx) >> 5] &= ~(1u << ((idx) & 0x1F)))
+
 /*
  * LOCAL VARIABLE DEFINITIONS
  *****************************************************************************************
  */
 static app_key_core_evt_cb_t   s_key_core_evt_cb;
-static struct  app_key_core_t  s_key_core_info[APP_KEY_REG_COUNT_MAX];
+static uint32_t                s_key_pressed_bits[APP_KEY_CORE_BITS_WORDS];    /**< Keys read pressed at last polling. */
+static uint32_t                s_key_polling_bits[APP_KEY_CORE_BITS_WORDS];    /**< Keys with a click in progress. */
 
 /*
  * LOCAL FUNCTION DEFINITIONS
@@ -65,8 +65,21 @@ static struct  app_key_core_t  s_key_core_info[APP_KEY_REG_COUNT_MAX];
  */
 static void app_key_core_key_polling_cplt(uint8_t key_idx)
 {
-    s_key_core_info[key_idx].is_pressed    = false;
-    s_key_core_info[key_idx].is_in_polling = false;
+    APP_KEY_CORE_BIT_CLR(s_key_pressed_bits, key_idx);
+    APP_KEY_CORE_BIT_CLR(s_key_polling_bits, key_idx);
+}
+
+static bool app_key_core_bits_is_empty(const uint32_t *p_bits)
+{
+    for (uint8_t word = 0; word < APP_KEY_CORE_BITS_WORDS; word++)
+    {
+        if (p_bits[word])
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /**
@@ -136,14 +149,14 @@ static app_key_state_t app_key_core_state_scan(uint8_t key_idx)
     switch (key_scan_state[key_idx])
     {
         case APP_KEY_STA_INIT:
-            if (s_key_core_info[key_idx].is_pressed)
+            if (APP_KEY_CORE_BIT_GET(s_key_pressed_bits, key_idx))
             {
                 key_scan_state[key_idx] = APP_KEY_STA_DEBOUNCE;
             }
             break;
 
         case APP_KEY_STA_DEBOUNCE:
-            if (s_key_core_info[key_idx].is_pressed)
+            if (APP_KEY_CORE_BIT_GET(s_key_pressed_bits, key_idx))
             {
                 key_long_click_count[key_idx] = 0;
                 key_scan_state[key_idx]       = APP_KEY_STA_PRESS;
@@ -156,7 +169,7 @@ static app_key_state_t app_key_core_state_scan(uint8_t key_idx)
             break;
 
         case APP_KEY_STA_PRESS:
-            if (!s_key_core_info[key_idx].is_pressed)
+            if (!APP_KEY_CORE_BIT_GET(s_key_pressed_bits, key_idx))
             {
                 key_state_return        = APP_KEY_STA_SINGLE_CLICK;
                 key_scan_state[key_idx] = APP_KEY_STA_INIT;
@@ -172,7 +185,7 @@ static app_key_state_t app_key_core_state_scan(uint8_t key_idx)
             break;
 
         case APP_KEY_STA_WAITE_RELEASE:
-            if (!s_key_core_info[key_idx].is_pressed)
+            if (!APP_KEY_CORE_BIT_GET(s_key_pressed_bits, key_idx))
             {
                 key_scan_state[key_idx] = APP_KEY_STA_INIT;
                 app_key_core_key_polling_cplt(key_idx);
@@ -284,36 +297,49 @@ bool app_key_core_cb_register(app_key_core_evt_cb_t key_core_evt_cb)
 
 void app_key_core_polling_10ms()
 {
-    for (uint8_t key_idx = 0; key_idx < APP_KEY_REG_COUNT_MAX; key_idx++)
+    uint32_t polling_mask;
+    uint8_t  key_idx;
+
+    /* Visit only the keys with a click in progress, idle keys cost nothing. */
+    for (uint8_t word = 0; word < APP_KEY_CORE_BITS_WORDS; word++)
     {
-        if (s_key_core_info[key_idx].is_in_polling)
+        polling_mask = s_key_polling_bits[word];
+
+        for (key_idx = word * 32; polling_mask; polling_mask >>= 1, key_idx++)
         {
-            app_key_core_click_read(key_idx);
+            if (polling_mask & 1)
+            {
+                app_key_core_click_read(key_idx);
+            }
         }
     }
 }
 
 void app_key_core_key_wait_polling_record(uint8_t key_idx)
 {
-    s_key_core_info[key_idx].is_in_polling = true;
+    APP_KEY_CORE_BIT_SET(s_key_polling_bits, key_idx);
 }
 
 void app_key_core_key_pressed_record(uint8_t key_idx, bool is_pressed)
 {
-    s_key_core_info[key_idx].is_pressed = is_pressed;
+    if (is_pressed)
+    {
+        APP_KEY_CORE_BIT_SET(s_key_pressed_bits, key_idx);
+    }
+    else
+    {
+        APP_KEY_CORE_BIT_CLR(s_key_pressed_bits, key_idx);
+    }
 }
 
 bool app_key_core_is_all_release(void)
 {
-    for (uint8_t key_idx = 0; key_idx < APP_KEY_REG_COUNT_MAX; key_idx++)
-    {
-        if (s_key_core_info[key_idx].is_pressed)
-        {
-            return false;
-        }
-    }
+    return app_key_core_bits_is_empty(s_key_pressed_bits);
+}
 
-    return true;
+bool app_key_core_is_all_idle(void)
+{
+    return app_key_core_bits_is_empty(s_key_polling_bits);
 }
 
 
@@ -44,7 +44,9 @@
  * @defgroup APP_KEY_CORE_MAROC Defines
  * @{
  */
-#define APP_KEY_REG_COUNT_MAX         10   /**< Maximum number of key instance can register, which can be configurable. */
+#ifndef APP_KEY_REG_COUNT_MAX
+#define APP_KEY_REG_COUNT_MAX         10   /**< Maximum number of key instance can register, including matrix keys, which can be configurable. */
+#endif
 #define APP_KEY_DOUBLE_TIME_COUNT     50   /**< Double click time count(in unit of 10ms), which can be configurable. */
 #define APP_KEY_LONG_TIME_COUNT       100  /**< Long click time count(in uint of 10ms), which can be configurable. */
 #define APP_KEY_CONTINUE_TIME_COUNT   20   /**< Continue click time count(in uint of 10ms), which can be configurable. */
@@ -132,6 +134,15 @@ void app_key_core_key_wait_polling_record(uint8_t key_idx);
  */
 bool app_key_core_is_all_release(void);
 
+/**
+ *****************************************************************************************
+ * @brief Check no key is waiting for polling, i.e. polling can stop.
+ *
+ * @return Result of checking.
+ *****************************************************************************************
+ */
+bool app_key_core_is_all_idle(void);
+
 /**
  *****************************************************************************************
  * @brief App key state polling.
@@ -40,6 +40,9 @@
  *****************************************************************************************
  */
 #include "app_log.h"
+#if APP_LOG_ASYNC_ENABLE
+#include "ring_buffer.h"
+#endif
 #include <string.h>
 #include <stdio.h>
 
@@ -98,6 +101,14 @@
 
 #endif
 
+#if APP_LOG_ASYNC_ENABLE
+#define APP_LOG_ASYNC_HDR_LEN             2        /**< Length header in front of every queued line. */
+
+#if APP_LOG_ASYNC_TX_SIZE < APP_LOG_LINE_BUF_SIZE
+#error "APP_LOG_ASYNC_TX_SIZE must be able to hold one whole log line."
+#endif
+#endif
+
 /*
  * STRUCTURES
  *****************************************************************************************
@@ -110,6 +121,7 @@ struct app_log_env_t
     app_log_trans_func_t trans_func;    /**< App log transmit function. */
     app_log_flush_func_t flush_func;    /**< App log flush function. */
     app_log_assert_flush_func_t assert_flush_func; /**< App log flush function for assert. */
+    app_log_timestamp_func_t    timestamp_func;    /**< App log timestamp get function for binary frames. */
 };
 
 /*
@@ -138,6 +150,20 @@ static const char *s_log_color_output_info[] =             /**< App log level ou
 
 static struct app_log_env_t  s_app_log_env;                  /**< App log environment variable. */
 
+uint8_t g_app_log_module_level_drop[APP_LOG_MODULE_NB];      /**< Levels dropped below debug of every app log module. */
+
+#if APP_LOG_ASYNC_ENABLE
+static ring_buffer_t              s_log_async_rbuf;                          /**< Queue of encoded log lines. */
+static uint8_t                    s_log_async_tx_buf[APP_LOG_ASYNC_TX_SIZE]; /**< Lines handed to transmit function. */
+static volatile bool              s_log_async_tx_busy;                       /**< Backend owns s_log_async_tx_buf. */
+static volatile bool              s_log_async_in_trans;                      /**< Transmit function is being called. */
+static volatile bool              s_log_async_tx_rejected;                   /**< Backend rejected the transmit buffer. */
+static uint16_t                   s_log_async_tx_len;                        /**< Length of data in s_log_async_tx_buf. */
+static uint16_t                   s_log_async_tx_lines;                      /**< Lines in s_log_async_tx_buf. */
+static app_log_overflow_policy_t  s_log_async_policy;                        /**< Queue overflow policy. */
+static app_log_async_stat_t       s_log_async_stat;                          /**< Queue statistics. */
+#endif
+
 
 /*
  * LOCAL FUNCTION DEFINITIONS
@@ -202,6 +228,182 @@ static bool app_log_is_fmt_set(uint8_t level, uint8_t fmt)
 
 }
 
+#if APP_LOG_ASYNC_ENABLE
+/**
+ *****************************************************************************************
+ * @brief Move whole queued lines to the transmit buffer.
+ *
+ * @return Length of moved data.
+ *****************************************************************************************
+ */
+static uint16_t app_log_async_fill(void)
+{
+    uint16_t tx_len   = 0;
+    uint16_t tx_lines = 0;
+    uint16_t line_len;
+    uint8_t  hdr[APP_LOG_ASYNC_HDR_LEN];
+
+    while (APP_LOG_ASYNC_HDR_LEN == ring_buffer_pick(&s_log_async_rbuf, hdr, APP_LOG_ASYNC_HDR_LEN))
+    {
+        line_len = hdr[0] | (hdr[1] << 8);
+
+        // Stop at a line which does not fit or is still being written.
+        if ((tx_len + line_len) > APP_LOG_ASYNC_TX_SIZE ||
+            ring_buffer_items_count_get(&s_log_async_rbuf) < (uint32_t)(APP_LOG_ASYNC_HDR_LEN + line_len))
+        {
+            break;
+        }
+
+        ring_buffer_skip(&s_log_async_rbuf, APP_LOG_ASYNC_HDR_LEN);
+        tx_len += ring_buffer_read(&s_log_async_rbuf, s_log_async_tx_buf + tx_len, line_len);
+        tx_lines++;
+    }
+
+    s_log_async_tx_len   = tx_len;
+    s_log_async_tx_lines = tx_lines;
+
+    return tx_len;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Hand queued lines to the backend until it is busy or the queue is empty.
+ *****************************************************************************************
+ */
+static void app_log_async_drain(void)
+{
+    uint16_t tx_len;
+
+    if (NULL == s_app_log_env.trans_func)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        tx_len = 0;
+
+        GLOBAL_EXCEPTION_DISABLE();
+        if (!s_log_async_tx_busy)
+        {
+            tx_len = app_log_async_fill();
+            s_log_async_tx_busy = tx_len ? true : false;
+        }
+        GLOBAL_EXCEPTION_ENABLE();
+
+        if (0 == tx_len)
+        {
+            break;
+        }
+
+        // A backend completing inside trans_func only clears busy flag, the loop sends the next lines.
+        s_log_async_in_trans    = true;
+        s_log_async_tx_rejected = false;
+        s_app_log_env.trans_func(s_log_async_tx_buf, tx_len);
+        s_log_async_in_trans    = false;
+
+        // A busy backend is tried again on the next log line or transmit completion.
+        if (s_log_async_tx_rejected)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Drain the whole queue synchronously through the flush function.
+ *
+ * @param[in] flush_func: Flush function which blocks until the backend is idle.
+ *****************************************************************************************
+ */
+static void app_log_async_drain_sync(app_log_flush_func_t flush_func)
+{
+    uint16_t tx_len;
+
+    if (NULL == s_app_log_env.trans_func)
+    {
+        flush_func();
+        return;
+    }
+
+    // Transmit completions only clear busy flag meanwhile, the transfers are chained here.
+    s_log_async_in_trans = true;
+
+    do
+    {
+        // Wait for the transfer in flight so that the transmit buffer can be reused.
+        flush_func();
+
+        GLOBAL_EXCEPTION_DISABLE();
+        tx_len = app_log_async_fill();
+        s_log_async_tx_busy = tx_len ? true : false;
+        GLOBAL_EXCEPTION_ENABLE();
+
+        if (tx_len)
+        {
+            s_app_log_env.trans_func(s_log_async_tx_buf, tx_len);
+        }
+    } while (tx_len);
+
+    s_log_async_in_trans = false;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Queue one encoded log line according to the overflow policy.
+ *
+ * @param[in] p_data: Pointer to log data.
+ * @param[in] length: Length of log data.
+ *****************************************************************************************
+ */
+static void app_log_async_enqueue(uint8_t *p_data, uint16_t length)
+{
+    uint8_t  hdr[APP_LOG_ASYNC_HDR_LEN];
+    uint16_t drop_len;
+    uint32_t need_len  = APP_LOG_ASYNC_HDR_LEN + length;
+    bool     drained   = false;
+    bool     room_made;
+
+    while (ring_buffer_surplus_space_get(&s_log_async_rbuf) < need_len)
+    {
+        room_made = false;
+
+        if (APP_LOG_OVERFLOW_DROP_OLDEST == s_log_async_policy)
+        {
+            GLOBAL_EXCEPTION_DISABLE();
+            if (APP_LOG_ASYNC_HDR_LEN == ring_buffer_pick(&s_log_async_rbuf, hdr, APP_LOG_ASYNC_HDR_LEN))
+            {
+                drop_len = hdr[0] | (hdr[1] << 8);
+                ring_buffer_skip(&s_log_async_rbuf, APP_LOG_ASYNC_HDR_LEN + drop_len);
+                s_log_async_stat.dropped_lines++;
+                s_log_async_stat.dropped_bytes += drop_len;
+                room_made = true;
+            }
+            GLOBAL_EXCEPTION_ENABLE();
+        }
+        else if (APP_LOG_OVERFLOW_BLOCK == s_log_async_policy && s_app_log_env.flush_func && !drained)
+        {
+            app_log_async_drain_sync(s_app_log_env.flush_func);
+            drained   = true;
+            room_made = true;
+        }
+
+        if (!room_made)
+        {
+            s_log_async_stat.dropped_lines++;
+            s_log_async_stat.dropped_bytes += length;
+            return;
+        }
+    }
+
+    hdr[0] = length & 0xFF;
+    hdr[1] = length >> 8;
+    ring_buffer_write(&s_log_async_rbuf, hdr, APP_LOG_ASYNC_HDR_LEN);
+    ring_buffer_write(&s_log_async_rbuf, p_data, length);
+}
+#endif
+
 /**
  *****************************************************************************************
  * @brief Transmit app log data.
@@ -219,6 +421,14 @@ static void app_log_data_trans(uint8_t *p_data, uint16_t length)
         return;
     }
 
+#if APP_LOG_ASYNC_ENABLE
+    if (s_log_async_rbuf.p_buffer)
+    {
+        app_log_async_enqueue(p_data, length);
+        app_log_async_drain();
+    }
+    else
+#endif
     if (s_app_log_env.trans_func)
     {
         s_app_log_env.trans_func(p_data, length);
@@ -229,6 +439,178 @@ static void app_log_data_trans(uint8_t *p_data, uint16_t length)
 #endif
 }
 
+/**
+ *****************************************************************************************
+ * @brief Put a little endian value into app log buffer.
+ *
+ * @param[in] wr_idx:     Write index of app log buffer.
+ * @param[in] p_log_buff: Pointer to app log cache buffer.
+ * @param[in] value:      Value to put.
+ * @param[in] size:       Size of value in bytes.
+ *
+ * @return Length of put, 0 if there is no enough space.
+ *****************************************************************************************
+ */
+static uint16_t app_log_bin_put(uint16_t wr_idx, uint8_t *p_log_buff, uint64_t value, uint8_t size)
+{
+    if ((wr_idx + size) > APP_LOG_LINE_BUF_SIZE)
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < size; i++)
+    {
+        p_log_buff[wr_idx + i] = (uint8_t)(value >> (i * 8));
+    }
+
+    return size;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Encode the raw arguments of a binary log frame.
+ *
+ * @details Only the conversion specifiers are scanned to get the promoted type of every
+ *          argument, no text is produced.
+ *
+ * @param[in] wr_idx:     Write index of app log buffer.
+ * @param[in] p_log_buff: Pointer to app log cache buffer.
+ * @param[in] format:     Output format.
+ * @param[in] ap:         Arguments.
+ * @param[out] p_trunc:   Set to true if the arguments did not fit in the buffer.
+ *
+ * @return Length of encoded arguments.
+ *****************************************************************************************
+ */
+static uint16_t app_log_bin_args_encode(uint16_t wr_idx, uint8_t *p_log_buff, const char *format, va_list ap, bool *p_trunc)
+{
+    uint16_t    start_idx = wr_idx;
+    uint16_t    put_len;
+    uint8_t     long_cnt;
+    const char *p_str;
+
+    while (*format != 0)
+    {
+        if (*format++ != '%')
+        {
+            continue;
+        }
+
+        while (*format == '-' || *format == '+' || *format == ' ' || *format == '#' || *format == '0')
+        {
+            format++;
+        }
+
+        // Width and precision given by '*' are int arguments.
+        while ((*format >= '0' && *format <= '9') || *format == '.' || *format == '*')
+        {
+            if (*format == '*')
+            {
+                put_len = app_log_bin_put(wr_idx, p_log_buff, (uint32_t)va_arg(ap, int), 4);
+                if (0 == put_len)
+                {
+                    *p_trunc = true;
+                    return wr_idx - start_idx;
+                }
+                wr_idx += put_len;
+            }
+            format++;
+        }
+
+        // "ll" and 'j' (intmax_t) are 64-bit, 'l', 'z' and 't' are 32-bit on this target.
+        long_cnt = 0;
+        while (*format == 'h' || *format == 'l' || *format == 'L' || *format == 'j' || *format == 'z' || *format == 't')
+        {
+            if (*format == 'l')
+            {
+                long_cnt++;
+            }
+            else if (*format == 'j')
+            {
+                long_cnt += 2;
+            }
+            format++;
+        }
+
+        switch (*format)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                if (long_cnt > 1)
+                {
+                    put_len = app_log_bin_put(wr_idx, p_log_buff, va_arg(ap, unsigned long long), 8);
+                }
+                else
+                {
+                    put_len = app_log_bin_put(wr_idx, p_log_buff, va_arg(ap, unsigned int), 4);
+                }
+                break;
+
+            case 'p':
+            case 'n':
+                put_len = app_log_bin_put(wr_idx, p_log_buff, (uint32_t)va_arg(ap, void *), 4);
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                double   value = va_arg(ap, double);
+                uint64_t raw;
+
+                memcpy(&raw, &value, sizeof(raw));
+                put_len = app_log_bin_put(wr_idx, p_log_buff, raw, 8);
+            } break;
+
+            case 's':
+                // The string may live in RAM, so copy it with its terminator.
+                p_str   = va_arg(ap, const char *);
+                p_str   = p_str ? p_str : "(null)";
+                put_len = app_log_strcpy(wr_idx, p_log_buff, p_str);
+                if ((wr_idx + put_len) < APP_LOG_LINE_BUF_SIZE)
+                {
+                    p_log_buff[wr_idx + put_len++] = 0;
+                }
+                else
+                {
+                    put_len = 0;
+                }
+                break;
+
+            case 0:
+                return wr_idx - start_idx;
+
+            default:
+                put_len = 0xFFFF;
+                break;
+        }
+
+        format++;
+
+        if (0 == put_len)
+        {
+            *p_trunc = true;
+            break;
+        }
+        else if (0xFFFF != put_len)
+        {
+            wr_idx += put_len;
+        }
+    }
+
+    return wr_idx - start_idx;
+}
+
 /*
  * GLOBAL FUNCTION DEFINITIONS
  *****************************************************************************************
@@ -256,6 +638,77 @@ sdk_err_t app_log_init(app_log_init_t *p_log_init, app_log_trans_func_t trans_fu
     return SDK_SUCCESS;
 }
 
+sdk_err_t app_log_module_level_set(uint8_t module_id, uint8_t level)
+{
+    if (module_id >= APP_LOG_MODULE_NB || level > APP_LOG_LVL_DEBUG)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    g_app_log_module_level_drop[module_id] = APP_LOG_LVL_DEBUG - level;
+
+    return SDK_SUCCESS;
+}
+
+uint8_t app_log_module_level_get(uint8_t module_id)
+{
+    if (module_id >= APP_LOG_MODULE_NB)
+    {
+        return APP_LOG_LVL_ERROR;
+    }
+
+    return APP_LOG_LVL_DEBUG - g_app_log_module_level_drop[module_id];
+}
+
+#if APP_LOG_ASYNC_ENABLE
+sdk_err_t app_log_async_init(uint8_t *p_buffer, uint32_t size, app_log_overflow_policy_t policy)
+{
+    if (NULL == p_buffer || size <= (APP_LOG_ASYNC_HDR_LEN + APP_LOG_LINE_BUF_SIZE) || policy > APP_LOG_OVERFLOW_BLOCK)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    APP_LOG_LOCK();
+
+    s_log_async_policy  = policy;
+    s_log_async_tx_busy = false;
+    memset(&s_log_async_stat, 0, sizeof(s_log_async_stat));
+    ring_buffer_init(&s_log_async_rbuf, p_buffer, size);
+
+    APP_LOG_UNLOCK();
+
+    return SDK_SUCCESS;
+}
+
+void app_log_async_tx_cplt(void)
+{
+    s_log_async_tx_busy = false;
+
+    if (!s_log_async_in_trans)
+    {
+        app_log_async_drain();
+    }
+}
+
+void app_log_async_tx_reject(void)
+{
+    s_log_async_stat.dropped_lines += s_log_async_tx_lines;
+    s_log_async_stat.dropped_bytes += s_log_async_tx_len;
+    s_log_async_tx_rejected = true;
+    s_log_async_tx_busy     = false;
+}
+
+void app_log_async_stat_get(app_log_async_stat_t *p_stat)
+{
+    if (p_stat)
+    {
+        GLOBAL_EXCEPTION_DISABLE();
+        memcpy(p_stat, &s_log_async_stat, sizeof(app_log_async_stat_t));
+        GLOBAL_EXCEPTION_ENABLE();
+    }
+}
+#endif
+
 void app_log_assert_flush_init(app_log_assert_flush_func_t assert_flush_func)
 {
     s_app_log_env.assert_flush_func = assert_flush_func;
@@ -387,6 +840,47 @@ void app_log_output(uint8_t level, const char *tag, const char *file, const char
     APP_LOG_UNLOCK();
 }
 
+void app_log_timestamp_init(app_log_timestamp_func_t timestamp_func)
+{
+    s_app_log_env.timestamp_func = timestamp_func;
+}
+
+void app_log_binary_output(uint8_t level, const char *format, ...)
+{
+    uint16_t args_length = 0;
+    uint32_t timestamp   = 0;
+    bool     truncated   = false;
+    va_list  ap;
+
+    if (level > s_app_log_env.app_log_init.filter.level && s_app_log_env.is_filter_set)
+    {
+        return;
+    }
+
+    if (s_app_log_env.timestamp_func)
+    {
+        timestamp = s_app_log_env.timestamp_func();
+    }
+
+    va_start(ap, format);
+
+    APP_LOG_LOCK();
+
+    args_length = app_log_bin_args_encode(APP_LOG_BIN_HEAD_LEN, s_log_encode_buf, format, ap, &truncated);
+
+    s_log_encode_buf[0] = APP_LOG_BIN_SYNC;
+    s_log_encode_buf[1] = truncated ? (level | APP_LOG_BIN_TRUNCATED) : level;
+    app_log_bin_put(2, s_log_encode_buf, args_length, 2);
+    app_log_bin_put(4, s_log_encode_buf, (uint32_t)format, 4);
+    app_log_bin_put(8, s_log_encode_buf, timestamp, 4);
+
+    app_log_data_trans(s_log_encode_buf, APP_LOG_BIN_HEAD_LEN + args_length);
+
+    APP_LOG_UNLOCK();
+
+    va_end(ap);
+}
+
 void app_log_raw_info(const char *format, ...)
 {
     int      fmt_result = 0;
@@ -579,6 +1073,13 @@ void app_log_flush(void)
 {
     if (s_app_log_env.flush_func)
     {
+#if APP_LOG_ASYNC_ENABLE
+        if (s_log_async_rbuf.p_buffer)
+        {
+            app_log_async_drain_sync(s_app_log_env.flush_func);
+            return;
+        }
+#endif
         s_app_log_env.flush_func();
     }
 }
@@ -587,6 +1088,13 @@ void app_log_assert_flush(void)
 {
     if (s_app_log_env.assert_flush_func)
     {
+#if APP_LOG_ASYNC_ENABLE
+        if (s_log_async_rbuf.p_buffer)
+        {
+            app_log_async_drain_sync(s_app_log_env.assert_flush_func);
+            return;
+        }
+#endif
         s_app_log_env.assert_flush_func();
     }
 }
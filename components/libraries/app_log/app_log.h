@@ -73,6 +73,24 @@
 #define APP_LOG_HEX_DUMP_RAW_DATA_ENABLE  0                        /**< Enable app log hex dump raw data. */
 #endif
 
+#ifndef APP_LOG_BINARY_ENABLE
+// If APP_LOG_BINARY_ENABLE=1, APP_LOG_ERROR/WARNING/INFO/DEBUG emit binary frames (format string address, timestamp and
+// raw arguments) instead of formatted text. The frames are decoded to text on the host with app_log_decoder.py and the ELF.
+#define APP_LOG_BINARY_ENABLE           0                          /**< Enable app log binary (deferred format) mode. */
+#endif
+
+#ifndef APP_LOG_ASYNC_ENABLE
+// If APP_LOG_ASYNC_ENABLE=1 and app_log_async_init() is called, encoded log lines are queued and handed to the
+// transmit function from the background. The transmit function must not block and the backend must call
+// app_log_async_tx_cplt() when it has consumed the data, e.g. on APP_UART_EVT_TX_CPLT of app_uart_dma_transmit_async(),
+// or app_log_async_tx_reject() from the transmit function when the transfer could not be started.
+#define APP_LOG_ASYNC_ENABLE            0                          /**< Enable app log asynchronous backend. */
+#endif
+
+#ifndef APP_LOG_ASYNC_TX_SIZE
+#define APP_LOG_ASYNC_TX_SIZE           (APP_LOG_LINE_BUF_SIZE * 2) /**< Maximum size handed to transmit function once. */
+#endif
+
 #define APP_LOG_LOCK()                  LOCAL_INT_DISABLE(BLE_IRQn) /**< App log lock. */
 #define APP_LOG_UNLOCK()                LOCAL_INT_RESTORE()         /**< APP log unlock. */
 
@@ -86,12 +104,37 @@
 #ifndef APP_LOG_PER_LINE_HEX_DUMP_SIZE
 #define APP_LOG_PER_LINE_HEX_DUMP_SIZE  8                          /**< Hex char dump size in per line. */
 #endif
-#define APP_LOG_SEVERITY_LEVEL          APP_LOG_LVL_DEBUG          /**< Default log severity level. */
+#ifndef APP_LOG_SEVERITY_LEVEL
+#define APP_LOG_SEVERITY_LEVEL          APP_LOG_LVL_DEBUG          /**< Default log severity level, lower levels are stripped at compile time. */
+#endif
+
+#ifndef APP_LOG_MODULE_NB
+#define APP_LOG_MODULE_NB               32                         /**< Number of log modules with runtime level. */
+#endif
+
+#ifndef APP_LOG_MODULE_ID
+    // Define APP_LOG_MODULE_ID (0 ~ APP_LOG_MODULE_NB - 1) before including app_log.h to give a module its own runtime level.
+    #define APP_LOG_MODULE_ID           0                          /**< Default app log module ID. */
+#endif
+
+#ifndef APP_LOG_MODULE_LEVEL
+    // Define APP_LOG_MODULE_LEVEL before including app_log.h to strip more levels of a module at compile time.
+    #define APP_LOG_MODULE_LEVEL        APP_LOG_SEVERITY_LEVEL     /**< Compile time level of app log module. */
+#endif
 #define APP_LOG_TAG_LEN_MAX             20                         /**< Maximum length of output filter's tag. */
 #define APP_LOG_LINE_NB_LEN_MAX         5                          /**< Maximum length of output line number. */
 #define APP_LOG_NEWLINE_SIGN            "\r\n"                     /**< Newline sign output. */
 /** @} */
 
+/**
+ * @defgroup APP_LOG_BIN_FRAME APP Log Binary Frame
+ * @{
+ */
+#define APP_LOG_BIN_SYNC                0xA5            /**< Sync byte of every binary log frame. */
+#define APP_LOG_BIN_HEAD_LEN            12              /**< Sync(1) + Level(1) + Args length(2) + Format address(4) + Timestamp(4). */
+#define APP_LOG_BIN_TRUNCATED           (1 << 7)        /**< Set in level byte if the arguments did not fit in line buffer. */
+/** @} */
+
 /**
  * @defgroup APP_LOG_FMT APP Log Formats
  * @{
@@ -117,26 +160,35 @@
 /** @} */
 
 #if APP_LOG_PRINTF_ENABLE
-    #if APP_LOG_SEVERITY_LEVEL >= APP_LOG_LVL_ERROR
-        #define APP_LOG_ERROR(...) app_log_output(APP_LOG_LVL_ERROR, APP_LOG_TAG, __FILE__, __func__, __LINE__, __VA_ARGS__)
+    #if APP_LOG_BINARY_ENABLE
+        #define APP_LOG_OUTPUT(level, ...) app_log_binary_output(level, __VA_ARGS__)
+    #else
+        #define APP_LOG_OUTPUT(level, ...) app_log_output(level, APP_LOG_TAG, __FILE__, __func__, __LINE__, __VA_ARGS__)
+    #endif
+
+    #define APP_LOG_MODULE_OUTPUT(level, ...) \
+        (((level) + g_app_log_module_level_drop[APP_LOG_MODULE_ID] <= APP_LOG_LVL_DEBUG) ? APP_LOG_OUTPUT(level, __VA_ARGS__) : (void)0)
+
+    #if APP_LOG_MODULE_LEVEL >= APP_LOG_LVL_ERROR
+        #define APP_LOG_ERROR(...) APP_LOG_MODULE_OUTPUT(APP_LOG_LVL_ERROR, __VA_ARGS__)
     #else
         #define APP_LOG_ERROR(...)
     #endif
 
-    #if APP_LOG_SEVERITY_LEVEL >= APP_LOG_LVL_WARNING
-        #define APP_LOG_WARNING(...) app_log_output(APP_LOG_LVL_WARNING, APP_LOG_TAG, __FILE__, __func__, __LINE__, __VA_ARGS__)
+    #if APP_LOG_MODULE_LEVEL >= APP_LOG_LVL_WARNING
+        #define APP_LOG_WARNING(...) APP_LOG_MODULE_OUTPUT(APP_LOG_LVL_WARNING, __VA_ARGS__)
     #else
         #define APP_LOG_WARNING(...)
     #endif
 
-    #if APP_LOG_SEVERITY_LEVEL >= APP_LOG_LVL_INFO
-        #define APP_LOG_INFO(...) app_log_output(APP_LOG_LVL_INFO, APP_LOG_TAG, __FILE__, __func__, __LINE__, __VA_ARGS__)
+    #if APP_LOG_MODULE_LEVEL >= APP_LOG_LVL_INFO
+        #define APP_LOG_INFO(...) APP_LOG_MODULE_OUTPUT(APP_LOG_LVL_INFO, __VA_ARGS__)
     #else
         #define APP_LOG_INFO(...)
     #endif
 
-    #if APP_LOG_SEVERITY_LEVEL >= APP_LOG_LVL_DEBUG
-        #define APP_LOG_DEBUG(...) app_log_output(APP_LOG_LVL_DEBUG, APP_LOG_TAG, __FILE__, __func__, __LINE__, __VA_ARGS__)
+    #if APP_LOG_MODULE_LEVEL >= APP_LOG_LVL_DEBUG
+        #define APP_LOG_DEBUG(...) APP_LOG_MODULE_OUTPUT(APP_LOG_LVL_DEBUG, __VA_ARGS__)
     #else
         #define APP_LOG_DEBUG(...)
     #endif
@@ -165,6 +217,22 @@ typedef void (*app_log_flush_func_t)(void);
 
 /**@brief  APP LOG flush function type for assert. */
 typedef void (*app_log_assert_flush_func_t)(void);
+
+/**@brief  APP LOG timestamp get function type, used by binary log frames. */
+typedef uint32_t (*app_log_timestamp_func_t)(void);
+/** @} */
+
+/**
+ * @defgroup APP_LOG_ENUM Enumerations
+ * @{
+ */
+/**@brief App log asynchronous queue overflow policy. */
+typedef enum
+{
+    APP_LOG_OVERFLOW_DROP_NEWEST,       /**< Drop the line being logged. */
+    APP_LOG_OVERFLOW_DROP_OLDEST,       /**< Drop the oldest queued lines until the new line fits. */
+    APP_LOG_OVERFLOW_BLOCK,             /**< Drain the queue synchronously through flush function, drop newest if no flush function. */
+} app_log_overflow_policy_t;
 /** @} */
 
 /**
@@ -184,6 +252,21 @@ typedef struct
     app_log_filter_t      filter;                     /**< App log filter. */
     uint8_t               fmt_set[APP_LOG_LVL_NB];    /**< Format of app log. See @ref APP_LOG_FMT.*/
 } app_log_init_t;
+
+/**@brief App log asynchronous queue statistics. */
+typedef struct
+{
+    uint32_t              dropped_lines;              /**< Number of lines dropped by overflow policy or rejected by backend. */
+    uint32_t              dropped_bytes;              /**< Number of bytes dropped by overflow policy or rejected by backend. */
+} app_log_async_stat_t;
+/** @} */
+
+/**
+ * @defgroup APP_LOG_VARIABLE Variables
+ * @{
+ */
+extern uint8_t g_app_log_module_level_drop[APP_LOG_MODULE_NB];  /**< Levels dropped below debug of every app log module,
+                                                                     zero at reset so that all levels are output. */
 /** @} */
 
 /**
@@ -203,6 +286,33 @@ typedef struct
  */
 sdk_err_t app_log_init(app_log_init_t *p_log_init, app_log_trans_func_t trans_func, app_log_flush_func_t flush_func);
 
+/**
+ *****************************************************************************************
+ * @brief Set the runtime level of an app log module.
+ *
+ * @param[in] module_id: App log module ID, see @ref APP_LOG_MODULE_ID.
+ * @param[in] level:     Highest severity level output by the module, see @ref APP_LOG_SVT_LVL.
+ *                       Levels stripped by APP_LOG_MODULE_LEVEL at compile time stay disabled.
+ *
+ * @note   All modules output every level till set. The levels may be set before app_log_init(),
+ *         which keeps them.
+ *
+ * @return Result of setting.
+ *****************************************************************************************
+ */
+sdk_err_t app_log_module_level_set(uint8_t module_id, uint8_t level);
+
+/**
+ *****************************************************************************************
+ * @brief Get the runtime level of an app log module.
+ *
+ * @param[in] module_id: App log module ID, see @ref APP_LOG_MODULE_ID.
+ *
+ * @return Runtime level of the module.
+ *****************************************************************************************
+ */
+uint8_t app_log_module_level_get(uint8_t module_id);
+
 /**
  *****************************************************************************************
  * @brief Initialize app log assert function.
@@ -213,6 +323,48 @@ sdk_err_t app_log_init(app_log_init_t *p_log_init, app_log_trans_func_t trans_fu
  */
 void app_log_assert_flush_init(app_log_assert_flush_func_t assert_flush_func);
 
+#if APP_LOG_ASYNC_ENABLE
+/**
+ *****************************************************************************************
+ * @brief Initialize app log asynchronous backend.
+ *
+ * @param[in] p_buffer: Pointer to queue buffer of encoded log lines.
+ * @param[in] size:     Size of queue buffer.
+ * @param[in] policy:   Overflow policy when the queue is full.
+ *
+ * @return Result of initialization.
+ *****************************************************************************************
+ */
+sdk_err_t app_log_async_init(uint8_t *p_buffer, uint32_t size, app_log_overflow_policy_t policy);
+
+/**
+ *****************************************************************************************
+ * @brief Notify app log that the backend has consumed the data of the last transmit
+ *        function call, the next queued lines are handed to the backend in this context.
+ *****************************************************************************************
+ */
+void app_log_async_tx_cplt(void);
+
+/**
+ *****************************************************************************************
+ * @brief Notify app log that the backend rejected the data, e.g. the transfer could not
+ *        be started. Call it from the transmit function instead of app_log_async_tx_cplt().
+ *        The data is counted as dropped, the queued lines are handed to the backend again
+ *        on the next log output or app_log_async_tx_cplt().
+ *****************************************************************************************
+ */
+void app_log_async_tx_reject(void);
+
+/**
+ *****************************************************************************************
+ * @brief Get app log asynchronous queue statistics.
+ *
+ * @param[out] p_stat: Pointer to statistics.
+ *****************************************************************************************
+ */
+void app_log_async_stat_get(app_log_async_stat_t *p_stat);
+#endif
+
 /**
  *****************************************************************************************
  * @brief Output app log.
@@ -228,6 +380,30 @@ void app_log_assert_flush_init(app_log_assert_flush_func_t assert_flush_func);
  */
 void app_log_output(uint8_t level, const char *tag, const char *file, const char *func, const long line, const char *format, ...);
 
+/**
+ *****************************************************************************************
+ * @brief Initialize the timestamp source of binary log frames.
+ *
+ * @param[in] timestamp_func: App log timestamp get function, the timestamp is 0 if NULL.
+ *****************************************************************************************
+ */
+void app_log_timestamp_init(app_log_timestamp_func_t timestamp_func);
+
+/**
+ *****************************************************************************************
+ * @brief Output app log as a binary frame without formatting.
+ *
+ * @details The frame carries the address of the format string, the timestamp and the raw
+ *          arguments. Strings passed with %s are copied into the frame, all other arguments
+ *          are copied as their promoted type. See @ref APP_LOG_BIN_FRAME.
+ *
+ * @param[in] level:  App log severity level.
+ * @param[in] format: Output format, must be a string literal located in the firmware image.
+ * @param[in] ...:    Arguments.
+ *****************************************************************************************
+ */
+void app_log_binary_output(uint8_t level, const char *format, ...);
+
 /**
  *****************************************************************************************
  * @brief Output RAW format log
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Decode app log binary frames (APP_LOG_BINARY_ENABLE=1) to text.
+
+The format strings are looked up by address in the firmware ELF file.
+
+Usage:
+    python app_log_decoder.py <firmware.elf> <log.bin>
+    python app_log_decoder.py <firmware.elf> -          (read frames from stdin)
+
+Requires pyelftools (pip install pyelftools).
+"""
+
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+APP_LOG_BIN_SYNC      = 0xA5
+APP_LOG_BIN_HEAD_LEN  = 12
+APP_LOG_BIN_TRUNCATED = 0x80
+
+LEVEL_INFO = ['APP_E: ', 'APP_W: ', 'APP_I: ', 'APP_D: ']
+
+# Same conversion specifier scan as app_log_bin_args_encode() in app_log.c.
+SPEC_RE = re.compile(r'%([-+ #0]*)((?:[0-9.]|\*)*)([hlLjzt]*)([a-zA-Z%]?)')
+
+
+class FormatTable:
+    def __init__(self, elf_path):
+        self.sections = []
+        self.cache    = {}
+
+        with open(elf_path, 'rb') as f:
+            elf = ELFFile(f)
+            for sec in elf.iter_sections():
+                if sec['sh_addr'] and sec['sh_type'] == 'SHT_PROGBITS':
+                    self.sections.append((sec['sh_addr'], sec.data()))
+
+    def lookup(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+
+        fmt = None
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.find(b'\0', addr - base)
+                fmt = data[addr - base:end].decode('utf-8', 'replace')
+                break
+
+        self.cache[addr] = fmt
+        return fmt
+
+
+def decode_args(fmt, args):
+    """Convert a C format and raw arguments to a Python %-format and value tuple."""
+    py_fmt = ''
+    values = []
+    pos    = 0
+    idx    = 0
+
+    for m in SPEC_RE.finditer(fmt):
+        py_fmt += fmt[pos:m.start()].replace('%', '%%')
+        pos = m.end()
+
+        flags, width, length, conv = m.groups()
+        if conv in ('%', ''):
+            py_fmt += '%%'
+            continue
+
+        if '*' in width:
+            for _ in range(width.count('*')):
+                values.append(struct.unpack_from('<i', args, idx)[0])
+                idx += 4
+
+        if conv in 'diuxXoc':
+            if length.count('l') + 2 * length.count('j') > 1:
+                value = struct.unpack_from('<q' if conv in 'di' else '<Q', args, idx)[0]
+                idx += 8
+            else:
+                value = struct.unpack_from('<i' if conv in 'di' else '<I', args, idx)[0]
+                idx += 4
+            py_fmt += '%' + flags + width + ('d' if conv == 'u' else conv)
+            values.append(value)
+        elif conv in 'pn':
+            value = struct.unpack_from('<I', args, idx)[0]
+            idx += 4
+            py_fmt += '0x%08x'
+            values.append(value)
+        elif conv in 'fFeEgGaA':
+            value = struct.unpack_from('<d', args, idx)[0]
+            idx += 8
+            py_fmt += '%' + flags + width + ('f' if conv in 'aA' else conv)
+            values.append(value)
+        elif conv == 's':
+            end = args.find(b'\0', idx)
+            end = len(args) if end < 0 else end
+            values.append(args[idx:end].decode('utf-8', 'replace'))
+            idx = end + 1
+            py_fmt += '%' + flags + width + 's'
+        else:
+            py_fmt += m.group(0).replace('%', '%%')
+
+    py_fmt += fmt[pos:].replace('%', '%%')
+
+    return py_fmt, tuple(values)
+
+
+def decode_stream(table, stream, out):
+    idx = 0
+
+    while idx + APP_LOG_BIN_HEAD_LEN <= len(stream):
+        if stream[idx] != APP_LOG_BIN_SYNC:
+            idx += 1
+            continue
+
+        level, args_len, fmt_addr, timestamp = struct.unpack_from('<BHII', stream, idx + 1)
+        fmt = table.lookup(fmt_addr)
+        if fmt is None or (level & ~APP_LOG_BIN_TRUNCATED) >= len(LEVEL_INFO):
+            idx += 1
+            continue
+
+        args = stream[idx + APP_LOG_BIN_HEAD_LEN:idx + APP_LOG_BIN_HEAD_LEN + args_len]
+        idx += APP_LOG_BIN_HEAD_LEN + args_len
+
+        try:
+            py_fmt, values = decode_args(fmt, args)
+            text = py_fmt % values
+        except (struct.error, TypeError, ValueError):
+            text = '<undecodable frame: %r>' % fmt
+
+        if level & APP_LOG_BIN_TRUNCATED:
+            text += ' <truncated>'
+
+        out.write('[%10u] %s%s\n' % (timestamp, LEVEL_INFO[level & ~APP_LOG_BIN_TRUNCATED], text.rstrip('\r\n')))
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+
+    table = FormatTable(sys.argv[1])
+
+    if sys.argv[2] == '-':
+        stream = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[2], 'rb') as f:
+            stream = f.read()
+
+    decode_stream(table, stream, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
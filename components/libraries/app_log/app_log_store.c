@@ -43,12 +43,18 @@
 #include "app_log_store.h"
 #if APP_LOG_STORE_ENABLE
 #include "utility.h"
+#if APP_LOG_STORE_COMPRESS_ENABLE
+#include "lz_compress.h"
+#endif
 
 /*
  * DEFINE
  *****************************************************************************************
  */
-#define APP_LOG_STORE_MAGIC              0x47444442   /**< Magic for app log store: "GDDB". */
+#define APP_LOG_STORE_MAGIC              0x4744444A   /**< Magic for app log store: "GDDJ". */
+#define APP_LOG_STORE_JNL_MAGIC          0x4A4C       /**< Magic for head journal record: "JL". */
+#define APP_LOG_STORE_JNL_BLK_NUM        2            /**< Number of blocks reserved for head journal. */
+#define APP_LOG_STORE_JNL_REC_SIZE       sizeof(log_store_jnl_rec_t)
 #define APP_LOG_STORE_TIME_SIZE          26           /**< [00000000.000] */
 #define APP_LOG_STORE_TIME_DEFAULT       "[1970/01/01 00:00:00:000] "
 #define APP_LOG_STORE_CACHE_SIZE         ((APP_LOG_STORE_LINE_SIZE) * (APP_LOG_STORE_CACHE_NUM))
@@ -58,12 +64,15 @@
 #define APP_LOG_STORE_DUMP_BIT           (0x01 << 2)
 #define APP_LOG_STORE_DUMP_READY_BIT     (0x01 << 3)
 #define APP_LOG_STORE_DUMP_START_BIT     (0x01 << 4)
+#define APP_LOG_STORE_BLK_MAGIC          0x4C5A       /**< Magic for compressed block: "LZ". */
+#define APP_LOG_STORE_BLK_HEAD_SIZE      sizeof(log_store_blk_head_t)
+#define APP_LOG_STORE_ENTRY_HEAD_MAX     13           /**< Varint time delta(10) + varint length(3). */
 
 /*
  * STRUCTURES
  *****************************************************************************************
  */
-/**@brief App log store head info. */
+/**@brief App log store head info, saved in NVDS only when the log db is formatted. */
 typedef struct
 {
     uint32_t magic;         /**< Magic for app log store. */
@@ -74,6 +83,16 @@ typedef struct
     uint16_t check_sum;     /**< Check sum for head info. */
 } log_store_head_t;
 
+/**@brief App log store head journal record, appended to the journal blocks at the front of log db. */
+typedef struct
+{
+    uint16_t magic;         /**< Magic for journal record. */
+    uint16_t flip_over;     /**< Is flip over. */
+    uint32_t seq;           /**< Sequence number, the greatest valid one is the current head. */
+    uint32_t offset;        /**< Offset of end log data. */
+    uint32_t check_sum;     /**< Check sum for journal record. */
+} log_store_jnl_rec_t;
+
 /**@brief App log store environment variable. */
 struct log_store_env_t
 {
@@ -82,8 +101,47 @@ struct log_store_env_t
     log_store_head_t  store_head;
     uint16_t          head_nv_tag;
     uint16_t          blk_size;
+    uint32_t          data_addr;     /**< Start address of log data, behind the journal blocks. */
+    uint32_t          data_size;     /**< Size of log data area. */
+    uint32_t          jnl_seq;       /**< Sequence number of the last journal record. */
+    uint16_t          jnl_slot;      /**< Next free record slot in the active journal block. */
+    uint8_t           jnl_blk;       /**< Index of the active journal block. */
+#if APP_LOG_STORE_COMPRESS_ENABLE
+    uint64_t          save_time_ms;  /**< Time of the last entry saved to cache. */
+    uint64_t          pack_time_ms;  /**< Time of the last entry packed to flash. */
+#endif
 };
 
+#if APP_LOG_STORE_COMPRESS_ENABLE
+/**@brief App log store compressed block head. Entries in block: varint zigzag time delta(ms) + varint length + data. */
+typedef struct
+{
+    uint16_t magic;         /**< Magic for compressed block. */
+    uint16_t comp_len;      /**< Length of payload, equal to raw_len if the block is stored uncompressed. */
+    uint16_t raw_len;       /**< Length of entries before compression. */
+    uint16_t text_len;      /**< Length of entries rendered to text by dump. */
+    uint32_t base_ms_lo;    /**< Time of the entry before this block, low 32 bits. */
+    uint32_t base_ms_hi;    /**< Time of the entry before this block, high 32 bits. */
+    uint32_t check_sum;     /**< Check sum for block head and payload. */
+} log_store_blk_head_t;
+
+/**@brief App log store compressed dump environment variable. */
+struct log_dump_env_t
+{
+    uint32_t scan_start;                            /**< Flash offset where the dump starts. */
+    uint32_t scan_size;                             /**< Size of flash to dump. */
+    uint32_t scan_pos;                              /**< Scanned size from scan_start. */
+    uint32_t text_total;                            /**< Length of rendered text announced at dump start. */
+    uint32_t text_sent;                             /**< Length of rendered text sent. */
+    uint64_t time_ms;                               /**< Time of the current entry. */
+    uint16_t raw_len;                               /**< Length of decompressed block. */
+    uint16_t raw_pos;                               /**< Read position in decompressed block. */
+    uint16_t data_left;                             /**< Data left of the current entry. */
+    uint8_t  ts_pos;                                /**< Sent length of the current time stamp text. */
+    uint8_t  ts_text[APP_LOG_STORE_TIME_SIZE + 1];  /**< Time stamp text of the current entry. */
+};
+#endif
+
 /*
  * LOCAL VARIABLE DEFINITIONS
  *****************************************************************************************
@@ -95,6 +153,11 @@ static uint32_t                s_log_store_dump_offset;
 static ring_buffer_t           s_log_store_rbuf __attribute__((section("RAM_CODE"))) = {0};
 static uint8_t                 s_log_store_cache[APP_LOG_STORE_CACHE_SIZE] __attribute__((section("RAM_CODE"))) = {0};
 static uint8_t                 s_read_dump_buffer[APP_LOG_STORE_ONECE_OP_SIZE];
+#if APP_LOG_STORE_COMPRESS_ENABLE
+static uint8_t                 s_log_store_comp_buf[APP_LOG_STORE_BLK_HEAD_SIZE + APP_LOG_STORE_ONECE_OP_SIZE];
+static uint8_t                 s_log_dump_raw_buf[APP_LOG_STORE_ONECE_OP_SIZE];
+static struct log_dump_env_t   s_log_dump_env;
+#endif
 
 /*
  * LOCAL FUNCTION DEFINITIONS
@@ -106,7 +169,7 @@ static uint32_t log_store_check_sum_calc(uint8_t *p_data, uint32_t len)
 
     if (p_data && len)
     {
-        for (uint8_t i = 0; i < len; i++)
+        for (uint32_t i = 0; i < len; i++)
         {
             check_sum += p_data[i];
         }
@@ -151,22 +214,155 @@ static bool log_store_head_update(uint16_t nv_tag, log_store_head_t *p_head)
     return true;
 }
 
-static bool log_store_time_stamp_encode(uint8_t *p_buffer, uint8_t buffer_size)
+static uint32_t log_store_jnl_blk_addr(uint8_t blk_idx)
 {
-    if (APP_LOG_STORE_TIME_SIZE != buffer_size)
+    return s_log_store_env.store_head.db_addr + blk_idx * s_log_store_env.blk_size;
+}
+
+static bool log_store_jnl_rec_check(log_store_jnl_rec_t *p_rec)
+{
+    if (APP_LOG_STORE_JNL_MAGIC != p_rec->magic ||
+        s_log_store_env.data_size < p_rec->offset)
     {
         return false;
     }
 
-    app_log_store_time_t rtc_time = {0};
+    return p_rec->check_sum == log_store_check_sum_calc((uint8_t *)p_rec, APP_LOG_STORE_JNL_REC_SIZE - 4);
+}
 
-    s_log_store_ops.time_get(&rtc_time);
+static bool log_store_jnl_rec_erased(log_store_jnl_rec_t *p_rec)
+{
+    uint8_t *p_data = (uint8_t *)p_rec;
+
+    for (uint8_t i = 0; i < APP_LOG_STORE_JNL_REC_SIZE; i++)
+    {
+        if (0xFF != p_data[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool log_store_jnl_append(void)
+{
+    log_store_jnl_rec_t rec;
+    uint16_t            slot_num = s_log_store_env.blk_size / APP_LOG_STORE_JNL_REC_SIZE;
+
+    if (s_log_store_env.jnl_slot >= slot_num)
+    {
+        // Active journal block is full, move to the other one. The previous block keeps
+        // the last valid record until the first record lands in the new block.
+        s_log_store_env.jnl_blk  = (s_log_store_env.jnl_blk + 1) % APP_LOG_STORE_JNL_BLK_NUM;
+        s_log_store_env.jnl_slot = 0;
+        s_log_store_ops.flash_erase(log_store_jnl_blk_addr(s_log_store_env.jnl_blk), s_log_store_env.blk_size);
+    }
+
+    rec.magic     = APP_LOG_STORE_JNL_MAGIC;
+    rec.flip_over = s_log_store_env.store_head.flip_over;
+    rec.seq       = ++s_log_store_env.jnl_seq;
+    rec.offset    = s_log_store_env.store_head.offset;
+    rec.check_sum = log_store_check_sum_calc((uint8_t *)&rec, APP_LOG_STORE_JNL_REC_SIZE - 4);
+
+    if (APP_LOG_STORE_JNL_REC_SIZE != s_log_store_ops.flash_write(log_store_jnl_blk_addr(s_log_store_env.jnl_blk) +
+                                                                  s_log_store_env.jnl_slot * APP_LOG_STORE_JNL_REC_SIZE,
+                                                                  (uint8_t *)&rec, APP_LOG_STORE_JNL_REC_SIZE))
+    {
+        return false;
+    }
+
+    s_log_store_env.jnl_slot++;
+
+    return true;
+}
+
+static bool log_store_jnl_recover(void)
+{
+    log_store_jnl_rec_t *p_rec;
+    uint16_t             slot_num = s_log_store_env.blk_size / APP_LOG_STORE_JNL_REC_SIZE;
+    uint16_t             read_slots;
+    uint16_t             used_slots[APP_LOG_STORE_JNL_BLK_NUM] = {0};
+    bool                 found = false;
+
+    for (uint8_t blk = 0; blk < APP_LOG_STORE_JNL_BLK_NUM; blk++)
+    {
+        for (uint16_t slot = 0; slot < slot_num; slot += read_slots)
+        {
+            read_slots = sizeof(s_read_dump_buffer) / APP_LOG_STORE_JNL_REC_SIZE;
+            if (read_slots > slot_num - slot)
+            {
+                read_slots = slot_num - slot;
+            }
+
+            s_log_store_ops.flash_read(log_store_jnl_blk_addr(blk) + slot * APP_LOG_STORE_JNL_REC_SIZE,
+                                       s_read_dump_buffer, read_slots * APP_LOG_STORE_JNL_REC_SIZE);
+
+            for (uint16_t i = 0; i < read_slots; i++)
+            {
+                p_rec = (log_store_jnl_rec_t *)&s_read_dump_buffer[i * APP_LOG_STORE_JNL_REC_SIZE];
+
+                if (log_store_jnl_rec_erased(p_rec))
+                {
+                    continue;
+                }
+
+                // Records are only ever appended, a torn write still consumes its slot.
+                used_slots[blk] = slot + i + 1;
+
+                if (log_store_jnl_rec_check(p_rec) && (!found || p_rec->seq > s_log_store_env.jnl_seq))
+                {
+                    found                                = true;
+                    s_log_store_env.jnl_seq              = p_rec->seq;
+                    s_log_store_env.jnl_blk              = blk;
+                    s_log_store_env.store_head.offset    = p_rec->offset;
+                    s_log_store_env.store_head.flip_over = p_rec->flip_over;
+                }
+            }
+        }
+    }
+
+    if (found)
+    {
+        s_log_store_env.jnl_slot = used_slots[s_log_store_env.jnl_blk];
+    }
+
+    return found;
+}
+
+static bool log_store_format(uint16_t nv_tag)
+{
+    s_log_store_env.store_head.magic     = APP_LOG_STORE_MAGIC;
+    s_log_store_env.store_head.offset    = 0;
+    s_log_store_env.store_head.flip_over = 0;
+
+    // Journal blocks are contiguous, one erase lets the flash driver use block erase where it can.
+    s_log_store_ops.flash_erase(log_store_jnl_blk_addr(0), APP_LOG_STORE_JNL_BLK_NUM * s_log_store_env.blk_size);
+
+    s_log_store_env.jnl_seq  = 0;
+    s_log_store_env.jnl_blk  = 0;
+    s_log_store_env.jnl_slot = 0;
+
+    if (!log_store_head_update(nv_tag, &s_log_store_env.store_head))
+    {
+        return false;
+    }
+
+    return log_store_jnl_append();
+}
+
+static bool log_store_time_text_encode(uint8_t *p_buffer, uint8_t buffer_size, app_log_store_time_t *p_time)
+{
+    if (APP_LOG_STORE_TIME_SIZE != buffer_size)
+    {
+        return false;
+    }
 
     if (APP_LOG_STORE_TIME_SIZE == snprintf((char *)p_buffer,
                                             APP_LOG_STORE_TIME_SIZE,
                                             "[%04d/%02d/%02d %02d:%02d:%02d:%03d] ", 
-                                            rtc_time.year, rtc_time.month, rtc_time.day,
-                                            rtc_time.hour, rtc_time.min, rtc_time.sec, rtc_time.msec))
+                                            p_time->year, p_time->month, p_time->day,
+                                            p_time->hour, p_time->min, p_time->sec, p_time->msec))
     {
         return true;
     }
@@ -174,6 +370,211 @@ static bool log_store_time_stamp_encode(uint8_t *p_buffer, uint8_t buffer_size)
     return false;
 }
 
+#if APP_LOG_STORE_COMPRESS_ENABLE
+static uint64_t log_store_time_to_ms(app_log_store_time_t *p_time)
+{
+    // Days from civil date, the year element counts from 2000.
+    int32_t  year  = 2000 + p_time->year;
+    uint32_t month = (p_time->month >= 1 && p_time->month <= 12) ? p_time->month : 1;
+    uint32_t day   = p_time->day ? p_time->day : 1;
+    uint32_t yoe, doy, doe;
+    int32_t  era;
+    int64_t  days;
+
+    year -= month <= 2;
+    era   = year / 400;
+    yoe   = year - era * 400;
+    doy   = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    doe   = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    days  = (int64_t)era * 146097 + doe - 719468;
+
+    return ((((uint64_t)days * 24 + p_time->hour) * 60 + p_time->min) * 60 + p_time->sec) * 1000 + p_time->msec;
+}
+
+static void log_store_ms_to_time(uint64_t time_ms, app_log_store_time_t *p_time)
+{
+    // Civil date from days, inverse of log_store_time_to_ms().
+    int32_t  days = time_ms / 86400000 + 719468;
+    uint32_t msec = time_ms % 86400000;
+    int32_t  era  = days / 146097;
+    uint32_t doe  = days - era * 146097;
+    uint32_t yoe  = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy  = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp   = (5 * doy + 2) / 153;
+    uint32_t mon  = mp < 10 ? mp + 3 : mp - 9;
+
+    p_time->year  = yoe + era * 400 + (mon <= 2) - 2000;
+    p_time->month = mon;
+    p_time->day   = doy - (153 * mp + 2) / 5 + 1;
+    p_time->hour  = msec / 3600000;
+    p_time->min   = msec / 60000 % 60;
+    p_time->sec   = msec / 1000 % 60;
+    p_time->msec  = msec % 1000;
+}
+
+static uint8_t log_store_varint_encode(uint64_t value, uint8_t *p_buffer)
+{
+    uint8_t len = 0;
+
+    while (value >= 0x80)
+    {
+        p_buffer[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    p_buffer[len++] = value;
+
+    return len;
+}
+
+static uint8_t log_store_varint_decode(const uint8_t *p_buffer, uint32_t buffer_len, uint64_t *p_value)
+{
+    uint64_t value = 0;
+
+    for (uint8_t i = 0; i < buffer_len && i < 10; i++)
+    {
+        value |= (uint64_t)(p_buffer[i] & 0x7F) << (7 * i);
+
+        if (0 == (p_buffer[i] & 0x80))
+        {
+            *p_value = value;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+static uint16_t log_store_entry_head_decode(const uint8_t *p_buffer, uint32_t buffer_len, int64_t *p_delta_ms, uint16_t *p_data_len)
+{
+    uint64_t zigzag;
+    uint64_t data_len;
+    uint8_t  delta_len;
+    uint8_t  len_len;
+
+    delta_len = log_store_varint_decode(p_buffer, buffer_len, &zigzag);
+    if (0 == delta_len)
+    {
+        return 0;
+    }
+
+    len_len = log_store_varint_decode(p_buffer + delta_len, buffer_len - delta_len, &data_len);
+    if (0 == len_len || data_len > APP_LOG_STORE_ONECE_OP_SIZE)
+    {
+        return 0;
+    }
+
+    *p_delta_ms = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+    *p_data_len = data_len;
+
+    return delta_len + len_len;
+}
+
+static void log_store_blk_check_sum_set(log_store_blk_head_t *p_head)
+{
+    p_head->check_sum = log_store_check_sum_calc((uint8_t *)p_head, APP_LOG_STORE_BLK_HEAD_SIZE - 4) +
+                        log_store_check_sum_calc((uint8_t *)p_head + APP_LOG_STORE_BLK_HEAD_SIZE, p_head->comp_len);
+}
+#endif
+
+#if APP_LOG_STORE_COMPRESS_ENABLE
+static void log_store_data_flash_write(void)
+{
+    log_store_blk_head_t *p_head   = (log_store_blk_head_t *)s_log_store_comp_buf;
+    uint8_t              *raw_buff = s_read_dump_buffer;
+    uint64_t              time_ms  = s_log_store_env.pack_time_ms;
+    uint32_t              pick_len;
+    uint32_t              raw_len  = 0;
+    uint32_t              text_len = 0;
+    uint32_t              blk_len;
+    uint32_t              offset;
+    uint16_t              head_len;
+    uint16_t              data_len;
+    int64_t               delta_ms;
+
+    pick_len = ring_buffer_pick(&s_log_store_rbuf, raw_buff, APP_LOG_STORE_ONECE_OP_SIZE);
+
+    // Pack whole entries only, so that every block can be decoded alone.
+    while (raw_len < pick_len)
+    {
+        head_len = log_store_entry_head_decode(raw_buff + raw_len, pick_len - raw_len, &delta_ms, &data_len);
+
+        if (0 == head_len || (raw_len + head_len + data_len) > pick_len)
+        {
+            break;
+        }
+
+        time_ms  += delta_ms;
+        raw_len  += head_len + data_len;
+        text_len += APP_LOG_STORE_TIME_SIZE + data_len;
+    }
+
+    if (0 == raw_len)
+    {
+        return;
+    }
+
+    ring_buffer_skip(&s_log_store_rbuf, raw_len);
+
+    p_head->magic      = APP_LOG_STORE_BLK_MAGIC;
+    p_head->raw_len    = raw_len;
+    p_head->text_len   = text_len;
+    p_head->base_ms_lo = (uint32_t)s_log_store_env.pack_time_ms;
+    p_head->base_ms_hi = (uint32_t)(s_log_store_env.pack_time_ms >> 32);
+    p_head->comp_len   = lz_compress(raw_buff, raw_len, s_log_store_comp_buf + APP_LOG_STORE_BLK_HEAD_SIZE, raw_len - 1);
+
+    if (0 == p_head->comp_len)
+    {
+        memcpy(s_log_store_comp_buf + APP_LOG_STORE_BLK_HEAD_SIZE, raw_buff, raw_len);
+        p_head->comp_len = raw_len;
+    }
+
+    log_store_blk_check_sum_set(p_head);
+
+    s_log_store_env.pack_time_ms = time_ms;
+
+    // A block never crosses an erase block, so that erasing ahead never breaks an older block.
+    blk_len = APP_LOG_STORE_BLK_HEAD_SIZE + p_head->comp_len;
+    offset  = s_log_store_env.store_head.offset;
+
+    if ((offset % s_log_store_env.blk_size) + blk_len > s_log_store_env.blk_size)
+    {
+        offset += s_log_store_env.blk_size - (offset % s_log_store_env.blk_size);
+    }
+
+    if (offset + blk_len > s_log_store_env.data_size)
+    {
+        offset = 0;
+        s_log_store_env.store_head.flip_over = 1;
+    }
+
+    if (0 == (offset % s_log_store_env.blk_size))
+    {
+        s_log_store_ops.flash_erase(s_log_store_env.data_addr + offset, s_log_store_env.blk_size);
+    }
+
+    s_log_store_ops.flash_write(s_log_store_env.data_addr + offset, s_log_store_comp_buf, blk_len);
+    offset += blk_len;
+
+    if (offset >= s_log_store_env.data_size)
+    {
+        offset = 0;
+        s_log_store_env.store_head.flip_over = 1;
+    }
+
+    s_log_store_env.store_head.offset = offset;
+
+    log_store_jnl_append();
+}
+#else
+static bool log_store_time_stamp_encode(uint8_t *p_buffer, uint8_t buffer_size)
+{
+    app_log_store_time_t rtc_time = {0};
+
+    s_log_store_ops.time_get(&rtc_time);
+
+    return log_store_time_text_encode(p_buffer, buffer_size, &rtc_time);
+}
+
 static void log_store_data_flash_write(void)
 {
     uint32_t align_num = 0;
@@ -184,7 +585,7 @@ static void log_store_data_flash_write(void)
     {
         if (s_log_store_ops.flash_erase)
         {
-            s_log_store_ops.flash_erase(s_log_store_env.store_head.db_addr + s_log_store_env.store_head.offset,
+            s_log_store_ops.flash_erase(s_log_store_env.data_addr + s_log_store_env.store_head.offset,
                                         s_log_store_env.blk_size);
         }
     }
@@ -202,19 +603,20 @@ static void log_store_data_flash_write(void)
 
     if (s_log_store_ops.flash_write && read_len)
     {
-        s_log_store_ops.flash_write(s_log_store_env.store_head.db_addr + s_log_store_env.store_head.offset, read_buff, read_len);
+        s_log_store_ops.flash_write(s_log_store_env.data_addr + s_log_store_env.store_head.offset, read_buff, read_len);
         s_log_store_env.store_head.offset += read_len;
     }
 
-    if (s_log_store_env.store_head.offset >= s_log_store_env.store_head.db_size)
+    // Log data lies behind the journal blocks, it wraps within the data area only.
+    if (s_log_store_env.store_head.offset >= s_log_store_env.data_size)
     {
         s_log_store_env.store_head.offset    = 0;
         s_log_store_env.store_head.flip_over = 1;
     }
 
-    log_store_head_update(s_log_store_env.head_nv_tag, &s_log_store_env.store_head);
-
+    log_store_jnl_append();
 }
+#endif
 
 static void log_store_to_flash(void)
 {
@@ -223,12 +625,159 @@ static void log_store_to_flash(void)
     s_log_store_env.store_status &= ~APP_LOG_STORE_SAVE_BIT;
 }
 
+#if APP_LOG_STORE_COMPRESS_ENABLE
+static bool log_dump_blk_read(uint32_t *p_scan_pos, log_store_blk_head_t *p_head)
+{
+    uint32_t offset;
+    uint32_t blk_end;
+
+    while (*p_scan_pos < s_log_dump_env.scan_size)
+    {
+        offset  = (s_log_dump_env.scan_start + *p_scan_pos) % s_log_store_env.data_size;
+        blk_end = offset + s_log_store_env.blk_size - (offset % s_log_store_env.blk_size);
+        blk_end = blk_end > s_log_store_env.data_size ? s_log_store_env.data_size : blk_end;
+
+        s_log_store_ops.flash_read(s_log_store_env.data_addr + offset, (uint8_t *)p_head, APP_LOG_STORE_BLK_HEAD_SIZE);
+
+        if (APP_LOG_STORE_BLK_MAGIC == p_head->magic &&
+            p_head->comp_len <= p_head->raw_len &&
+            p_head->raw_len  <= APP_LOG_STORE_ONECE_OP_SIZE &&
+            offset + APP_LOG_STORE_BLK_HEAD_SIZE + p_head->comp_len <= blk_end)
+        {
+            uint32_t check_sum = p_head->check_sum;
+
+            memcpy(s_log_store_comp_buf, p_head, APP_LOG_STORE_BLK_HEAD_SIZE);
+            s_log_store_ops.flash_read(s_log_store_env.data_addr + offset + APP_LOG_STORE_BLK_HEAD_SIZE,
+                                       s_log_store_comp_buf + APP_LOG_STORE_BLK_HEAD_SIZE, p_head->comp_len);
+            log_store_blk_check_sum_set((log_store_blk_head_t *)s_log_store_comp_buf);
+
+            if (check_sum == ((log_store_blk_head_t *)s_log_store_comp_buf)->check_sum)
+            {
+                *p_scan_pos += APP_LOG_STORE_BLK_HEAD_SIZE + p_head->comp_len;
+                return true;
+            }
+        }
+
+        // Erased or broken space, the next block starts at the next erase block.
+        *p_scan_pos += blk_end - offset;
+    }
+
+    return false;
+}
+
+static bool log_dump_blk_load(void)
+{
+    log_store_blk_head_t head;
+    uint8_t             *p_payload = s_log_store_comp_buf + APP_LOG_STORE_BLK_HEAD_SIZE;
+
+    while (log_dump_blk_read(&s_log_dump_env.scan_pos, &head))
+    {
+        if (head.comp_len == head.raw_len)
+        {
+            memcpy(s_log_dump_raw_buf, p_payload, head.raw_len);
+        }
+        else if (head.raw_len != lz_decompress(p_payload, head.comp_len, s_log_dump_raw_buf, head.raw_len))
+        {
+            continue;
+        }
+
+        s_log_dump_env.raw_len = head.raw_len;
+        s_log_dump_env.raw_pos = 0;
+        s_log_dump_env.time_ms = ((uint64_t)head.base_ms_hi << 32) | head.base_ms_lo;
+
+        return true;
+    }
+
+    return false;
+}
+
+static void log_dump_from_flash(void)
+{
+    uint8_t             *dump_buffer = s_read_dump_buffer;
+    uint16_t             dump_len    = 0;
+    uint16_t             copy_len;
+    uint16_t             head_len;
+    int64_t              delta_ms;
+    app_log_store_time_t entry_time;
+
+    while (dump_len < APP_LOG_STORE_ONECE_OP_SIZE &&
+           s_log_dump_env.text_sent + dump_len < s_log_dump_env.text_total)
+    {
+        if (s_log_dump_env.ts_pos < APP_LOG_STORE_TIME_SIZE)
+        {
+            copy_len = MIN(APP_LOG_STORE_TIME_SIZE - s_log_dump_env.ts_pos, APP_LOG_STORE_ONECE_OP_SIZE - dump_len);
+            memcpy(dump_buffer + dump_len, s_log_dump_env.ts_text + s_log_dump_env.ts_pos, copy_len);
+            s_log_dump_env.ts_pos += copy_len;
+            dump_len += copy_len;
+        }
+        else if (s_log_dump_env.data_left)
+        {
+            copy_len = MIN(s_log_dump_env.data_left, APP_LOG_STORE_ONECE_OP_SIZE - dump_len);
+            memcpy(dump_buffer + dump_len, s_log_dump_raw_buf + s_log_dump_env.raw_pos, copy_len);
+            s_log_dump_env.raw_pos   += copy_len;
+            s_log_dump_env.data_left -= copy_len;
+            dump_len += copy_len;
+        }
+        else if (s_log_dump_env.raw_pos < s_log_dump_env.raw_len)
+        {
+            head_len = log_store_entry_head_decode(s_log_dump_raw_buf + s_log_dump_env.raw_pos,
+                                                   s_log_dump_env.raw_len - s_log_dump_env.raw_pos,
+                                                   &delta_ms, &s_log_dump_env.data_left);
+            if (0 == head_len)
+            {
+                s_log_dump_env.raw_pos = s_log_dump_env.raw_len;
+                continue;
+            }
+
+            s_log_dump_env.raw_pos += head_len;
+            s_log_dump_env.time_ms += delta_ms;
+            s_log_dump_env.ts_pos   = 0;
+
+            if (s_log_dump_env.time_ms)
+            {
+                log_store_ms_to_time(s_log_dump_env.time_ms, &entry_time);
+                log_store_time_text_encode(s_log_dump_env.ts_text, APP_LOG_STORE_TIME_SIZE, &entry_time);
+                s_log_dump_env.ts_text[APP_LOG_STORE_TIME_SIZE - 1] = ' ';
+            }
+            else
+            {
+                memcpy(s_log_dump_env.ts_text, APP_LOG_STORE_TIME_DEFAULT, APP_LOG_STORE_TIME_SIZE);
+            }
+        }
+        else if (!log_dump_blk_load())
+        {
+            break;
+        }
+    }
+
+    s_log_dump_env.text_sent += dump_len;
+
+    if (0 == dump_len)
+    {
+        s_log_store_env.store_status &= ~APP_LOG_STORE_DUMP_BIT;
+        s_log_store_env.store_status |= APP_LOG_STORE_DUMP_READY_BIT;
+        return;
+    }
+
+    s_log_store_env.store_status &= ~APP_LOG_STORE_DUMP_READY_BIT;
+
+    if (s_log_dump_env.text_sent >= s_log_dump_env.text_total)
+    {
+        s_log_store_env.store_status &= ~APP_LOG_STORE_DUMP_BIT;
+    }
+
+    if (s_log_dump_cbs->dump_process_cb)
+    {
+        s_log_dump_cbs->dump_process_cb(dump_buffer, dump_len);
+    }
+}
+#else
 static void log_dump_from_flash(void)
 {
     uint8_t *dump_buffer = s_read_dump_buffer;
     uint16_t dump_len;
     uint32_t need_dump_size = s_log_store_env.store_head.flip_over ? 
-                              s_log_store_env.store_head.db_size : s_log_store_env.store_head.offset;
+                              s_log_store_env.data_size : s_log_store_env.store_head.offset;
 
 
     if (s_log_store_ops.flash_read && need_dump_size)
@@ -245,7 +794,7 @@ static void log_dump_from_flash(void)
             dump_len = APP_LOG_STORE_ONECE_OP_SIZE;
         }
 
-        s_log_store_ops.flash_read(s_log_store_dump_offset + s_log_store_env.store_head.db_addr, dump_buffer, dump_len);
+        s_log_store_ops.flash_read(s_log_store_dump_offset + s_log_store_env.data_addr, dump_buffer, dump_len);
 
         s_log_store_env.store_status &= ~APP_LOG_STORE_DUMP_READY_BIT;
         
@@ -268,6 +817,7 @@ static void log_dump_from_flash(void)
         s_log_store_env.store_status |= APP_LOG_STORE_DUMP_READY_BIT;
     }
 }
+#endif
 
 static void log_store_flush(void)
 {
@@ -288,6 +838,40 @@ static void log_store_flush(void)
     } while (items_count >= APP_LOG_STORE_ONECE_OP_SIZE);
 }
 
+#if APP_LOG_STORE_COMPRESS_ENABLE
+static void log_dump_ready(void)
+{
+    log_store_blk_head_t head;
+    uint32_t             scan_pos = 0;
+
+    log_store_flush();
+
+    // Dump from the oldest erase block, blocks are counted first to announce the text length.
+    memset(&s_log_dump_env, 0, sizeof(s_log_dump_env));
+    s_log_dump_env.ts_pos = APP_LOG_STORE_TIME_SIZE;
+
+    if (s_log_store_env.store_head.flip_over)
+    {
+        s_log_dump_env.scan_start = ALIGN_NUM(s_log_store_env.blk_size, s_log_store_env.store_head.offset + 1);
+        s_log_dump_env.scan_start = s_log_dump_env.scan_start >= s_log_store_env.data_size ? 0 : s_log_dump_env.scan_start;
+        s_log_dump_env.scan_size  = s_log_store_env.data_size;
+    }
+    else
+    {
+        s_log_dump_env.scan_size  = s_log_store_env.store_head.offset;
+    }
+
+    while (log_dump_blk_read(&scan_pos, &head))
+    {
+        s_log_dump_env.text_total += head.text_len;
+    }
+
+    if (s_log_dump_cbs->dump_start_cb)
+    {
+        s_log_dump_cbs->dump_start_cb(s_log_dump_env.text_total);
+    }
+}
+#else
 static void log_dump_ready(void)
 {
     uint32_t log_length;
@@ -297,18 +881,22 @@ static void log_dump_ready(void)
     if (s_log_dump_cbs->dump_start_cb)
     {
         log_length = s_log_store_env.store_head.flip_over ? 
-                     s_log_store_env.store_head.db_size : s_log_store_env.store_head.offset;
+                     s_log_store_env.data_size : s_log_store_env.store_head.offset;
         s_log_dump_cbs->dump_start_cb(log_length);
     }
 }
+#endif
 
 static void log_store_clear(void)
 {
     s_log_store_env.store_head.offset    = 0;
     s_log_store_env.store_head.flip_over = 0;
     ring_buffer_clean(&s_log_store_rbuf);
+#if APP_LOG_STORE_COMPRESS_ENABLE
+    s_log_store_env.pack_time_ms = s_log_store_env.save_time_ms;
+#endif
 
-    log_store_head_update(s_log_store_env.head_nv_tag, &s_log_store_env.store_head);
+    log_store_jnl_append();
     
     s_log_store_dump_offset = 0;
     s_log_store_env.store_status = APP_LOG_STORE_DUMP_READY_BIT;
@@ -335,36 +923,42 @@ uint16_t app_log_store_init(app_log_store_info_t *p_info, app_log_store_op_t *p_
         || NULL == p_op_func->flash_erase
         || 0 == p_info->db_size
         || 0 == p_info->blk_size
-        || 0 != (p_info->db_addr % p_info->blk_size))
+        || 0 != (p_info->db_addr % p_info->blk_size)
+        || p_info->db_size <= APP_LOG_STORE_JNL_BLK_NUM * p_info->blk_size
+#if APP_LOG_STORE_COMPRESS_ENABLE
+        || p_info->blk_size < APP_LOG_STORE_BLK_HEAD_SIZE + APP_LOG_STORE_ONECE_OP_SIZE
+#endif
+        )
     {
         return SDK_ERR_INVALID_PARAM;
     }
 
+    memcpy(&s_log_store_ops, p_op_func, sizeof(s_log_store_ops));
+
+    p_op_func->flash_init();
+
+    s_log_store_env.blk_size  = p_info->blk_size;
+    s_log_store_env.data_addr = p_info->db_addr + APP_LOG_STORE_JNL_BLK_NUM * p_info->blk_size;
+    s_log_store_env.data_size = p_info->db_size - APP_LOG_STORE_JNL_BLK_NUM * p_info->blk_size;
+
     nvds_get(p_info->nv_tag, &head_len, (uint8_t *)&s_log_store_env.store_head);
 
-    if (!log_store_head_check(&s_log_store_env.store_head, p_info->db_addr, p_info->db_size))
+    if (!log_store_head_check(&s_log_store_env.store_head, p_info->db_addr, p_info->db_size) ||
+        !log_store_jnl_recover())
     {
-        s_log_store_env.store_head.magic     = APP_LOG_STORE_MAGIC;
-        s_log_store_env.store_head.db_addr   = p_info->db_addr;
-        s_log_store_env.store_head.db_size   = p_info->db_size;
-        s_log_store_env.store_head.offset    = 0;
-        s_log_store_env.store_head.flip_over = 0;
+        s_log_store_env.store_head.db_addr = p_info->db_addr;
+        s_log_store_env.store_head.db_size = p_info->db_size;
 
-        if (!log_store_head_update(p_info->nv_tag, &s_log_store_env.store_head))
+        if (!log_store_format(p_info->nv_tag))
         {
             return SDK_ERR_SDK_INTERNAL;
         }
     }
 
-    memcpy(&s_log_store_ops, p_op_func, sizeof(s_log_store_ops));
-
     s_log_store_env.head_nv_tag = p_info->nv_tag;
-    s_log_store_env.blk_size    = p_info->blk_size;
     s_log_store_env.initialized = true;
     s_log_store_env.store_status |= APP_LOG_STORE_DUMP_READY_BIT;
 
-    p_op_func->flash_init();
-
     if (APP_LOG_STORE_CACHE_SIZE != s_log_store_rbuf.buffer_size)
     {
         ring_buffer_init(&s_log_store_rbuf, s_log_store_cache, APP_LOG_STORE_CACHE_SIZE);
@@ -381,6 +975,45 @@ uint16_t app_log_store_init(app_log_store_info_t *p_info, app_log_store_op_t *p_
 }
 
 
+#if APP_LOG_STORE_COMPRESS_ENABLE
+uint16_t app_log_store_save(const uint8_t *p_data, const uint16_t length)
+{
+    uint8_t              entry_head[APP_LOG_STORE_ENTRY_HEAD_MAX];
+    uint8_t              head_len;
+    uint64_t             time_ms;
+    int64_t              delta_ms;
+    app_log_store_time_t rtc_time = {0};
+
+    if (!s_log_store_env.initialized)
+    {
+        return SDK_ERR_DISALLOWED;
+    }
+
+    time_ms = s_log_store_env.save_time_ms;
+
+    if (s_log_store_ops.time_get)
+    {
+        s_log_store_ops.time_get(&rtc_time);
+        time_ms = log_store_time_to_ms(&rtc_time);
+    }
+
+    // Entry head: zigzag time delta to the former entry, then data length.
+    delta_ms = (int64_t)(time_ms - s_log_store_env.save_time_ms);
+    head_len = log_store_varint_encode(((uint64_t)delta_ms << 1) ^ (uint64_t)(delta_ms >> 63), entry_head);
+    head_len += log_store_varint_encode(length, entry_head + head_len);
+
+    // A partly cached entry would break the delta chain, drop the whole entry instead.
+    if ((head_len + length) > APP_LOG_STORE_ONECE_OP_SIZE ||
+        (head_len + length) > ring_buffer_surplus_space_get(&s_log_store_rbuf))
+    {
+        return SDK_ERR_NO_RESOURCES;
+    }
+
+    s_log_store_env.save_time_ms = time_ms;
+
+    ring_buffer_write(&s_log_store_rbuf, entry_head, head_len);
+    ring_buffer_write(&s_log_store_rbuf, p_data, length);
+#else
 uint16_t app_log_store_save(const uint8_t *p_data, const uint16_t length)
 {
     uint8_t  time_encode[APP_LOG_STORE_TIME_SIZE] = APP_LOG_STORE_TIME_DEFAULT;
@@ -398,6 +1031,7 @@ uint16_t app_log_store_save(const uint8_t *p_data, const uint16_t length)
 
     ring_buffer_write(&s_log_store_rbuf, time_encode, APP_LOG_STORE_TIME_SIZE);
     ring_buffer_write(&s_log_store_rbuf, p_data, length);
+#endif
 
     if ((APP_LOG_STORE_ONECE_OP_SIZE <= ring_buffer_items_count_get(&s_log_store_rbuf)) && 
         !(s_log_store_env.store_status & APP_LOG_STORE_DUMP_BIT))
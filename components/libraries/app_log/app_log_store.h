@@ -54,6 +54,10 @@
 #define APP_LOG_STORE_RUN_ON_OS  0          /**< Is run on OS. */
 #define APP_LOG_STORE_LINE_SIZE  280        /**< Size for every line's log. */
 #define APP_LOG_STORE_CACHE_NUM  10         /**< Number of log lines cache. */
+
+#ifndef APP_LOG_STORE_COMPRESS_ENABLE
+#define APP_LOG_STORE_COMPRESS_ENABLE  0    /**< Store log in LZ compressed blocks with binary time stamps, lz_compress.c must be built. */
+#endif
 /** @} */
 
 /**
@@ -98,9 +102,9 @@ typedef struct
 /**@brief App log store init stucture. */
 typedef struct
 {
-    uint16_t   nv_tag;        /**< NVDS Tag for app log store env. */
+    uint16_t   nv_tag;        /**< NVDS Tag for app log store env, only written when the log db is formatted. */
     uint32_t   db_addr;       /**< Start address of app log db flash. */
-    uint32_t   db_size;       /**< Size of app log db flash. */
+    uint32_t   db_size;       /**< Size of app log db flash, the first two blocks are reserved for head journal. */
     uint16_t   blk_size;      /**< Block size in the flash for erase minimum granularity */
 } app_log_store_info_t;
 /** @} */
@@ -0,0 +1,71 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_log_bin_test.c
+ *
+ * @brief Host test of app log binary frames, run by app_log_bin_test.py.
+ *
+ * @details Every case is logged with app_log_binary_output() and printed with the C
+ *          library, one line per case: format, raw arguments in hex and expected text,
+ *          separated by tabs. The script decodes the arguments with app_log_decoder.py
+ *          and compares the text. Only fixed-size integer types are used, since long is
+ *          64-bit on the host but 32-bit on the target.
+ *
+ *****************************************************************************************
+ */
+#include "app_log.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+static uint8_t  s_frame[APP_LOG_LINE_BUF_SIZE];
+static uint16_t s_frame_len;
+
+static void frame_trans(uint8_t *p_data, uint16_t length)
+{
+    memcpy(s_frame, p_data, length);
+    s_frame_len = length;
+}
+
+static void case_print(const char *format, const char *p_expect)
+{
+    uint16_t args_len = s_frame[2] | (s_frame[3] << 8);
+
+    assert(APP_LOG_BIN_SYNC == s_frame[0]);
+    assert(0 == (s_frame[1] & APP_LOG_BIN_TRUNCATED));
+    assert(APP_LOG_BIN_HEAD_LEN + args_len == s_frame_len);
+
+    printf("%s\t", format);
+    for (uint16_t i = APP_LOG_BIN_HEAD_LEN; i < s_frame_len; i++)
+    {
+        printf("%02x", s_frame[i]);
+    }
+    printf("\t%s\n", p_expect);
+}
+
+#define BIN_CASE(format, ...)                                                       \
+    do {                                                                            \
+        char expect[APP_LOG_LINE_BUF_SIZE];                                         \
+        app_log_binary_output(APP_LOG_LVL_INFO, format, __VA_ARGS__);              \
+        snprintf(expect, sizeof(expect), format, __VA_ARGS__);                      \
+        case_print(format, expect);                                                 \
+    } while (0)
+
+int main(void)
+{
+    app_log_init_t init = { .filter = { .level = APP_LOG_LVL_DEBUG } };
+
+    assert(SDK_SUCCESS == app_log_init(&init, frame_trans, NULL));
+
+    BIN_CASE("%d %u %x", (int32_t)-5, (uint32_t)4000000000u, (uint32_t)0xBEEF);
+    BIN_CASE("%jd %d", (intmax_t)-1234567890123, (int32_t)77);
+    BIN_CASE("%ju %jx %u", (uintmax_t)18000000000000000000u, (uintmax_t)0x123456789A, (uint32_t)9);
+    BIN_CASE("%lld %s %d", (long long)-9000000000, "mid", (int32_t)-1);
+    BIN_CASE("%hd %zu %c", (short)-12, (size_t)3, 'Q');
+    BIN_CASE("%*d|%-6s|", 5, (int32_t)42, "ab");
+    BIN_CASE("%.3f %jd %e", 3.14159, (intmax_t)-1, 1.5e-7);
+    BIN_CASE("%s %jd %s", "a", (intmax_t)INT64_MIN, "z");
+
+    return 0;
+}
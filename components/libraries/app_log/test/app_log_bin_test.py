@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Round trip of app log binary frames: decode the arguments printed by the
+app_log_bin_test host program with app_log_decoder.py and compare with the
+text of the C library.
+
+Usage:
+    python app_log_bin_test.py <app_log_bin_test executable>
+"""
+
+import os
+import struct
+import subprocess
+import sys
+import types
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+# The decoder only needs pyelftools for the ELF format table, not for decode_args().
+sys.modules.setdefault('elftools', types.ModuleType('elftools'))
+sys.modules.setdefault('elftools.elf', types.ModuleType('elftools.elf'))
+elffile = sys.modules.setdefault('elftools.elf.elffile', types.ModuleType('elftools.elf.elffile'))
+if not hasattr(elffile, 'ELFFile'):
+    elffile.ELFFile = None
+
+from app_log_decoder import decode_args
+
+
+def main():
+    output = subprocess.run([sys.argv[1]], check=True, stdout=subprocess.PIPE).stdout.decode()
+    failed = 0
+    cases  = 0
+
+    for line in output.splitlines():
+        fmt, args, expect = line.split('\t')
+        cases += 1
+        try:
+            py_fmt, values = decode_args(fmt, bytes.fromhex(args))
+            text           = py_fmt % values
+        except (struct.error, TypeError, ValueError) as err:
+            text = '<%s>' % err
+        if text != expect:
+            failed += 1
+            print('FAIL %r: decoded %r, expected %r' % (fmt, text, expect))
+
+    print('%d/%d binary log cases passed' % (cases - failed, cases))
+    return 1 if failed or not cases else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,260 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_log_store_test.c
+ *
+ * @brief Host test of app_log_store wear on an emulated flash.
+ *
+ * @details The log db is a 64 KB range with 4 KB blocks in a 1 MB emulated flash, where
+ *          programming can only clear bits. 1 MB of typical log lines is saved and
+ *          scheduled to flash. NVDS must not be written after init, nothing outside the
+ *          log db may be touched, data blocks must wear evenly and the head journal must
+ *          be erased once every blk_size/16 flushes. After a simulated reboot, init must
+ *          recover the head from the journal without erasing. The driver source is
+ *          included to reach its state, built with and without compression.
+ *
+ *****************************************************************************************
+ */
+#include "../app_log_store.c"
+
+#include <stdio.h>
+
+#define TEST_REGION_SIZE        0x100000
+#define TEST_DB_ADDR            0x40000
+#define TEST_DB_SIZE            0x10000
+#define TEST_BLK_SIZE           0x1000
+#define TEST_BLK_NUM            (TEST_DB_SIZE / TEST_BLK_SIZE)
+#define TEST_FEED_SIZE          0x100000
+#define TEST_NV_TAG             0x4001
+
+static uint8_t  s_flash[TEST_REGION_SIZE];
+static uint32_t s_erase_count[TEST_BLK_NUM];
+static uint32_t s_outside;              /* Erases, reads and writes outside the log db. */
+static uint32_t s_misaligned;           /* Erases not on block boundaries. */
+static uint32_t s_bad_program;          /* Bytes written with a bit set from 0 to 1. */
+static uint32_t s_jnl_writes;
+
+static uint8_t  s_nvds[sizeof(log_store_head_t)];
+static bool     s_nvds_valid;
+static uint32_t s_nvds_puts;
+
+static uint64_t s_time_ms;
+
+/*
+ * FLASH, NVDS AND TIME FAKES
+ *****************************************************************************************
+ */
+static bool test_range_check(uint32_t addr, uint32_t size)
+{
+    if ((addr < TEST_DB_ADDR) || (addr + size > TEST_DB_ADDR + TEST_DB_SIZE))
+    {
+        s_outside++;
+    }
+    return addr + size <= TEST_REGION_SIZE;
+}
+
+static bool test_flash_init(void)
+{
+    return true;
+}
+
+static bool test_flash_erase(const uint32_t addr, const uint32_t size)
+{
+    if ((addr % TEST_BLK_SIZE) || (size % TEST_BLK_SIZE))
+    {
+        s_misaligned++;
+    }
+    if (!test_range_check(addr, size))
+    {
+        return false;
+    }
+
+    for (uint32_t blk_addr = addr; blk_addr < addr + size; blk_addr += TEST_BLK_SIZE)
+    {
+        if ((blk_addr >= TEST_DB_ADDR) && (blk_addr < TEST_DB_ADDR + TEST_DB_SIZE))
+        {
+            s_erase_count[(blk_addr - TEST_DB_ADDR) / TEST_BLK_SIZE]++;
+        }
+    }
+    memset(&s_flash[addr], 0xFF, size);
+
+    return true;
+}
+
+static uint32_t test_flash_read(const uint32_t addr, uint8_t *buf, const uint32_t size)
+{
+    if (!test_range_check(addr, size))
+    {
+        return 0;
+    }
+
+    memcpy(buf, &s_flash[addr], size);
+
+    return size;
+}
+
+static uint32_t test_flash_write(const uint32_t addr, const uint8_t *buf, const uint32_t size)
+{
+    if (!test_range_check(addr, size))
+    {
+        return 0;
+    }
+
+    if (addr < TEST_DB_ADDR + APP_LOG_STORE_JNL_BLK_NUM * TEST_BLK_SIZE)
+    {
+        s_jnl_writes++;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+        s_bad_program += ((s_flash[addr + i] & buf[i]) != buf[i]);
+        s_flash[addr + i] &= buf[i];
+    }
+
+    return size;
+}
+
+static void test_time_get(app_log_store_time_t *p_time)
+{
+    uint64_t sec = s_time_ms / 1000;
+
+    p_time->year  = 24;
+    p_time->month = 6;
+    p_time->day   = 1 + (uint8_t)(sec / 86400);
+    p_time->hour  = (uint8_t)(sec / 3600 % 24);
+    p_time->min   = (uint8_t)(sec / 60 % 60);
+    p_time->sec   = (uint8_t)(sec % 60);
+    p_time->msec  = (uint16_t)(s_time_ms % 1000);
+}
+
+uint8_t nvds_get(uint16_t tag, uint16_t *p_len, uint8_t *p_buf)
+{
+    if (!s_nvds_valid || (TEST_NV_TAG != tag) || (*p_len < sizeof(s_nvds)))
+    {
+        return 1;
+    }
+
+    memcpy(p_buf, s_nvds, sizeof(s_nvds));
+    *p_len = sizeof(s_nvds);
+
+    return 0;
+}
+
+uint8_t nvds_put(uint16_t tag, uint16_t len, const uint8_t *p_buf)
+{
+    if ((TEST_NV_TAG != tag) || (len != sizeof(s_nvds)))
+    {
+        return 1;
+    }
+
+    memcpy(s_nvds, p_buf, sizeof(s_nvds));
+    s_nvds_valid = true;
+    s_nvds_puts++;
+
+    return 0;
+}
+
+/*
+ * TEST FUNCTIONS
+ *****************************************************************************************
+ */
+static bool test_check(const char *p_name, bool ok, const char *p_detail)
+{
+    printf("%-24s %s %s\n", p_name, ok ? "PASS" : "FAIL", p_detail);
+    return ok;
+}
+
+int main(void)
+{
+    static const char *states[] = { "ok", "idle", "busy", "retry", "timeout" };
+    app_log_store_info_t info =
+    {
+        .nv_tag   = TEST_NV_TAG,
+        .db_addr  = TEST_DB_ADDR,
+        .db_size  = TEST_DB_SIZE,
+        .blk_size = TEST_BLK_SIZE,
+    };
+    app_log_store_op_t ops =
+    {
+        .flash_init  = test_flash_init,
+        .flash_erase = test_flash_erase,
+        .flash_read  = test_flash_read,
+        .flash_write = test_flash_write,
+        .time_get    = test_time_get,
+    };
+    char     line[APP_LOG_STORE_LINE_SIZE];
+    char     detail[96];
+    uint32_t fed = 0;
+    uint32_t nvds_puts;
+    uint32_t jnl_writes;
+    uint32_t data_min = 0xFFFFFFFF;
+    uint32_t data_max = 0;
+    uint32_t data_sum = 0;
+    uint32_t jnl_erases;
+    bool     ok = true;
+
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    if (SDK_SUCCESS != app_log_store_init(&info, &ops))
+    {
+        printf("FAIL init\n");
+        return 1;
+    }
+    nvds_puts  = s_nvds_puts;
+    jnl_writes = s_jnl_writes;
+    memset(s_erase_count, 0, sizeof(s_erase_count));
+
+    for (uint32_t i = 0; fed < TEST_FEED_SIZE; i++)
+    {
+        int len = snprintf(line, sizeof(line), "[I] sensor_task.c:%u: ch %u value %u state %s\r\n",
+                           200 + i % 37, i % 8, (i * 7919) % 4096, states[i % 5]);
+
+        s_time_ms += 3 + i % 11;
+        app_log_store_save((const uint8_t *)line, (uint16_t)len);
+        app_log_store_schedule();
+        fed += len;
+    }
+
+    for (uint32_t blk = APP_LOG_STORE_JNL_BLK_NUM; blk < TEST_BLK_NUM; blk++)
+    {
+        data_min  = (s_erase_count[blk] < data_min) ? s_erase_count[blk] : data_min;
+        data_max  = (s_erase_count[blk] > data_max) ? s_erase_count[blk] : data_max;
+        data_sum += s_erase_count[blk];
+    }
+    jnl_erases = s_erase_count[0] + s_erase_count[1];
+    jnl_writes = s_jnl_writes - jnl_writes;
+
+    snprintf(detail, sizeof(detail), "%u after init", (unsigned)(s_nvds_puts - nvds_puts));
+    ok &= test_check("nvds writes", s_nvds_puts == nvds_puts, detail);
+
+    snprintf(detail, sizeof(detail), "%u outside, %u misaligned, %u bad program",
+             (unsigned)s_outside, (unsigned)s_misaligned, (unsigned)s_bad_program);
+    ok &= test_check("flash accesses", !s_outside && !s_misaligned && !s_bad_program, detail);
+
+    // The ring wrapped several times, every data block is erased as often as the others.
+    snprintf(detail, sizeof(detail), "%u erases, %u to %u per block", (unsigned)data_sum,
+             (unsigned)data_min, (unsigned)data_max);
+    ok &= test_check("data wear", (data_min > 1) && (data_max - data_min <= 1), detail);
+
+    snprintf(detail, sizeof(detail), "%u erases for %u records", (unsigned)jnl_erases, (unsigned)jnl_writes);
+    ok &= test_check("journal wear", (jnl_writes > 0) &&
+                     (jnl_erases <= jnl_writes / (TEST_BLK_SIZE / APP_LOG_STORE_JNL_REC_SIZE) + 1), detail);
+
+    // Reboot: the head comes back from the journal, without formatting.
+    log_store_head_t head = s_log_store_env.store_head;
+    uint32_t         seq  = s_log_store_env.jnl_seq;
+    uint32_t         erases = data_sum + jnl_erases;
+
+    memset(&s_log_store_env, 0, sizeof(s_log_store_env));
+    ok &= (SDK_SUCCESS == app_log_store_init(&info, &ops));
+    data_sum = 0;
+    for (uint32_t blk = 0; blk < TEST_BLK_NUM; blk++)
+    {
+        data_sum += s_erase_count[blk];
+    }
+    snprintf(detail, sizeof(detail), "offset 0x%x flip %u seq %u", (unsigned)s_log_store_env.store_head.offset,
+             (unsigned)s_log_store_env.store_head.flip_over, (unsigned)s_log_store_env.jnl_seq);
+    ok &= test_check("reboot", (s_log_store_env.store_head.offset == head.offset) &&
+                     (s_log_store_env.store_head.flip_over == head.flip_over) && (1 == head.flip_over) &&
+                     (s_log_store_env.jnl_seq == seq) && (data_sum == erases) && (s_nvds_puts == nvds_puts), detail);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+/* Host test configuration of app_log, see ../Makefile. */
+#ifndef __CUSTOM_CONFIG_H__
+#define __CUSTOM_CONFIG_H__
+
+#ifndef APP_LOG_ENABLE
+#define APP_LOG_ENABLE          1
+#endif
+#ifndef APP_LOG_STORE_ENABLE
+#define APP_LOG_STORE_ENABLE    0
+#endif
+
+#endif
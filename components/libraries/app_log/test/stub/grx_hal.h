@@ -0,0 +1,11 @@
+/* Host stand-in of grx_hal.h, single context so the critical sections are empty. */
+#ifndef __GRX_HAL_H__
+#define __GRX_HAL_H__
+
+#define GLOBAL_EXCEPTION_DISABLE()  do {
+#define GLOBAL_EXCEPTION_ENABLE()   } while (0)
+#define LOCAL_INT_DISABLE(irq)      do {
+#define LOCAL_INT_RESTORE()         } while (0)
+#define BLE_IRQn                    0
+
+#endif
@@ -0,0 +1,23 @@
+/* Host stand-in of grx_sys.h, only what app_log and app_log_store need. */
+#ifndef __GRX_SYS_H__
+#define __GRX_SYS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef uint16_t sdk_err_t;
+
+#define SDK_SUCCESS             0
+#define SDK_ERR_DISALLOWED      1
+#define SDK_ERR_INVALID_PARAM   2
+#define SDK_ERR_SDK_INTERNAL    3
+#define SDK_ERR_BUSY            4
+#define SDK_ERR_NO_RESOURCES    5
+#define SDK_ERR_POINTER_NULL    6
+
+uint8_t nvds_get(uint16_t tag, uint16_t *p_len, uint8_t *p_buf);
+uint8_t nvds_put(uint16_t tag, uint16_t len, const uint8_t *p_buf);
+
+#endif
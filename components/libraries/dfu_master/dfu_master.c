@@ -41,6 +41,7 @@
  */
 #include "dfu_master.h"
 #include "flash_scatter_config.h"
+#include "utility.h"
 #include <string.h>
 
 /*
@@ -69,6 +70,18 @@
 #define DFU_ERASEING_FAIL            0x05     /**< FW erase flash fail event. */
 #define DFU_ERASE_REGIONS_NOT_EXIS   0x06     /**< FW erase regions not exist. */
 #define FAST_DFU_FLASH_SUCCESS       0xFF     /**< FW write flash success. */
+#define FAST_DFU_CRC32_BIT           0x08     /**< Fast DFU is checked by CRC-32 and resumable. */
+#define DFU_FEATURE_CRC32            0x01     /**< Peer feature flag: fast DFU CRC-32 and resume. */
+#define CRC_READ_LEN                 256      /**< Firmware data length read once to calculate CRC-32. */
+
+#ifndef DFU_M_FAST_WINDOW_NUM
+#define DFU_M_FAST_WINDOW_NUM        4        /**< Fast DFU chunks sent and not yet completed at most, per session. */
+#endif
+#ifndef DFU_M_FAST_WINDOW_BUF_SIZE
+#define DFU_M_FAST_WINDOW_BUF_SIZE   (2048 * DFU_M_SESSION_MAX) /**< Buffer of fast DFU chunks shared by sessions, windows shrink to fit in it. */
+#endif
+#define DFU_M_FAST_RETRY_MAX         3        /**< Times one fast DFU chunk is sent again on send fail. */
+#define DFU_M_CHUNK_SLOT_MAX         (DFU_M_FAST_WINDOW_NUM * DFU_M_SESSION_MAX) /**< Chunk slots in buffer at most. */
 
 #define FLASH_OP_PAGE_SIZE           0x1000   /**< Flash page size. */
 #define PATTERN_VALUE                (0x4744) /**< Pattern value. */
@@ -109,40 +122,87 @@ typedef struct
     uint16_t check_sum;
 } receive_frame_t;
 
+/**@brief Image chunk in the shared chunk buffer, read once for all sessions sending it. */
+typedef struct
+{
+    uint32_t          addr;               /**< Image data address of the chunk. */
+    uint32_t          check_sum;          /**< Byte sum of the chunk. */
+    uint16_t          len;                /**< Length of the chunk, 0 if the slot holds no data. */
+    uint8_t           ref_cnt;            /**< Sessions holding the chunk in their windows. */
+} dfu_m_chunk_t;
+
+/**@brief Fast DFU send window. Chunk n is held in slot[n % window_num] until it is completed. */
+typedef struct
+{
+    bool              active;             /**< Fast DFU data is being sent. */
+    uint8_t           window_num;         /**< Chunks in window at most. */
+    uint8_t           retry;              /**< Send fails of the oldest chunk in a row. */
+    uint8_t           slot[DFU_M_FAST_WINDOW_NUM]; /**< Chunk slots held by the window. */
+    uint32_t          img_addr;           /**< Image data address of chunk 0. */
+    uint32_t          base;               /**< Image offset of chunk 0, non-zero when the peer resumes. */
+    uint32_t          chunk_num;          /**< Chunks to send. */
+    uint32_t          read_seq;           /**< Chunks got a slot. */
+    uint32_t          release_seq;        /**< Chunks gave the slot back. */
+    uint32_t          sent_seq;           /**< Next chunk to send, goes back on send fail. */
+    uint32_t          submit_cnt;         /**< Send requests made. */
+    uint32_t          report_seq;         /**< Completed chunks reported to app. */
+    volatile uint32_t cplt_cnt;           /**< Send completions or fails got. */
+    volatile uint32_t acked_seq;          /**< Chunks completed in order. */
+    volatile bool     fail;               /**< Chunk acked_seq failed, the ones behind it are stale. */
+} dfu_m_window_t;
+
+/**@brief DFU master session, the update of one peer. */
+typedef struct
+{
+    receive_frame_t   receive_frame;
+    boot_info_t       bootloader_boot_info;
+    bool              cmd_receive_flag;
+    uint16_t          receive_data_count;
+    uint32_t          receive_check_sum;
+    cmd_parse_state_t parse_state;
+
+    dfu_img_info_t    now_img_info;
+    dfu_img_info_t    app_info;
+    uint32_t          page_start_addr;
+    uint32_t          all_check_sum;
+    uint32_t          file_size;
+    uint32_t          program_size;
+    bool              run_fw_flag;
+
+    uint16_t          sended_len;
+    uint16_t          all_send_len;
+    uint8_t          *send_data_buffer;
+
+    bool              sec_flag;
+    bool              version_flag;
+    bool              peer_crc32;
+    bool              fast_crc32;
+
+    uint16_t          erase_all_count;
+    uint32_t          dfu_save_addr;
+
+    dfu_m_window_t    fast_window;
+} dfu_m_session_t;
+
 /*
  * LOCAL VARIABLE DEFINITIONS
  ****************************************************************************************
  */
-static receive_frame_t   s_receive_frame;
-static boot_info_t       s_bootloader_boot_info;
-static bool              s_cmd_receive_flag;
-static uint16_t          s_receive_data_count;
-static uint32_t          s_receive_check_sum;
-
-static dfu_img_info_t    s_now_img_info;
-static dfu_img_info_t    s_app_info;
-static uint32_t          s_page_start_addr;
-static uint32_t          s_all_check_sum;
-static uint32_t          s_file_size;
-static bool              s_run_fw_flag;
+static dfu_m_session_t   s_session[DFU_M_SESSION_MAX];
 static dfu_m_func_cfg_t *s_p_func_cfg;
-
-static uint16_t          s_sended_len;
-static uint16_t          s_all_send_len;
 static uint16_t          s_once_size = 350;
-static uint8_t*          s_send_data_buffer;
 
-static cmd_parse_state_t s_parse_state = CHECK_FRAME_L_STATE;
+static uint8_t           s_chunk_buf[DFU_M_FAST_WINDOW_BUF_SIZE];
+static dfu_m_chunk_t     s_chunk[DFU_M_CHUNK_SLOT_MAX];
+static uint8_t           s_chunk_slot_num;
+static uint8_t           s_chunk_next;
+static uint16_t          s_chunk_size;
+static uint8_t           s_schedule_first;
 
-static bool              s_sec_flag = false;
-static bool              s_version_flag = false;
+uint8_t                  fast_dfu_mode = 0;
 
-static uint16_t          s_erase_all_count = 0;
-static uint32_t          s_dfu_save_addr = 0;
+#define SESSION_IDX(p_s)    ((uint8_t)((p_s) - s_session))
 
-uint8_t                  fast_dfu_mode = 0;
-uint32_t                 program_size;
-uint8_t                  ble_send_cplt_flag = 0;
 /**
  *****************************************************************************************
  * @brief Function for getting updated firmware information.
@@ -177,15 +237,20 @@ static void dfu_m_get_img_data(uint32_t addr, uint8_t *data, uint16_t len)
 
 /**
  *****************************************************************************************
- * @brief Function for start update firmware.
+ * @brief Function for sending data to the peer of a session.
  *
- * @param[in]  security: Upgrade firmware is encrypted?.
- * @param[in]  run_fw: Whether to run the firmware immediately after the upgrade.
+ * @param[in]  p_s: Pointer of session.
+ * @param[in]  data: Pointer of data.
+ * @param[in]  len: Data length.
  *****************************************************************************************
  */
-static void dfu_m_send_data(uint8_t *data, uint16_t len)
+static void dfu_m_send_data(dfu_m_session_t *p_s, uint8_t *data, uint16_t len)
 {
-    if(s_p_func_cfg -> dfu_m_send_data != NULL)
+    if(s_p_func_cfg -> dfu_m_session_send_data != NULL)
+    {
+        s_p_func_cfg -> dfu_m_session_send_data(SESSION_IDX(p_s), data, len);
+    }
+    else if(s_p_func_cfg -> dfu_m_send_data != NULL)
     {
         s_p_func_cfg -> dfu_m_send_data(data, len);
     }
@@ -214,15 +279,20 @@ static void dfu_m_send_data(uint8_t *data, uint16_t len)
 
 /**
  *****************************************************************************************
- * @brief Function for start update firmware.
+ * @brief Function for sending event of a session to app.
  *
- * @param[in]  security: Upgrade firmware is encrypted?.
- * @param[in]  run_fw: Whether to run the firmware immediately after the upgrade.
+ * @param[in]  p_s: Pointer of session.
+ * @param[in]  event: DFU master event.
+ * @param[in]  pre: Progress in percent.
  *****************************************************************************************
  */
-static void dfu_m_event_handler(dfu_m_event_t event, uint8_t pre)
+static void dfu_m_event_handler(dfu_m_session_t *p_s, dfu_m_event_t event, uint8_t pre)
 {
-    if(s_p_func_cfg -> dfu_m_event_handler != NULL)
+    if(s_p_func_cfg -> dfu_m_session_event_handler != NULL)
+    {
+        s_p_func_cfg -> dfu_m_session_event_handler(SESSION_IDX(p_s), event, pre);
+    }
+    else if(s_p_func_cfg -> dfu_m_event_handler != NULL)
     {
         s_p_func_cfg -> dfu_m_event_handler(event, pre);
     }
@@ -237,22 +307,22 @@ static void dfu_m_event_handler(dfu_m_event_t event, uint8_t pre)
  * @param[in]  run_fw: Whether to run the firmware immediately after the upgrade.
  *****************************************************************************************
  */
-static void dfu_m_cmd_check(void)
+static void dfu_m_cmd_check(dfu_m_session_t *p_s)
 {
     uint16_t i = 0;
-    for(i=0; i<s_receive_frame.data_len; i++)
+    for(i=0; i<p_s->receive_frame.data_len; i++)
     {
-        s_receive_check_sum += s_receive_frame.data[i];
+        p_s->receive_check_sum += p_s->receive_frame.data[i];
     }
 
-    if((s_receive_check_sum & 0xffff) == s_receive_frame.check_sum)
+    if((p_s->receive_check_sum & 0xffff) == p_s->receive_frame.check_sum)
     {
-        s_cmd_receive_flag = true;
+        p_s->cmd_receive_flag = true;
     }
     else
     {
-        s_cmd_receive_flag = false;
-        dfu_m_event_handler(FRAM_CHECK_ERROR, 0);
+        p_s->cmd_receive_flag = false;
+        dfu_m_event_handler(p_s, FRAM_CHECK_ERROR, 0);
     }
 }
 
@@ -264,21 +334,21 @@ static void dfu_m_cmd_check(void)
  * @param[in]  run_fw: Whether to run the firmware immediately after the upgrade.
  *****************************************************************************************
  */
-static void dfu_m_send(uint8_t *data, uint16_t len)
+static void dfu_m_send(dfu_m_session_t *p_s, uint8_t *data, uint16_t len)
 {
-    s_send_data_buffer = s_receive_frame.data;
-    memcpy(s_send_data_buffer,data,len);
-    s_all_send_len = len;
+    p_s->send_data_buffer = p_s->receive_frame.data;
+    memcpy(p_s->send_data_buffer,data,len);
+    p_s->all_send_len = len;
     if(len >= s_once_size)
     {
-        s_sended_len = s_once_size;
+        p_s->sended_len = s_once_size;
     }
     else
     {
-        s_sended_len = len;
+        p_s->sended_len = len;
     }
 
-    dfu_m_send_data(s_send_data_buffer,s_sended_len);
+    dfu_m_send_data(p_s, p_s->send_data_buffer,p_s->sended_len);
 }
 
 /**
@@ -289,7 +359,7 @@ static void dfu_m_send(uint8_t *data, uint16_t len)
  * @param[in]  run_fw: Whether to run the firmware immediately after the upgrade.
  *****************************************************************************************
  */
-static void dfu_m_send_frame(uint8_t *data,uint16_t len,uint16_t cmd_type)
+static void dfu_m_send_frame(dfu_m_session_t *p_s, uint8_t *data,uint16_t len,uint16_t cmd_type)
 {
     uint8_t send_data[RECEIVE_MAX_LEN + 8];
     uint16_t i = 0;
@@ -313,7 +383,7 @@ static void dfu_m_send_frame(uint8_t *data,uint16_t len,uint16_t cmd_type)
     }
     send_data[6+len] = check_sum;
     send_data[7+len] = check_sum >> 8;
-    dfu_m_send(send_data,len+8);
+    dfu_m_send(p_s, send_data,len+8);
 }
 
 /**
@@ -324,381 +394,351 @@ static void dfu_m_send_frame(uint8_t *data,uint16_t len,uint16_t cmd_type)
  * @param[in]  run_fw: Whether to run the firmware immediately after the upgrade.
  *****************************************************************************************
  */
-static void dfu_m_program_flash(uint16_t len)
+static void dfu_m_program_flash(dfu_m_session_t *p_s, uint16_t len)
 {
     uint16_t i=0;
-    program_size += len;
+    uint8_t *p_data = p_s->receive_frame.data;
 
-    dfu_m_get_img_data(s_page_start_addr, &s_receive_frame.data[7], len);
+    p_s->program_size += len;
+
+    dfu_m_get_img_data(p_s->page_start_addr, &p_data[7], len);
     for(i=0; i<len; i++)
     {
-        s_all_check_sum += s_receive_frame.data[i+7];
+        p_s->all_check_sum += p_data[i+7];
     }
-    s_receive_frame.data[0] = 0x01;
+    p_data[0] = 0x01;
 
-    s_receive_frame.data[1] = s_dfu_save_addr;
-    s_receive_frame.data[2] = s_dfu_save_addr>>8;
-    s_receive_frame.data[3] = s_dfu_save_addr>>16;
-    s_receive_frame.data[4] = s_dfu_save_addr>>24;
+    p_data[1] = p_s->dfu_save_addr;
+    p_data[2] = p_s->dfu_save_addr>>8;
+    p_data[3] = p_s->dfu_save_addr>>16;
+    p_data[4] = p_s->dfu_save_addr>>24;
 
-    s_receive_frame.data[5] = len;
-    s_receive_frame.data[6] = len>>8;
+    p_data[5] = len;
+    p_data[6] = len>>8;
 
-    dfu_m_send_frame(s_receive_frame.data, len+7, PROGRAME_FLASH);
-    s_dfu_save_addr += len;
-    s_page_start_addr += len;
+    dfu_m_send_frame(p_s, p_data, len+7, PROGRAME_FLASH);
+    p_s->dfu_save_addr += len;
+    p_s->page_start_addr += len;
 }
 
-static void dfu_m_fast_program_flash(void)
+static uint32_t dfu_m_img_crc32_calc(uint32_t addr, uint32_t size)
 {
-    uint16_t remain;
-    uint16_t i = 0;
-    uint8_t pre = 0;
+    uint8_t  buf[CRC_READ_LEN];
+    uint32_t crc = 0;
+    uint16_t len;
 
-    while (program_size != s_file_size)
+    while (size)
     {
-        if (ble_send_cplt_flag || program_size == 0)
-        {
-            ble_send_cplt_flag = 0;
-
-            dfu_m_get_img_data(s_page_start_addr, &s_receive_frame.data[0], s_once_size);
-
-            if (program_size + s_once_size > s_file_size)
-            {
-                remain = s_file_size - program_size;
-                dfu_m_send(&s_receive_frame.data[0], remain);
-                for (i = 0; i < remain; i++)
-                {
-                    s_all_check_sum += s_receive_frame.data[i];
-                }
-                program_size += remain;
-            }
-            else
-            {
-                program_size += s_once_size;
-                dfu_m_send(&s_receive_frame.data[0], s_once_size);
-                for (i = 0; i < s_once_size; i++)
-                {
-                    s_all_check_sum += s_receive_frame.data[i];
-                }
-            }
-
-            pre = (program_size * 100) / s_file_size;
-            dfu_m_event_handler(FAST_DFU_PRO_FLASH_SUCCESS, pre);
-            s_page_start_addr += s_once_size;
-        }
+        len = size > CRC_READ_LEN ? CRC_READ_LEN : size;
+        dfu_m_get_img_data(addr, buf, len);
+        crc   = crc32_calc(crc, buf, len);
+        addr += len;
+        size -= len;
     }
+
+    return crc;
 }
 
-/*
- * GLOBAL FUNCTION DEFINITIONS
- *****************************************************************************************
- */
-void dfu_m_send_data_cmpl_process(void)
+static int dfu_m_chunk_get(uint32_t addr, uint16_t len)
 {
-    int remain = s_all_send_len - s_sended_len;
+    uint8_t idx;
+    int     free_idx = -1;
 
-    if(remain >= s_once_size)
+    // A chunk another session has read is shared.
+    for (idx = 0; idx < s_chunk_slot_num; idx++)
     {
-        dfu_m_send_data(&s_send_data_buffer[s_sended_len], s_once_size);
-        s_sended_len += s_once_size;
-    }
-    else if(remain > 0)
-    {
-        dfu_m_send_data(&s_send_data_buffer[s_sended_len], remain);
-        s_sended_len += remain;
+        if (s_chunk[idx].len == len && s_chunk[idx].addr == addr)
+        {
+            s_chunk[idx].ref_cnt++;
+            return idx;
+        }
     }
-}
-
-
-void dfu_m_cmd_prase(uint8_t* data,uint16_t len)
-{
-    uint16_t i = 0;
 
-    if(s_cmd_receive_flag == 0)
+    // Round robin over the free slots, so a chunk just given back stays for the sessions behind.
+    for (uint8_t i = 0; i < s_chunk_slot_num; i++)
     {
-        for(i=0; i<len; i++)
+        idx = (s_chunk_next + i) % s_chunk_slot_num;
+        if (0 == s_chunk[idx].ref_cnt)
         {
-            switch(s_parse_state)
-            {
-                case CHECK_FRAME_L_STATE:
-                {
-                    s_receive_check_sum = 0;
-                    if(data[i] == CMD_FRAME_HEADER_L)
-                    {
-                        s_parse_state = CHECK_FRAME_H_STATE;
-                    }
-                }
-                break;
-
-                case CHECK_FRAME_H_STATE:
-                {
-                    if(data[i] == CMD_FRAME_HEADER_H)
-                    {
-                        s_parse_state = RECEIVE_CMD_TYPE_L_STATE;
-                    } else if(data[i] == CMD_FRAME_HEADER_L) {
-                        s_parse_state = CHECK_FRAME_H_STATE;
-                    } else {
-                        s_parse_state = CHECK_FRAME_L_STATE;
-                    }
-                }
-                break;
-
-                case RECEIVE_CMD_TYPE_L_STATE:
-                {
-                    s_receive_frame.cmd_type = data[i];
-                    s_receive_check_sum += data[i];
-                    s_parse_state = RECEIVE_CMD_TYPE_H_STATE;
-                }
-                break;
-
-                case RECEIVE_CMD_TYPE_H_STATE:
-                {
-                    s_receive_frame.cmd_type |= (data[i] << 8);
-                    s_receive_check_sum += data[i];
-                    s_parse_state = RECEIVE_LEN_L_STATE;
-                }
-                break;
-
-                case RECEIVE_LEN_L_STATE:
-                {
-                    s_receive_frame.data_len = data[i];
-                    s_receive_check_sum += data[i];
-                    s_parse_state = RECEIVE_LEN_H_STATE;
-                }
-                break;
-
-                case RECEIVE_LEN_H_STATE:
-                {
-                    s_receive_frame.data_len |= (data[i] << 8);
-                    s_receive_check_sum += data[i];
-                    if(s_receive_frame.data_len == 0)
-                    {
-                        s_parse_state = RECEIVE_CHECK_SUM_L_STATE;
-                    }
-                    else if(s_receive_frame.data_len >= RECEIVE_MAX_LEN)
-                    {
-                        s_parse_state = CHECK_FRAME_L_STATE;
-                    }
-                    else
-                    {
-                        s_receive_data_count = 0;
-                        s_parse_state = RECEIVE_DATA_STATE;
-                    }
-                }
-                break;
+            free_idx = idx;
+            break;
+        }
+    }
 
-                case RECEIVE_DATA_STATE:
-                {
-                    s_receive_frame.data[s_receive_data_count] = data[i];
-                    if(++s_receive_data_count == s_receive_frame.data_len)
-                    {
-                        s_parse_state = RECEIVE_CHECK_SUM_L_STATE;
-                    }
-                }
-                break;
+    if (free_idx < 0)
+    {
+        return -1;
+    }
 
-                case RECEIVE_CHECK_SUM_L_STATE:
-                {
-                    s_receive_frame.check_sum = data[i];
-                    s_parse_state = RECEIVE_CHECK_SUM_H_STATE;
-                }
-                break;
+    uint8_t *p_data = &s_chunk_buf[free_idx * s_chunk_size];
 
-                case RECEIVE_CHECK_SUM_H_STATE:
-                {
-                    s_receive_frame.check_sum |= (data[i] << 8);
-                    s_parse_state = CHECK_FRAME_L_STATE;
-                    dfu_m_cmd_check();
-                }
-                break;
+    s_chunk_next               = (free_idx + 1) % s_chunk_slot_num;
+    s_chunk[free_idx].addr      = addr;
+    s_chunk[free_idx].len       = len;
+    s_chunk[free_idx].ref_cnt   = 1;
+    s_chunk[free_idx].check_sum = 0;
 
-                default:{s_parse_state=CHECK_FRAME_L_STATE;}break;
-            }
-        }
+    dfu_m_get_img_data(addr, p_data, len);
+    for (uint16_t i = 0; i < len; i++)
+    {
+        s_chunk[free_idx].check_sum += p_data[i];
     }
+
+    return free_idx;
 }
 
-void dfu_m_init(dfu_m_func_cfg_t *dfu_m_func_cfg, uint16_t once_send_size)
+static void dfu_m_fast_chunk_release(dfu_m_window_t *p_win, uint32_t end_seq)
 {
-    if(once_send_size != 0)
+    while (p_win->release_seq < end_seq)
     {
-      s_once_size = once_send_size;
+        s_chunk[p_win->slot[p_win->release_seq % p_win->window_num]].ref_cnt--;
+        p_win->release_seq++;
     }
+}
 
-    if(dfu_m_func_cfg != NULL)
+static void dfu_m_fast_program_stop(dfu_m_session_t *p_s)
+{
+    dfu_m_window_t *p_win = &p_s->fast_window;
+
+    if (p_win->active)
     {
-        s_p_func_cfg = dfu_m_func_cfg;
+        p_win->active = false;
+        dfu_m_fast_chunk_release(p_win, p_win->read_seq);
     }
 }
 
-
-void dfu_m_program_start(bool security, bool run_fw)
+static void dfu_m_fast_program_start(dfu_m_session_t *p_s)
 {
-    uint16_t img_len = sizeof(dfu_img_info_t);
-    uint32_t fw_sign_flag_addr = 0;
-    uint8_t fw_sign_flag[4] = {0};
-
-    s_run_fw_flag = run_fw;
-    s_page_start_addr = 0;
-    s_all_check_sum = 0;
-    s_file_size = 0;
-    program_size = 0;
-    s_receive_frame.data[0] = 0;
+    dfu_m_window_t *p_win = &p_s->fast_window;
+    bool            busy  = false;
 
-    dfu_m_get_img_info(&s_now_img_info);
-
-    if ((s_now_img_info.boot_info.load_addr < s_bootloader_boot_info.load_addr) || ((s_now_img_info.boot_info.load_addr >= s_bootloader_boot_info.load_addr) && \
-        (s_now_img_info.boot_info.load_addr <=  s_bootloader_boot_info.load_addr + s_bootloader_boot_info.bin_size + 48 + 856)) || \
-         (s_now_img_info.boot_info.load_addr >= s_dfu_save_addr && s_now_img_info.boot_info.load_addr <= s_dfu_save_addr + s_now_img_info.boot_info.bin_size + 48 + 856))
+    for (uint8_t i = 0; i < DFU_M_SESSION_MAX; i++)
     {
-        dfu_m_event_handler(IMG_INFO_LOAD_ADDR_ERROR, 0);
-        return;
+        busy |= s_session[i].fast_window.active;
     }
 
-    if((s_now_img_info.pattern != PATTERN_VALUE) || \
-       (s_now_img_info.boot_info.load_addr % FLASH_OP_PAGE_SIZE != 0))
+    // Chunk size is shared, it changes only when no session sends.
+    if (!busy)
     {
-        dfu_m_event_handler(IMG_INFO_CHECK_FAIL, 0);
+        s_chunk_size     = s_once_size > DFU_M_FAST_WINDOW_BUF_SIZE ? DFU_M_FAST_WINDOW_BUF_SIZE : s_once_size;
+        s_chunk_slot_num = DFU_M_FAST_WINDOW_BUF_SIZE / s_chunk_size;
+        s_chunk_slot_num = s_chunk_slot_num > DFU_M_CHUNK_SLOT_MAX ? DFU_M_CHUNK_SLOT_MAX : s_chunk_slot_num;
+        s_chunk_next     = 0;
+        memset(s_chunk, 0, sizeof(s_chunk));
     }
 
-    s_page_start_addr = (s_now_img_info.boot_info.load_addr & 0xfffff000);
+    p_win->window_num  = s_chunk_slot_num > DFU_M_FAST_WINDOW_NUM ? DFU_M_FAST_WINDOW_NUM : s_chunk_slot_num;
+    p_win->img_addr    = p_s->page_start_addr;
+    p_win->base        = p_s->program_size;
+    p_win->chunk_num   = (p_s->file_size - p_s->program_size + s_chunk_size - 1) / s_chunk_size;
+    p_win->read_seq    = 0;
+    p_win->release_seq = 0;
+    p_win->sent_seq    = 0;
+    p_win->submit_cnt  = 0;
+    p_win->report_seq  = 0;
+    p_win->retry       = 0;
+    p_win->cplt_cnt    = 0;
+    p_win->acked_seq   = 0;
+    p_win->fail        = false;
+    p_win->active      = true;
+}
 
-    s_now_img_info.boot_info.load_addr = s_dfu_save_addr;
+static bool dfu_m_fast_program_update(dfu_m_session_t *p_s)
+{
+    dfu_m_window_t *p_win = &p_s->fast_window;
+    uint32_t        acked_seq;
+    uint32_t        offset;
 
-    if(security)//security mode
+    if (!p_win->active)
     {
-        s_file_size = (s_now_img_info.boot_info.bin_size + 48 + 856);
+        return false;
     }
-    else
-    {
-        fw_sign_flag_addr = s_page_start_addr + s_now_img_info.boot_info.bin_size + 48 + FW_SIGN_FLAG_OFFSET;
-        dfu_m_get_img_data(fw_sign_flag_addr, fw_sign_flag, sizeof(fw_sign_flag));
 
-        if (fw_sign_flag[0] == 0x53 && fw_sign_flag[1] == 0x49 && fw_sign_flag[2] == 0x47 && fw_sign_flag[3] == 0x4E)
+    // Go back to the failed chunk once the completions of the chunks sent behind it are all in.
+    if (p_win->fail)
+    {
+        if (p_win->cplt_cnt != p_win->submit_cnt)
         {
-            s_file_size = (s_now_img_info.boot_info.bin_size + 48 + 856);
-            s_receive_frame.data[0] |= SIGN_FW_TYPE;
+            return false;
         }
-        else
+
+        if (++p_win->retry > DFU_M_FAST_RETRY_MAX)
         {
-            s_file_size = (s_now_img_info.boot_info.bin_size + 48);
-            s_receive_frame.data[0] |= NORMAL_FW_TYPE;
+            dfu_m_fast_program_stop(p_s);
+            dfu_m_event_handler(p_s, FAST_DFU_FLASH_FAIL, 0);
+            return false;
         }
+
+        p_win->sent_seq = p_win->acked_seq;
+        p_win->fail     = false;
     }
 
-    s_receive_frame.data[0] |= fast_dfu_mode;
+    acked_seq = p_win->acked_seq;
 
-    memcpy(&s_receive_frame.data[1], &s_now_img_info, img_len);
+    if (acked_seq != p_win->report_seq)
+    {
+        dfu_m_fast_chunk_release(p_win, acked_seq);
+        p_win->retry      = 0;
+        p_win->report_seq = acked_seq;
+        offset            = p_win->base + acked_seq * s_chunk_size;
+        p_s->program_size = offset > p_s->file_size ? p_s->file_size : offset;
+        dfu_m_event_handler(p_s, FAST_DFU_PRO_FLASH_SUCCESS, (p_s->program_size * 100) / p_s->file_size);
+    }
 
-    dfu_m_send_frame(s_receive_frame.data, img_len+1, PROGRAM_START);
-}
+    if (acked_seq == p_win->chunk_num)
+    {
+        p_win->active = false;
+        return false;
+    }
 
-void dfu_m_parse_state_reset(void)
-{
-    s_parse_state = CHECK_FRAME_L_STATE;
-    s_cmd_receive_flag   = false;
-    s_receive_data_count = 0;
-    s_receive_check_sum  = 0;
+    return true;
 }
 
-void dfu_m_get_info(void)
+static bool dfu_m_fast_program_send(dfu_m_session_t *p_s)
 {
-    dfu_m_send_frame(s_receive_frame.data, 0, GET_INFO);
-}
+    dfu_m_window_t *p_win = &p_s->fast_window;
+    uint32_t        offset;
+    uint16_t        len;
+    int             slot;
+
+    if (!p_win->active || p_win->fail ||
+        p_win->sent_seq >= p_win->chunk_num ||
+        p_win->sent_seq >= p_win->acked_seq + p_win->window_num)
+    {
+        return false;
+    }
 
-void dfu_m_dfu_mode_set(uint8_t dfu_mode)
-{
-    s_receive_frame.data[0] = dfu_mode;
-    dfu_m_send_frame(s_receive_frame.data, 1, DFU_MODE_SET);
-}
+    offset = p_win->sent_seq * s_chunk_size;
+    len    = (p_win->base + offset + s_chunk_size > p_s->file_size) ? (p_s->file_size - p_win->base - offset) : s_chunk_size;
 
-void dfu_m_dfu_fw_info_get(void)
-{
-    dfu_m_send_frame(s_receive_frame.data, 0, DFU_FW_INFO_GET);
-}
+    // Chunks are read straight into a shared slot once, a chunk sent again is still there.
+    if (p_win->sent_seq == p_win->read_seq)
+    {
+        slot = dfu_m_chunk_get(p_win->img_addr + offset, len);
+        if (slot < 0)
+        {
+            return false;
+        }
 
-void dfu_m_system_info_get(void)
-{
-    // read
-    uint32_t addr = FLASH_START_ADDR;
-    s_receive_frame.data[0] = 0x00;
-    // address
-    s_receive_frame.data[1] = addr;
-    s_receive_frame.data[2] = addr >> 8;
-    s_receive_frame.data[3] = addr >> 16;
-    s_receive_frame.data[4] = addr >> 24;
-    //length
-    s_receive_frame.data[5] = 0x30;
-    s_receive_frame.data[6] = 0;
+        p_win->slot[p_win->read_seq % p_win->window_num] = slot;
+        if (!p_s->fast_crc32)
+        {
+            p_s->all_check_sum += s_chunk[slot].check_sum;
+        }
+        p_win->read_seq++;
+    }
+
+    slot = p_win->slot[p_win->sent_seq % p_win->window_num];
+    p_win->sent_seq++;
+    p_win->submit_cnt++;
+    dfu_m_send_data(p_s, &s_chunk_buf[slot * s_chunk_size], len);
 
-    dfu_m_send_frame(s_receive_frame.data, 7, SYSTEM_INFO);
+    return true;
 }
 
-bool dfu_m_get_sec_flag(void)
+static void dfu_m_fast_program_schedule(void)
 {
-    return s_sec_flag;
+    uint8_t sending[DFU_M_SESSION_MAX];
+    bool    sent;
+    uint8_t i;
+    uint8_t idx;
+
+    for (i = 0; i < DFU_M_SESSION_MAX; i++)
+    {
+        sending[i] = dfu_m_fast_program_update(&s_session[i]);
+    }
+
+    // One chunk per session in turn, sessions at the same offset send a chunk read once.
+    do
+    {
+        sent = false;
+        for (i = 0; i < DFU_M_SESSION_MAX; i++)
+        {
+            idx = (s_schedule_first + i) % DFU_M_SESSION_MAX;
+            if (sending[idx] && dfu_m_fast_program_send(&s_session[idx]))
+            {
+                sent = true;
+            }
+        }
+    } while (sent);
+
+    s_schedule_first = (s_schedule_first + 1) % DFU_M_SESSION_MAX;
 }
 
-void  dfu_m_schedule(dfu_m_rev_cmd_cb_t rev_cmd_cb)
+static void dfu_m_session_schedule(dfu_m_session_t *p_s, dfu_m_rev_cmd_cb_t rev_cmd_cb)
 {
     uint8_t pre = 0;
     uint16_t erase_count = 0;
+    uint8_t *p_data = p_s->receive_frame.data;
 
-    if(s_cmd_receive_flag)
+    if(p_s->cmd_receive_flag)
     {
         if (rev_cmd_cb)
         {
             rev_cmd_cb();
         }
 
-        switch (s_receive_frame.cmd_type)
+        switch (p_s->receive_frame.cmd_type)
         {
             case PROGRAM_START:
-                if(s_receive_frame.data[0] == ACK_SUCCESS)
+                if(p_data[0] == ACK_SUCCESS)
                 {
                     if (FAST_DFU_MODE_DISABLE == fast_dfu_mode)
                     {
-                        dfu_m_program_flash(ONCE_SEND_LEN);
-                        dfu_m_event_handler(PRO_START_SUCCESS, 0);
+                        dfu_m_program_flash(p_s, ONCE_SEND_LEN);
+                        dfu_m_event_handler(p_s, PRO_START_SUCCESS, 0);
                     }
                     else if (FAST_DFU_MODE_ENABLE == fast_dfu_mode)
                     {
-                        switch (s_receive_frame.data[1])
+                        switch (p_data[1])
                         {
                             case DFU_ERASE_START_SUCCESS:
-                                s_erase_all_count = 0;
-                                s_erase_all_count |= (s_receive_frame.data[2] & 0xff);
-                                s_erase_all_count |= ((s_receive_frame.data[3] << 8) & 0xff00);
-                                dfu_m_event_handler(ERASE_START_SUCCESS, 0);
+                                p_s->erase_all_count = 0;
+                                p_s->erase_all_count |= (p_data[2] & 0xff);
+                                p_s->erase_all_count |= ((p_data[3] << 8) & 0xff00);
+                                if (p_s->fast_crc32 && p_s->receive_frame.data_len >= 8)
+                                {
+                                    // The peer kept the data before the resume offset, send the rest only.
+                                    uint32_t resume_offset = 0;
+                                    resume_offset |= (p_data[4] & 0xff);
+                                    resume_offset |= ((p_data[5] << 8) & 0xff00);
+                                    resume_offset |= ((p_data[6] << 16) & 0xff0000);
+                                    resume_offset |= ((p_data[7] << 24) & 0xff000000);
+                                    if (resume_offset < p_s->file_size)
+                                    {
+                                        p_s->program_size     = resume_offset;
+                                        p_s->page_start_addr += resume_offset;
+                                    }
+                                }
+                                dfu_m_event_handler(p_s, ERASE_START_SUCCESS, 0);
                             break;
 
                             case DFU_ERASEING_SUCCESS:
-                                erase_count |= (s_receive_frame.data[2] & 0xff);
-                                erase_count |= ((s_receive_frame.data[3] << 8) & 0xff00);
-                                pre = (erase_count * 100) / s_erase_all_count;
-                                dfu_m_event_handler(ERASEING_SUCCESS, pre);
+                                erase_count |= (p_data[2] & 0xff);
+                                erase_count |= ((p_data[3] << 8) & 0xff00);
+                                pre = (erase_count * 100) / p_s->erase_all_count;
+                                dfu_m_event_handler(p_s, ERASEING_SUCCESS, pre);
                             break;
 
                             case DFU_ERASE_END_SUCCESS:
-                                dfu_m_event_handler(ERASE_END_SUCCESS, 0);
-                                dfu_m_fast_program_flash();
+                                dfu_m_event_handler(p_s, ERASE_END_SUCCESS, 0);
+                                dfu_m_fast_program_start(p_s);
                             break;
 
                             case DFU_ERASE_REGION_NOT_ALIGNED:
-                                dfu_m_event_handler(ERASE_REGION_NOT_ALIGNED, 0);
+                                dfu_m_event_handler(p_s, ERASE_REGION_NOT_ALIGNED, 0);
                             break;
 
                             case DFU_ERASE_REGIONS_OVERLAP:
-                                dfu_m_event_handler(ERASE_REGION_OVERLAP, 0);
+                                dfu_m_event_handler(p_s, ERASE_REGION_OVERLAP, 0);
                                 break;
 
                             case DFU_ERASEING_FAIL:
-                                dfu_m_event_handler(ERASE_FLASH_FAIL, 0);
+                                dfu_m_event_handler(p_s, ERASE_FLASH_FAIL, 0);
                                 break;
 
                             case DFU_ERASE_REGIONS_NOT_EXIS:
-                                dfu_m_event_handler(ERASE_REGION_NOT_EXIST, 0);
+                                dfu_m_event_handler(p_s, ERASE_REGION_NOT_EXIST, 0);
                                 break;
 
                             default:
@@ -708,112 +748,116 @@ void  dfu_m_schedule(dfu_m_rev_cmd_cb_t rev_cmd_cb)
                 }
                 else
                 {
-                    dfu_m_event_handler(PRO_START_ERROR, 0);
+                    dfu_m_event_handler(p_s, PRO_START_ERROR, 0);
                 }
                 break;
 
             case PROGRAME_FLASH:
-                if(s_receive_frame.data[0] == ACK_SUCCESS)
+                if(p_data[0] == ACK_SUCCESS)
                 {
-                    pre = (program_size * 100) / s_file_size;
-                    dfu_m_event_handler(PRO_FLASH_SUCCESS, pre);
+                    pre = (p_s->program_size * 100) / p_s->file_size;
+                    dfu_m_event_handler(p_s, PRO_FLASH_SUCCESS, pre);
                     //pro success, precent
-                    if(program_size == s_file_size)
+                    if(p_s->program_size == p_s->file_size)
                     {
-                        s_receive_frame.data[0] = s_run_fw_flag;
-                        s_receive_frame.data[1] = s_all_check_sum;
-                        s_receive_frame.data[2] = s_all_check_sum>>8;
-                        s_receive_frame.data[3] = s_all_check_sum>>16;
-                        s_receive_frame.data[4] = s_all_check_sum>>24;
-                        dfu_m_send_frame(s_receive_frame.data, 5, PROGRAME_END);//progem end
+                        p_data[0] = p_s->run_fw_flag;
+                        p_data[1] = p_s->all_check_sum;
+                        p_data[2] = p_s->all_check_sum>>8;
+                        p_data[3] = p_s->all_check_sum>>16;
+                        p_data[4] = p_s->all_check_sum>>24;
+                        dfu_m_send_frame(p_s, p_data, 5, PROGRAME_END);//progem end
                     }
-                    else if(program_size + ONCE_SEND_LEN > s_file_size)
+                    else if(p_s->program_size + ONCE_SEND_LEN > p_s->file_size)
                     {
-                        dfu_m_program_flash(s_file_size - program_size);
+                        dfu_m_program_flash(p_s, p_s->file_size - p_s->program_size);
                     }
                     else
                     {
-                        dfu_m_program_flash(ONCE_SEND_LEN);
+                        dfu_m_program_flash(p_s, ONCE_SEND_LEN);
                     }
                 }
                 else
                 {
-                    dfu_m_event_handler(PRO_FLASH_FAIL, pre);
+                    dfu_m_event_handler(p_s, PRO_FLASH_FAIL, pre);
                 }
                 break;
 
             case PROGRAME_END:
-                if(s_receive_frame.data[0] == ACK_SUCCESS)
+                if(p_data[0] == ACK_SUCCESS)
                 {
                     if (fast_dfu_mode == FAST_DFU_MODE_ENABLE)
                     {
                         uint32_t check_sum = 0;
-                        check_sum |= (s_receive_frame.data[1] & 0xff);
-                        check_sum |= ((s_receive_frame.data[2] << 8) & 0xff00);
-                        check_sum |= ((s_receive_frame.data[3] << 16) & 0xff0000);
-                        check_sum |= ((s_receive_frame.data[4] << 24) & 0xff000000);
+                        check_sum |= (p_data[1] & 0xff);
+                        check_sum |= ((p_data[2] << 8) & 0xff00);
+                        check_sum |= ((p_data[3] << 16) & 0xff0000);
+                        check_sum |= ((p_data[4] << 24) & 0xff000000);
 
-                        if (check_sum == s_all_check_sum)
+                        if (check_sum == p_s->all_check_sum)
                         {
-                            dfu_m_event_handler(PRO_END_SUCCESS, 0);
+                            dfu_m_event_handler(p_s, PRO_END_SUCCESS, 0);
                         }
                         else
                         {
-                            dfu_m_event_handler(PRO_END_FAIL, 0);
+                            dfu_m_event_handler(p_s, PRO_END_FAIL, 0);
                         }
                     }
                     else if (fast_dfu_mode == FAST_DFU_MODE_DISABLE)
                     {
-                        dfu_m_event_handler(PRO_END_SUCCESS, 0);
+                        dfu_m_event_handler(p_s, PRO_END_SUCCESS, 0);
                     }
                 }
                 else
                 {
-                    dfu_m_event_handler(PRO_END_FAIL, 0);
+                    dfu_m_event_handler(p_s, PRO_END_FAIL, 0);
                 }
                 break;
 
             case GET_INFO:
-                s_dfu_save_addr = 0;
-                if(s_receive_frame.data[0] == ACK_SUCCESS)
+                p_s->dfu_save_addr = 0;
+                if(p_data[0] == ACK_SUCCESS)
                 {
                     // dfu version
-                    if (s_receive_frame.data[17] == DFU_VERSION)
+                    if (p_data[17] == DFU_VERSION)
                     {
-                        s_version_flag = 1; // new version
+                        p_s->version_flag = 1; // new version
                     }
                     else
                     {
-                        s_version_flag = 0; // old version
+                        p_s->version_flag = 0; // old version
                     }
-                    dfu_m_system_info_get();
+                    // Feature flags are valid only with their check byte, older peers may not send them at all.
+                    p_s->peer_crc32 = p_s->version_flag && (p_s->receive_frame.data_len >= 20) &&
+                                      (p_data[19] == (uint8_t)~p_data[18]) &&
+                                      (p_data[18] & DFU_FEATURE_CRC32);
+                    dfu_m_session_system_info_get(SESSION_IDX(p_s));
                 }
                 else
                 {
-                    dfu_m_event_handler(GET_INFO_FAIL, 0);
+                    dfu_m_event_handler(p_s, GET_INFO_FAIL, 0);
                 }
                 break;
 
             case DFU_FW_INFO_GET:
-                if (s_receive_frame.data[0] == ACK_SUCCESS)
+                if (p_data[0] == ACK_SUCCESS)
                 {
-                    s_dfu_save_addr = 0;
-                    s_dfu_save_addr |= (s_receive_frame.data[1] & 0xff);
-                    s_dfu_save_addr |= ((s_receive_frame.data[2] << 8) & 0xff00);
-                    s_dfu_save_addr |= ((s_receive_frame.data[3] << 16) & 0xff0000);
-                    s_dfu_save_addr |= ((s_receive_frame.data[4] << 24) & 0xff000000);
+                    p_s->dfu_save_addr = 0;
+                    p_s->dfu_save_addr |= (p_data[1] & 0xff);
+                    p_s->dfu_save_addr |= ((p_data[2] << 8) & 0xff00);
+                    p_s->dfu_save_addr |= ((p_data[3] << 16) & 0xff0000);
+                    p_s->dfu_save_addr |= ((p_data[4] << 24) & 0xff000000);
 
-                    memcpy(&s_app_info, &s_receive_frame.data[6], sizeof(dfu_img_info_t));
+                    memcpy(&p_s->app_info, &p_data[6], sizeof(dfu_img_info_t));
 
-                    if (((s_dfu_save_addr >= s_app_info.boot_info.load_addr) && \
-                        (s_dfu_save_addr <= s_app_info.boot_info.load_addr + s_app_info.boot_info.bin_size + 48 + 856)) || \
-                         ((s_dfu_save_addr >= s_bootloader_boot_info.load_addr) && (s_dfu_save_addr <= s_bootloader_boot_info.load_addr + s_bootloader_boot_info.bin_size + 48 + 856))) 
+                    if (((p_s->dfu_save_addr >= p_s->app_info.boot_info.load_addr) && \
+                        (p_s->dfu_save_addr <= p_s->app_info.boot_info.load_addr + p_s->app_info.boot_info.bin_size + 48 + 856)) || \
+                         ((p_s->dfu_save_addr >= p_s->bootloader_boot_info.load_addr) && (p_s->dfu_save_addr <= p_s->bootloader_boot_info.load_addr + p_s->bootloader_boot_info.bin_size + 48 + 856))) 
                     {
-                        dfu_m_event_handler(DFU_FW_SAVE_ADDR_CONFLICT, 0);
+                        dfu_m_event_handler(p_s, DFU_FW_SAVE_ADDR_CONFLICT, 0);
                     }
                     else
                     {
-                        dfu_m_dfu_mode_set(0x01);
+                        dfu_m_session_dfu_mode_set(SESSION_IDX(p_s), 0x01);
                     }
                 }
                 else
@@ -823,40 +867,43 @@ void  dfu_m_schedule(dfu_m_rev_cmd_cb_t rev_cmd_cb)
                 break;
 
             case SYSTEM_INFO:
-                if(s_receive_frame.data[0] == ACK_SUCCESS)
+                if(p_data[0] == ACK_SUCCESS)
                 {
                     // security mode
-                    if (s_receive_frame.data[1])
+                    if (p_data[1])
                     {
-                        s_sec_flag = true;
+                        p_s->sec_flag = true;
                     }
                     else
                     {
-                        s_sec_flag = false;
+                        p_s->sec_flag = false;
                     }
 
-                    memcpy(&s_bootloader_boot_info, &s_receive_frame.data[8], sizeof(boot_info_t));
+                    memcpy(&p_s->bootloader_boot_info, &p_data[8], sizeof(boot_info_t));
 
-                    if (s_version_flag)
+                    if (p_s->version_flag)
                     {
-                        dfu_m_dfu_fw_info_get();
+                        p_s->receive_frame.data_len = 0;
+                        dfu_m_send_frame(p_s, p_data, 0, DFU_FW_INFO_GET);
                     }
                 }
                 break;
 
             case FAST_DFU_FLASH_SUCCESS:
-                if (s_receive_frame.data[0] == ACK_SUCCESS)
+                // The peer got all data, completions of the last chunks may still come.
+                dfu_m_fast_program_stop(p_s);
+                if (p_data[0] == ACK_SUCCESS)
                 {
-                    s_receive_frame.data[0] = s_run_fw_flag;
-                    s_receive_frame.data[1] = s_all_check_sum;
-                    s_receive_frame.data[2] = s_all_check_sum>>8;
-                    s_receive_frame.data[3] = s_all_check_sum>>16;
-                    s_receive_frame.data[4] = s_all_check_sum>>24;
-                    dfu_m_send_frame(s_receive_frame.data, 5, PROGRAME_END);//progem end
+                    p_data[0] = p_s->run_fw_flag;
+                    p_data[1] = p_s->all_check_sum;
+                    p_data[2] = p_s->all_check_sum>>8;
+                    p_data[3] = p_s->all_check_sum>>16;
+                    p_data[4] = p_s->all_check_sum>>24;
+                    dfu_m_send_frame(p_s, p_data, 5, PROGRAME_END);//progem end
                 }
                 else
                 {
-                    dfu_m_event_handler(FAST_DFU_FLASH_FAIL, 0);
+                    dfu_m_event_handler(p_s, FAST_DFU_FLASH_FAIL, 0);
                 }
             break;
 
@@ -864,10 +911,394 @@ void  dfu_m_schedule(dfu_m_rev_cmd_cb_t rev_cmd_cb)
                 break;
         }
 
-        s_cmd_receive_flag = 0;
+        p_s->cmd_receive_flag = 0;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void dfu_m_session_send_data_cmpl_process(uint8_t session)
+{
+    dfu_m_session_t *p_s;
+    int remain;
+
+    if (session >= DFU_M_SESSION_MAX)
+    {
+        return;
+    }
+
+    p_s = &s_session[session];
+
+    if (p_s->fast_window.active)
+    {
+        p_s->fast_window.cplt_cnt++;
+        if (!p_s->fast_window.fail)
+        {
+            p_s->fast_window.acked_seq++;
+        }
+        return;
+    }
+
+    remain = p_s->all_send_len - p_s->sended_len;
+
+    if(remain >= s_once_size)
+    {
+        dfu_m_send_data(p_s, &p_s->send_data_buffer[p_s->sended_len], s_once_size);
+        p_s->sended_len += s_once_size;
+    }
+    else if(remain > 0)
+    {
+        dfu_m_send_data(p_s, &p_s->send_data_buffer[p_s->sended_len], remain);
+        p_s->sended_len += remain;
+    }
+}
+
+void dfu_m_send_data_cmpl_process(void)
+{
+    dfu_m_session_send_data_cmpl_process(0);
+}
+
+void dfu_m_session_send_data_fail_process(uint8_t session)
+{
+    if (session < DFU_M_SESSION_MAX && s_session[session].fast_window.active)
+    {
+        s_session[session].fast_window.cplt_cnt++;
+        s_session[session].fast_window.fail = true;
+    }
+}
+
+void dfu_m_send_data_fail_process(void)
+{
+    dfu_m_session_send_data_fail_process(0);
+}
+
+void dfu_m_session_cmd_prase(uint8_t session, uint8_t* data, uint16_t len)
+{
+    dfu_m_session_t *p_s;
+    uint16_t i = 0;
+
+    if (session >= DFU_M_SESSION_MAX)
+    {
+        return;
+    }
+
+    p_s = &s_session[session];
+
+    if(p_s->cmd_receive_flag == 0)
+    {
+        for(i=0; i<len; i++)
+        {
+            switch(p_s->parse_state)
+            {
+                case CHECK_FRAME_L_STATE:
+                {
+                    p_s->receive_check_sum = 0;
+                    if(data[i] == CMD_FRAME_HEADER_L)
+                    {
+                        p_s->parse_state = CHECK_FRAME_H_STATE;
+                    }
+                }
+                break;
+
+                case CHECK_FRAME_H_STATE:
+                {
+                    if(data[i] == CMD_FRAME_HEADER_H)
+                    {
+                        p_s->parse_state = RECEIVE_CMD_TYPE_L_STATE;
+                    } else if(data[i] == CMD_FRAME_HEADER_L) {
+                        p_s->parse_state = CHECK_FRAME_H_STATE;
+                    } else {
+                        p_s->parse_state = CHECK_FRAME_L_STATE;
+                    }
+                }
+                break;
+
+                case RECEIVE_CMD_TYPE_L_STATE:
+                {
+                    p_s->receive_frame.cmd_type = data[i];
+                    p_s->receive_check_sum += data[i];
+                    p_s->parse_state = RECEIVE_CMD_TYPE_H_STATE;
+                }
+                break;
+
+                case RECEIVE_CMD_TYPE_H_STATE:
+                {
+                    p_s->receive_frame.cmd_type |= (data[i] << 8);
+                    p_s->receive_check_sum += data[i];
+                    p_s->parse_state = RECEIVE_LEN_L_STATE;
+                }
+                break;
+
+                case RECEIVE_LEN_L_STATE:
+                {
+                    p_s->receive_frame.data_len = data[i];
+                    p_s->receive_check_sum += data[i];
+                    p_s->parse_state = RECEIVE_LEN_H_STATE;
+                }
+                break;
+
+                case RECEIVE_LEN_H_STATE:
+                {
+                    p_s->receive_frame.data_len |= (data[i] << 8);
+                    p_s->receive_check_sum += data[i];
+                    if(p_s->receive_frame.data_len == 0)
+                    {
+                        p_s->parse_state = RECEIVE_CHECK_SUM_L_STATE;
+                    }
+                    else if(p_s->receive_frame.data_len >= RECEIVE_MAX_LEN)
+                    {
+                        p_s->parse_state = CHECK_FRAME_L_STATE;
+                    }
+                    else
+                    {
+                        p_s->receive_data_count = 0;
+                        p_s->parse_state = RECEIVE_DATA_STATE;
+                    }
+                }
+                break;
+
+                case RECEIVE_DATA_STATE:
+                {
+                    p_s->receive_frame.data[p_s->receive_data_count] = data[i];
+                    if(++p_s->receive_data_count == p_s->receive_frame.data_len)
+                    {
+                        p_s->parse_state = RECEIVE_CHECK_SUM_L_STATE;
+                    }
+                }
+                break;
+
+                case RECEIVE_CHECK_SUM_L_STATE:
+                {
+                    p_s->receive_frame.check_sum = data[i];
+                    p_s->parse_state = RECEIVE_CHECK_SUM_H_STATE;
+                }
+                break;
+
+                case RECEIVE_CHECK_SUM_H_STATE:
+                {
+                    p_s->receive_frame.check_sum |= (data[i] << 8);
+                    p_s->parse_state = CHECK_FRAME_L_STATE;
+                    dfu_m_cmd_check(p_s);
+                }
+                break;
+
+                default:{p_s->parse_state=CHECK_FRAME_L_STATE;}break;
+            }
+        }
+    }
+}
+
+void dfu_m_cmd_prase(uint8_t* data,uint16_t len)
+{
+    dfu_m_session_cmd_prase(0, data, len);
+}
+
+void dfu_m_init(dfu_m_func_cfg_t *dfu_m_func_cfg, uint16_t once_send_size)
+{
+    if(once_send_size != 0)
+    {
+      s_once_size = once_send_size;
+    }
+
+    if(dfu_m_func_cfg != NULL)
+    {
+        s_p_func_cfg = dfu_m_func_cfg;
     }
 }
 
 
+void dfu_m_session_program_start(uint8_t session, bool security, bool run_fw)
+{
+    dfu_m_session_t *p_s;
+    uint8_t *p_data;
+    uint16_t img_len = sizeof(dfu_img_info_t);
+    uint32_t fw_sign_flag_addr = 0;
+    uint8_t fw_sign_flag[4] = {0};
+
+    if (session >= DFU_M_SESSION_MAX)
+    {
+        return;
+    }
+
+    p_s    = &s_session[session];
+    p_data = p_s->receive_frame.data;
+
+    dfu_m_fast_program_stop(p_s);
+    p_s->run_fw_flag = run_fw;
+    p_s->page_start_addr = 0;
+    p_s->all_check_sum = 0;
+    p_s->file_size = 0;
+    p_s->program_size = 0;
+    p_data[0] = 0;
+
+    dfu_m_get_img_info(&p_s->now_img_info);
+
+    if ((p_s->now_img_info.boot_info.load_addr < p_s->bootloader_boot_info.load_addr) || ((p_s->now_img_info.boot_info.load_addr >= p_s->bootloader_boot_info.load_addr) && \
+        (p_s->now_img_info.boot_info.load_addr <=  p_s->bootloader_boot_info.load_addr + p_s->bootloader_boot_info.bin_size + 48 + 856)) || \
+         (p_s->now_img_info.boot_info.load_addr >= p_s->dfu_save_addr && p_s->now_img_info.boot_info.load_addr <= p_s->dfu_save_addr + p_s->now_img_info.boot_info.bin_size + 48 + 856))
+    {
+        dfu_m_event_handler(p_s, IMG_INFO_LOAD_ADDR_ERROR, 0);
+        return;
+    }
+
+    if((p_s->now_img_info.pattern != PATTERN_VALUE) || \
+       (p_s->now_img_info.boot_info.load_addr % FLASH_OP_PAGE_SIZE != 0))
+    {
+        dfu_m_event_handler(p_s, IMG_INFO_CHECK_FAIL, 0);
+    }
+
+    p_s->page_start_addr = (p_s->now_img_info.boot_info.load_addr & 0xfffff000);
+
+    p_s->now_img_info.boot_info.load_addr = p_s->dfu_save_addr;
 
+    if(security)//security mode
+    {
+        p_s->file_size = (p_s->now_img_info.boot_info.bin_size + 48 + 856);
+    }
+    else
+    {
+        fw_sign_flag_addr = p_s->page_start_addr + p_s->now_img_info.boot_info.bin_size + 48 + FW_SIGN_FLAG_OFFSET;
+        dfu_m_get_img_data(fw_sign_flag_addr, fw_sign_flag, sizeof(fw_sign_flag));
 
+        if (fw_sign_flag[0] == 0x53 && fw_sign_flag[1] == 0x49 && fw_sign_flag[2] == 0x47 && fw_sign_flag[3] == 0x4E)
+        {
+            p_s->file_size = (p_s->now_img_info.boot_info.bin_size + 48 + 856);
+            p_data[0] |= SIGN_FW_TYPE;
+        }
+        else
+        {
+            p_s->file_size = (p_s->now_img_info.boot_info.bin_size + 48);
+            p_data[0] |= NORMAL_FW_TYPE;
+        }
+    }
+
+    p_data[0] |= fast_dfu_mode;
+
+    // The image CRC-32 is known before sending, the peer also uses it to match a checkpoint to resume from.
+    p_s->fast_crc32 = (FAST_DFU_MODE_ENABLE == fast_dfu_mode) && p_s->peer_crc32;
+    if (p_s->fast_crc32)
+    {
+        p_s->all_check_sum = dfu_m_img_crc32_calc(p_s->page_start_addr, p_s->file_size);
+        p_data[0] |= FAST_DFU_CRC32_BIT;
+    }
+
+    memcpy(&p_data[1], &p_s->now_img_info, img_len);
+
+    if (p_s->fast_crc32)
+    {
+        p_data[img_len + 1] = p_s->all_check_sum;
+        p_data[img_len + 2] = p_s->all_check_sum >> 8;
+        p_data[img_len + 3] = p_s->all_check_sum >> 16;
+        p_data[img_len + 4] = p_s->all_check_sum >> 24;
+        img_len += 4;
+    }
+
+    dfu_m_send_frame(p_s, p_data, img_len+1, PROGRAM_START);
+}
+
+void dfu_m_program_start(bool security, bool run_fw)
+{
+    dfu_m_session_program_start(0, security, run_fw);
+}
+
+void dfu_m_session_parse_state_reset(uint8_t session)
+{
+    if (session >= DFU_M_SESSION_MAX)
+    {
+        return;
+    }
+
+    s_session[session].parse_state = CHECK_FRAME_L_STATE;
+    s_session[session].cmd_receive_flag   = false;
+    s_session[session].receive_data_count = 0;
+    s_session[session].receive_check_sum  = 0;
+}
+
+void dfu_m_parse_state_reset(void)
+{
+    dfu_m_session_parse_state_reset(0);
+}
+
+void dfu_m_session_get_info(uint8_t session)
+{
+    if (session < DFU_M_SESSION_MAX)
+    {
+        dfu_m_send_frame(&s_session[session], s_session[session].receive_frame.data, 0, GET_INFO);
+    }
+}
+
+void dfu_m_get_info(void)
+{
+    dfu_m_session_get_info(0);
+}
+
+void dfu_m_session_dfu_mode_set(uint8_t session, uint8_t dfu_mode)
+{
+    if (session < DFU_M_SESSION_MAX)
+    {
+        s_session[session].receive_frame.data[0] = dfu_mode;
+        dfu_m_send_frame(&s_session[session], s_session[session].receive_frame.data, 1, DFU_MODE_SET);
+    }
+}
+
+void dfu_m_dfu_mode_set(uint8_t dfu_mode)
+{
+    dfu_m_session_dfu_mode_set(0, dfu_mode);
+}
+
+void dfu_m_dfu_fw_info_get(void)
+{
+    dfu_m_send_frame(&s_session[0], s_session[0].receive_frame.data, 0, DFU_FW_INFO_GET);
+}
+
+void dfu_m_session_system_info_get(uint8_t session)
+{
+    uint8_t *p_data;
+    // read
+    uint32_t addr = FLASH_START_ADDR;
+
+    if (session >= DFU_M_SESSION_MAX)
+    {
+        return;
+    }
+
+    p_data = s_session[session].receive_frame.data;
+    p_data[0] = 0x00;
+    // address
+    p_data[1] = addr;
+    p_data[2] = addr >> 8;
+    p_data[3] = addr >> 16;
+    p_data[4] = addr >> 24;
+    //length
+    p_data[5] = 0x30;
+    p_data[6] = 0;
+
+    dfu_m_send_frame(&s_session[session], p_data, 7, SYSTEM_INFO);
+}
+
+void dfu_m_system_info_get(void)
+{
+    dfu_m_session_system_info_get(0);
+}
+
+bool dfu_m_session_get_sec_flag(uint8_t session)
+{
+    return (session < DFU_M_SESSION_MAX) ? s_session[session].sec_flag : false;
+}
+
+bool dfu_m_get_sec_flag(void)
+{
+    return dfu_m_session_get_sec_flag(0);
+}
+
+void  dfu_m_schedule(dfu_m_rev_cmd_cb_t rev_cmd_cb)
+{
+    for (uint8_t i = 0; i < DFU_M_SESSION_MAX; i++)
+    {
+        dfu_m_session_schedule(&s_session[i], rev_cmd_cb);
+    }
+
+    dfu_m_fast_program_schedule();
+}
@@ -52,6 +52,11 @@
 #define FAST_DFU_MODE_ENABLE                 0x02                 /**< Fast DFU Mode Enable. */
 #define FAST_DFU_MODE_DISABLE                0x00                 /**< Fast DFU Mode Disable. */
 
+#ifndef DFU_M_SESSION_MAX
+#define DFU_M_SESSION_MAX                    1                    /**< Peers updated at the same time, one session each. */
+#endif
+/** @} */
+
 /**
  * @defgroup DFU_MASTER_ENUM Enumerations
  * @{
@@ -122,6 +127,8 @@ typedef struct
     void (*dfu_m_send_data)(uint8_t *data, uint16_t len);                                   /**< This function is used to send data to peer device. */
     uint32_t (*dfu_m_fw_read)(const uint32_t addr, uint8_t *p_buf, const uint32_t size);    /**< This function is used to read firmware data. */
     void (*dfu_m_event_handler)(dfu_m_event_t event, uint8_t pre);                          /**< This function is used to send event to app. */
+    void (*dfu_m_session_send_data)(uint8_t session, uint8_t *data, uint16_t len);          /**< This function is used to send data to the peer of a session, dfu_m_send_data is used if NULL. */
+    void (*dfu_m_session_event_handler)(uint8_t session, dfu_m_event_t event, uint8_t pre); /**< This function is used to send event of a session to app, dfu_m_event_handler is used if NULL. */
 }dfu_m_func_cfg_t;
 /** @} */
 
@@ -148,7 +155,8 @@ void dfu_m_parse_state_reset(void);
  *****************************************************************************************
  * @brief Function for checking DFU master cmd.
  *
- * @note This function should be called in loop.
+ * @note This function should be called in loop. It does not block, fast DFU data is sent
+ *       from here as chunks in the send window complete.
  *****************************************************************************************
  */
 void dfu_m_schedule(dfu_m_rev_cmd_cb_t rev_cmd_cb);
@@ -221,10 +229,45 @@ void dfu_m_cmd_prase(uint8_t* data,uint16_t len);
  *****************************************************************************************
  * @brief This function should be called when data sended completely.
  *
+ * @note In fast DFU it should be called once for every dfu_m_send_data call, in the same order.
+ *
  * @retval void
  *****************************************************************************************
  */
 void dfu_m_send_data_cmpl_process(void);
 
+/**
+ *****************************************************************************************
+ * @brief This function should be called when data failed to send in fast DFU.
+ *
+ * @details The failed chunk and the chunks sent behind it are sent again in order.
+ *
+ * @retval void
+ *****************************************************************************************
+ */
+void dfu_m_send_data_fail_process(void);
+
+/**
+ *****************************************************************************************
+ * @brief Session versions of the functions above, for DFU_M_SESSION_MAX peers updated at
+ *        the same time. The functions above work on session 0.
+ *
+ * @details Every session runs its own command exchange with its peer. In fast DFU the
+ *          sessions send their chunks in turn from @ref dfu_m_schedule, and a chunk is read
+ *          from the image once for all the sessions sending it at about the same time.
+ *
+ * @param[in]  session: Session index, less than DFU_M_SESSION_MAX.
+ *****************************************************************************************
+ */
+void dfu_m_session_parse_state_reset(uint8_t session);
+void dfu_m_session_program_start(uint8_t session, bool security, bool run_fw);
+void dfu_m_session_system_info_get(uint8_t session);
+void dfu_m_session_get_info(uint8_t session);
+void dfu_m_session_dfu_mode_set(uint8_t session, uint8_t dfu_mode);
+bool dfu_m_session_get_sec_flag(uint8_t session);
+void dfu_m_session_cmd_prase(uint8_t session, uint8_t* data, uint16_t len);
+void dfu_m_session_send_data_cmpl_process(uint8_t session);
+void dfu_m_session_send_data_fail_process(uint8_t session);
+
 /** @} */
 #endif
@@ -0,0 +1,407 @@
+/**
+ *****************************************************************************************
+ *
+ * @file dfu_master_test.c
+ *
+ * @brief Host test of dfu_master sessions, driving fake peers over fake transports.
+ *
+ * @details Every session talks to a fake peer doing the slave side of fast DFU: get info,
+ *          system info, firmware info, program start with erase, raw data chunks and
+ *          program end. The transport completes a few sends per session on every tick of
+ *          the main loop, and may fail a data send together with the sends queued behind
+ *          it. Every peer must end with the whole image, and with peers in lock step every
+ *          image chunk must be read once for all of them.
+ *
+ *****************************************************************************************
+ */
+#include "dfu_master.h"
+#include "utility.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_SESSION_NUM        DFU_M_SESSION_MAX
+#define TEST_ONCE_SIZE          244
+#define TEST_BOOT_ADDR          0x00202000
+#define TEST_IMG_ADDR           0x00220000
+#define TEST_IMG_BIN_SIZE       (60 * 1024 + 111)
+#define TEST_SAVE_ADDR          0x00260000
+#define TEST_TX_QUEUE_SIZE      16
+#define TEST_TX_MAX_LEN         256
+#define TEST_RX_MAX_LEN         4096
+#define TEST_TICK_MAX           100000
+
+#define CMD_GET_INFO            0x01
+#define CMD_PROGRAM_START       0x23
+#define CMD_PROGRAM_END         0x25
+#define CMD_SYSTEM_INFO         0x27
+#define CMD_DFU_MODE_SET        0x41
+#define CMD_DFU_FW_INFO_GET     0x42
+#define CMD_FAST_FLASH_SUCCESS  0xFF
+
+typedef struct
+{
+    uint8_t  data[TEST_TX_MAX_LEN];
+    uint16_t len;
+} test_tx_t;
+
+typedef struct
+{
+    // Test setup.
+    uint8_t   features;                             /* DFU_FEATURE_CRC32 or 0. */
+    uint8_t   speed;                                /* Sends completed per tick. */
+    uint32_t  fail_every;                           /* Fail every n-th data send, 0 for never. */
+
+    // Fake transport.
+    test_tx_t tx[TEST_TX_QUEUE_SIZE];
+    uint32_t  tx_head;
+    uint32_t  tx_tail;
+    uint32_t  data_sends;
+    uint32_t  data_fails;
+
+    // Fake peer.
+    uint8_t   rx[TEST_RX_MAX_LEN];
+    uint32_t  rx_len;
+    uint8_t   reply[4][64];
+    uint16_t  reply_len[4];
+    uint32_t  reply_head;
+    uint32_t  reply_tail;
+    bool      mode_set;
+    bool      started;
+    bool      data_mode;
+    bool      crc_mode;
+    uint32_t  file_size;
+    uint32_t  img_len;
+    uint8_t   img[TEST_IMG_BIN_SIZE + 48];
+
+    // Result.
+    bool      end_ok;
+    bool      failed;
+} test_peer_t;
+
+static test_peer_t s_peer[TEST_SESSION_NUM];
+static uint8_t     s_image[TEST_IMG_BIN_SIZE + 48 + 856];
+static uint32_t    s_img_read_bytes;
+extern uint8_t     fast_dfu_mode;
+
+static void test_get_img_info(dfu_img_info_t *p_info)
+{
+    memset(p_info, 0, sizeof(*p_info));
+    p_info->pattern             = 0x4744;
+    p_info->boot_info.bin_size  = TEST_IMG_BIN_SIZE;
+    p_info->boot_info.load_addr = TEST_IMG_ADDR;
+    p_info->boot_info.run_addr  = TEST_IMG_ADDR;
+}
+
+static void test_get_img_data(uint32_t addr, uint8_t *p_data, uint16_t len)
+{
+    memcpy(p_data, &s_image[addr - TEST_IMG_ADDR], len);
+    s_img_read_bytes += len;
+}
+
+static void test_send_data(uint8_t session, uint8_t *p_data, uint16_t len)
+{
+    test_peer_t *p_peer = &s_peer[session];
+    test_tx_t   *p_tx   = &p_peer->tx[p_peer->tx_tail % TEST_TX_QUEUE_SIZE];
+
+    if (len > TEST_TX_MAX_LEN || p_peer->tx_tail - p_peer->tx_head == TEST_TX_QUEUE_SIZE)
+    {
+        printf("session %u: send of %u bytes does not fit in transport\n", session, len);
+        p_peer->failed = true;
+        return;
+    }
+
+    memcpy(p_tx->data, p_data, len);
+    p_tx->len = len;
+    p_peer->tx_tail++;
+}
+
+static void test_event_handler(uint8_t session, dfu_m_event_t event, uint8_t pre)
+{
+    switch (event)
+    {
+        case PRO_END_SUCCESS:
+            s_peer[session].end_ok = true;
+            break;
+
+        case FAST_DFU_PRO_FLASH_SUCCESS:
+        case ERASE_START_SUCCESS:
+        case ERASEING_SUCCESS:
+        case ERASE_END_SUCCESS:
+            break;
+
+        default:
+            printf("session %u: event %d\n", session, event);
+            s_peer[session].failed = true;
+            break;
+    }
+}
+
+static void peer_reply(test_peer_t *p_peer, uint16_t type, const uint8_t *p_data, uint16_t len)
+{
+    uint8_t  *p_frame = p_peer->reply[p_peer->reply_tail % 4];
+    uint16_t  check_sum;
+
+    p_frame[0] = 0x44;
+    p_frame[1] = 0x47;
+    p_frame[2] = type;
+    p_frame[3] = type >> 8;
+    p_frame[4] = len;
+    p_frame[5] = len >> 8;
+    memcpy(&p_frame[6], p_data, len);
+    check_sum = 0;
+    for (uint16_t i = 2; i < 6 + len; i++)
+    {
+        check_sum += p_frame[i];
+    }
+    p_frame[6 + len] = check_sum;
+    p_frame[7 + len] = check_sum >> 8;
+
+    p_peer->reply_len[p_peer->reply_tail % 4] = len + 8;
+    p_peer->reply_tail++;
+}
+
+static void peer_cmd_handle(test_peer_t *p_peer, uint16_t type, const uint8_t *p_data, uint16_t len)
+{
+    uint8_t        rsp[64] = {0};
+    dfu_img_info_t info;
+    uint32_t       sum;
+
+    switch (type)
+    {
+        case CMD_GET_INFO:
+            rsp[0]  = 0x01;
+            rsp[17] = DFU_VERSION;
+            rsp[18] = p_peer->features;
+            rsp[19] = ~p_peer->features;
+            peer_reply(p_peer, type, rsp, 20);
+            break;
+
+        case CMD_SYSTEM_INFO:
+        {
+            boot_info_t boot = { .bin_size = 0x8000, .load_addr = TEST_BOOT_ADDR, .run_addr = TEST_BOOT_ADDR };
+
+            rsp[0] = 0x01;
+            memcpy(&rsp[8], &boot, sizeof(boot));
+            peer_reply(p_peer, type, rsp, 8 + 0x30);
+        } break;
+
+        case CMD_DFU_FW_INFO_GET:
+            rsp[0] = 0x01;
+            rsp[1] = (uint8_t)TEST_SAVE_ADDR;
+            rsp[2] = (uint8_t)(TEST_SAVE_ADDR >> 8);
+            rsp[3] = (uint8_t)(TEST_SAVE_ADDR >> 16);
+            rsp[4] = (uint8_t)(TEST_SAVE_ADDR >> 24);
+            test_get_img_info(&info);
+            memcpy(&rsp[6], &info, sizeof(info));
+            peer_reply(p_peer, type, rsp, 6 + sizeof(info));
+            break;
+
+        case CMD_DFU_MODE_SET:
+            p_peer->mode_set = true;
+            break;
+
+        case CMD_PROGRAM_START:
+            memcpy(&info, &p_data[1], sizeof(info));
+            p_peer->crc_mode  = (p_data[0] & 0x08) != 0;
+            p_peer->file_size = info.boot_info.bin_size + 48;
+            p_peer->img_len   = 0;
+            rsp[0] = 0x01;
+            rsp[1] = 0x01;      // erase start, 1 sector to keep it short, resume offset 0
+            rsp[2] = 0x01;
+            peer_reply(p_peer, type, rsp, p_peer->crc_mode ? 8 : 4);
+            rsp[1] = 0x03;      // erase end
+            peer_reply(p_peer, type, rsp, 2);
+            p_peer->data_mode = true;
+            break;
+
+        case CMD_PROGRAM_END:
+            sum = p_peer->crc_mode ? crc32_calc(0, p_peer->img, p_peer->img_len) : 0;
+            for (uint32_t i = 0; !p_peer->crc_mode && i < p_peer->img_len; i++)
+            {
+                sum += p_peer->img[i];
+            }
+            rsp[0] = 0x01;
+            rsp[1] = sum;
+            rsp[2] = sum >> 8;
+            rsp[3] = sum >> 16;
+            rsp[4] = sum >> 24;
+            peer_reply(p_peer, type, rsp, 5);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void peer_receive(test_peer_t *p_peer, const uint8_t *p_data, uint16_t len)
+{
+    uint16_t frame_len;
+
+    if (p_peer->data_mode)
+    {
+        if (p_peer->img_len + len > p_peer->file_size)
+        {
+            printf("peer got %u bytes more than the image\n", p_peer->img_len + len - p_peer->file_size);
+            p_peer->failed = true;
+            return;
+        }
+        memcpy(&p_peer->img[p_peer->img_len], p_data, len);
+        p_peer->img_len += len;
+        if (p_peer->img_len == p_peer->file_size)
+        {
+            uint8_t ack = 0x01;
+
+            p_peer->data_mode = false;
+            peer_reply(p_peer, CMD_FAST_FLASH_SUCCESS, &ack, 1);
+        }
+        return;
+    }
+
+    memcpy(&p_peer->rx[p_peer->rx_len], p_data, len);
+    p_peer->rx_len += len;
+
+    while (p_peer->rx_len >= 8)
+    {
+        frame_len = 8 + (p_peer->rx[4] | (p_peer->rx[5] << 8));
+        if (p_peer->rx_len < frame_len)
+        {
+            break;
+        }
+        peer_cmd_handle(p_peer, p_peer->rx[2] | (p_peer->rx[3] << 8), &p_peer->rx[6], frame_len - 8);
+        memmove(p_peer->rx, &p_peer->rx[frame_len], p_peer->rx_len - frame_len);
+        p_peer->rx_len -= frame_len;
+    }
+}
+
+static void transport_tick(uint8_t session)
+{
+    test_peer_t *p_peer = &s_peer[session];
+    test_tx_t   *p_tx;
+
+    for (uint8_t i = 0; i < p_peer->speed && p_peer->tx_head != p_peer->tx_tail; i++)
+    {
+        p_tx = &p_peer->tx[p_peer->tx_head % TEST_TX_QUEUE_SIZE];
+
+        if (p_peer->data_mode && p_peer->fail_every && 0 == (++p_peer->data_sends % p_peer->fail_every))
+        {
+            // The link drops this send and the ones queued behind it, in order.
+            while (p_peer->tx_head != p_peer->tx_tail)
+            {
+                p_peer->tx_head++;
+                p_peer->data_fails++;
+                dfu_m_session_send_data_fail_process(session);
+            }
+            return;
+        }
+
+        p_peer->tx_head++;
+        peer_receive(p_peer, p_tx->data, p_tx->len);
+        dfu_m_session_send_data_cmpl_process(session);
+    }
+}
+
+static bool test_run(const char *p_name, bool check_shared_read)
+{
+    uint32_t file_size = TEST_IMG_BIN_SIZE + 48;
+    uint32_t tick;
+    uint32_t data_fails = 0;
+    bool     all_done = false;
+    bool     ok       = true;
+
+    s_img_read_bytes = 0;
+    fast_dfu_mode    = FAST_DFU_MODE_ENABLE;
+    for (uint8_t s = 0; s < TEST_SESSION_NUM; s++)
+    {
+        dfu_m_session_parse_state_reset(s);
+        dfu_m_session_get_info(s);
+    }
+
+    for (tick = 0; tick < TEST_TICK_MAX && !all_done; tick++)
+    {
+        all_done = true;
+        for (uint8_t s = 0; s < TEST_SESSION_NUM; s++)
+        {
+            test_peer_t *p_peer = &s_peer[s];
+
+            transport_tick(s);
+            if (p_peer->reply_head != p_peer->reply_tail)
+            {
+                dfu_m_session_cmd_prase(s, p_peer->reply[p_peer->reply_head % 4], p_peer->reply_len[p_peer->reply_head % 4]);
+                p_peer->reply_head++;
+            }
+            if (p_peer->mode_set && !p_peer->started)
+            {
+                p_peer->started = true;
+                dfu_m_session_program_start(s, false, false);
+            }
+            all_done &= p_peer->end_ok || p_peer->failed;
+        }
+        dfu_m_schedule(NULL);
+    }
+
+    for (uint8_t s = 0; s < TEST_SESSION_NUM; s++)
+    {
+        test_peer_t *p_peer = &s_peer[s];
+
+        if (!p_peer->end_ok || p_peer->failed || p_peer->img_len != file_size || memcmp(p_peer->img, s_image, file_size))
+        {
+            printf("FAIL %s: session %u end %d failed %d, %u of %u bytes\n", p_name, s, p_peer->end_ok, p_peer->failed,
+                   p_peer->img_len, file_size);
+            ok = false;
+        }
+    }
+
+    // Chunks plus the sign flag read of every session.
+    if (check_shared_read && s_img_read_bytes > file_size + TEST_ONCE_SIZE * TEST_SESSION_NUM + 4 * TEST_SESSION_NUM)
+    {
+        printf("FAIL %s: %u image bytes read for %u sessions of %u bytes\n", p_name, s_img_read_bytes, TEST_SESSION_NUM, file_size);
+        ok = false;
+    }
+
+    for (uint8_t s = 0; s < TEST_SESSION_NUM; s++)
+    {
+        data_fails += s_peer[s].data_fails;
+    }
+    printf("%s: %u sessions in %u ticks, %u image bytes read, %u data sends failed, %s\n", p_name, TEST_SESSION_NUM, tick,
+           s_img_read_bytes, data_fails, ok ? "ok" : "FAILED");
+
+    return ok;
+}
+
+int main(void)
+{
+    dfu_m_func_cfg_t cfg = {
+        .dfu_m_get_img_info          = test_get_img_info,
+        .dfu_m_get_img_data          = test_get_img_data,
+        .dfu_m_session_send_data     = test_send_data,
+        .dfu_m_session_event_handler = test_event_handler,
+    };
+    bool ok = true;
+
+    for (uint32_t i = 0; i < sizeof(s_image); i++)
+    {
+        s_image[i] = (uint8_t)(i * 7 + (i >> 9));
+    }
+    dfu_m_init(&cfg, TEST_ONCE_SIZE);
+
+    // Peers in lock step share every chunk read.
+    memset(s_peer, 0, sizeof(s_peer));
+    for (uint8_t s = 0; s < TEST_SESSION_NUM; s++)
+    {
+        s_peer[s].speed = 2;
+    }
+    ok &= test_run("lock step", true);
+
+    // Peers at different speeds, with send fails, and a peer checking by CRC-32.
+    memset(s_peer, 0, sizeof(s_peer));
+    for (uint8_t s = 0; s < TEST_SESSION_NUM; s++)
+    {
+        s_peer[s].speed      = 1 + s;
+        s_peer[s].fail_every = (s & 1) ? 0 : 17 + s;
+    }
+    s_peer[TEST_SESSION_NUM - 1].features = 0x01;
+    ok &= test_run("mixed", false);
+
+    return ok ? 0 : 1;
+}
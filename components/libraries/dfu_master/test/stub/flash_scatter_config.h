@@ -0,0 +1,7 @@
+/* Host stand-in of flash_scatter_config.h, only what dfu_master needs. */
+#ifndef __FLASH_SCATTER_CONFIG_H__
+#define __FLASH_SCATTER_CONFIG_H__
+
+#define FLASH_START_ADDR          0x00200000
+
+#endif
@@ -0,0 +1,481 @@
+/**
+ *****************************************************************************************
+ *
+ * @file dfu_patch.c
+ *
+ * @brief DFU compressed image and delta patch Implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "dfu_patch.h"
+#include "lz_compress.h"
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define DFU_PATCH_IN_HEAD           0x00    /**< Receiving patch file head. */
+#define DFU_PATCH_IN_BLK_HEAD       0x01    /**< Receiving block head. */
+#define DFU_PATCH_IN_BLK_DATA       0x02    /**< Receiving block data. */
+#define DFU_PATCH_IN_ERROR          0xFF    /**< Patch aborted. */
+
+#define DFU_PATCH_REC_DIFF_LEN      0x00    /**< Decoding diff length. */
+#define DFU_PATCH_REC_EXTRA_LEN     0x01    /**< Decoding extra length. */
+#define DFU_PATCH_REC_SEEK          0x02    /**< Decoding source seek. */
+#define DFU_PATCH_REC_DIFF          0x03    /**< Applying diff bytes. */
+#define DFU_PATCH_REC_EXTRA         0x04    /**< Copying extra bytes. */
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static uint16_t dfu_patch_out_flush(dfu_patch_t *p_patch)
+{
+    if (0 == p_patch->out_len)
+    {
+        return SDK_SUCCESS;
+    }
+
+    if (!p_patch->op.target_write(p_patch->target_addr + p_patch->target_pos, p_patch->out_buf, p_patch->out_len))
+    {
+        return SDK_ERR_SDK_INTERNAL;
+    }
+
+    p_patch->target_pos += p_patch->out_len;
+    p_patch->out_len     = 0;
+
+    return SDK_SUCCESS;
+}
+
+static uint16_t dfu_patch_out_put(dfu_patch_t *p_patch, const uint8_t *p_data, uint32_t length, bool is_diff)
+{
+    uint32_t copy_len;
+    uint8_t *p_out;
+    uint16_t error;
+
+    if (p_patch->target_pos + p_patch->out_len + length > p_patch->head.target_size)
+    {
+        return SDK_ERR_INVALID_ADDRESS;
+    }
+
+    if (is_diff && p_patch->source_pos + length > p_patch->head.source_size)
+    {
+        return SDK_ERR_INVALID_ADDRESS;
+    }
+
+    while (length)
+    {
+        copy_len = DFU_PATCH_OUT_SIZE - p_patch->out_len;
+        copy_len = copy_len > length ? length : copy_len;
+        p_out    = p_patch->out_buf + p_patch->out_len;
+
+        if (is_diff)
+        {
+            // Source bytes are read in place and the diff is added on them.
+            if (copy_len != p_patch->op.source_read(p_patch->source_addr + p_patch->source_pos, p_out, copy_len))
+            {
+                return SDK_ERR_SDK_INTERNAL;
+            }
+
+            for (uint32_t i = 0; i < copy_len; i++)
+            {
+                p_out[i] += p_data[i];
+            }
+            p_patch->source_pos += copy_len;
+        }
+        else
+        {
+            memcpy(p_out, p_data, copy_len);
+        }
+
+        for (uint32_t i = 0; i < copy_len; i++)
+        {
+            p_patch->check_sum += p_out[i];
+        }
+
+        p_patch->out_len += copy_len;
+        p_data           += copy_len;
+        length           -= copy_len;
+
+        if (DFU_PATCH_OUT_SIZE == p_patch->out_len)
+        {
+            error = dfu_patch_out_flush(p_patch);
+            if (SDK_SUCCESS != error)
+            {
+                return error;
+            }
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+static uint16_t dfu_patch_rec_varint(dfu_patch_t *p_patch, uint8_t data, bool *p_done)
+{
+    if (p_patch->varint_shift > 28 || ((p_patch->varint_shift == 28) && (data & 0x70)))
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    p_patch->varint |= (uint32_t)(data & 0x7F) << p_patch->varint_shift;
+    p_patch->varint_shift += 7;
+    *p_done = !(data & 0x80);
+
+    return SDK_SUCCESS;
+}
+
+static uint16_t dfu_patch_rec_process(dfu_patch_t *p_patch, const uint8_t *p_data, uint32_t length)
+{
+    uint32_t handle_len;
+    uint32_t varint;
+    int32_t  seek;
+    bool     done;
+    uint16_t error;
+
+    if (DFU_PATCH_TYPE_FULL == p_patch->head.type)
+    {
+        return dfu_patch_out_put(p_patch, p_data, length, false);
+    }
+
+    while (length)
+    {
+        if (DFU_PATCH_REC_DIFF == p_patch->rec_state || DFU_PATCH_REC_EXTRA == p_patch->rec_state)
+        {
+            handle_len = p_patch->rec_left > length ? length : p_patch->rec_left;
+            error      = dfu_patch_out_put(p_patch, p_data, handle_len, DFU_PATCH_REC_DIFF == p_patch->rec_state);
+            if (SDK_SUCCESS != error)
+            {
+                return error;
+            }
+
+            p_data            += handle_len;
+            length            -= handle_len;
+            p_patch->rec_left -= handle_len;
+
+            if (0 == p_patch->rec_left)
+            {
+                if (DFU_PATCH_REC_DIFF == p_patch->rec_state && p_patch->rec_extra)
+                {
+                    p_patch->rec_left  = p_patch->rec_extra;
+                    p_patch->rec_state = DFU_PATCH_REC_EXTRA;
+                }
+                else
+                {
+                    p_patch->rec_state = DFU_PATCH_REC_DIFF_LEN;
+                }
+            }
+            continue;
+        }
+
+        error = dfu_patch_rec_varint(p_patch, *p_data++, &done);
+        length--;
+        if (SDK_SUCCESS != error)
+        {
+            return error;
+        }
+
+        if (!done)
+        {
+            continue;
+        }
+
+        varint                = p_patch->varint;
+        p_patch->varint       = 0;
+        p_patch->varint_shift = 0;
+
+        switch (p_patch->rec_state)
+        {
+            case DFU_PATCH_REC_DIFF_LEN:
+                p_patch->rec_left  = varint;
+                p_patch->rec_state = DFU_PATCH_REC_EXTRA_LEN;
+                break;
+
+            case DFU_PATCH_REC_EXTRA_LEN:
+                p_patch->rec_extra = varint;
+                p_patch->rec_state = DFU_PATCH_REC_SEEK;
+                break;
+
+            case DFU_PATCH_REC_SEEK:
+                // The seek moves the source position before the diff bytes of this record.
+                seek = (int32_t)(varint >> 1) ^ -(int32_t)(varint & 0x01);
+                if ((int64_t)p_patch->source_pos + seek < 0 ||
+                    (int64_t)p_patch->source_pos + seek + p_patch->rec_left > p_patch->head.source_size)
+                {
+                    return SDK_ERR_INVALID_ADDRESS;
+                }
+                p_patch->source_pos += seek;
+
+                if (p_patch->rec_left)
+                {
+                    p_patch->rec_state = DFU_PATCH_REC_DIFF;
+                }
+                else if (p_patch->rec_extra)
+                {
+                    p_patch->rec_left  = p_patch->rec_extra;
+                    p_patch->rec_state = DFU_PATCH_REC_EXTRA;
+                }
+                else
+                {
+                    p_patch->rec_state = DFU_PATCH_REC_DIFF_LEN;
+                }
+                break;
+
+            default:
+                return SDK_ERR_INVALID_PARAM;
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+static uint16_t dfu_patch_head_process(dfu_patch_t *p_patch)
+{
+    uint32_t check_sum = 0;
+    uint32_t read_len;
+
+    memcpy(&p_patch->head, p_patch->blk_buf, DFU_PATCH_HEAD_SIZE);
+
+    if (DFU_PATCH_MAGIC != p_patch->head.magic ||
+        DFU_PATCH_VERSION != p_patch->head.version ||
+        p_patch->head.blk_size > DFU_PATCH_BLK_SIZE ||
+        p_patch->head.target_size > p_patch->target_max)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    if (DFU_PATCH_TYPE_FULL == p_patch->head.type)
+    {
+        return SDK_SUCCESS;
+    }
+
+    if (DFU_PATCH_TYPE_DELTA != p_patch->head.type)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    // Target is written while source is still read, they must not overlap.
+    if (p_patch->target_addr < p_patch->source_addr + p_patch->head.source_size &&
+        p_patch->source_addr < p_patch->target_addr + p_patch->head.target_size)
+    {
+        return SDK_ERR_INVALID_ADDRESS;
+    }
+
+    // Refuse a patch made against another firmware, out_buf is free before the first block.
+    for (uint32_t offset = 0; offset < p_patch->head.source_size; offset += read_len)
+    {
+        read_len = p_patch->head.source_size - offset;
+        read_len = read_len > DFU_PATCH_OUT_SIZE ? DFU_PATCH_OUT_SIZE : read_len;
+
+        if (read_len != p_patch->op.source_read(p_patch->source_addr + offset, p_patch->out_buf, read_len))
+        {
+            return SDK_ERR_SDK_INTERNAL;
+        }
+
+        for (uint32_t i = 0; i < read_len; i++)
+        {
+            check_sum += p_patch->out_buf[i];
+        }
+    }
+
+    if (check_sum != p_patch->head.source_check_sum)
+    {
+        return SDK_ERR_DISALLOWED;
+    }
+
+    return SDK_SUCCESS;
+}
+
+static uint16_t dfu_patch_blk_process(dfu_patch_t *p_patch)
+{
+    uint16_t comp_len = p_patch->blk_buf[0] | (p_patch->blk_buf[1] << 8);
+    uint16_t raw_len  = p_patch->blk_buf[2] | (p_patch->blk_buf[3] << 8);
+    uint8_t *p_comp   = p_patch->blk_buf + DFU_PATCH_BLK_HEAD_SIZE;
+
+    // Blocks that do not shrink are stored raw.
+    if (comp_len == raw_len)
+    {
+        return dfu_patch_rec_process(p_patch, p_comp, raw_len);
+    }
+
+    if (raw_len != lz_decompress(p_comp, comp_len, p_patch->raw_buf, raw_len))
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    return dfu_patch_rec_process(p_patch, p_patch->raw_buf, raw_len);
+}
+
+static uint16_t dfu_patch_in_process(dfu_patch_t *p_patch)
+{
+    uint16_t comp_len;
+    uint16_t raw_len;
+    uint16_t error = SDK_SUCCESS;
+
+    switch (p_patch->in_state)
+    {
+        case DFU_PATCH_IN_HEAD:
+            error = dfu_patch_head_process(p_patch);
+            p_patch->in_state = DFU_PATCH_IN_BLK_HEAD;
+            p_patch->in_need  = DFU_PATCH_BLK_HEAD_SIZE;
+            break;
+
+        case DFU_PATCH_IN_BLK_HEAD:
+            comp_len = p_patch->blk_buf[0] | (p_patch->blk_buf[1] << 8);
+            raw_len  = p_patch->blk_buf[2] | (p_patch->blk_buf[3] << 8);
+
+            if (0 == comp_len || comp_len > raw_len || raw_len > p_patch->head.blk_size)
+            {
+                error = SDK_ERR_INVALID_PARAM;
+                break;
+            }
+            p_patch->in_state = DFU_PATCH_IN_BLK_DATA;
+            p_patch->in_need  = DFU_PATCH_BLK_HEAD_SIZE + comp_len;
+            return SDK_SUCCESS;
+
+        case DFU_PATCH_IN_BLK_DATA:
+            error = dfu_patch_blk_process(p_patch);
+            p_patch->in_state = DFU_PATCH_IN_BLK_HEAD;
+            p_patch->in_need  = DFU_PATCH_BLK_HEAD_SIZE;
+            break;
+
+        default:
+            error = SDK_ERR_DISALLOWED;
+            break;
+    }
+
+    p_patch->in_len = 0;
+
+    return error;
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+uint16_t dfu_patch_init(dfu_patch_t *p_patch, const dfu_patch_op_t *p_op, uint32_t source_addr, uint32_t target_addr, uint32_t target_max)
+{
+    if (NULL == p_patch || NULL == p_op || NULL == p_op->source_read || NULL == p_op->target_write)
+    {
+        return SDK_ERR_POINTER_NULL;
+    }
+
+    memset(p_patch, 0, offsetof(dfu_patch_t, blk_buf));
+
+    p_patch->op          = *p_op;
+    p_patch->source_addr = source_addr;
+    p_patch->target_addr = target_addr;
+    p_patch->target_max  = target_max;
+    p_patch->in_state    = DFU_PATCH_IN_HEAD;
+    p_patch->in_need     = DFU_PATCH_HEAD_SIZE;
+    p_patch->rec_state   = DFU_PATCH_REC_DIFF_LEN;
+
+    return SDK_SUCCESS;
+}
+
+uint16_t dfu_patch_write(dfu_patch_t *p_patch, const uint8_t *p_data, uint32_t length)
+{
+    uint32_t copy_len;
+    uint16_t error;
+
+    if (NULL == p_patch || NULL == p_data)
+    {
+        return SDK_ERR_POINTER_NULL;
+    }
+
+    while (length)
+    {
+        if (DFU_PATCH_IN_ERROR == p_patch->in_state)
+        {
+            return SDK_ERR_DISALLOWED;
+        }
+
+        copy_len = p_patch->in_need - p_patch->in_len;
+        copy_len = copy_len > length ? length : copy_len;
+
+        memcpy(p_patch->blk_buf + p_patch->in_len, p_data, copy_len);
+        p_patch->in_len += copy_len;
+        p_data          += copy_len;
+        length          -= copy_len;
+
+        if (p_patch->in_len == p_patch->in_need)
+        {
+            error = dfu_patch_in_process(p_patch);
+            if (SDK_SUCCESS != error)
+            {
+                p_patch->in_state = DFU_PATCH_IN_ERROR;
+                return error;
+            }
+        }
+    }
+
+    return SDK_SUCCESS;
+}
+
+uint16_t dfu_patch_finish(dfu_patch_t *p_patch)
+{
+    uint16_t error;
+
+    if (NULL == p_patch)
+    {
+        return SDK_ERR_POINTER_NULL;
+    }
+
+    if (DFU_PATCH_IN_BLK_HEAD != p_patch->in_state || p_patch->in_len ||
+        DFU_PATCH_REC_DIFF_LEN != p_patch->rec_state || p_patch->varint_shift)
+    {
+        return SDK_ERR_INVALID_DATA_LENGTH;
+    }
+
+    error = dfu_patch_out_flush(p_patch);
+    if (SDK_SUCCESS != error)
+    {
+        return error;
+    }
+
+    if (p_patch->target_pos != p_patch->head.target_size)
+    {
+        return SDK_ERR_INVALID_DATA_LENGTH;
+    }
+
+    if (p_patch->check_sum != p_patch->head.target_check_sum)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+
+    return SDK_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/**
+ *****************************************************************************************
+ *
+ * @file dfu_patch.h
+ *
+ * @brief Header file - DFU compressed image and delta patch APIs
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+
+#ifndef __DFU_PATCH_H__
+#define __DFU_PATCH_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "ble_error.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup DFU_PATCH_MAROC Defines
+ * @{
+ */
+#define DFU_PATCH_MAGIC             0x54504447  /**< Magic for patch file: "GDPT". */
+#define DFU_PATCH_VERSION           0x01        /**< Version of patch file format. */
+#define DFU_PATCH_TYPE_FULL         0x00        /**< Blocks carry the whole target image. */
+#define DFU_PATCH_TYPE_DELTA        0x01        /**< Blocks carry diff records against the source image. */
+#define DFU_PATCH_HEAD_SIZE         sizeof(dfu_patch_head_t)
+#define DFU_PATCH_BLK_HEAD_SIZE     4           /**< Length of compressed data(16 bits) + length of raw data(16 bits). */
+
+#ifndef DFU_PATCH_BLK_SIZE
+#define DFU_PATCH_BLK_SIZE          1024        /**< Maximum raw length of one block, must match the patch generator. */
+#endif
+
+#ifndef DFU_PATCH_OUT_SIZE
+#define DFU_PATCH_OUT_SIZE          1024        /**< Size of target write buffer. */
+#endif
+/** @} */
+
+/**
+ * @defgroup DFU_PATCH_STRUCT Structures
+ * @{
+ */
+/**@brief Patch file head, followed by blocks. Check sums are byte sums like the DFU image check sum. */
+typedef struct
+{
+    uint32_t magic;                 /**< Magic for patch file. */
+    uint8_t  version;               /**< Version of patch file format. */
+    uint8_t  type;                  /**< DFU_PATCH_TYPE_FULL or DFU_PATCH_TYPE_DELTA. */
+    uint16_t blk_size;              /**< Maximum raw length of one block. */
+    uint32_t source_size;           /**< Size of source image, 0 for full image. */
+    uint32_t source_check_sum;      /**< Check sum of source image. */
+    uint32_t target_size;           /**< Size of target image. */
+    uint32_t target_check_sum;      /**< Check sum of target image. */
+} dfu_patch_head_t;
+
+/**@brief Patch flash operation functions. */
+typedef struct
+{
+    uint32_t (*source_read)(uint32_t addr, uint8_t *p_buf, uint32_t size);          /**< Read source image, return read length. */
+    bool     (*target_write)(uint32_t addr, const uint8_t *p_buf, uint32_t size);   /**< Write erased target area. */
+} dfu_patch_op_t;
+
+/**@brief Patch apply context, RAM use is bounded by the buffers below.
+ *        Delta blocks carry a stream of records: varint diff length, varint extra length,
+ *        zigzag varint source seek applied before the diff, diff bytes added to source bytes, extra bytes. */
+typedef struct
+{
+    dfu_patch_op_t   op;                                        /**< Flash operation functions. */
+    dfu_patch_head_t head;                                      /**< Patch file head. */
+    uint32_t         source_addr;                               /**< Start address of source image. */
+    uint32_t         target_addr;                               /**< Start address of target area. */
+    uint32_t         target_max;                                /**< Size of target area. */
+    uint32_t         source_pos;                                /**< Source offset of the next diff byte. */
+    uint32_t         target_pos;                                /**< Target length written to flash. */
+    uint32_t         check_sum;                                 /**< Check sum of target bytes produced. */
+    uint32_t         rec_left;                                  /**< Bytes left of the current diff or extra data. */
+    uint32_t         rec_extra;                                 /**< Extra length of the current record. */
+    uint32_t         varint;                                    /**< Varint being decoded. */
+    uint8_t          varint_shift;                              /**< Bit shift of the next varint byte. */
+    uint8_t          rec_state;                                 /**< Record decode state. */
+    uint8_t          in_state;                                  /**< Input decode state. */
+    uint16_t         in_len;                                    /**< Length of data in blk_buf. */
+    uint16_t         in_need;                                   /**< Length of data needed in blk_buf for the current state. */
+    uint16_t         out_len;                                   /**< Length of data in out_buf. */
+    uint8_t          blk_buf[DFU_PATCH_BLK_HEAD_SIZE + DFU_PATCH_BLK_SIZE]; /**< Input block. */
+    uint8_t          raw_buf[DFU_PATCH_BLK_SIZE];               /**< Decompressed block. */
+    uint8_t          out_buf[DFU_PATCH_OUT_SIZE];               /**< Target data waiting for write. */
+} dfu_patch_t;
+/** @} */
+
+/**
+ * @defgroup DFU_PATCH_FUNCTION Functions
+ * @{
+ */
+/**
+ *****************************************************************************************
+ * @brief Start applying a patch file.
+ *
+ * @details The target area must be erased before data is written. Delta patches are
+ *          rejected if the source image is not the one the patch was made against, or
+ *          if the target area overlaps the source image.
+ *
+ * @param[in] p_patch:     Pointer to patch context.
+ * @param[in] p_op:        Pointer to flash operation functions.
+ * @param[in] source_addr: Start address of source image (running firmware).
+ * @param[in] target_addr: Start address of target area.
+ * @param[in] target_max:  Size of target area.
+ *
+ * @return Result of initialization.
+ *****************************************************************************************
+ */
+uint16_t dfu_patch_init(dfu_patch_t *p_patch, const dfu_patch_op_t *p_op, uint32_t source_addr, uint32_t target_addr, uint32_t target_max);
+
+/**
+ *****************************************************************************************
+ * @brief Feed patch file data, in any split.
+ *
+ * @param[in] p_patch: Pointer to patch context.
+ * @param[in] p_data:  Pointer to patch file data.
+ * @param[in] length:  Length of patch file data.
+ *
+ * @return Result of apply, the patch is aborted on any error.
+ *****************************************************************************************
+ */
+uint16_t dfu_patch_write(dfu_patch_t *p_patch, const uint8_t *p_data, uint32_t length);
+
+/**
+ *****************************************************************************************
+ * @brief Write the last target data and check the target image.
+ *
+ * @param[in] p_patch: Pointer to patch context.
+ *
+ * @return SDK_SUCCESS if the whole target image is written and its check sum matches.
+ *****************************************************************************************
+ */
+uint16_t dfu_patch_finish(dfu_patch_t *p_patch);
+/** @} */
+
+#endif
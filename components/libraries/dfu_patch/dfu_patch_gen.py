@@ -0,0 +1,334 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Generate DFU patch files applied on device by dfu_patch.c.
+
+A full patch carries the LZ compressed target image. A delta patch carries
+bsdiff style records against the firmware running on the device, so that
+only the changes and the code moved by them are transferred.
+
+Usage:
+    python dfu_patch_gen.py <target.bin> <out.patch>                      (full image)
+    python dfu_patch_gen.py --source <running.bin> <target.bin> <out.patch>  (delta)
+    python dfu_patch_gen.py --apply [--source <running.bin>] <in.patch> <out.bin>
+
+Every generated patch is applied again by this tool and compared with the
+target before it is written.
+"""
+
+import argparse
+import struct
+import sys
+
+DFU_PATCH_MAGIC      = 0x54504447
+DFU_PATCH_VERSION    = 0x01
+DFU_PATCH_TYPE_FULL  = 0x00
+DFU_PATCH_TYPE_DELTA = 0x01
+DFU_PATCH_HEAD_FMT   = '<IBBHIIII'
+DFU_PATCH_BLK_SIZE   = 1024
+
+# Same limits as lz_compress.h.
+LZ_MAX_OFFSET = 8192
+LZ_MAX_LIT    = 32
+LZ_MAX_MATCH  = 264
+
+DIFF_KEY_LEN   = 8     # Length of source index key.
+DIFF_MIN_MATCH = 16    # Shortest exact match to start a new record.
+DIFF_MAX_CAND  = 16    # Source positions kept per index key.
+
+
+def lz_compress(data):
+    """Compress one block in the lz_compress.c token format, with a larger match search than on device."""
+    out     = bytearray()
+    table   = {}
+    idx     = 0
+    lit_idx = 0
+    n       = len(data)
+
+    def flush_literal(end):
+        nonlocal lit_idx
+        while lit_idx < end:
+            run = min(end - lit_idx, LZ_MAX_LIT)
+            out.append(run - 1)
+            out.extend(data[lit_idx:lit_idx + run])
+            lit_idx += run
+
+    while idx + 2 < n:
+        key        = data[idx:idx + 3]
+        cands      = table.setdefault(key, [])
+        best_len   = 0
+        best_ref   = 0
+        max_len    = min(n - idx, LZ_MAX_MATCH)
+
+        for ref in reversed(cands[-8:]):
+            if idx - ref > LZ_MAX_OFFSET:
+                continue
+            length = 3
+            while length < max_len and data[ref + length] == data[idx + length]:
+                length += 1
+            if length > best_len:
+                best_len, best_ref = length, ref
+
+        cands.append(idx)
+
+        if best_len >= 3:
+            flush_literal(idx)
+            offset = idx - best_ref - 1
+            length = best_len - 2
+            if length < 7:
+                out.append((length << 5) | (offset >> 8))
+            else:
+                out.append((7 << 5) | (offset >> 8))
+                out.append(length - 7)
+            out.append(offset & 0xFF)
+
+            for k in range(idx + 1, min(idx + best_len, n - 2)):
+                table.setdefault(data[k:k + 3], []).append(k)
+            idx    += best_len
+            lit_idx = idx
+        else:
+            idx += 1
+
+    flush_literal(n)
+    return bytes(out)
+
+
+def lz_decompress(data, raw_len):
+    out = bytearray()
+    idx = 0
+
+    while idx < len(data):
+        ctrl = data[idx]
+        idx += 1
+        if ctrl < 32:
+            out.extend(data[idx:idx + ctrl + 1])
+            idx += ctrl + 1
+        else:
+            length = ctrl >> 5
+            if length == 7:
+                length += data[idx]
+                idx += 1
+            offset = (((ctrl & 0x1F) << 8) | data[idx]) + 1
+            idx += 1
+            for _ in range(length + 2):
+                out.append(out[-offset])
+
+    if len(out) != raw_len:
+        raise ValueError('corrupted block')
+    return bytes(out)
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return value * 2 if value >= 0 else -value * 2 - 1
+
+
+def match_len(a, a_pos, b, b_pos, limit):
+    length = 0
+    while length < limit:
+        step = min(64, limit - length)
+        if a[a_pos + length:a_pos + length + step] == b[b_pos + length:b_pos + length + step]:
+            length += step
+            continue
+        while length < limit and a[a_pos + length] == b[b_pos + length]:
+            length += 1
+        break
+    return length
+
+
+def delta_records(source, target):
+    """Greedy bsdiff: exact matches anchor records, the bytes in between are diffed against the former alignment."""
+    index = {}
+    for pos in range(0, len(source) - DIFF_KEY_LEN + 1):
+        cands = index.setdefault(source[pos:pos + DIFF_KEY_LEN], [])
+        if len(cands) < DIFF_MAX_CAND:
+            cands.append(pos)
+
+    stream     = bytearray()
+    source_pos = 0
+    last_scan  = 0
+    last_pos   = 0
+    scan       = 0
+
+    def emit(scan_end):
+        nonlocal source_pos
+        # Longest prefix of the gap worth diffing: more than half of its bytes match under the former alignment.
+        limit      = min(scan_end - last_scan, len(source) - last_pos)
+        score      = 0
+        best_score = 0
+        diff_len   = 0
+        for k in range(limit):
+            score += 1 if source[last_pos + k] == target[last_scan + k] else -1
+            if score > best_score:
+                best_score, diff_len = score, k + 1
+
+        diff  = bytes((target[last_scan + k] - source[last_pos + k]) & 0xFF for k in range(diff_len))
+        extra = target[last_scan + diff_len:scan_end]
+
+        stream.extend(varint(diff_len))
+        stream.extend(varint(len(extra)))
+        stream.extend(varint(zigzag(last_pos - source_pos)))
+        stream.extend(diff)
+        stream.extend(extra)
+        source_pos = last_pos + diff_len
+
+    while scan + DIFF_KEY_LEN <= len(target):
+        best_len = 0
+        best_pos = 0
+        for pos in index.get(target[scan:scan + DIFF_KEY_LEN], ()):
+            length = match_len(source, pos, target, scan, min(len(source) - pos, len(target) - scan))
+            if length > best_len:
+                best_len, best_pos = length, pos
+
+        aligned = last_pos + (scan - last_scan)
+        if best_len < DIFF_MIN_MATCH or best_pos == aligned:
+            scan += 1
+            continue
+
+        # Keep the former alignment if it is nearly as good, small edits must not split records.
+        if aligned + best_len <= len(source):
+            old_match = sum(1 for k in range(best_len) if source[aligned + k] == target[scan + k])
+            if old_match + DIFF_KEY_LEN >= best_len:
+                scan += 1
+                continue
+
+        emit(scan)
+        last_scan = scan
+        last_pos  = best_pos
+        scan     += best_len
+
+    emit(len(target))
+    return bytes(stream)
+
+
+def apply_records(source, stream, target_size):
+    target     = bytearray()
+    source_pos = 0
+    idx        = 0
+
+    def read_varint():
+        nonlocal idx
+        value = 0
+        shift = 0
+        while True:
+            byte = stream[idx]
+            idx += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while idx < len(stream):
+        diff_len  = read_varint()
+        extra_len = read_varint()
+        seek      = read_varint()
+        seek      = (seek >> 1) ^ -(seek & 1)
+        source_pos += seek
+        for k in range(diff_len):
+            target.append((source[source_pos + k] + stream[idx + k]) & 0xFF)
+        idx        += diff_len
+        source_pos += diff_len
+        target.extend(stream[idx:idx + extra_len])
+        idx        += extra_len
+
+    if len(target) != target_size:
+        raise ValueError('target size mismatch')
+    return bytes(target)
+
+
+def build_patch(source, target):
+    if source is None:
+        patch_type = DFU_PATCH_TYPE_FULL
+        stream     = target
+        source     = b''
+    else:
+        patch_type = DFU_PATCH_TYPE_DELTA
+        stream     = delta_records(source, target)
+
+    out = bytearray(struct.pack(DFU_PATCH_HEAD_FMT, DFU_PATCH_MAGIC, DFU_PATCH_VERSION, patch_type, DFU_PATCH_BLK_SIZE,
+                                len(source), sum(source) & 0xFFFFFFFF, len(target), sum(target) & 0xFFFFFFFF))
+
+    for pos in range(0, len(stream), DFU_PATCH_BLK_SIZE):
+        raw  = stream[pos:pos + DFU_PATCH_BLK_SIZE]
+        comp = lz_compress(raw)
+        if len(comp) >= len(raw):
+            comp = raw
+        out.extend(struct.pack('<HH', len(comp), len(raw)))
+        out.extend(comp)
+
+    return bytes(out)
+
+
+def apply_patch(source, patch):
+    magic, version, patch_type, blk_size, source_size, source_sum, target_size, target_sum = \
+        struct.unpack_from(DFU_PATCH_HEAD_FMT, patch)
+
+    if magic != DFU_PATCH_MAGIC or version != DFU_PATCH_VERSION:
+        raise ValueError('not a patch file')
+
+    if patch_type == DFU_PATCH_TYPE_DELTA:
+        if source is None or len(source) != source_size or (sum(source) & 0xFFFFFFFF) != source_sum:
+            raise ValueError('source image does not match the patch')
+
+    stream = bytearray()
+    idx    = struct.calcsize(DFU_PATCH_HEAD_FMT)
+    while idx < len(patch):
+        comp_len, raw_len = struct.unpack_from('<HH', patch, idx)
+        idx += 4
+        block = patch[idx:idx + comp_len]
+        idx  += comp_len
+        stream.extend(block if comp_len == raw_len else lz_decompress(block, raw_len))
+
+    if patch_type == DFU_PATCH_TYPE_DELTA:
+        target = apply_records(source, stream, target_size)
+    else:
+        target = bytes(stream)
+
+    if len(target) != target_size or (sum(target) & 0xFFFFFFFF) != target_sum:
+        raise ValueError('target check failed')
+    return target
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate or apply DFU patch files.')
+    parser.add_argument('--source', help='firmware running on the device, for delta patch')
+    parser.add_argument('--apply', action='store_true', help='apply <in.patch> and write the target image')
+    parser.add_argument('input')
+    parser.add_argument('output')
+    args = parser.parse_args()
+
+    source = None
+    if args.source:
+        with open(args.source, 'rb') as f:
+            source = f.read()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    if args.apply:
+        result = apply_patch(source, data)
+    else:
+        result = build_patch(source, data)
+        if apply_patch(source, result) != data:
+            raise ValueError('patch verify failed')
+        print('%s: %d -> %d bytes (%.1f%%)' % (args.output, len(data), len(result), 100.0 * len(result) / len(data)))
+
+    with open(args.output, 'wb') as f:
+        f.write(result)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,193 @@
+/**
+ *****************************************************************************************
+ *
+ * @file dfu_patch_test.c
+ *
+ * @brief Host test of dfu_patch and lz_compress against a file-backed flash image,
+ *        run by dfu_patch_test.py.
+ *
+ * @details Usage: dfu_patch_test <flash.bin> <source.bin> <in.patch> <target.bin>
+ *          The source image is put in the flash file at its address and the target area
+ *          is erased. The patch is fed in random splits, programming can only clear bits
+ *          like on flash, and the target area must then hold the target image. The same
+ *          patch with one byte changed must be rejected.
+ *
+ *****************************************************************************************
+ */
+#include "dfu_patch.h"
+#include "lz_compress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLASH_BASE          0x01000000
+#define FLASH_SIZE          0x00080000
+#define SOURCE_ADDR         0x01002000
+#define TARGET_ADDR         0x01040000
+#define TARGET_MAX          (FLASH_BASE + FLASH_SIZE - TARGET_ADDR)
+
+static FILE *s_flash;
+
+static uint32_t flash_read(uint32_t addr, uint8_t *p_buf, uint32_t size)
+{
+    if (addr < FLASH_BASE || addr + size > FLASH_BASE + FLASH_SIZE || fseek(s_flash, addr - FLASH_BASE, SEEK_SET))
+    {
+        return 0;
+    }
+
+    return fread(p_buf, 1, size, s_flash);
+}
+
+static bool flash_write(uint32_t addr, const uint8_t *p_buf, uint32_t size)
+{
+    uint8_t cell[DFU_PATCH_OUT_SIZE];
+
+    if (addr < TARGET_ADDR || size > sizeof(cell) || size != flash_read(addr, cell, size))
+    {
+        return false;
+    }
+
+    // Programming only clears bits.
+    for (uint32_t i = 0; i < size; i++)
+    {
+        cell[i] &= p_buf[i];
+    }
+
+    return !fseek(s_flash, addr - FLASH_BASE, SEEK_SET) && size == fwrite(cell, 1, size, s_flash);
+}
+
+static uint8_t *file_load(const char *p_path, uint32_t *p_size)
+{
+    FILE    *fp = fopen(p_path, "rb");
+    uint8_t *p_data;
+    long     size;
+
+    if (NULL == fp || fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0)
+    {
+        fprintf(stderr, "can not read %s\n", p_path);
+        exit(2);
+    }
+    rewind(fp);
+    p_data = malloc(size + 1);
+    if (NULL == p_data || (size_t)size != fread(p_data, 1, size, fp))
+    {
+        exit(2);
+    }
+    fclose(fp);
+    *p_size = size;
+
+    return p_data;
+}
+
+static void flash_prepare(const uint8_t *p_source, uint32_t source_size)
+{
+    static uint8_t erased[FLASH_SIZE];
+
+    memset(erased, 0xFF, sizeof(erased));
+    memcpy(erased + SOURCE_ADDR - FLASH_BASE, p_source, source_size);
+    rewind(s_flash);
+    if (sizeof(erased) != fwrite(erased, 1, sizeof(erased), s_flash))
+    {
+        exit(2);
+    }
+}
+
+static uint16_t patch_apply(const uint8_t *p_patch_data, uint32_t patch_size)
+{
+    static dfu_patch_t patch;
+    dfu_patch_op_t     op = { flash_read, flash_write };
+    uint32_t           idx = 0;
+    uint32_t           len;
+    uint16_t           error;
+
+    error = dfu_patch_init(&patch, &op, SOURCE_ADDR, TARGET_ADDR, TARGET_MAX);
+    while (SDK_SUCCESS == error && idx < patch_size)
+    {
+        // Splits like BLE packets and DFU frames, down to single bytes.
+        len   = 1 + rand() % ((rand() & 1) ? 7 : 600);
+        len   = len > patch_size - idx ? patch_size - idx : len;
+        error = dfu_patch_write(&patch, p_patch_data + idx, len);
+        idx  += len;
+    }
+
+    return (SDK_SUCCESS == error) ? dfu_patch_finish(&patch) : error;
+}
+
+static bool lz_round_trip(const uint8_t *p_data, uint32_t size)
+{
+    static uint8_t comp[LZ_COMPRESS_BOUND(DFU_PATCH_BLK_SIZE)];
+    static uint8_t raw[DFU_PATCH_BLK_SIZE];
+    uint32_t       blk_len;
+    uint32_t       comp_len;
+
+    for (uint32_t idx = 0; idx < size; idx += blk_len)
+    {
+        blk_len  = size - idx > DFU_PATCH_BLK_SIZE ? DFU_PATCH_BLK_SIZE : size - idx;
+        comp_len = lz_compress(p_data + idx, blk_len, comp, sizeof(comp));
+        if (0 == comp_len || blk_len != lz_decompress(comp, comp_len, raw, sizeof(raw)) || memcmp(raw, p_data + idx, blk_len))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t target_read[TARGET_MAX];
+    uint8_t       *p_source;
+    uint8_t       *p_patch_data;
+    uint8_t       *p_target;
+    uint32_t       source_size;
+    uint32_t       patch_size;
+    uint32_t       target_size;
+    uint16_t       error;
+    int            failed = 0;
+
+    if (5 != argc)
+    {
+        fprintf(stderr, "usage: %s <flash.bin> <source.bin> <in.patch> <target.bin>\n", argv[0]);
+        return 2;
+    }
+
+    s_flash      = fopen(argv[1], "w+b");
+    p_source     = file_load(argv[2], &source_size);
+    p_patch_data = file_load(argv[3], &patch_size);
+    p_target     = file_load(argv[4], &target_size);
+    if (NULL == s_flash || source_size > TARGET_ADDR - SOURCE_ADDR || target_size > TARGET_MAX)
+    {
+        return 2;
+    }
+    srand(target_size);
+
+    flash_prepare(p_source, source_size);
+    error = patch_apply(p_patch_data, patch_size);
+    if (SDK_SUCCESS != error || target_size != flash_read(TARGET_ADDR, target_read, target_size) ||
+        memcmp(target_read, p_target, target_size))
+    {
+        printf("FAIL %s: apply error 0x%02x or target mismatch\n", argv[3], error);
+        failed++;
+    }
+
+    // Change a byte of the block data, the check sum must catch it.
+    flash_prepare(p_source, source_size);
+    p_patch_data[DFU_PATCH_HEAD_SIZE + DFU_PATCH_BLK_HEAD_SIZE + (patch_size - DFU_PATCH_HEAD_SIZE) / 2] ^= 0x01;
+    if (SDK_SUCCESS == patch_apply(p_patch_data, patch_size))
+    {
+        printf("FAIL %s: corrupted patch accepted\n", argv[3]);
+        failed++;
+    }
+
+    if (!lz_round_trip(p_target, target_size))
+    {
+        printf("FAIL %s: lz_compress round trip\n", argv[4]);
+        failed++;
+    }
+
+    printf("%s: %u bytes patch -> %u bytes target, %s\n", argv[3], patch_size, target_size, failed ? "FAILED" : "ok");
+    fclose(s_flash);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Make source and target firmware images, generate full and delta patches of
+them with dfu_patch_gen.py, and apply every patch on a file-backed flash
+image with the dfu_patch_test host program.
+
+Usage:
+    python dfu_patch_test.py <dfu_patch_test executable> <work dir>
+"""
+
+import os
+import random
+import subprocess
+import sys
+
+GEN = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'dfu_patch_gen.py')
+
+
+def firmware(rng, size):
+    """Code-like image: repeated instruction patterns, tables and some noise."""
+    words = [rng.getrandbits(32) for _ in range(64)]
+    data  = bytearray()
+    while len(data) < size:
+        if rng.random() < 0.1:
+            data.extend(rng.getrandbits(8) for _ in range(rng.randint(4, 64)))
+        else:
+            for _ in range(rng.randint(2, 16)):
+                data.extend(rng.choice(words).to_bytes(4, 'little'))
+    return data[:size]
+
+
+def mutate(rng, source):
+    """New release: edits, an inserted function and a removed one move the code after them."""
+    target = bytearray(source)
+    for _ in range(40):
+        pos = rng.randrange(len(target) - 4)
+        target[pos:pos + 4] = rng.getrandbits(32).to_bytes(4, 'little')
+    pos = rng.randrange(len(target))
+    target[pos:pos] = firmware(rng, 3000)
+    pos = rng.randrange(len(target) - 2000)
+    del target[pos:pos + 2000]
+    return target
+
+
+def main():
+    exe, work = sys.argv[1], sys.argv[2]
+    rng       = random.Random(5332)
+    failed    = 0
+
+    os.makedirs(work, exist_ok=True)
+    source = firmware(rng, 120 * 1024 + 17)
+    target = mutate(rng, source)
+    files  = {name: os.path.join(work, name) for name in ('source.bin', 'target.bin', 'full.patch', 'delta.patch', 'flash.bin')}
+    for name, data in (('source.bin', source), ('target.bin', target)):
+        with open(files[name], 'wb') as f:
+            f.write(data)
+
+    subprocess.run([sys.executable, GEN, files['target.bin'], files['full.patch']], check=True)
+    subprocess.run([sys.executable, GEN, '--source', files['source.bin'], files['target.bin'], files['delta.patch']], check=True)
+
+    for patch in ('full.patch', 'delta.patch'):
+        failed |= subprocess.run([exe, files['flash.bin'], files['source.bin'], files[patch], files['target.bin']]).returncode
+
+    # A delta patch made against another source must be refused.
+    with open(files['source.bin'], 'wb') as f:
+        f.write(mutate(rng, source))
+    if subprocess.run([exe, files['flash.bin'], files['source.bin'], files['delta.patch'], files['target.bin']],
+                      stdout=subprocess.DEVNULL).returncode == 0:
+        print('FAIL delta.patch: applied on a wrong source image')
+        failed = 1
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
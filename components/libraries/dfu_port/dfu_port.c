@@ -49,6 +49,12 @@
 #ifdef ENABLE_DFU_SPI_FLASH
     #include "gr55xx_spi_flash.h"
 #endif
+#ifdef ENABLE_DFU_PATCH
+    #include "dfu_patch.h"
+#endif
+#ifdef ENABLE_DFU_CRC32
+    #include "utility.h"
+#endif
 
 
 #define DFU_BUFFER_SIZE                 2048                                                         /**< The dfu buffer size. */
@@ -77,6 +83,36 @@
 #define FAST_DFU_ERASE_FLASH_STATE      0x01
 #define FAST_DFU_PROGRAM_FLASH_STATE    0x02
 
+#ifndef FAST_DFU_ERASE_AHEAD_NUM
+#define FAST_DFU_ERASE_AHEAD_NUM        2                                                             /**< Sectors kept erased ahead of programming, 0 to erase all before programming. */
+#endif
+#define FAST_DFU_RX_RATIO_MAX           90                                                            /**< LLD message heap usage ratio when flash keeps up. */
+#define FAST_DFU_RX_RATIO_MIN           50                                                            /**< LLD message heap usage ratio when flash lags most. */
+#define FAST_DFU_BACKLOG_LOW_MS         20                                                            /**< Flash backlog below which reception is not throttled. */
+#define FAST_DFU_BACKLOG_HIGH_MS        100                                                           /**< Flash backlog above which reception is throttled most. */
+
+#ifdef ENABLE_DFU_PATCH
+#define FAST_DFU_PATCH_BIT              0x04                                                          /**< Fast DFU data is a patch file. */
+#define FAST_DFU_PATCH_READ_LEN         256                                                           /**< The patch data length applied once. */
+#if DFU_PATCH_OUT_SIZE > ONCE_WRITE_DATA_LEN
+#error "Error: DFU_PATCH_OUT_SIZE > ONCE_WRITE_DATA_LEN"
+#endif
+#endif
+
+#ifdef ENABLE_DFU_CRC32
+#define FAST_DFU_CRC32_BIT              0x08                                                          /**< Fast DFU is checked by CRC-32 and resumable. */
+#define DFU_FEATURE_CRC32               0x01                                                          /**< Feature flag in get info response: fast DFU CRC-32 and resume. */
+#ifndef FAST_DFU_CHECKPOINT_SIZE
+#define FAST_DFU_CHECKPOINT_SIZE        (4 * DFU_FLASH_SECTOR_SIZE)                                   /**< Programmed length between two saved checkpoints. */
+#endif
+#ifndef FAST_DFU_CHECKPOINT_NV_TAG
+#define FAST_DFU_CHECKPOINT_NV_TAG      NV_TAG_APP(0x3FFE)                                            /**< NVDS tag of fast DFU checkpoint. */
+#endif
+#if FAST_DFU_CHECKPOINT_SIZE % DFU_FLASH_SECTOR_SIZE
+#error "Error: FAST_DFU_CHECKPOINT_SIZE must be multiple of DFU_FLASH_SECTOR_SIZE"
+#endif
+#endif
+
 enum
 {
     DFU_ACK_SUCCESS = 0x01,
@@ -90,8 +126,24 @@ enum
 
     FAST_DFU_INNER = 0x02,
     FAST_DFU_SPI = 0X03,
+
+    FAST_DFU_INNER_PATCH = 0x06,
+    FAST_DFU_SPI_PATCH = 0x07,
 };
 
+#ifdef ENABLE_DFU_CRC32
+/**@brief Fast DFU checkpoint, the programmed data before offset is verified. */
+typedef struct
+{
+    uint32_t load_addr;         /**< Start address of the data. */
+    uint32_t file_size;         /**< Size of the data. */
+    uint32_t image_crc;         /**< CRC-32 of the whole data given by master. */
+    uint32_t flash_type;        /**< DFU_FLASH_INNER or DFU_FLASH_SPI. */
+    uint32_t offset;            /**< Length of data programmed and verified, sector aligned. */
+    uint32_t offset_crc;        /**< CRC-32 of the data before offset read back from flash. */
+} fast_dfu_checkpoint_t;
+#endif
+
 enum
 {
     NORMAL_FIRMWARE = 0x00,
@@ -174,13 +226,27 @@ static uint32_t             s_file_size       = 0x00;
 static uint16_t             s_erase_all_count = 0;
 static uint32_t             s_all_write_size  = 0x00;
 static uint16_t             s_erase_count = 0;
+static uint32_t             s_flash_cycles_per_byte = 0;
+static uint8_t              s_rx_ratio = FAST_DFU_RX_RATIO_MAX;
 static uint8_t              s_fast_dfu_mode    = 0x00;
 static dfu_image_info_t     s_now_img_info;
 static dfu_enter_callback   s_dfu_enter_func = NULL;
 
 static uint8_t              s_ota_conn_index = BLE_GAP_INVALID_CONN_INDEX;
 
+#ifdef ENABLE_DFU_PATCH
+static bool                 s_fast_dfu_patch = false;
+static dfu_patch_t          s_dfu_patch;
+#endif
+
+#ifdef ENABLE_DFU_CRC32
+static bool                 s_fast_dfu_crc32 = false;
+static fast_dfu_checkpoint_t s_checkpoint;
+#endif
+
 #if defined(SOC_GR533X) || defined(SOC_GR5405)
+static uint32_t dfu_exflash_erase(uint32_t erase_type, uint32_t addr, uint32_t size);
+
 static uint32_t     page_start_addr;
 static uint32_t     *p_page_start_addr = NULL;
 static uint32_t     all_check_sum;
@@ -192,7 +258,7 @@ static dfu_func_t       s_dfu_func  =
     .dfu_ble_send_data      = ble_send_data,
     .dfu_flash_read         = hal_exflash_read,
     .dfu_flash_write        = hal_exflash_write,
-    .dfu_flash_erase        = hal_exflash_erase,
+    .dfu_flash_erase        = dfu_exflash_erase,
     .dfu_flash_get_info     = hal_flash_get_info,
     .dfu_flash_feat_enable  = NULL,
 };
@@ -336,6 +402,7 @@ static void dfu_spi_flash_init(uint8_t *p_data)
         flash_init.spi_type = FLASH_SPIM_ID;
         flash_init.is_dual_line = false;
         flash_init.is_high_freq = false;
+        flash_init.is_quad_line = false;
 
         spi_flash_init(&flash_init);
     }
@@ -372,6 +439,7 @@ static void dfu_spi_flash_init(uint8_t *p_data)
         }
 
         flash_init.is_high_freq = false;
+        flash_init.is_quad_line = false;
 
         spi_flash_init(&flash_init);
     }
@@ -409,6 +477,7 @@ static void dfu_spi_flash_init(uint8_t *p_data)
         flash_init.spi_type = FLASH_SPIM_ID;
         flash_init.is_dual_line = false;
         flash_init.is_high_freq = false;
+        flash_init.is_quad_line = false;
 
         spi_flash_init(&flash_init);
     }
@@ -438,6 +507,7 @@ static void dfu_spi_flash_init(uint8_t *p_data)
 
         flash_init.is_dual_line = false;
         flash_init.is_high_freq = false;
+        flash_init.is_quad_line = false;
         flash_init.spi_type = (ssi_id == 0) ? FLASH_QSPI_ID0 : ((ssi_id == 1) ? FLASH_QSPI_ID1 : FLASH_QSPI_ID2);
 
         spi_flash_init(&flash_init);
@@ -473,6 +543,7 @@ static void dfu_spi_flash_init(uint8_t *p_data)
         flash_init.spi_type = FLASH_SPIM_ID;
         flash_init.is_dual_line = false;
         flash_init.is_high_freq = false;
+        flash_init.is_quad_line = false;
 
         spi_flash_init(&flash_init);
     }
@@ -580,6 +651,12 @@ void fast_dfu_state_machine_reset(void)
     s_fast_dfu_mode = 0;
     s_program_end_flag = 0;
     s_fast_dfu_state = FAST_DFU_INIT_STATE;
+#ifdef ENABLE_DFU_PATCH
+    s_fast_dfu_patch = false;
+#endif
+#ifdef ENABLE_DFU_CRC32
+    s_fast_dfu_crc32 = false;
+#endif
 }
 
 
@@ -694,6 +771,12 @@ static void get_info_replace(dfu_receive_frame_t *p_frame)
     memcpy(&p_frame->data[9], &sdk_version, sizeof(sdk_version_t));
 
     p_frame->data[17] = OTAS_VERSION;
+#ifdef ENABLE_DFU_CRC32
+    p_frame->data[18] = DFU_FEATURE_CRC32;
+#else
+    p_frame->data[18] = 0;
+#endif
+    p_frame->data[19] = ~p_frame->data[18];     // Check byte, the master does not trust data[18] without it.
 
     dfu_send_frame(p_frame->data, 20, p_frame->cmd_type);
     cmd_receive_flag = 0;
@@ -743,36 +826,170 @@ static void dfu_fw_info_get(dfu_receive_frame_t *p_frame)
     cmd_receive_flag = 0;
 }
 
+#if defined(SOC_GR533X) || defined(SOC_GR5405)
+static uint32_t dfu_exflash_erase(uint32_t erase_type, uint32_t addr, uint32_t size)
+{
+    // Sector erase of a region goes through hal_flash_erase, which erases whole blocks by block erase.
+    if (EXFLASH_ERASE_SECTOR == erase_type && size)
+    {
+        return hal_flash_erase(addr, size) ? HAL_OK : HAL_ERROR;
+    }
+
+    return hal_exflash_erase(erase_type, addr, size);
+}
+#endif
+
+static bool fast_dfu_sector_erase(uint32_t address, uint16_t sector_num)
+{
+#if defined(SOC_GR533X) || defined(SOC_GR5405)
+    return !dfu_flash_erase(address, sector_num * DFU_FLASH_SECTOR_SIZE);
+#else
+    return dfu_flash_erase(address, sector_num * DFU_FLASH_SECTOR_SIZE);
+#endif
+}
+
+static bool fast_dfu_erase_ahead(uint32_t end_address)
+{
+    uint32_t erase_goal = (end_address - page_start_addr + DFU_FLASH_SECTOR_SIZE - 1) / DFU_FLASH_SECTOR_SIZE + FAST_DFU_ERASE_AHEAD_NUM;
+
+    erase_goal = erase_goal > s_erase_all_count ? s_erase_all_count : erase_goal;
+
+    if (s_erase_count < erase_goal)
+    {
+        if (!fast_dfu_sector_erase(page_start_addr + (s_erase_count * DFU_FLASH_SECTOR_SIZE), erase_goal - s_erase_count))
+        {
+            return false;
+        }
+        s_erase_count = erase_goal;
+    }
+
+    return true;
+}
+
+static void fast_dfu_erase_idle(void)
+{
+    // Nothing to program, erase one more sector so that later programming stalls less.
+    if (s_erase_count < s_erase_all_count &&
+        fast_dfu_sector_erase(page_start_addr + (s_erase_count * DFU_FLASH_SECTOR_SIZE), 1))
+    {
+        s_erase_count++;
+    }
+}
+
+static void fast_dfu_flash_rate_update(uint32_t cycles, uint32_t length)
+{
+    uint32_t cycles_per_byte = cycles / length;
+
+    // Smooth it, a sector erase lands in one measure only.
+    s_flash_cycles_per_byte = s_flash_cycles_per_byte ? ((s_flash_cycles_per_byte * 3 + cycles_per_byte) / 4) : cycles_per_byte;
+}
+
+static void fast_dfu_rx_throttle(void)
+{
+    uint32_t backlog_ms;
+    uint8_t  ratio;
+
+    // Reception stopped by ring buffer overflow resumes when one flash write length is free.
+    if (s_ring_buffer_over_flag && ring_buffer_surplus_space_get(&s_ble_rx_ring_buffer) <= ONCE_WRITE_DATA_LEN)
+    {
+        return;
+    }
+
+    // Time the flash needs for the data in ring buffer, at the measured flash bandwidth.
+    backlog_ms = (uint64_t)ring_buffer_items_count_get(&s_ble_rx_ring_buffer) * s_flash_cycles_per_byte / (SystemCoreClock / 1000);
+
+    if (backlog_ms <= FAST_DFU_BACKLOG_LOW_MS)
+    {
+        ratio = FAST_DFU_RX_RATIO_MAX;
+    }
+    else if (backlog_ms >= FAST_DFU_BACKLOG_HIGH_MS)
+    {
+        ratio = FAST_DFU_RX_RATIO_MIN;
+    }
+    else
+    {
+        ratio = FAST_DFU_RX_RATIO_MAX - (FAST_DFU_RX_RATIO_MAX - FAST_DFU_RX_RATIO_MIN) *
+                (backlog_ms - FAST_DFU_BACKLOG_LOW_MS) / (FAST_DFU_BACKLOG_HIGH_MS - FAST_DFU_BACKLOG_LOW_MS);
+    }
+
+    if (s_ring_buffer_over_flag || ratio != s_rx_ratio)
+    {
+        sys_lld_max_msg_usage_ratio_set(ratio);
+        s_rx_ratio = ratio;
+        s_ring_buffer_over_flag = false;
+    }
+}
+
+static void fast_dfu_rx_ratio_restore(void)
+{
+    // Programming is over, reception gets the whole message heap back.
+    if (FAST_DFU_RX_RATIO_MAX != s_rx_ratio)
+    {
+        sys_lld_max_msg_usage_ratio_set(FAST_DFU_RX_RATIO_MAX);
+        s_rx_ratio = FAST_DFU_RX_RATIO_MAX;
+    }
+}
+
+static bool fast_dfu_flash_program(uint32_t address, uint8_t *p_data, uint16_t length)
+{
+    bool is_success;
+
+    if (!fast_dfu_erase_ahead(address + length))
+    {
+        return false;
+    }
+
+    security_disable();
+#if defined(SOC_GR533X) || defined(SOC_GR5405)
+    is_success = (HAL_OK == dfu_flash_write(address, p_data, length));
+#else
+    is_success = (length == dfu_flash_write(address, p_data, length));
+#endif
+    security_state_recovery();
+
+    return is_success;
+}
+
+static void fast_dfu_program_end(bool is_success)
+{
+    s_program_end_flag = true;
+    s_p_cmd_buffer[0] = is_success ? DFU_ACK_SUCCESS : DFU_ACK_ERROR;
+    dfu_send_frame(s_p_cmd_buffer, 1, 0xFF); // write over
+    s_fast_dfu_state = FAST_DFU_INIT_STATE;
+
+    if (!is_success)
+    {
+        fast_dfu_state_machine_reset();
+    }
+    fast_dfu_rx_ratio_restore();
+}
+
 static void fast_dfu_erase_flash(void)
 {
     bool report_state = false;
-    bool erase_not_complete = s_erase_count < s_erase_all_count;
+    // Only the first sectors are erased before programming, the others are erased ahead of programming.
+    uint16_t erase_goal = (FAST_DFU_ERASE_AHEAD_NUM && FAST_DFU_ERASE_AHEAD_NUM < s_erase_all_count) ?
+                          FAST_DFU_ERASE_AHEAD_NUM : s_erase_all_count;
+    bool erase_not_complete = s_erase_count < erase_goal;
     // erase flash when ble idle
     if (erase_not_complete)
     {
         bool has_error = false;
-        for (int i = 0; i < 20; i++)
+        // Up to 20 sectors in one erase, the flash driver erases the whole blocks in them by block erase.
+        uint16_t erase_num = (erase_goal - s_erase_count) > 20 ? 20 : (erase_goal - s_erase_count);
+        uint32_t address = page_start_addr + (s_erase_count * DFU_FLASH_SECTOR_SIZE);
+        if (fast_dfu_sector_erase(address, erase_num))
         {
-            uint32_t address = page_start_addr + (s_erase_count * DFU_FLASH_SECTOR_SIZE);
-#if defined(SOC_GR533X) || defined(SOC_GR5405)
-            if (!dfu_flash_erase(address, DFU_FLASH_SECTOR_SIZE))
-#else
-            if (dfu_flash_erase(address, DFU_FLASH_SECTOR_SIZE))
-#endif
-            {
-                s_erase_count++;
-                if (s_erase_count >= s_erase_all_count)
-                {
-                    erase_not_complete = false;
-                    break;
-                }
-            }
-            else
+            s_erase_count += erase_num;
+            if (s_erase_count >= erase_goal)
             {
-                has_error = true;
-                break;
+                erase_not_complete = false;
             }
         }
+        else
+        {
+            has_error = true;
+        }
         if (has_error)
         {
             report_state = true;
@@ -811,12 +1028,151 @@ static void fast_dfu_cal_check_sum(uint32_t address, uint16_t len)
     dfu_flash_read(address, s_p_fast_cache_buffer, len);
     security_state_recovery();
 
+#ifdef ENABLE_DFU_CRC32
+    if (s_fast_dfu_crc32)
+    {
+        all_check_sum = crc32_calc(all_check_sum, s_p_fast_cache_buffer, len);
+        return;
+    }
+#endif
+
     for(uint16_t i=0; i<len; i++)
     {
         all_check_sum += s_p_fast_cache_buffer[i];
     }
 }
 
+#ifdef ENABLE_DFU_CRC32
+static uint32_t fast_dfu_checkpoint_resume(void)
+{
+    fast_dfu_checkpoint_t saved;
+    uint16_t              saved_len = sizeof(saved);
+    uint32_t              crc       = 0;
+    uint32_t              offset    = 0;
+    uint32_t              read_len;
+
+    if (NVDS_SUCCESS != nvds_get(FAST_DFU_CHECKPOINT_NV_TAG, &saved_len, (uint8_t *)&saved) ||
+        sizeof(saved) != saved_len ||
+        saved.load_addr  != s_checkpoint.load_addr ||
+        saved.file_size  != s_checkpoint.file_size ||
+        saved.image_crc  != s_checkpoint.image_crc ||
+        saved.flash_type != s_checkpoint.flash_type ||
+        saved.offset >= saved.file_size ||
+        saved.offset % DFU_FLASH_SECTOR_SIZE)
+    {
+        return 0;
+    }
+
+    // Flash may be touched after the checkpoint was saved, read it back again.
+    while (offset < saved.offset)
+    {
+        read_len = saved.offset - offset;
+        read_len = read_len > ONCE_WRITE_DATA_LEN ? ONCE_WRITE_DATA_LEN : read_len;
+
+        security_disable();
+        dfu_flash_read(saved.load_addr + offset, s_p_fast_cache_buffer, read_len);
+        security_state_recovery();
+
+        crc     = crc32_calc(crc, s_p_fast_cache_buffer, read_len);
+        offset += read_len;
+    }
+
+    if (crc != saved.offset_crc)
+    {
+        return 0;
+    }
+
+    s_checkpoint.offset     = saved.offset;
+    s_checkpoint.offset_crc = saved.offset_crc;
+
+    return saved.offset;
+}
+
+static void fast_dfu_checkpoint_save(void)
+{
+    if (!s_fast_dfu_crc32 || !s_fast_dfu_mode ||
+        s_all_write_size >= s_file_size ||
+        s_all_write_size % DFU_FLASH_SECTOR_SIZE ||
+        s_all_write_size - s_checkpoint.offset < FAST_DFU_CHECKPOINT_SIZE)
+    {
+        return;
+    }
+
+    s_checkpoint.offset     = s_all_write_size;
+    s_checkpoint.offset_crc = all_check_sum;
+    nvds_put(FAST_DFU_CHECKPOINT_NV_TAG, sizeof(s_checkpoint), (uint8_t *)&s_checkpoint);
+}
+#endif
+
+#ifdef ENABLE_DFU_PATCH
+static uint32_t fast_dfu_patch_source_read(uint32_t addr, uint8_t *p_buf, uint32_t size)
+{
+    return hal_flash_read_judge_security(addr, p_buf, size);
+}
+
+static bool fast_dfu_patch_target_write(uint32_t addr, const uint8_t *p_buf, uint32_t size)
+{
+    bool ret = fast_dfu_flash_program(addr, (uint8_t *)p_buf, size);
+
+    fast_dfu_cal_check_sum(addr, size);
+
+    return ret;
+}
+
+static uint16_t fast_dfu_patch_start(uint32_t target_max)
+{
+    dfu_image_info_t     app_info;
+    const dfu_patch_op_t patch_op =
+    {
+        .source_read  = fast_dfu_patch_source_read,
+        .target_write = fast_dfu_patch_target_write,
+    };
+
+    // The source of delta patch is the running app firmware.
+    hal_flash_read_judge_security(APP_INFO_START_ADDR, (uint8_t *)&app_info, sizeof(dfu_image_info_t));
+
+    return dfu_patch_init(&s_dfu_patch, &patch_op, app_info.boot_info.load_addr, page_start_addr, target_max);
+}
+
+static void fast_dfu_patch_program(uint16_t items_size)
+{
+    uint8_t  read_buf[FAST_DFU_PATCH_READ_LEN];
+    uint16_t read_len;
+    uint16_t error = SDK_SUCCESS;
+
+    // The target data of one patch data is unbounded, so apply a little patch data once.
+    read_len = ring_buffer_read(&s_ble_rx_ring_buffer, read_buf, items_size > sizeof(read_buf) ? sizeof(read_buf) : items_size);
+    if (read_len)
+    {
+        HAL_TIMEOUT_INIT();
+        uint32_t start_tick = HAL_TIMEOUT_GET_TICK();
+
+        error = dfu_patch_write(&s_dfu_patch, read_buf, read_len);
+        s_all_write_size += read_len;
+        dfu_programing(read_len);
+
+        fast_dfu_flash_rate_update(HAL_TIMEOUT_GET_TICK() - start_tick, read_len);
+        HAL_TIMEOUT_DEINIT();
+    }
+    else
+    {
+        fast_dfu_erase_idle();
+    }
+
+    if (SDK_SUCCESS == error && s_all_write_size < s_file_size)
+    {
+        return;
+    }
+
+    if (SDK_SUCCESS == error)
+    {
+        error = dfu_patch_finish(&s_dfu_patch);
+    }
+
+    fast_dfu_program_end(SDK_SUCCESS == error);
+}
+#endif
+
 static void program_start_replace(dfu_receive_frame_t *p_frame)
 {
     uint8_t dfu_type = p_frame->data[0] & 0x0F;
@@ -831,6 +1187,35 @@ static void program_start_replace(dfu_receive_frame_t *p_frame)
 
     bool    erase_state = false;
 
+#ifdef ENABLE_DFU_CRC32
+    uint32_t image_crc     = 0;
+    uint32_t resume_offset = 0;
+
+    s_fast_dfu_crc32 = (dfu_type & FAST_DFU_CRC32_BIT) && p_frame->data_len > 4;
+    if (s_fast_dfu_crc32)
+    {
+        // CRC-32 start frame is the fast DFU (or patch) start frame followed by the CRC-32 of the image.
+        p_frame->data_len -= 4;
+        image_crc = ((p_frame->data[p_frame->data_len + 3] << 24) | (p_frame->data[p_frame->data_len + 2] << 16) |
+                     (p_frame->data[p_frame->data_len + 1] << 8) | (p_frame->data[p_frame->data_len]));
+        dfu_type &= ~FAST_DFU_CRC32_BIT;
+    }
+#endif
+
+#ifdef ENABLE_DFU_PATCH
+    uint32_t patch_size = 0;
+
+    s_fast_dfu_patch = (dfu_type == FAST_DFU_INNER_PATCH || dfu_type == FAST_DFU_SPI_PATCH) && p_frame->data_len > 4;
+    if (s_fast_dfu_patch)
+    {
+        // Patch start frame is the fast DFU start frame followed by the patch file size.
+        p_frame->data_len -= 4;
+        patch_size = ((p_frame->data[p_frame->data_len + 3] << 24) | (p_frame->data[p_frame->data_len + 2] << 16) |
+                      (p_frame->data[p_frame->data_len + 1] << 8) | (p_frame->data[p_frame->data_len]));
+        dfu_type &= ~FAST_DFU_PATCH_BIT;
+    }
+#endif
+
     s_fast_dfu_mode = 0x00;
 
     if (dfu_type == DFU_FLASH_INNER && p_frame->data_len == (sizeof(dfu_image_info_t) + 1)) // code in flash 
@@ -925,6 +1310,23 @@ static void program_start_replace(dfu_receive_frame_t *p_frame)
             s_erase_all_count = s_file_size / DFU_FLASH_SECTOR_SIZE;
         }
 
+#ifdef ENABLE_DFU_PATCH
+        if (s_fast_dfu_patch)
+        {
+            if (SDK_SUCCESS != fast_dfu_patch_start(s_erase_all_count * DFU_FLASH_SECTOR_SIZE))
+            {
+                fast_dfu_state_machine_reset();
+                p_frame->data[0] = DFU_ACK_ERROR;
+                dfu_send_frame(p_frame->data, 1, p_frame->cmd_type);
+                cmd_receive_flag = 0;
+                return;
+            }
+
+            // Received length is counted on the patch file, the target image size only decides the erase.
+            s_file_size = patch_size;
+        }
+#endif
+
         if (dfu_type == FAST_DFU_INNER)
         {
             dfu_flash_type_set(DFU_FLASH_INNER);
@@ -935,20 +1337,62 @@ static void program_start_replace(dfu_receive_frame_t *p_frame)
         }
 
         s_program_address = page_start_addr;
+        s_all_write_size = 0;
+        s_erase_count = 0;
+        all_check_sum = 0;
         p_frame->data[0] = DFU_ACK_SUCCESS;
         p_frame->data[1] = DFU_ERASE_FLASH_START;
         p_frame->data[2] = s_erase_all_count & 0xff;
         p_frame->data[3] = (s_erase_all_count >> 8) & 0xff;
-        dfu_send_frame(p_frame->data, 4, p_frame->cmd_type);
+
+#ifdef ENABLE_DFU_CRC32
+        if (s_fast_dfu_crc32)
+        {
+            s_checkpoint.load_addr  = page_start_addr;
+            s_checkpoint.file_size  = s_file_size;
+            s_checkpoint.image_crc  = image_crc;
+            s_checkpoint.flash_type = (dfu_type == FAST_DFU_INNER) ? DFU_FLASH_INNER : DFU_FLASH_SPI;
+            s_checkpoint.offset     = 0;
+            s_checkpoint.offset_crc = 0;
+
+    #ifdef ENABLE_DFU_PATCH
+            if (!s_fast_dfu_patch)
+    #endif
+            {
+                resume_offset = fast_dfu_checkpoint_resume();
+            }
+
+            // Programming goes on behind the verified data, the master skips it as well.
+            s_program_address = page_start_addr + resume_offset;
+            s_all_write_size = resume_offset;
+            s_erase_count = resume_offset / DFU_FLASH_SECTOR_SIZE;
+            all_check_sum = s_checkpoint.offset_crc;
+
+            p_frame->data[4] = resume_offset & 0xff;
+            p_frame->data[5] = (resume_offset >> 8) & 0xff;
+            p_frame->data[6] = (resume_offset >> 16) & 0xff;
+            p_frame->data[7] = (resume_offset >> 24) & 0xff;
+            dfu_send_frame(p_frame->data, 8, p_frame->cmd_type);
+        }
+        else
+#endif
+        {
+            dfu_send_frame(p_frame->data, 4, p_frame->cmd_type);
+        }
         s_fast_dfu_state = FAST_DFU_ERASE_FLASH_STATE;
         s_ring_buffer_over_flag = false;
-        s_all_write_size = 0;
-        s_erase_count = 0;
-        all_check_sum = 0;
+        s_flash_cycles_per_byte = 0;
+        s_rx_ratio = FAST_DFU_RX_RATIO_MAX;
         s_program_end_flag = false;
         ring_buffer_init(&s_ble_rx_ring_buffer, s_p_ring_buffer, s_ring_buffer_size);
         ring_buffer_clean(&s_ble_rx_ring_buffer);
         dfu_program_start(s_file_size);
+#ifdef ENABLE_DFU_CRC32
+        for (uint32_t i = 0; i < resume_offset; i += DFU_FLASH_SECTOR_SIZE)
+        {
+            dfu_programing(DFU_FLASH_SECTOR_SIZE);
+        }
+#endif
         cmd_receive_flag = 0;
         return ;
     }
@@ -1122,6 +1566,15 @@ static void program_end_replace(dfu_receive_frame_t *p_frame)
 
     p_frame->data[1] = end_flag;
 
+#ifdef ENABLE_DFU_CRC32
+    if (s_fast_dfu_mode && s_fast_dfu_crc32)
+    {
+        // Done either way, a mismatched image restarts from the beginning.
+        nvds_del(FAST_DFU_CHECKPOINT_NV_TAG);
+        s_fast_dfu_crc32 = false;
+    }
+#endif
+
     if (s_fast_dfu_mode)
     {
         p_frame->data[1] = all_check_sum & 0xff;
@@ -1323,25 +1776,37 @@ static void fast_dfu_program_schedule(void)
     uint16_t items_size = 0;
 
     items_size = ring_buffer_items_count_get(&s_ble_rx_ring_buffer);
+#ifdef ENABLE_DFU_PATCH
+    if (s_fast_dfu_patch)
+    {
+        fast_dfu_patch_program(items_size);
+    }
+    else
+#endif
     if (items_size >= ONCE_WRITE_DATA_LEN)
     {
+        HAL_TIMEOUT_INIT();
+        uint32_t start_tick = HAL_TIMEOUT_GET_TICK();
+
         read_len = ring_buffer_read(&s_ble_rx_ring_buffer, s_p_fast_cache_buffer, ONCE_WRITE_DATA_LEN);
 
-        security_disable();
-#if defined(SOC_GR533X) || defined(SOC_GR5405)
-        if(HAL_OK != dfu_flash_write(s_program_address, s_p_fast_cache_buffer, read_len))
-#else
-        if(read_len != dfu_flash_write(s_program_address, s_p_fast_cache_buffer, read_len))
-#endif
+        if (!fast_dfu_flash_program(s_program_address, s_p_fast_cache_buffer, read_len))
         {
-            fast_dfu_state_machine_reset();
+            HAL_TIMEOUT_DEINIT();
+            fast_dfu_program_end(false);
+            return;
         }
-        security_state_recovery();
 
         fast_dfu_cal_check_sum(s_program_address, read_len);
         s_all_write_size += read_len;
         s_program_address += read_len;
         dfu_programing(read_len);
+#ifdef ENABLE_DFU_CRC32
+        fast_dfu_checkpoint_save();
+#endif
+
+        fast_dfu_flash_rate_update(HAL_TIMEOUT_GET_TICK() - start_tick, read_len);
+        HAL_TIMEOUT_DEINIT();
     }
     else
     {
@@ -1350,29 +1815,30 @@ static void fast_dfu_program_schedule(void)
             read_len = ring_buffer_read(&s_ble_rx_ring_buffer, s_p_fast_cache_buffer, items_size);
             if (read_len)
             {
-                security_disable();
-                dfu_flash_write(s_program_address, s_p_fast_cache_buffer, read_len);
-                security_state_recovery();
+                if (!fast_dfu_flash_program(s_program_address, s_p_fast_cache_buffer, read_len))
+                {
+                    fast_dfu_program_end(false);
+                    return;
+                }
 
                 fast_dfu_cal_check_sum(s_program_address, read_len);
                 s_all_write_size += read_len;
             }
             dfu_programing(read_len);
 
-            s_program_end_flag = true;
-            s_p_cmd_buffer[0] = DFU_ACK_SUCCESS;
-            dfu_send_frame(s_p_cmd_buffer, 1, 0xFF); // write over
-            s_fast_dfu_state = FAST_DFU_INIT_STATE;
+            fast_dfu_program_end(true);
+            return;
+        }
+        else if (0 == items_size)
+        {
+            fast_dfu_erase_idle();
         }
     }
 
-    if (s_ring_buffer_over_flag && !s_program_end_flag)
+    // Programming ended in patch mode, no more data to pace.
+    if (FAST_DFU_INIT_STATE != s_fast_dfu_state)
     {
-        if (ring_buffer_surplus_space_get(&s_ble_rx_ring_buffer) > ONCE_WRITE_DATA_LEN)
-        {
-            sys_lld_max_msg_usage_ratio_set(90);
-            s_ring_buffer_over_flag = false;
-        }
+        fast_dfu_rx_throttle();
     }
 }
 
@@ -80,6 +80,11 @@ void dfu_service_init(dfu_enter_callback dfu_enter);
  * @brief DFU port init.
  * @details If not using serial port update function, uart_send_data can be set NULL.
             if the user doesn't care about the upgrade status,p_dfu_callback can set NULL.
+            With ENABLE_DFU_PATCH defined (dfu_patch.c and lz_compress.c built), fast DFU also
+            accepts patch files made by dfu_patch_gen.py: LZ compressed images, or deltas against
+            the running app firmware which need the save address outside the running firmware.
+            With ENABLE_DFU_CRC32 defined, a master asking for it checks fast DFU by CRC-32, and a
+            transfer broken off resumes behind the last checkpoint kept in NVDS.
  *
  * @param[in] uart_send_data  : Function is used to send data to master by UART.
  * @param[in] dfu_fw_save_addr: The start address of the upgraded firmware stored in flash
@@ -150,7 +150,49 @@ bool hal_flash_get_security(void)
 
 bool hal_flash_erase(const uint32_t addr, const uint32_t size)
 {
-    return (HAL_OK == hal_exflash_erase(EXFLASH_ERASE_SECTOR, addr, size)) ? true : false;
+    uint32_t erase_addr = addr & ~(EXFLASH_SIZE_SECTOR_BYTES - 1);
+    uint32_t erase_end  = (addr + size + EXFLASH_SIZE_SECTOR_BYTES - 1) & ~(EXFLASH_SIZE_SECTOR_BYTES - 1);
+    uint32_t erase_type;
+    uint32_t erase_size;
+
+    if (0 == size)
+    {
+        return (HAL_OK == hal_exflash_erase(EXFLASH_ERASE_SECTOR, addr, size)) ? true : false;
+    }
+
+    /* Erase whole 64KB/32KB blocks in the region by block erase, which is much faster per byte than sector erase. */
+    while (erase_addr < erase_end)
+    {
+        if (0 == (erase_addr & (EXFLASH_SIZE_BLOCK_BYTES - 1)) && erase_end - erase_addr >= EXFLASH_SIZE_BLOCK_BYTES)
+        {
+            erase_type = EXFLASH_ERASE_BLOCK;
+            erase_size = EXFLASH_SIZE_BLOCK_BYTES;
+        }
+        else if (0 == (erase_addr & (EXFLASH_SIZE_BLOCK_32K_BYTES - 1)) && erase_end - erase_addr >= EXFLASH_SIZE_BLOCK_32K_BYTES)
+        {
+            erase_type = EXFLASH_ERASE_BLOCK32K;
+            erase_size = EXFLASH_SIZE_BLOCK_32K_BYTES;
+        }
+        else
+        {
+            erase_type = EXFLASH_ERASE_SECTOR;
+            erase_size = EXFLASH_SIZE_SECTOR_BYTES;
+        }
+
+        if (HAL_OK != hal_exflash_erase(erase_type, erase_addr, erase_size))
+        {
+            /* Block erase refused, erase the block by sectors. */
+            if (EXFLASH_ERASE_SECTOR == erase_type ||
+                HAL_OK != hal_exflash_erase(EXFLASH_ERASE_SECTOR, erase_addr, erase_size))
+            {
+                return false;
+            }
+        }
+
+        erase_addr += erase_size;
+    }
+
+    return true;
 }
 
 bool hal_flash_erase_chip(void)
@@ -143,7 +143,8 @@ bool hal_flash_get_security(void);
  *       will be erased. If addr is not sector aligned, preceding data
  *       on the sector that addr belongs to will also be erased.
  *       If (addr + size) is not sector aligned, the whole sector
- *       will also be erased.
+ *       will also be erased. Whole 32KB/64KB blocks in the region
+ *       are erased by block erase.
  *
  * @param[in] addr    start address in flash to write data to.
  * @param[in] size    number of bytes to write.
@@ -0,0 +1,237 @@
+/**
+ *****************************************************************************************
+ *
+ * @file lz_compress.c
+ *
+ * @brief LZ block compression Implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "lz_compress.h"
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define LZ_HASH_SIZE            (1 << LZ_COMPRESS_HASH_LOG)
+#define LZ_HASH(p)              ((uint16_t)((((p)[0] << 16) | ((p)[1] << 8) | (p)[2]) * 2654435761u >> (32 - LZ_COMPRESS_HASH_LOG)))
+#define LZ_HASH_EMPTY           0xFFFF
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static uint16_t s_lz_hash_tab[LZ_HASH_SIZE];    /**< Last input position of every 3 bytes hash. */
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static bool lz_literal_flush(const uint8_t *p_lit, uint32_t lit_len, uint8_t *p_out, uint32_t out_size, uint32_t *p_out_idx)
+{
+    if (0 == lit_len)
+    {
+        return true;
+    }
+
+    if (*p_out_idx + 1 + lit_len > out_size)
+    {
+        return false;
+    }
+
+    p_out[(*p_out_idx)++] = lit_len - 1;
+    memcpy(&p_out[*p_out_idx], p_lit, lit_len);
+    *p_out_idx += lit_len;
+
+    return true;
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+uint32_t lz_compress(const uint8_t *p_in, uint32_t in_len, uint8_t *p_out, uint32_t out_size)
+{
+    uint32_t in_idx  = 0;
+    uint32_t out_idx = 0;
+    uint32_t lit_idx = 0;
+    uint32_t ref_idx;
+    uint32_t match_len;
+    uint32_t max_len;
+    uint32_t offset;
+    uint16_t hash;
+
+    if (NULL == p_in || NULL == p_out || 0 == in_len || in_len > 0xFFFF)
+    {
+        return 0;
+    }
+
+    memset(s_lz_hash_tab, 0xFF, sizeof(s_lz_hash_tab));
+
+    while (in_idx + 2 < in_len)
+    {
+        hash    = LZ_HASH(&p_in[in_idx]);
+        ref_idx = s_lz_hash_tab[hash];
+        s_lz_hash_tab[hash] = in_idx;
+
+        if (LZ_HASH_EMPTY != ref_idx &&
+            (in_idx - ref_idx) <= LZ_COMPRESS_MAX_OFFSET &&
+            0 == memcmp(&p_in[ref_idx], &p_in[in_idx], 3))
+        {
+            max_len = in_len - in_idx;
+            max_len = max_len > LZ_COMPRESS_MAX_MATCH ? LZ_COMPRESS_MAX_MATCH : max_len;
+
+            for (match_len = 3; match_len < max_len && p_in[ref_idx + match_len] == p_in[in_idx + match_len]; match_len++);
+
+            if (!lz_literal_flush(&p_in[lit_idx], in_idx - lit_idx, p_out, out_size, &out_idx) ||
+                out_idx + 3 > out_size)
+            {
+                return 0;
+            }
+
+            offset     = in_idx - ref_idx - 1;
+            match_len -= 2;
+
+            if (match_len < 7)
+            {
+                p_out[out_idx++] = (match_len << 5) | (offset >> 8);
+            }
+            else
+            {
+                p_out[out_idx++] = (7 << 5) | (offset >> 8);
+                p_out[out_idx++] = match_len - 7;
+            }
+            p_out[out_idx++] = offset & 0xFF;
+
+            in_idx += match_len + 2;
+            lit_idx = in_idx;
+            continue;
+        }
+
+        in_idx++;
+
+        if ((in_idx - lit_idx) == LZ_COMPRESS_MAX_LIT)
+        {
+            if (!lz_literal_flush(&p_in[lit_idx], LZ_COMPRESS_MAX_LIT, p_out, out_size, &out_idx))
+            {
+                return 0;
+            }
+            lit_idx = in_idx;
+        }
+    }
+
+    // Tail bytes too short for a match.
+    while (lit_idx < in_len)
+    {
+        uint32_t lit_len = in_len - lit_idx;
+
+        lit_len = lit_len > LZ_COMPRESS_MAX_LIT ? LZ_COMPRESS_MAX_LIT : lit_len;
+        if (!lz_literal_flush(&p_in[lit_idx], lit_len, p_out, out_size, &out_idx))
+        {
+            return 0;
+        }
+        lit_idx += lit_len;
+    }
+
+    return out_idx;
+}
+
+uint32_t lz_decompress(const uint8_t *p_in, uint32_t in_len, uint8_t *p_out, uint32_t out_size)
+{
+    uint32_t in_idx  = 0;
+    uint32_t out_idx = 0;
+    uint32_t ctrl;
+    uint32_t len;
+    uint32_t offset;
+
+    if (NULL == p_in || NULL == p_out)
+    {
+        return 0;
+    }
+
+    while (in_idx < in_len)
+    {
+        ctrl = p_in[in_idx++];
+
+        if (ctrl < (1 << 5))
+        {
+            len = ctrl + 1;
+
+            if (in_idx + len > in_len || out_idx + len > out_size)
+            {
+                return 0;
+            }
+
+            memcpy(&p_out[out_idx], &p_in[in_idx], len);
+            in_idx  += len;
+            out_idx += len;
+        }
+        else
+        {
+            len = ctrl >> 5;
+
+            if (7 == len)
+            {
+                if (in_idx >= in_len)
+                {
+                    return 0;
+                }
+                len += p_in[in_idx++];
+            }
+
+            if (in_idx >= in_len)
+            {
+                return 0;
+            }
+
+            offset = (((ctrl & 0x1F) << 8) | p_in[in_idx++]) + 1;
+            len   += 2;
+
+            if (offset > out_idx || out_idx + len > out_size)
+            {
+                return 0;
+            }
+
+            // Byte copy, the reference may overlap the output.
+            for (uint32_t i = 0; i < len; i++, out_idx++)
+            {
+                p_out[out_idx] = p_out[out_idx - offset];
+            }
+        }
+    }
+
+    return out_idx;
+}
@@ -0,0 +1,103 @@
+/**
+ *****************************************************************************************
+ *
+ * @file lz_compress.h
+ *
+ * @brief Header file - LZ block compression APIs
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+#ifndef __LZ_COMPRESS_H__
+#define __LZ_COMPRESS_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup LZ_COMPRESS_MAROC Defines
+ * @{
+ */
+#ifndef LZ_COMPRESS_HASH_LOG
+#define LZ_COMPRESS_HASH_LOG        8       /**< Log2 of compressor hash table entries, the table takes 2 << LZ_COMPRESS_HASH_LOG bytes RAM. */
+#endif
+
+#define LZ_COMPRESS_MAX_OFFSET      8192    /**< Maximum back reference distance. */
+#define LZ_COMPRESS_MAX_LIT         32      /**< Maximum literal run of one token. */
+#define LZ_COMPRESS_MAX_MATCH       264     /**< Maximum match length of one token. */
+
+/**@brief Worst case size of compressed data, used to size the output buffer. */
+#define LZ_COMPRESS_BOUND(in_len)   ((in_len) + ((in_len) / LZ_COMPRESS_MAX_LIT) + 1)
+/** @} */
+
+/**
+ * @defgroup LZ_COMPRESS_FUNCTION Functions
+ * @{
+ */
+/**
+ *****************************************************************************************
+ * @brief Compress one block with LZ77 (LZF token format).
+ *
+ * @details Token format:
+ *          - 000LLLLL:                   literal run of L + 1 bytes follows.
+ *          - LLLOOOOO OOOOOOOO:          match of L + 2 bytes at distance O + 1, L < 7.
+ *          - 111OOOOO LLLLLLLL OOOOOOOO: match of L + 9 bytes at distance O + 1.
+ *          Every block is independent, the decompressor needs no history of former blocks.
+ *
+ * @param[in]  p_in:     Pointer to data to compress.
+ * @param[in]  in_len:   Length of data to compress, no more than 65535.
+ * @param[out] p_out:    Pointer to output buffer.
+ * @param[in]  out_size: Size of output buffer.
+ *
+ * @return Length of compressed data, 0 if the data does not fit in output buffer.
+ *****************************************************************************************
+ */
+uint32_t lz_compress(const uint8_t *p_in, uint32_t in_len, uint8_t *p_out, uint32_t out_size);
+
+/**
+ *****************************************************************************************
+ * @brief Decompress one block compressed by @ref lz_compress.
+ *
+ * @param[in]  p_in:     Pointer to compressed data.
+ * @param[in]  in_len:   Length of compressed data.
+ * @param[out] p_out:    Pointer to output buffer.
+ * @param[in]  out_size: Size of output buffer.
+ *
+ * @return Length of decompressed data, 0 if the data is corrupted or does not fit in output buffer.
+ *****************************************************************************************
+ */
+uint32_t lz_decompress(const uint8_t *p_in, uint32_t in_len, uint8_t *p_out, uint32_t out_size);
+/** @} */
+
+#endif
@@ -220,6 +220,133 @@ uint32_t ring_buffer_pick(ring_buffer_t *p_ring_buff, uint8_t *p_rd_data, uint32
     return length;
 }
 
+uint32_t ring_buffer_skip(ring_buffer_t *p_ring_buff, uint32_t length)
+{
+    uint32_t items_avail = 0;
+
+    if (NULL == p_ring_buff)
+        return 0;
+
+    RING_BUFFER_LOCK();
+
+    uint32_t wr_idx = p_ring_buff->write_index;
+    uint32_t rd_idx = p_ring_buff->read_index;
+
+    if (wr_idx >= rd_idx)
+    {
+        items_avail = wr_idx - rd_idx;
+    }
+    else
+    {
+        items_avail = p_ring_buff->buffer_size - rd_idx + wr_idx;
+    }
+
+    length  = (length > items_avail ? items_avail : length);
+    rd_idx += length;
+
+    if (rd_idx >= p_ring_buff->buffer_size)
+    {
+        rd_idx -= p_ring_buff->buffer_size;
+    }
+
+    p_ring_buff->read_index = rd_idx;
+
+    RING_BUFFER_UNLOCK();
+
+    return length;
+}
+
+uint32_t ring_buffer_read_span_get(ring_buffer_t *p_ring_buff, uint8_t **pp_data)
+{
+    uint32_t length = 0;
+
+    if ((NULL == p_ring_buff) || (NULL == pp_data))
+        return 0;
+
+    RING_BUFFER_LOCK();
+
+    uint32_t wr_idx = p_ring_buff->write_index;
+    uint32_t rd_idx = p_ring_buff->read_index;
+
+    if (wr_idx >= rd_idx)
+    {
+        length = wr_idx - rd_idx;
+    }
+    else
+    {
+        length = p_ring_buff->buffer_size - rd_idx;
+    }
+    *pp_data = p_ring_buff->p_buffer + rd_idx;
+
+    RING_BUFFER_UNLOCK();
+
+    return length;
+}
+
+uint32_t ring_buffer_write_span_get(ring_buffer_t *p_ring_buff, uint8_t **pp_data)
+{
+    uint32_t length = 0;
+
+    if ((NULL == p_ring_buff) || (NULL == pp_data))
+        return 0;
+
+    RING_BUFFER_LOCK();
+
+    uint32_t wr_idx = p_ring_buff->write_index;
+    uint32_t rd_idx = p_ring_buff->read_index;
+
+    // One byte is always left free, full and empty buffer are told apart by it.
+    if (rd_idx > wr_idx)
+    {
+        length = rd_idx - wr_idx - 1;
+    }
+    else
+    {
+        length = p_ring_buff->buffer_size - wr_idx - (0 == rd_idx ? 1 : 0);
+    }
+    *pp_data = p_ring_buff->p_buffer + wr_idx;
+
+    RING_BUFFER_UNLOCK();
+
+    return length;
+}
+
+uint32_t ring_buffer_write_commit(ring_buffer_t *p_ring_buff, uint32_t length)
+{
+    uint32_t surplus_space = 0;
+
+    if (NULL == p_ring_buff)
+        return 0;
+
+    RING_BUFFER_LOCK();
+
+    uint32_t wr_idx = p_ring_buff->write_index;
+    uint32_t rd_idx = p_ring_buff->read_index;
+
+    if (rd_idx > wr_idx)
+    {
+        surplus_space = rd_idx - wr_idx - 1;
+    }
+    else
+    {
+        surplus_space = p_ring_buff->buffer_size - wr_idx + rd_idx - 1;
+    }
+
+    length  = (length > surplus_space ? surplus_space : length);
+    wr_idx += length;
+
+    if (wr_idx >= p_ring_buff->buffer_size)
+    {
+        wr_idx -= p_ring_buff->buffer_size;
+    }
+
+    p_ring_buff->write_index = wr_idx;
+
+    RING_BUFFER_UNLOCK();
+
+    return length;
+}
+
 uint32_t ring_buffer_items_count_get(ring_buffer_t *p_ring_buff)
 {
     uint32_t count = 0;
@@ -116,6 +116,57 @@ uint32_t ring_buffer_read(ring_buffer_t *p_ring_buff, uint8_t *p_rd_data, uint32
  *****************************************************************************************
  */
 uint32_t ring_buffer_pick(ring_buffer_t *p_ring_buff, uint8_t *p_rd_data, uint32_t length);
+
+/**
+ *****************************************************************************************
+ * @brief Discard data from one ring buffer without copying it.
+ *
+ * @param[in] p_ring_buff: Pointer to ring buffer.
+ * @param[in] length:      Length of data want to discard.
+ *
+ * @return Length of discarded data.
+ *****************************************************************************************
+ */
+uint32_t ring_buffer_skip(ring_buffer_t *p_ring_buff, uint32_t length);
+
+/**
+ *****************************************************************************************
+ * @brief Get the data readable in place: the contiguous part from the read index on.
+ *        Consume it with @ref ring_buffer_skip, the rest of wrapped data is got by the next call.
+ *
+ * @param[in]  p_ring_buff: Pointer to ring buffer.
+ * @param[out] pp_data:     Pointer to where save the address of the data.
+ *
+ * @return Length of contiguous data.
+ *****************************************************************************************
+ */
+uint32_t ring_buffer_read_span_get(ring_buffer_t *p_ring_buff, uint8_t **pp_data);
+
+/**
+ *****************************************************************************************
+ * @brief Get the space writable in place: the contiguous part from the write index on.
+ *        Make the data written there readable with @ref ring_buffer_write_commit.
+ *
+ * @param[in]  p_ring_buff: Pointer to ring buffer.
+ * @param[out] pp_data:     Pointer to where save the address of the space.
+ *
+ * @return Length of contiguous space.
+ *****************************************************************************************
+ */
+uint32_t ring_buffer_write_span_get(ring_buffer_t *p_ring_buff, uint8_t **pp_data);
+
+/**
+ *****************************************************************************************
+ * @brief Make data written in place (by CPU or DMA) readable by moving the write index.
+ *
+ * @param[in] p_ring_buff: Pointer to ring buffer.
+ * @param[in] length:      Length of data written.
+ *
+ * @return Length of committed data, limited to surplus space.
+ *****************************************************************************************
+ */
+uint32_t ring_buffer_write_commit(ring_buffer_t *p_ring_buff, uint32_t length);
+
 /**
  *****************************************************************************************
  * @brief Get surplus space of one ring buffer.
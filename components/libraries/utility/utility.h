@@ -376,6 +376,21 @@ void put_u16_inc(uint8_t **pp_buf, uint16_t x);
  *****************************************************************************************
  */
 void put_u32_inc(uint8_t **pp_buf, uint32_t x);
+
+/**
+ *****************************************************************************************
+ * @brief Function for calculating CRC-32 (IEEE 802.3, same as zlib crc32()).
+ *
+ * @note Pass 0 as crc to start, pass the former result to continue over more data.
+ *
+ * @param[in] crc:    CRC of the former data, 0 for none.
+ * @param[in] p_data: Pointer to data.
+ * @param[in] len:    Length of data.
+ *
+ * @return CRC of the former data followed by this data.
+ *****************************************************************************************
+ */
+uint32_t crc32_calc(uint32_t crc, const uint8_t *p_data, uint32_t len);
 /** @} */
 #ifdef __cplusplus
 }
@@ -74,6 +74,8 @@ extern "C" {
 typedef enum
 {
     APP_ADC_EVT_CONV_CPLT,           /**< Conversion completed by ADC peripheral. */
+    APP_ADC_EVT_STREAM_DATA,         /**< One half of stream buffer filled, the other half is being filled. */
+    APP_ADC_EVT_STREAM_ERROR,        /**< Stream stopped, DMA into the other half could not be started. */
 } app_adc_evt_type_t;
 
 /**@brief App adc state types. */
@@ -135,9 +137,22 @@ typedef struct
   */
 typedef struct
 {
-    app_adc_evt_type_t  type; /**< Type of event. */
+    app_adc_evt_type_t  type;     /**< Type of event. */
+    uint16_t           *p_data;   /**< Filled half of stream buffer, for APP_ADC_EVT_STREAM_DATA. */
+    uint32_t            length;   /**< Number of codes in p_data, for APP_ADC_EVT_STREAM_DATA. */
 } app_adc_evt_t;
 
+/**
+  * @brief ADC code to voltage coefficients, voltage = code * gain + offset
+  */
+typedef struct
+{
+    float               gain;      /**< Volt per code. */
+    float               offset;    /**< Volt at code 0. */
+    int32_t             gain_q16;  /**< Microvolt per code, Q16 fixed point. */
+    int32_t             offset_uv; /**< Microvolt at code 0. */
+} app_adc_conv_coef_t;
+
 /** @} */
 
 /** @addtogroup APP_ADC_TYPEDEFS Type definitions
@@ -177,6 +192,9 @@ typedef struct
     app_adc_dma_state_t     adc_dma_state;             /**< ADC dma state types. */
     app_adc_sample_node_t *p_current_sample_node;      /**< ADC sample-node definition. */
     uint32_t multi_channel;                            /**< multi channel definition. */
+    uint16_t               *p_stream_buf;              /**< Stream buffer, NULL if not streaming. */
+    uint32_t               stream_half_len;            /**< Codes in one half of stream buffer. */
+    uint32_t               stream_fill_idx;            /**< Half of stream buffer being filled. */
 } adc_env_t;
 
 /**
@@ -248,6 +266,72 @@ uint16_t app_adc_conversion_sync(uint16_t *p_data, uint32_t length, uint32_t tim
  */
 uint16_t app_adc_conversion_async(uint16_t *p_data, uint32_t length);
 
+/**
+ ****************************************************************************************
+ * @brief  Start continuous DMA conversion into two halves of a buffer.
+ *
+ * @note   When one half is filled, DMA goes on into the other half, started from the
+ *         conversion complete interrupt, and APP_ADC_EVT_STREAM_DATA reports the filled
+ *         half. It must be processed before the other half is filled, e.g. with
+ *         app_adc_conv_f32() or app_adc_conv_uv(). If DMA into the other half can not be
+ *         started, the stream is stopped and APP_ADC_EVT_STREAM_ERROR follows the last
+ *         APP_ADC_EVT_STREAM_DATA, app_adc_stream_start() may then be called again.
+ *
+ * @param[in]  p_buf: Pointer to buffer, 4-byte aligned.
+ * @param[in]  length: Codes of the whole buffer, a multiple of 4, half of it no more than 4095.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_adc_stream_start(uint16_t *p_buf, uint32_t length);
+
+/**
+ ****************************************************************************************
+ * @brief  Stop continuous DMA conversion started by app_adc_stream_start().
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_adc_stream_stop(void);
+
+/**
+ ****************************************************************************************
+ * @brief  Get the coefficients of app_adc_voltage_intern() or app_adc_voltage_extern(),
+ *         for the float and fixed point conversion kernels.
+ *
+ * @param[in]  ref: External reference value, 0 for internal reference.
+ * @param[out] p_coef: Pointer to coefficients.
+ *
+ * @return Result of operation, APP_DRV_ERR_HAL if the HAL conversion is not linear.
+ ****************************************************************************************
+ */
+uint16_t app_adc_conv_coef_get(double ref, app_adc_conv_coef_t *p_coef);
+
+/**
+ ****************************************************************************************
+ * @brief  Convert ADC codes to voltage in float, single precision instead of the double
+ *         precision of app_adc_voltage_intern() and app_adc_voltage_extern().
+ *
+ * @param[in]  p_coef: Pointer to coefficients got by app_adc_conv_coef_get().
+ * @param[in]  p_in: Pointer to ADC codes.
+ * @param[out] p_out: Pointer to voltage results in volt.
+ * @param[in]  length: Number of codes.
+ ****************************************************************************************
+ */
+void app_adc_conv_f32(const app_adc_conv_coef_t *p_coef, const uint16_t *p_in, float *p_out, uint32_t length);
+
+/**
+ ****************************************************************************************
+ * @brief  Convert ADC codes to voltage in fixed point, without FPU.
+ *
+ * @param[in]  p_coef: Pointer to coefficients got by app_adc_conv_coef_get().
+ * @param[in]  p_in: Pointer to ADC codes.
+ * @param[out] p_out: Pointer to voltage results in microvolt.
+ * @param[in]  length: Number of codes.
+ ****************************************************************************************
+ */
+void app_adc_conv_uv(const app_adc_conv_coef_t *p_coef, const uint16_t *p_in, int32_t *p_out, uint32_t length);
+
 /**
  ****************************************************************************************
  * @brief  Convert the ADC conversion results to a voltage value(internal reference).
@@ -62,6 +62,16 @@ extern "C" {
 #ifdef HAL_DMA_MODULE_ENABLED
 
 
+/** @addtogroup APP_DMA_MACRO Defines
+  * @{
+  */
+#define APP_DMA_BLOCK_MAX_LENGTH    0xFFF   /**< Maximum data items of one DMA block. */
+
+#ifndef APP_DMA_MEMCPY_CALIB_SIZE
+#define APP_DMA_MEMCPY_CALIB_SIZE   256     /**< Largest copy timed by the memcpy calibration, twice of it is taken from stack. */
+#endif
+/** @} */
+
 /** @addtogroup APP_DMA_ENUMERATIONS Enumerations
   * @{
   */
@@ -102,6 +112,11 @@ typedef int16_t dma_id_t;
   */
 typedef void (*app_dma_evt_handler_t)(app_dma_evt_type_t type);
 
+/**
+  * @brief DMA memcpy complete callback definition, result is APP_DRV_SUCCESS or the error code.
+  */
+typedef void (*app_dma_memcpy_cb_t)(uint16_t result);
+
 /** @} */
 
 /** @addtogroup APP_DMA_STRUCTURES Structures
@@ -116,6 +131,9 @@ typedef struct
     app_dma_state_t       dma_state;        /**< App dma state types. */
     dma_handle_t          handle;           /**< DMA handle definition. */
     app_dma_evt_handler_t evt_handler;      /**< DMA event callback definition. */
+    uint32_t              xfer_src;         /**< Source address of the next block of a split transfer. */
+    uint32_t              xfer_dst;         /**< Destination address of the next block of a split transfer. */
+    uint32_t              xfer_remain;      /**< Data items left after the running block of a split transfer. */
 } dma_env_t;
 
 /**
@@ -163,11 +181,14 @@ uint16_t app_dma_deinit(dma_id_t ins_id);
 /**
  ****************************************************************************************
  * @brief  Start the DMA Transfer.
+ * @note   A transfer longer than APP_DMA_BLOCK_MAX_LENGTH is split into blocks, the next block is
+ *         started from the transfer complete interrupt of the former one. APP_DMA_EVT_TFR is
+ *         reported once after the last block.
  *
  * @param[in]  id: DMA channel id.
  * @param[in]  src_address: The source memory Buffer address
  * @param[in]  dst_address: The destination memory Buffer address
- * @param[in]  data_length: The length of data to be transferred from source to destination, ranging between 0 and 4095.
+ * @param[in]  data_length: The length of data to be transferred from source to destination, in source data width, at least 1.
  ****************************************************************************************
  */
 uint16_t app_dma_start(dma_id_t id, uint32_t src_address, uint32_t dst_address, uint32_t data_length);
@@ -183,6 +204,122 @@ uint16_t app_dma_start(dma_id_t id, uint32_t src_address, uint32_t dst_address,
  */
 dma_handle_t *app_dma_get_handle(dma_id_t id);
 
+/**
+ ****************************************************************************************
+ * @brief  Reserve a DMA channel for app_dma_memcpy_sync/async and app_dma_memset_sync/async.
+ * @note   The copy and fill sizes from which DMA beats the CPU are calibrated here by timing
+ *         both on a stack buffer of 2 * APP_DMA_MEMCPY_CALIB_SIZE bytes.
+ *
+ * @param[in]  p_instance: DMA instance of the channel.
+ * @param[in]  channel: DMA channel, not used by any other module.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_dma_memcpy_init(dma_regs_t *p_instance, dma_channel_t channel);
+
+/**
+ ****************************************************************************************
+ * @brief  Release the DMA channel of the memcpy service, copies then run on the CPU.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_dma_memcpy_deinit(void);
+
+/**
+ ****************************************************************************************
+ * @brief  Copy memory, by DMA from the calibrated threshold on, by CPU below it or while the channel is busy.
+ *
+ * @param[in]  p_dst: Destination address, must not overlap the source.
+ * @param[in]  p_src: Source address.
+ * @param[in]  length: Bytes to copy.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_dma_memcpy_sync(void *p_dst, const void *p_src, uint32_t length);
+
+/**
+ ****************************************************************************************
+ * @brief  Start copying memory by DMA and return, cb is called in DMA interrupt when it completes.
+ *         Below the threshold or while the channel is busy, the copy is done by CPU and cb is called before return.
+ *
+ * @param[in]  p_dst: Destination address, must not overlap the source.
+ * @param[in]  p_src: Source address, must not be changed until cb is called.
+ * @param[in]  length: Bytes to copy.
+ * @param[in]  cb: Complete callback, can be NULL.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_dma_memcpy_async(void *p_dst, const void *p_src, uint32_t length, app_dma_memcpy_cb_t cb);
+
+/**
+ ****************************************************************************************
+ * @brief  Set the copy size from which the memcpy service uses DMA, overriding the calibrated one.
+ *
+ * @param[in]  threshold: Copy size in bytes, 0xFFFFFFFF to copy by CPU only.
+ ****************************************************************************************
+ */
+void app_dma_memcpy_threshold_set(uint32_t threshold);
+
+/**
+ ****************************************************************************************
+ * @brief  Get the copy size from which the memcpy service uses DMA.
+ *
+ * @return Copy size in bytes.
+ ****************************************************************************************
+ */
+uint32_t app_dma_memcpy_threshold_get(void);
+
+/**
+ ****************************************************************************************
+ * @brief  Fill memory, by DMA from a fixed pattern word from the calibrated threshold on,
+ *         by CPU below it or while the channel of the memcpy service is busy.
+ *
+ * @param[in]  p_dst: Destination address.
+ * @param[in]  value: Byte to fill with.
+ * @param[in]  length: Bytes to fill.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_dma_memset_sync(void *p_dst, uint8_t value, uint32_t length);
+
+/**
+ ****************************************************************************************
+ * @brief  Start filling memory by DMA and return, cb is called in DMA interrupt when it completes.
+ *         Below the threshold or while the channel is busy, the fill is done by CPU and cb is called before return.
+ *
+ * @param[in]  p_dst: Destination address.
+ * @param[in]  value: Byte to fill with.
+ * @param[in]  length: Bytes to fill.
+ * @param[in]  cb: Complete callback, can be NULL.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_dma_memset_async(void *p_dst, uint8_t value, uint32_t length, app_dma_memcpy_cb_t cb);
+
+/**
+ ****************************************************************************************
+ * @brief  Set the fill size from which the memcpy service uses DMA for memset, overriding the calibrated one.
+ *
+ * @param[in]  threshold: Fill size in bytes, 0xFFFFFFFF to fill by CPU only.
+ ****************************************************************************************
+ */
+void app_dma_memset_threshold_set(uint32_t threshold);
+
+/**
+ ****************************************************************************************
+ * @brief  Get the fill size from which the memcpy service uses DMA for memset.
+ *
+ * @return Fill size in bytes.
+ ****************************************************************************************
+ */
+uint32_t app_dma_memset_threshold_get(void);
+
 #ifdef APP_DRIVER_WAKEUP_CALL_FUN
 /**
  ****************************************************************************************
@@ -77,6 +77,42 @@ typedef struct scroll_read_info_t{
     struct scroll_read_info_t* next;
 } app_qspi_scroll_read_info_t;
 
+#ifndef APP_QSPI_DIRTY_RECT_MAX
+#define APP_QSPI_DIRTY_RECT_MAX             8u       /**< Max. rectangles kept apart by a dirty region, more are merged */
+#endif
+
+#ifndef APP_QSPI_DIRTY_RECT_OVERHEAD
+#define APP_QSPI_DIRTY_RECT_OVERHEAD        256u     /**< Pixels one more window costs (window commands and DMA restart), two rectangles
+                                                          are merged if their bounding box adds no more pixels than this */
+#endif
+
+/**
+  * @brief Rectangle of the screen, unit: pixel
+  */
+typedef struct {
+    uint16_t    x;                            /**< start column */
+    uint16_t    y;                            /**< start row */
+    uint16_t    w;                            /**< width, 0 means empty */
+    uint16_t    h;                            /**< height, 0 means empty */
+} app_qspi_rect_t;
+
+/**
+  * @brief Dirty region of the screen, the changed rectangles since last refresh
+  */
+typedef struct {
+    app_qspi_rect_t rect[APP_QSPI_DIRTY_RECT_MAX];  /**< disjoint or cheaper-to-send-apart rectangles */
+    uint16_t        rect_num;                       /**< valid rectangles in rect[] */
+    uint16_t        scrn_width;                     /**< screen width, rectangles are clipped to it */
+    uint16_t        scrn_height;                    /**< screen height, rectangles are clipped to it */
+    uint16_t        align;                          /**< window start and size alignment of the panel in pixel, power of 2, such as 2 */
+} app_qspi_dirty_region_t;
+
+/**
+  * @brief Set the column/row address window of the panel, the coordinates are inclusive.
+  *        Implemented by the application with the CASET/RASET commands (or alike) of its panel.
+  */
+typedef uint16_t (*app_qspi_screen_window_set_t)(app_qspi_id_t screen_id, uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end);
+
 /* Exported functions --------------------------------------------------------*/
 /** @addtogroup APP_GRAPHICS_QSPI_DRIVER_FUNCTIONS Functions
   * @{
@@ -212,6 +248,108 @@ SECTION_RAM_CODE uint16_t app_qspi_send_display_frame_simp(app_qspi_id_t screen_
                                      const app_qspi_screen_command_t *const p_screen_cmd,
                                      const app_qspi_screen_info_t *const p_screen_info, const uint8_t * p_buff);
 
+/**
+ ****************************************************************************************
+ * @brief  Init a dirty region to empty.
+ *
+ * @param[out] p_region:    pointer to the dirty region
+ * @param[in]  scrn_width:  screen width in pixel
+ * @param[in]  scrn_height: screen height in pixel
+ * @param[in]  align:       window start and size alignment the panel requires, power of 2, 0 or 1 means none
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_qspi_dirty_region_init(app_qspi_dirty_region_t *p_region, uint16_t scrn_width, uint16_t scrn_height, uint16_t align);
+
+/**
+ ****************************************************************************************
+ * @brief  Add a changed rectangle to the dirty region.
+ *         The rectangle is clipped to the screen and aligned, then merged with every rectangle of the region
+ *         whose bounding box costs no more than sending both apart (see APP_QSPI_DIRTY_RECT_OVERHEAD).
+ *         If the region is full, it is merged with the rectangle growing the least.
+ *
+ * @param[in,out] p_region: pointer to the dirty region
+ * @param[in]     p_rect:   pointer to the changed rectangle
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_qspi_dirty_region_add(app_qspi_dirty_region_t *p_region, const app_qspi_rect_t *p_rect);
+
+/**
+ ****************************************************************************************
+ * @brief  Empty the dirty region.
+ *
+ * @param[in,out] p_region: pointer to the dirty region
+ ****************************************************************************************
+ */
+void app_qspi_dirty_region_clear(app_qspi_dirty_region_t *p_region);
+
+/**
+ ****************************************************************************************
+ * @brief  Build the DMA LLP blocks sending the rows of one rectangle from a frame buffer.
+ *         Rows adjacent in the frame buffer share blocks, rows longer than one block are split.
+ *         Only whole rows are chained, call it again with the updated p_line until it returns 0.
+ *
+ * @param[in]     p_screen_info: pointer to the frame buffer information, stride and depth are used
+ * @param[in]     p_rect:        pointer to the rectangle
+ * @param[in]     p_buff:        pointer to the frame buffer
+ * @param[in]     beat_bytes:    DMA beat size: 1, 2 or 4
+ * @param[in,out] p_line:        first row of the rectangle to chain, updated to the row following the chain
+ * @param[out]    p_block:       LLP blocks to fill
+ * @param[in]     block_num:     number of blocks in p_block
+ *
+ * @return Bytes chained, 0 if no row is left or the first row does not fit.
+ ****************************************************************************************
+ */
+uint32_t app_qspi_dirty_rect_llp_build(const app_qspi_screen_info_t *const p_screen_info, const app_qspi_rect_t *p_rect,
+                                       const uint8_t *p_buff, uint32_t beat_bytes, uint32_t *p_line,
+                                       dma_block_config_t *p_block, uint32_t block_num);
+
+/**
+ ****************************************************************************************
+ * @brief  Send one rectangle of a frame buffer to the screen in dma llp mode, the call returns when it is sent.
+ *         The window is set by set_window, then the pixels are written by leading_address and ongoing_address commands.
+ *         Must enable the micro-defines to enable this API:
+ *         QSPI_DMA_LLP_FEATUTE_SUPPORT
+ *
+ * @param[in]  screen_id:     QSPI module ID for screen
+ * @param[in]  p_screen_cmd:  pointer to the screen pixel write command
+ * @param[in]  p_screen_info: pointer to the frame buffer information
+ * @param[in]  p_buff:        pointer to the frame buffer
+ * @param[in]  p_rect:        pointer to the rectangle
+ * @param[in]  set_window:    callback setting the panel column/row address window
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_qspi_send_display_rect(app_qspi_id_t screen_id,
+                                    const app_qspi_screen_command_t *const p_screen_cmd,
+                                    const app_qspi_screen_info_t *const p_screen_info, const uint8_t * p_buff,
+                                    const app_qspi_rect_t *p_rect, app_qspi_screen_window_set_t set_window);
+
+/**
+ ****************************************************************************************
+ * @brief  Send the dirty region of a frame buffer to the screen, then empty the region.
+ *         Must enable the micro-defines to enable this API:
+ *         QSPI_DMA_LLP_FEATUTE_SUPPORT
+ *
+ * @param[in]     screen_id:     QSPI module ID for screen
+ * @param[in]     p_screen_cmd:  pointer to the screen pixel write command
+ * @param[in]     p_screen_info: pointer to the frame buffer information
+ * @param[in]     p_buff:        pointer to the frame buffer
+ * @param[in,out] p_region:      pointer to the dirty region, kept if sending fails
+ * @param[in]     set_window:    callback setting the panel column/row address window
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_qspi_send_display_dirty(app_qspi_id_t screen_id,
+                                     const app_qspi_screen_command_t *const p_screen_cmd,
+                                     const app_qspi_screen_info_t *const p_screen_info, const uint8_t * p_buff,
+                                     app_qspi_dirty_region_t *p_region, app_qspi_screen_window_set_t set_window);
+
 /**
  ****************************************************************************************
  * @brief  Special API to Blit Image from memory mapped device to RAM Buffer
@@ -67,6 +67,14 @@ extern "C" {
 
 #ifdef HAL_I2C_MODULE_ENABLED
 
+/** @addtogroup APP_I2C_MACRO Defines
+  * @{
+  */
+#ifndef APP_I2C_BATCH_DMA_MIN_SIZE
+#define APP_I2C_BATCH_DMA_MIN_SIZE      8   /**< Batch transactions shorter than it use interrupt mode, DMA setup costs more. */
+#endif
+/** @} */
+
 /** @addtogroup APP_I2C_ENUM Enumerations
   * @{
   */
@@ -197,6 +205,47 @@ typedef void (*app_i2c_evt_handler_t)(app_i2c_evt_t *p_evt);
 /** @addtogroup APP_I2C_STRUCTURES Structures
   * @{
   */
+/**
+  * @brief I2C batch transaction type Enumerations definition
+  */
+typedef enum
+{
+    APP_I2C_XFER_WRITE,                  /**< Write data to device. */
+    APP_I2C_XFER_READ,                   /**< Read data from device. */
+    APP_I2C_XFER_MEM_WRITE,              /**< Write memory address and data to device. */
+    APP_I2C_XFER_MEM_READ,               /**< Write memory address, then read data after repeated start. */
+} app_i2c_xfer_type_t;
+
+/**
+  * @brief I2C batch transaction structure definition
+  */
+typedef struct
+{
+    app_i2c_xfer_type_t type;            /**< Type of transaction. */
+    uint16_t            dev_address;     /**< Target device address. */
+    uint16_t            mem_address;     /**< Memory address, for MEM_WRITE and MEM_READ. */
+    uint16_t            mem_addr_size;   /**< Memory address size, I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT. */
+    uint8_t            *p_data;          /**< Pointer to data buffer. */
+    uint16_t            size;            /**< Amount of data. */
+    uint16_t            result;          /**< Set when done: APP_DRV_SUCCESS, or the error. */
+    uint32_t            latency_us;      /**< Set when done: time from start to completion in us. */
+} app_i2c_xfer_t;
+
+/**
+  * @brief I2C batch structure definition
+  */
+typedef struct app_i2c_batch
+{
+    app_i2c_xfer_t      *p_xfer;                          /**< Transactions, run in order. */
+    uint16_t             xfer_num;                        /**< Number of transactions. */
+    void               (*cplt_cb)(struct app_i2c_batch *p_batch); /**< Called in interrupt when all transactions done. */
+    uint16_t             err_num;                         /**< Set when done: number of failed transactions. */
+    uint16_t             xfer_idx;                        /**< Internal: transaction running. */
+    uint32_t             tick;                            /**< Internal: start tick of transaction running. */
+    uint32_t             demcr_initial;                   /**< Internal: DWT state before batch. */
+    uint32_t             dwt_ctrl_initial;                /**< Internal: DWT state before batch. */
+} app_i2c_batch_t;
+
 /**
   * @brief I2C device structure definition
   */
@@ -211,6 +260,7 @@ typedef struct
     app_i2c_dma_state_t     i2c_dma_state;       /**< I2C dma state types. */
     volatile bool           start_flag;          /**< Start flag definition. */
     uint16_t                slv_dev_addr;        /**< I2C Slave address. */
+    app_i2c_batch_t         *p_batch;            /**< Batch running, NULL if none. */
 } i2c_env_t;
 
 /**
@@ -409,6 +459,27 @@ i2c_handle_t *app_i2c_get_handle(app_i2c_id_t id);
  */
 uint16_t app_i2c_master_abort_it(app_i2c_id_t id);
 
+/**
+ ****************************************************************************************
+ * @brief  Run a batch of master transactions back to back, each one started from the
+ *         completion interrupt of the former one.
+ *
+ * @note   DMA is used for transactions of APP_I2C_BATCH_DMA_MIN_SIZE bytes or more if
+ *         app_i2c_dma_init() configured both channels, interrupt mode otherwise. A failed
+ *         transaction does not stop the batch. No event is reported to evt_handler for
+ *         the transactions, cplt_cb of batch is called once all done, with result and
+ *         latency_us of every transaction set. The batch must be kept until then.
+ *         If no transaction can be started, APP_DRV_ERR_HAL is returned and cplt_cb
+ *         is not called.
+ *
+ * @param[in]  id: which I2C module.
+ * @param[in]  p_batch: Pointer to batch.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_i2c_batch_start(app_i2c_id_t id, app_i2c_batch_t *p_batch);
+
 /**
  ****************************************************************************************
  * @brief  Adjust I2C timing value to adapt to real load.
@@ -64,6 +64,13 @@
   * @brief PWR MAX value for sleep check
   */
 #define APP_SLEEP_CB_MAX     PWR_ID_MAX
+
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+#ifndef APP_PWR_MGMT_PROFILE_HIST_NUM
+#define APP_PWR_MGMT_PROFILE_HIST_NUM    24     /**< Log2 histogram bins, bin n counts [2^n, 2^(n+1)) us, the last one all above. */
+#endif
+#define APP_PWR_MGMT_PROFILE_DEV_NUM     32     /**< Blocker counters, one per bit of the device state. */
+#endif
 /** @} */
 
 /** @addtogroup APP_PWR_ENUMERATIONS Enumerations
@@ -114,6 +121,44 @@ typedef struct
     void (*app_wake_up_ind)(void);          /**< Resume peripherals when chip wakeup. */
 } app_sleep_callbacks_t;
 
+#ifdef APP_PWR_MGMT_STATS_ENABLE
+/**
+  * @brief PWR sleep and wakeup path statistics Structure, in CPU cycles
+  */
+typedef struct
+{
+    uint32_t suspend_count;                 /**< Times devices suspended before sleep. */
+    uint32_t suspend_cycles;                /**< Cycles spent suspending devices. */
+    uint32_t resume_count;                  /**< Times devices resumed after wakeup. */
+    uint32_t resume_cycles;                 /**< Cycles spent resuming devices. */
+} app_pwr_mgmt_stats_t;
+#endif
+
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+/**
+  * @brief PWR sleep residency profile Structure
+  * @note  Blockers are indexed by periph_device_number_t, or by pwr_id_t on GR551x.
+  */
+typedef struct
+{
+    uint32_t attempt_count;                                     /**< Sleep checks done. */
+    uint32_t blocked_count;                                     /**< Sleep checks refused by a busy device. */
+    uint32_t sleep_count;                                       /**< Wakeups from sleep. */
+    uint32_t blocker_count[APP_PWR_MGMT_PROFILE_DEV_NUM];       /**< Refused sleep checks per busy device. */
+    uint64_t sleep_us;                                          /**< Total time asleep. */
+    uint64_t awake_us;                                          /**< Total time awake between two sleeps. */
+    uint32_t sleep_hist[APP_PWR_MGMT_PROFILE_HIST_NUM];         /**< Histogram of time asleep. */
+    uint32_t awake_hist[APP_PWR_MGMT_PROFILE_HIST_NUM];         /**< Histogram of time awake between two sleeps. */
+    uint32_t deadline_hist[APP_PWR_MGMT_PROFILE_HIST_NUM];      /**< Histogram of the next app_timer deadline when going to sleep. */
+    uint32_t no_deadline_count;                                 /**< Sleeps with no app_timer running. */
+} app_pwr_mgmt_profile_t;
+
+/**
+  * @brief Print function for profile dump, e.g. app_log_raw_info or printf.
+  */
+typedef void (*app_pwr_mgmt_print_t)(const char *format, ...);
+#endif
+
 /** @} */
 
 
@@ -161,6 +206,60 @@ void pwr_wake_up_ind(void);
  ****************************************************************************************
  */
 pwr_mgmt_dev_state_t pwr_enter_sleep_check(void);
+
+#ifdef HAL_RECOVER_WHEN_USING
+/**
+ ****************************************************************************************
+ * @brief    Set the devices resumed on wakeup, the others are resumed by HAL on first use.
+ * @param    devices_mask : Bit mask of periph_device_number_t, e.g. the devices used
+ *                          right after every wakeup.
+ ****************************************************************************************
+ */
+void app_pwr_mgmt_eager_resume_set(uint32_t devices_mask);
+#endif
+
+#ifdef APP_PWR_MGMT_STATS_ENABLE
+/**
+ ****************************************************************************************
+ * @brief    Get the time spent in the sleep and wakeup path.
+ * @param    p_stats : Pointer to statistics.
+ ****************************************************************************************
+ */
+void app_pwr_mgmt_stats_get(app_pwr_mgmt_stats_t *p_stats);
+
+/**
+ ****************************************************************************************
+ * @brief    Clear the statistics of the sleep and wakeup path.
+ ****************************************************************************************
+ */
+void app_pwr_mgmt_stats_reset(void);
+#endif
+
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+/**
+ ****************************************************************************************
+ * @brief    Get the sleep residency profile, e.g. to send it by a GATT characteristic.
+ * @param    p_profile : Pointer to profile.
+ ****************************************************************************************
+ */
+void app_pwr_mgmt_profile_get(app_pwr_mgmt_profile_t *p_profile);
+
+/**
+ ****************************************************************************************
+ * @brief    Clear the sleep residency profile.
+ ****************************************************************************************
+ */
+void app_pwr_mgmt_profile_reset(void);
+
+/**
+ ****************************************************************************************
+ * @brief    Print the sleep residency profile as "PWRP," lines, which
+ *           build/tools/pwr_profile_report.py turns into a residency report.
+ * @param    print : Print function, e.g. app_log_raw_info.
+ ****************************************************************************************
+ */
+void app_pwr_mgmt_profile_dump(app_pwr_mgmt_print_t print);
+#endif
 /** @} */
 
 #endif
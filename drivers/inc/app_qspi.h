@@ -95,6 +95,28 @@ extern "C" {
 #define DMA_MAX_XFER_SIZE_ONCE                  (4095u)              /**< max xfer beat in every dma xfer  */
 
 //#define APP_STORAGE_RAM_ID    0xf                  /**< Special ID to handle RAM Source */
+
+#ifndef APP_QSPI_MMAP_CACHE_ENABLE
+#define APP_QSPI_MMAP_CACHE_ENABLE              0u                   /**< Software read cache in front of the mmap read APIs */
+#endif
+
+#if APP_QSPI_MMAP_CACHE_ENABLE
+#ifndef APP_QSPI_MMAP_CACHE_LINE_SIZE
+#define APP_QSPI_MMAP_CACHE_LINE_SIZE           32u                  /**< Bytes per cache line, power of 2, 4 at least */
+#endif
+#ifndef APP_QSPI_MMAP_CACHE_SETS
+#define APP_QSPI_MMAP_CACHE_SETS                16u                  /**< Number of cache sets, power of 2 */
+#endif
+#ifndef APP_QSPI_MMAP_CACHE_WAYS
+#define APP_QSPI_MMAP_CACHE_WAYS                4u                   /**< Lines per set, replaced least recently used first */
+#endif
+#ifndef APP_QSPI_MMAP_CACHE_PREFETCH_LINES
+#define APP_QSPI_MMAP_CACHE_PREFETCH_LINES      2u                   /**< Lines read ahead of sequential misses, 0 to disable, less than APP_QSPI_MMAP_CACHE_SETS */
+#endif
+#ifndef APP_QSPI_MMAP_CACHE_BYPASS_SIZE
+#define APP_QSPI_MMAP_CACHE_BYPASS_SIZE         256u                 /**< Block reads of this length or longer skip the cache */
+#endif
+#endif
 #endif
 
 #ifndef QSPI_SMART_CS_ENABLE
@@ -295,6 +317,19 @@ typedef struct {
     } rd;                                                   /**< Specifies read command by real device */
     void * set;                                             /**< Reserved */
 } app_qspi_mmap_device_t;
+
+#if APP_QSPI_MMAP_CACHE_ENABLE
+/**
+  * @brief QSPI memory-mapped read cache statistics
+  */
+typedef struct {
+    uint32_t hit;                                           /**< Line accesses found in cache */
+    uint32_t miss;                                          /**< Lines read from device on demand */
+    uint32_t prefetch;                                      /**< Lines read ahead from device */
+    uint32_t prefetch_hit;                                  /**< Lines read ahead and used before replaced */
+    uint32_t bypass;                                        /**< Block reads sent to device directly */
+} app_qspi_mmap_cache_stats_t;
+#endif
 #endif
 
 /**
@@ -958,6 +993,54 @@ bool app_qspi_mmap_read_block(app_qspi_id_t id, uint32_t address, uint8_t * buff
  */
 uint32_t app_qspi_get_xip_base_address(app_qspi_id_t id);
 
+#if APP_QSPI_MMAP_CACHE_ENABLE
+/**
+ ****************************************************************************************
+ * @brief  Enable or disable the software read cache of the mmap read APIs for a QSPI module.
+ * @note   The cache is shared by all QSPI modules. Each line lookup runs with interrupts off, for
+ *         the time of up to APP_QSPI_MMAP_CACHE_PREFETCH_LINES + 1 line reads on a miss, so reads
+ *         from interrupts are safe. u8/block reads return bytes in device order, u16/u32 reads the
+ *         same values as without cache. Disabling drops all lines of the module.
+ *
+ * @param[in]  id : QSPI module ID.
+ * @param[in]  enable : true to read through the cache.
+ * @return true/false
+ ****************************************************************************************
+ */
+bool app_qspi_mmap_cache_enable(app_qspi_id_t id, bool enable);
+
+/**
+ ****************************************************************************************
+ * @brief  Check whether the mmap reads of a QSPI module go through the read cache.
+ *
+ * @param[in]  id : QSPI module ID.
+ * @return true/false
+ ****************************************************************************************
+ */
+bool app_qspi_mmap_cache_is_enabled(app_qspi_id_t id);
+
+/**
+ ****************************************************************************************
+ * @brief  Drop the cached lines of a device range, call it after the device was written or erased.
+ *
+ * @param[in]  id : QSPI module ID.
+ * @param[in]  address : the address of device connected to QSPI, start from 0x000000
+ * @param[in]  length  : the length in byte, 0 for the whole device
+ ****************************************************************************************
+ */
+void app_qspi_mmap_cache_invalidate(app_qspi_id_t id, uint32_t address, uint32_t length);
+
+/**
+ ****************************************************************************************
+ * @brief  Get the hit/miss statistics of the mmap read cache.
+ *
+ * @param[out] p_stats : Pointer to the statistics.
+ * @param[in]  reset   : true to clear the statistics after reading.
+ ****************************************************************************************
+ */
+void app_qspi_mmap_cache_stats_get(app_qspi_mmap_cache_stats_t *p_stats, bool reset);
+#endif
+
 #endif
 
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
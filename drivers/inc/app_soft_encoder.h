@@ -61,6 +61,20 @@
 extern "C" {
 #endif
 
+/** @addtogroup APP_SOFT_ENCODER_MACRO Defines
+  * @{
+  */
+#ifndef APP_SOFT_ENCODER_STEPS_PER_COUNT
+#define APP_SOFT_ENCODER_STEPS_PER_COUNT       4       /**< Signal transitions per distance count, 4 for one count per quadrature cycle. */
+#endif
+#ifndef APP_SOFT_ENCODER_VELOCITY_EDGES
+#define APP_SOFT_ENCODER_VELOCITY_EDGES        4       /**< Transitions averaged by the velocity estimation. */
+#endif
+#ifndef APP_SOFT_ENCODER_VELOCITY_TIMEOUT_MS
+#define APP_SOFT_ENCODER_VELOCITY_TIMEOUT_MS   500     /**< Velocity is taken as 0 with no transition for this time. */
+#endif
+/** @} */
+
 /** @addtogroup APP_SOFT_ENCODER_ENUM Enumerations
   * @{
   */
@@ -107,6 +121,11 @@ typedef struct
   */
 typedef void (*app_soft_encoder_callback)(app_soft_encoder_direction_t direction,int distance);
 
+/**
+  * @brief SOFT_ENCODER free running up counting tick, for velocity estimation
+  */
+typedef uint32_t (*app_soft_encoder_tick_get_t)(void);
+
 /** @} */
 
 /* Exported functions --------------------------------------------------------*/
@@ -117,6 +136,13 @@ typedef void (*app_soft_encoder_callback)(app_soft_encoder_direction_t direction
  ****************************************************************************************
  * @brief  Initialize the APP TIM DRIVER according to the specified parameters
  *         in the app_soft_encoder_params_t and app_soft_encoder_evt_handler_t.
+ * @note   Both signals interrupt on both edges and every transition is decoded by table.
+ *         The callback is called once per APP_SOFT_ENCODER_STEPS_PER_COUNT transitions,
+ *         A leading B is positive.
+ * @note   GR551x interrupts on one edge only, so the mode of both signals must be
+ *         APP_IO_MODE_IT_RISING or APP_IO_MODE_IT_FALLING, and the edge decode is kept:
+ *         the callback is called once per quadrature cycle, A leading B is positive with
+ *         rising edges and negative with falling edges. No transition is illegal there.
  *
  * @param[in]  p_params: Pointer to app_soft_encoder_params_t parameter which contains the
  *                       configuration information for the specified SOFT_ENCODER module.
@@ -128,6 +154,40 @@ typedef void (*app_soft_encoder_callback)(app_soft_encoder_direction_t direction
 uint16_t app_soft_encoder_init(app_soft_encoder_io_param_t *p_a_params,
                                app_soft_encoder_io_param_t *p_b_params,
                                app_soft_encoder_callback    evt_handler);
+
+/**
+ ****************************************************************************************
+ * @brief  Get the number of transitions with both signals changed, i.e. missed transitions.
+ *
+ * @return Number of illegal transitions since initialization.
+ ****************************************************************************************
+ */
+uint32_t app_soft_encoder_illegal_count_get(void);
+
+/**
+ ****************************************************************************************
+ * @brief  Enable velocity and acceleration estimation from the transition periods.
+ *
+ * @param[in]  tick_get: Free running up counting 32-bit tick of a hardware timer, e.g. DWT
+ *                       cycle counter, or NULL to disable the estimation.
+ * @param[in]  tick_freq_hz: Tick frequency.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_soft_encoder_velocity_enable(app_soft_encoder_tick_get_t tick_get, uint32_t tick_freq_hz);
+
+/**
+ ****************************************************************************************
+ * @brief  Get the estimated velocity and acceleration.
+ *
+ * @param[out] p_velocity: Velocity in counts per second, negative in reverse.
+ * @param[out] p_acceleration: Acceleration in counts per second squared.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_soft_encoder_velocity_get(float *p_velocity, float *p_acceleration);
 /** @} */
 
 #endif
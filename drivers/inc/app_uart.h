@@ -68,7 +68,9 @@ extern "C" {
   * @{
   */
 
-#define TX_ONCE_MAX_SIZE     128                 /**< UART max bytes size transmitted at one time */
+#ifndef TX_ONCE_MAX_SIZE
+#define TX_ONCE_MAX_SIZE     128                 /**< UART max bytes size transmitted at one time, queued writes are coalesced up to it */
+#endif
 
 /** @} */
 
@@ -105,6 +107,10 @@ typedef enum
     APP_UART_EVT_ABORT_TX,             /**< Requested TX abort completed. */
     APP_UART_EVT_ABORT_RX,             /**< Requested RX abort completed. */
     APP_UART_EVT_ABORT_TXRX,           /**< Requested TX, RX abort completed. */
+    APP_UART_EVT_RX_HALF,              /**< RX ring filled up to its half. */
+    APP_UART_EVT_RX_FULL,              /**< RX ring filled up to its end and wrapped. */
+    APP_UART_EVT_RX_IDLE,              /**< RX line idle after data received into RX ring. */
+    APP_UART_EVT_RX_OVERFLOW,          /**< RX ring has no space, receiving paused until data released. */
 } app_uart_evt_type_t;
 
 /**@brief App uart state types. */
@@ -184,7 +190,7 @@ typedef struct
     union
     {
         uint32_t error_code;            /**< UART Error code . */
-        uint16_t size;                  /**< UART transmitted/received counter. */
+        uint16_t size;                  /**< UART transmitted/received counter, or data count in RX ring for RX ring events. */
     } data;                             /**< Data of event. */
 } app_uart_evt_t;
 
@@ -224,6 +230,10 @@ typedef struct
     bool                   tx_abort_flag;                      /**< tx abort flag.  */
     bool                   rx_abort_flag;                      /**< rx abort flag.  */
     bool                   is_dma_tx_mode;                     /**< dma tx mode.  */
+    ring_buffer_t          *p_rx_ring;                         /**< RX ring filled by DMA, NULL if not running.  */
+    uint16_t               rx_dma_len;                         /**< Length of RX ring DMA chunk, 0 if paused.  */
+    uint16_t               rx_dma_committed;                   /**< Data of RX ring DMA chunk already committed.  */
+    bool                   rx_idle_pending;                    /**< Data received since last RX idle event.  */
 } uart_env_t;
 
 /**
@@ -238,6 +248,15 @@ typedef struct
     uart_env_t         uart_dev;       /**< UART event data.                                                 */
 } app_uart_params_t;
 
+/**
+  * @brief UART transmit segment structure definition
+  */
+typedef struct
+{
+    uint8_t  *p_data;      /**< Pointer to the segment data. */
+    uint16_t  size;        /**< Size of the segment. */
+} app_uart_iovec_t;
+
 /**
   * @brief UART buffer structure definition
   */
@@ -283,6 +302,10 @@ uint16_t app_uart_deinit(app_uart_id_t id);
  ****************************************************************************************
  * @brief  Send an amount of data in interrupt mode.
  *
+ * @note   Data is copied to TX buffer and queued behind the data already there, so
+ *         the call succeeds while a transfer is ongoing. If TX buffer has not enough
+ *         space, nothing is queued and APP_DRV_ERR_BUSY is returned.
+ *
  * @param[in]  id: which UART module want to receive.
  * @param[in]  p_data: Pointer to data buffer
  * @param[in]  size: Amount of data to be sent
@@ -292,6 +315,23 @@ uint16_t app_uart_deinit(app_uart_id_t id);
  */
 uint16_t app_uart_transmit_async(app_uart_id_t id, uint8_t *p_data, uint16_t size);
 
+/**
+ ****************************************************************************************
+ * @brief  Send several data segments in interrupt mode.
+ *
+ * @note   All segments are queued at once and back to back, or none of them if TX buffer
+ *         has not enough space. Adjacent segments are sent in one transfer of up to
+ *         TX_ONCE_MAX_SIZE bytes, the next transfer is started from TX complete interrupt.
+ *
+ * @param[in]  id: which UART module want to send.
+ * @param[in]  p_iov: Pointer to segments.
+ * @param[in]  iov_cnt: Number of segments.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_uart_transmit_vec_async(app_uart_id_t id, const app_uart_iovec_t *p_iov, uint16_t iov_cnt);
+
 /**
  ****************************************************************************************
  * @brief  Send an amount of data in blocking mode.
@@ -108,6 +108,8 @@ uint16_t app_uart_dma_receive_async(app_uart_id_t id, uint8_t *p_data, uint16_t
  ****************************************************************************************
  * @brief  Send an amount of data in dma mode.
  *
+ * @note   Data is queued as by app_uart_transmit_async(), and sent by DMA.
+ *
  * @param[in]  id: which UART module want to send.
  * @param[in]  p_data: Pointer to data buffer.
  * @param[in]  size: Amount of data to be sent.
@@ -117,6 +119,81 @@ uint16_t app_uart_dma_receive_async(app_uart_id_t id, uint8_t *p_data, uint16_t
  */
 uint16_t app_uart_dma_transmit_async(app_uart_id_t id, uint8_t *p_data, uint16_t size);
 
+/**
+ ****************************************************************************************
+ * @brief  Send several data segments in dma mode.
+ *
+ * @note   All segments are queued at once and back to back, or none of them if TX buffer
+ *         has not enough space. Adjacent segments are sent in one DMA transfer of up to
+ *         TX_ONCE_MAX_SIZE bytes, the next transfer is started from TX complete interrupt.
+ *
+ * @param[in]  id: which UART module want to send.
+ * @param[in]  p_iov: Pointer to segments.
+ * @param[in]  iov_cnt: Number of segments.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_uart_dma_transmit_vec_async(app_uart_id_t id, const app_uart_iovec_t *p_iov, uint16_t iov_cnt);
+
+/**
+ ****************************************************************************************
+ * @brief  Start receiving continuously into a ring buffer in dma mode.
+ *
+ * @note   DMA fills the ring in chunks ending at its half and its end, the next chunk is
+ *         started from RX complete interrupt. APP_UART_EVT_RX_HALF and APP_UART_EVT_RX_FULL
+ *         are reported when the ring fills up to these points, APP_UART_EVT_RX_IDLE is
+ *         reported by @ref app_uart_dma_rx_ring_poll. Data is read in place with
+ *         ring_buffer_read_span_get() and given back with @ref app_uart_dma_rx_ring_release.
+ *         If the ring has no space, APP_UART_EVT_RX_OVERFLOW is reported and receiving
+ *         pauses until data is released. A reception error keeps the data received so far
+ *         and starts the next chunk before APP_UART_EVT_ERROR is reported.
+ *
+ * @param[in]  id:     which UART module want to receive.
+ * @param[in]  p_ring: Pointer to ring buffer initialized by user, its size no more than 2 * 0xFFF.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_uart_dma_rx_ring_start(app_uart_id_t id, ring_buffer_t *p_ring);
+
+/**
+ ****************************************************************************************
+ * @brief  Make data received so far by RX ring DMA readable, and report APP_UART_EVT_RX_IDLE
+ *         if no data arrived since the former call but some since the last idle event.
+ *
+ * @note   Call it periodically, e.g. from an app_timer, the period is the idle detection time.
+ *
+ * @param[in]  id: which UART module.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_uart_dma_rx_ring_poll(app_uart_id_t id);
+
+/**
+ ****************************************************************************************
+ * @brief  Give back data read in place from RX ring, restart receiving if paused.
+ *
+ * @param[in]  id:     which UART module.
+ * @param[in]  length: Length of data consumed.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_uart_dma_rx_ring_release(app_uart_id_t id, uint32_t length);
+
+/**
+ ****************************************************************************************
+ * @brief  Stop receiving into RX ring, the data received so far is kept readable.
+ *
+ * @param[in]  id: which UART module.
+ *
+ * @return Result of operation.
+ ****************************************************************************************
+ */
+uint16_t app_uart_dma_rx_ring_stop(app_uart_id_t id);
+
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X)
 /**
  ****************************************************************************************
@@ -46,6 +46,16 @@
 
 #ifdef HAL_ADC_MODULE_ENABLED
 
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define ADC_STREAM_HALF_MAX         4095    /**< Codes of one DMA conversion. */
+#define ADC_CONV_PROBE_LOW          1024    /**< Codes used to get conversion coefficients. */
+#define ADC_CONV_PROBE_HIGH         3072
+#define ADC_CONV_PROBE_MID          2048    /**< Code used to check the conversion is linear. */
+#define ADC_CONV_LINEAR_TOL         0.00001 /**< Deviation in volt allowed at ADC_CONV_PROBE_MID. */
+
 /*
  * LOCAL FUNCTION DECLARATION
  *****************************************************************************************
@@ -193,6 +203,7 @@ uint16_t app_adc_init(app_adc_params_t *p_params, app_adc_evt_handler_t evt_hand
     HAL_ERR_CODE_CHECK(hal_err_code);
 
     pwr_register_sleep_cb(&adc_sleep_cb, APP_DRIVER_ADC_WAKEUP_PRIORITY, ADC_PWR_ID);
+    p_adc_env->p_stream_buf = NULL;
     p_adc_env->adc_state = APP_ADC_ACTIVITY;
 
     return APP_DRV_SUCCESS;
@@ -315,6 +326,72 @@ uint16_t app_adc_conversion_async(uint16_t *p_data, uint32_t length)
     return APP_DRV_SUCCESS;
 }
 
+uint16_t app_adc_stream_start(uint16_t *p_buf, uint32_t length)
+{
+    hal_status_t err_code;
+
+    if ((p_adc_env == NULL) || (p_adc_env->adc_state == APP_ADC_INVALID))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if ((p_buf == NULL) || ((uint32_t)p_buf & 0x3) || (length == 0) || (length & 0x3) ||
+        ((length >> 1) > ADC_STREAM_HALF_MAX))
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    if (p_adc_env->adc_dma_state == APP_ADC_DMA_INVALID)
+    {
+        return APP_DRV_ERR_INVALID_MODE;
+    }
+
+#ifdef APP_DRIVER_WAKEUP_CALL_FUN
+    adc_wake_up();
+#endif
+
+    if (HAL_ADC_STATE_READY != hal_adc_get_state(&p_adc_env->handle))
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    p_adc_env->p_stream_buf    = p_buf;
+    p_adc_env->stream_half_len = length >> 1;
+    p_adc_env->stream_fill_idx = 0;
+
+    err_code = hal_adc_start_dma(&p_adc_env->handle, p_buf, p_adc_env->stream_half_len);
+    if (err_code != HAL_OK)
+    {
+        p_adc_env->p_stream_buf = NULL;
+    }
+    HAL_ERR_CODE_CHECK(err_code);
+
+    return APP_DRV_SUCCESS;
+}
+
+uint16_t app_adc_stream_stop(void)
+{
+    hal_status_t err_code;
+
+    if ((p_adc_env == NULL) || (p_adc_env->adc_state == APP_ADC_INVALID))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if (p_adc_env->p_stream_buf == NULL)
+    {
+        return APP_DRV_SUCCESS;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    p_adc_env->p_stream_buf = NULL;
+    err_code = hal_adc_stop_dma(&p_adc_env->handle);
+    GLOBAL_EXCEPTION_ENABLE();
+    HAL_ERR_CODE_CHECK(err_code);
+
+    return APP_DRV_SUCCESS;
+}
+
 uint16_t app_adc_multi_channel_conversion_async(app_adc_sample_node_t *p_begin_node, uint32_t total_nodes)
 {
     hal_status_t err_code;
@@ -463,6 +540,90 @@ uint16_t app_adc_vbat_conv(uint16_t *inbuf, double *outbuf, uint32_t buflen)
 }
 #endif
 
+uint16_t app_adc_conv_coef_get(double ref, app_adc_conv_coef_t *p_coef)
+{
+    uint16_t code[3] = { ADC_CONV_PROBE_LOW, ADC_CONV_PROBE_HIGH, ADC_CONV_PROBE_MID };
+    double   volt[3];
+    double   gain;
+    double   offset;
+    double   deviation;
+
+    if ((p_adc_env == NULL) || (p_adc_env->adc_state == APP_ADC_INVALID))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if (p_coef == NULL)
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    /* The conversion is linear, two codes give its gain and offset with the trim data applied,
+       the third one checks that the HAL still agrees with the line. */
+    if (ref == 0)
+    {
+        hal_adc_voltage_intern(&p_adc_env->handle, code, volt, 3);
+    }
+    else
+    {
+        hal_adc_voltage_extern(&p_adc_env->handle, ref, code, volt, 3);
+    }
+
+    gain   = (volt[1] - volt[0]) / (ADC_CONV_PROBE_HIGH - ADC_CONV_PROBE_LOW);
+    offset = volt[0] - gain * ADC_CONV_PROBE_LOW;
+
+    deviation = volt[2] - (gain * ADC_CONV_PROBE_MID + offset);
+    if ((deviation > ADC_CONV_LINEAR_TOL) || (deviation < -ADC_CONV_LINEAR_TOL))
+    {
+        return APP_DRV_ERR_HAL;
+    }
+
+    p_coef->gain      = (float)gain;
+    p_coef->offset    = (float)offset;
+    p_coef->gain_q16  = (int32_t)(gain * 1000000.0 * 65536.0 + (gain < 0 ? -0.5 : 0.5));
+    p_coef->offset_uv = (int32_t)(offset * 1000000.0 + (offset < 0 ? -0.5 : 0.5));
+
+    return APP_DRV_SUCCESS;
+}
+
+void app_adc_conv_f32(const app_adc_conv_coef_t *p_coef, const uint16_t *p_in, float *p_out, uint32_t length)
+{
+    float    gain   = p_coef->gain;
+    float    offset = p_coef->offset;
+    uint32_t i      = 0;
+
+    for (; i + 4 <= length; i += 4)
+    {
+        p_out[i]     = (float)p_in[i]     * gain + offset;
+        p_out[i + 1] = (float)p_in[i + 1] * gain + offset;
+        p_out[i + 2] = (float)p_in[i + 2] * gain + offset;
+        p_out[i + 3] = (float)p_in[i + 3] * gain + offset;
+    }
+
+    for (; i < length; i++)
+    {
+        p_out[i] = (float)p_in[i] * gain + offset;
+    }
+}
+
+void app_adc_conv_uv(const app_adc_conv_coef_t *p_coef, const uint16_t *p_in, int32_t *p_out, uint32_t length)
+{
+    int32_t  gain_q16  = p_coef->gain_q16;
+    int32_t  offset_uv = p_coef->offset_uv;
+    uint32_t i         = 0;
+
+    for (; i + 2 <= length; i += 2)
+    {
+        p_out[i]     = (int32_t)(((int64_t)p_in[i]     * gain_q16 + 0x8000) >> 16) + offset_uv;
+        p_out[i + 1] = (int32_t)(((int64_t)p_in[i + 1] * gain_q16 + 0x8000) >> 16) + offset_uv;
+    }
+
+    for (; i < length; i++)
+    {
+        p_out[i] = (int32_t)(((int64_t)p_in[i] * gain_q16 + 0x8000) >> 16) + offset_uv;
+    }
+}
+
 adc_handle_t *app_adc_get_handle(void)
 {
     if ((p_adc_env == NULL) || (p_adc_env->adc_state == APP_ADC_INVALID))
@@ -481,6 +642,45 @@ void hal_adc_conv_cplt_callback(adc_handle_t *p_adc)
 {
     app_adc_evt_t evt;
 
+    if (p_adc_env->p_stream_buf != NULL)
+    {
+        uint32_t filled_idx = p_adc_env->stream_fill_idx;
+
+        evt.p_data = p_adc_env->p_stream_buf + filled_idx * p_adc_env->stream_half_len;
+        evt.length = p_adc_env->stream_half_len;
+
+        /* Go on into the other half first, the handler may take long. */
+        p_adc_env->stream_fill_idx = filled_idx ^ 1;
+        hal_status_t hal_status = hal_adc_start_dma(&p_adc_env->handle,
+                                                    p_adc_env->p_stream_buf + p_adc_env->stream_fill_idx * p_adc_env->stream_half_len,
+                                                    p_adc_env->stream_half_len);
+        if (HAL_OK != hal_status)
+        {
+            /* The stream can not go on, end it. The filled half is still reported. */
+            p_adc_env->p_stream_buf    = NULL;
+            p_adc_env->stream_fill_idx = 0;
+            hal_adc_stop_dma(&p_adc_env->handle);
+        }
+
+        evt.type = APP_ADC_EVT_STREAM_DATA;
+        if (p_adc_env->evt_handler != NULL)
+        {
+            p_adc_env->evt_handler(&evt);
+        }
+
+        if (HAL_OK != hal_status)
+        {
+            evt.type   = APP_ADC_EVT_STREAM_ERROR;
+            evt.p_data = NULL;
+            evt.length = 0;
+            if (p_adc_env->evt_handler != NULL)
+            {
+                p_adc_env->evt_handler(&evt);
+            }
+        }
+        return;
+    }
+
     if(p_adc_env->multi_channel > 0)
     {
         p_adc_env->multi_channel--;
@@ -55,12 +55,40 @@
 #define DMA_HANDLE_MAX            12
 #endif
 
+#define DMA_MEMCPY_CPU_ONLY       0xFFFFFFFF
+#define DMA_MEMCPY_CALIB_MIN      16
+#define DMA_MEMCPY_CALIB_ROUNDS   4
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+typedef struct
+{
+    dma_id_t                dma_id;
+    uint32_t                threshold;
+    uint32_t                set_threshold;
+    uint32_t                width_shift;
+    uint32_t                src_increment;
+    uint32_t                pattern;
+    volatile bool           is_busy;
+    volatile uint16_t       result;
+    app_dma_memcpy_cb_t     cb;
+} dma_memcpy_env_t;
+
 /*
  * LOCAL FUNCTION DECLARATION
  *****************************************************************************************
  */
 static bool dma_prepare_for_sleep(void);
 static void dma_wake_up_ind(void);
+static void dma_xfer_advance(dma_env_t *p_env, uint32_t block_length);
+static void dma_memcpy_evt_handler(app_dma_evt_type_t type);
+static void dma_memcpy_cpu(uint8_t *p_dst, const uint8_t *p_src, uint32_t length);
+static bool dma_memcpy_acquire(void);
+static uint16_t dma_memcpy_start(void *p_dst, const void *p_src, uint32_t src_increment, uint32_t length, app_dma_memcpy_cb_t cb);
+static uint32_t dma_memcpy_threshold_calc(const uint32_t size[2], const uint32_t cpu_cycles[2], const uint32_t dma_cycles[2]);
+static void dma_memcpy_calibrate(void);
 
 /*
  * LOCAL VARIABLE DEFINITIONS
@@ -68,6 +96,16 @@ static void dma_wake_up_ind(void);
  */
 dma_env_t s_dma_env[DMA_HANDLE_MAX];
 
+static dma_memcpy_env_t s_dma_memcpy_env =
+{
+    .dma_id        = -1,
+    .threshold     = DMA_MEMCPY_CPU_ONLY,
+    .set_threshold = DMA_MEMCPY_CPU_ONLY,
+    .width_shift   = 0,
+    .src_increment = DMA_SRC_INCREMENT,
+    .is_busy       = false,
+};
+
 static const app_sleep_callbacks_t dma_sleep_cb =
 {
     .app_prepare_for_sleep  = dma_prepare_for_sleep,
@@ -197,6 +235,243 @@ SECTION_RAM_CODE static void dma_wake_up_ind(void)
 #endif
 }
 
+static void dma_xfer_advance(dma_env_t *p_env, uint32_t block_length)
+{
+    uint32_t block_size = block_length;
+
+    if (DMA_SDATAALIGN_HALFWORD == p_env->handle.init.src_data_alignment)
+    {
+        block_size <<= 1;
+    }
+    else if (DMA_SDATAALIGN_WORD == p_env->handle.init.src_data_alignment)
+    {
+        block_size <<= 2;
+    }
+
+    if (DMA_SRC_INCREMENT == p_env->handle.init.src_increment)
+    {
+        p_env->xfer_src += block_size;
+    }
+    else if (DMA_SRC_DECREMENT == p_env->handle.init.src_increment)
+    {
+        p_env->xfer_src -= block_size;
+    }
+
+    if (DMA_DST_INCREMENT == p_env->handle.init.dst_increment)
+    {
+        p_env->xfer_dst += block_size;
+    }
+    else if (DMA_DST_DECREMENT == p_env->handle.init.dst_increment)
+    {
+        p_env->xfer_dst -= block_size;
+    }
+}
+
+static void dma_memcpy_evt_handler(app_dma_evt_type_t type)
+{
+    app_dma_memcpy_cb_t cb = s_dma_memcpy_env.cb;
+
+    if (APP_DMA_EVT_BLK == type)
+    {
+        return;
+    }
+
+    s_dma_memcpy_env.result  = (APP_DMA_EVT_TFR == type) ? APP_DRV_SUCCESS : APP_DRV_ERR_HAL;
+    s_dma_memcpy_env.cb      = NULL;
+    s_dma_memcpy_env.is_busy = false;
+
+    if (NULL != cb)
+    {
+        cb(s_dma_memcpy_env.result);
+    }
+}
+
+static void dma_memcpy_cpu(uint8_t *p_dst, const uint8_t *p_src, uint32_t length)
+{
+    uint32_t       *p_dst_word;
+    const uint32_t *p_src_word;
+
+    /* Word copy needs both addresses at the same offset in a word. */
+    if (0 == (((uint32_t)p_dst ^ (uint32_t)p_src) & 0x3))
+    {
+        while ((length > 0) && ((uint32_t)p_dst & 0x3))
+        {
+            *p_dst++ = *p_src++;
+            length--;
+        }
+
+        p_dst_word = (uint32_t *)p_dst;
+        p_src_word = (const uint32_t *)p_src;
+        while (length >= 16)
+        {
+            p_dst_word[0] = p_src_word[0];
+            p_dst_word[1] = p_src_word[1];
+            p_dst_word[2] = p_src_word[2];
+            p_dst_word[3] = p_src_word[3];
+            p_dst_word += 4;
+            p_src_word += 4;
+            length     -= 16;
+        }
+        while (length >= 4)
+        {
+            *p_dst_word++ = *p_src_word++;
+            length       -= 4;
+        }
+        p_dst = (uint8_t *)p_dst_word;
+        p_src = (const uint8_t *)p_src_word;
+    }
+
+    while (length > 0)
+    {
+        *p_dst++ = *p_src++;
+        length--;
+    }
+}
+
+static bool dma_memcpy_acquire(void)
+{
+    bool acquired = false;
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if ((s_dma_memcpy_env.dma_id >= 0) && !s_dma_memcpy_env.is_busy)
+    {
+        s_dma_memcpy_env.is_busy = true;
+        acquired = true;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return acquired;
+}
+
+static uint16_t dma_memcpy_start(void *p_dst, const void *p_src, uint32_t src_increment, uint32_t length, app_dma_memcpy_cb_t cb)
+{
+    dma_handle_t *p_handle = &s_dma_env[s_dma_memcpy_env.dma_id].handle;
+    uint32_t      addr_bits = (uint32_t)p_dst | (uint32_t)p_src | length;
+    uint32_t      width_shift = 0;
+    uint16_t      ret;
+
+    /* The widest beat all of the addresses and the length are aligned to. */
+    if (0 == (addr_bits & 0x3))
+    {
+        width_shift = 2;
+    }
+    else if (0 == (addr_bits & 0x1))
+    {
+        width_shift = 1;
+    }
+
+    if ((width_shift != s_dma_memcpy_env.width_shift) || (src_increment != s_dma_memcpy_env.src_increment))
+    {
+        p_handle->init.src_increment      = src_increment;
+        p_handle->init.src_data_alignment = (2 == width_shift) ? DMA_SDATAALIGN_WORD :
+                                            (1 == width_shift) ? DMA_SDATAALIGN_HALFWORD : DMA_SDATAALIGN_BYTE;
+        p_handle->init.dst_data_alignment = (2 == width_shift) ? DMA_DDATAALIGN_WORD :
+                                            (1 == width_shift) ? DMA_DDATAALIGN_HALFWORD : DMA_DDATAALIGN_BYTE;
+        if (HAL_OK != hal_dma_init(p_handle))
+        {
+            return APP_DRV_ERR_HAL;
+        }
+        s_dma_memcpy_env.width_shift   = width_shift;
+        s_dma_memcpy_env.src_increment = src_increment;
+    }
+
+    s_dma_memcpy_env.cb = cb;
+    ret = app_dma_start(s_dma_memcpy_env.dma_id, (uint32_t)p_src, (uint32_t)p_dst, length >> width_shift);
+    if (APP_DRV_SUCCESS != ret)
+    {
+        s_dma_memcpy_env.cb = NULL;
+    }
+
+    return ret;
+}
+
+static uint32_t dma_memcpy_threshold_calc(const uint32_t size[2], const uint32_t cpu_cycles[2], const uint32_t dma_cycles[2])
+{
+    int32_t diff[2];
+
+    if ((DMA_MEMCPY_CPU_ONLY == dma_cycles[0]) || (DMA_MEMCPY_CPU_ONLY == dma_cycles[1]))
+    {
+        return DMA_MEMCPY_CPU_ONLY;
+    }
+
+    /* Both costs grow linearly with the size, DMA is used from where the lines cross. */
+    diff[0] = (int32_t)(dma_cycles[0] - cpu_cycles[0]);
+    diff[1] = (int32_t)(dma_cycles[1] - cpu_cycles[1]);
+    if (diff[0] <= 0)
+    {
+        return size[0];
+    }
+    if (diff[1] >= diff[0])
+    {
+        return DMA_MEMCPY_CPU_ONLY;
+    }
+
+    return size[0] + (uint32_t)diff[0] * (size[1] - size[0]) / (uint32_t)(diff[0] - diff[1]);
+}
+
+static void dma_memcpy_calibrate(void)
+{
+    uint32_t buf[APP_DMA_MEMCPY_CALIB_SIZE / 2];
+    uint8_t *p_src = (uint8_t *)buf;
+    uint8_t *p_dst = (uint8_t *)buf + APP_DMA_MEMCPY_CALIB_SIZE;
+    const uint32_t size[2] = {DMA_MEMCPY_CALIB_MIN, APP_DMA_MEMCPY_CALIB_SIZE};
+    uint32_t cpu_cycles[2][2];
+    uint32_t dma_cycles[2][2];
+    uint32_t tick;
+    uint32_t cycles;
+    uint32_t op;
+    uint32_t i;
+    uint32_t round;
+
+    memset(buf, 0x5A, sizeof(buf));
+    s_dma_memcpy_env.pattern = 0xA5A5A5A5;
+
+    /* op 0 times copies, op 1 times fills from the fixed pattern word. */
+    HAL_TIMEOUT_INIT();
+    for (op = 0; op < 2; op++)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            cpu_cycles[op][i] = DMA_MEMCPY_CPU_ONLY;
+            dma_cycles[op][i] = DMA_MEMCPY_CPU_ONLY;
+
+            for (round = 0; round < DMA_MEMCPY_CALIB_ROUNDS; round++)
+            {
+                tick = HAL_TIMEOUT_GET_TICK();
+                if (0 == op)
+                {
+                    dma_memcpy_cpu(p_dst, p_src, size[i]);
+                }
+                else
+                {
+                    memset(p_dst, 0xA5, size[i]);
+                }
+                cycles = HAL_TIMEOUT_GET_TICK() - tick;
+                cpu_cycles[op][i] = cycles < cpu_cycles[op][i] ? cycles : cpu_cycles[op][i];
+
+                if (!dma_memcpy_acquire())
+                {
+                    continue;
+                }
+                tick = HAL_TIMEOUT_GET_TICK();
+                if (APP_DRV_SUCCESS != dma_memcpy_start(p_dst, (0 == op) ? p_src : (const void *)&s_dma_memcpy_env.pattern,
+                                                        (0 == op) ? DMA_SRC_INCREMENT : DMA_SRC_NO_CHANGE, size[i], NULL))
+                {
+                    s_dma_memcpy_env.is_busy = false;
+                    continue;
+                }
+                while (s_dma_memcpy_env.is_busy);
+                cycles = HAL_TIMEOUT_GET_TICK() - tick;
+                dma_cycles[op][i] = cycles < dma_cycles[op][i] ? cycles : dma_cycles[op][i];
+            }
+        }
+    }
+    HAL_TIMEOUT_DEINIT();
+
+    s_dma_memcpy_env.threshold     = dma_memcpy_threshold_calc(size, cpu_cycles[0], dma_cycles[0]);
+    s_dma_memcpy_env.set_threshold = dma_memcpy_threshold_calc(size, cpu_cycles[1], dma_cycles[1]);
+}
+
 #ifdef APP_DRIVER_WAKEUP_CALL_FUN
 void dma_wake_up(dma_id_t id)
 {
@@ -258,6 +533,28 @@ void dma_tfr_callback(struct _dma_handle *hdma)
 #endif
         )
         {
+            if (s_dma_env[i].xfer_remain > 0)
+            {
+                uint32_t src_address  = s_dma_env[i].xfer_src;
+                uint32_t dst_address  = s_dma_env[i].xfer_dst;
+                uint32_t block_length = s_dma_env[i].xfer_remain > APP_DMA_BLOCK_MAX_LENGTH ?
+                                        APP_DMA_BLOCK_MAX_LENGTH : s_dma_env[i].xfer_remain;
+
+                s_dma_env[i].xfer_remain -= block_length;
+                dma_xfer_advance(&s_dma_env[i], block_length);
+                if (HAL_OK == hal_dma_start_it(&s_dma_env[i].handle, src_address, dst_address, block_length))
+                {
+                    break;
+                }
+
+                s_dma_env[i].xfer_remain = 0;
+                if(NULL != s_dma_env[i].evt_handler)
+                {
+                    s_dma_env[i].evt_handler(APP_DMA_EVT_ERROR);
+                }
+                break;
+            }
+
             if(NULL != s_dma_env[i].evt_handler)
             {
                 s_dma_env[i].evt_handler(APP_DMA_EVT_TFR);
@@ -281,6 +578,7 @@ void dma_err_callback(struct _dma_handle * hdma)
         )
 
         {
+            s_dma_env[i].xfer_remain = 0;
             if(NULL != s_dma_env[i].evt_handler)
             {
                 s_dma_env[i].evt_handler(APP_DMA_EVT_ERROR);
@@ -487,6 +785,7 @@ dma_handle_t *app_dma_get_handle(dma_id_t id)
 uint16_t app_dma_start(dma_id_t id, uint32_t src_address, uint32_t dst_address, uint32_t data_length)
 {
     hal_status_t status = HAL_ERROR;
+    uint32_t block_length;
 
     if ((id < 0) || (id >= DMA_HANDLE_MAX))
     {
@@ -498,7 +797,7 @@ uint16_t app_dma_start(dma_id_t id, uint32_t src_address, uint32_t dst_address,
         return APP_DRV_ERR_NOT_INIT;
     }
 
-    if ((data_length < 1) || (data_length > 0xFFF))
+    if (data_length < 1)
     {
         return APP_DRV_ERR_INVALID_PARAM;
     }
@@ -507,9 +806,21 @@ uint16_t app_dma_start(dma_id_t id, uint32_t src_address, uint32_t dst_address,
     dma_wake_up(id);
 #endif
 
-    status = hal_dma_start_it(&s_dma_env[id].handle, src_address, dst_address, data_length);
+    if (HAL_DMA_STATE_BUSY == s_dma_env[id].handle.state)
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    block_length = data_length > APP_DMA_BLOCK_MAX_LENGTH ? APP_DMA_BLOCK_MAX_LENGTH : data_length;
+    s_dma_env[id].xfer_src    = src_address;
+    s_dma_env[id].xfer_dst    = dst_address;
+    s_dma_env[id].xfer_remain = data_length - block_length;
+    dma_xfer_advance(&s_dma_env[id], block_length);
+
+    status = hal_dma_start_it(&s_dma_env[id].handle, src_address, dst_address, block_length);
     if (HAL_OK != status)
     {
+        s_dma_env[id].xfer_remain = 0;
         return (uint16_t)status;
     }
 
@@ -550,3 +861,177 @@ uint16_t app_dma_start_sg_llp(dma_id_t id, uint32_t src_address, uint32_t dst_ad
 }
 #endif
 
+uint16_t app_dma_memcpy_init(dma_regs_t *p_instance, dma_channel_t channel)
+{
+    app_dma_params_t dma_params = { 0 };
+
+    if (s_dma_memcpy_env.dma_id >= 0)
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    dma_params.p_instance               = p_instance;
+    dma_params.channel_number           = channel;
+    dma_params.init.direction           = DMA_MEMORY_TO_MEMORY;
+    dma_params.init.src_increment       = DMA_SRC_INCREMENT;
+    dma_params.init.dst_increment       = DMA_DST_INCREMENT;
+    dma_params.init.src_data_alignment  = DMA_SDATAALIGN_BYTE;
+    dma_params.init.dst_data_alignment  = DMA_DDATAALIGN_BYTE;
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    dma_params.init.mode                = DMA_NORMAL;
+#endif
+    dma_params.init.priority            = DMA_PRIORITY_LOW;
+
+    s_dma_memcpy_env.dma_id = app_dma_init(&dma_params, dma_memcpy_evt_handler);
+    if (s_dma_memcpy_env.dma_id < 0)
+    {
+        s_dma_memcpy_env.dma_id = -1;
+        return APP_DRV_ERR_HAL;
+    }
+    s_dma_memcpy_env.width_shift   = 0;
+    s_dma_memcpy_env.src_increment = DMA_SRC_INCREMENT;
+    s_dma_memcpy_env.is_busy       = false;
+    s_dma_memcpy_env.cb            = NULL;
+
+    dma_memcpy_calibrate();
+
+    return APP_DRV_SUCCESS;
+}
+
+uint16_t app_dma_memcpy_deinit(void)
+{
+    dma_id_t id = s_dma_memcpy_env.dma_id;
+
+    if (id < 0)
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if (!dma_memcpy_acquire())
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    s_dma_memcpy_env.dma_id        = -1;
+    s_dma_memcpy_env.threshold     = DMA_MEMCPY_CPU_ONLY;
+    s_dma_memcpy_env.set_threshold = DMA_MEMCPY_CPU_ONLY;
+    s_dma_memcpy_env.is_busy       = false;
+
+    return app_dma_deinit(id);
+}
+
+uint16_t app_dma_memcpy_sync(void *p_dst, const void *p_src, uint32_t length)
+{
+    if ((NULL == p_dst) || (NULL == p_src))
+    {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if ((length >= s_dma_memcpy_env.threshold) && dma_memcpy_acquire())
+    {
+        if (APP_DRV_SUCCESS == dma_memcpy_start(p_dst, p_src, DMA_SRC_INCREMENT, length, NULL))
+        {
+            while (s_dma_memcpy_env.is_busy);
+            return s_dma_memcpy_env.result;
+        }
+        s_dma_memcpy_env.is_busy = false;
+    }
+
+    dma_memcpy_cpu((uint8_t *)p_dst, (const uint8_t *)p_src, length);
+
+    return APP_DRV_SUCCESS;
+}
+
+uint16_t app_dma_memcpy_async(void *p_dst, const void *p_src, uint32_t length, app_dma_memcpy_cb_t cb)
+{
+    if ((NULL == p_dst) || (NULL == p_src))
+    {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if ((length >= s_dma_memcpy_env.threshold) && dma_memcpy_acquire())
+    {
+        if (APP_DRV_SUCCESS == dma_memcpy_start(p_dst, p_src, DMA_SRC_INCREMENT, length, cb))
+        {
+            return APP_DRV_SUCCESS;
+        }
+        s_dma_memcpy_env.is_busy = false;
+    }
+
+    dma_memcpy_cpu((uint8_t *)p_dst, (const uint8_t *)p_src, length);
+    if (NULL != cb)
+    {
+        cb(APP_DRV_SUCCESS);
+    }
+
+    return APP_DRV_SUCCESS;
+}
+
+void app_dma_memcpy_threshold_set(uint32_t threshold)
+{
+    s_dma_memcpy_env.threshold = threshold;
+}
+
+uint32_t app_dma_memcpy_threshold_get(void)
+{
+    return s_dma_memcpy_env.threshold;
+}
+
+uint16_t app_dma_memset_sync(void *p_dst, uint8_t value, uint32_t length)
+{
+    if (NULL == p_dst)
+    {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if ((length >= s_dma_memcpy_env.set_threshold) && dma_memcpy_acquire())
+    {
+        s_dma_memcpy_env.pattern = value * 0x01010101UL;
+        if (APP_DRV_SUCCESS == dma_memcpy_start(p_dst, &s_dma_memcpy_env.pattern, DMA_SRC_NO_CHANGE, length, NULL))
+        {
+            while (s_dma_memcpy_env.is_busy);
+            return s_dma_memcpy_env.result;
+        }
+        s_dma_memcpy_env.is_busy = false;
+    }
+
+    memset(p_dst, value, length);
+
+    return APP_DRV_SUCCESS;
+}
+
+uint16_t app_dma_memset_async(void *p_dst, uint8_t value, uint32_t length, app_dma_memcpy_cb_t cb)
+{
+    if (NULL == p_dst)
+    {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if ((length >= s_dma_memcpy_env.set_threshold) && dma_memcpy_acquire())
+    {
+        s_dma_memcpy_env.pattern = value * 0x01010101UL;
+        if (APP_DRV_SUCCESS == dma_memcpy_start(p_dst, &s_dma_memcpy_env.pattern, DMA_SRC_NO_CHANGE, length, cb))
+        {
+            return APP_DRV_SUCCESS;
+        }
+        s_dma_memcpy_env.is_busy = false;
+    }
+
+    memset(p_dst, value, length);
+    if (NULL != cb)
+    {
+        cb(APP_DRV_SUCCESS);
+    }
+
+    return APP_DRV_SUCCESS;
+}
+
+void app_dma_memset_threshold_set(uint32_t threshold)
+{
+    s_dma_memcpy_env.set_threshold = threshold;
+}
+
+uint32_t app_dma_memset_threshold_get(void)
+{
+    return s_dma_memcpy_env.set_threshold;
+}
@@ -99,6 +99,13 @@ bool app_qspi_dma_mmap_read_block(app_qspi_id_t id, uint32_t address, uint8_t *
     bool ret = true;
     APP_ASSERT_CHECK(p_qspi_env[id]->is_mmap_inited);
 
+#if APP_QSPI_MMAP_CACHE_ENABLE
+    /* short reads of assets are served by the mmap read cache, which keeps the same byte order */
+    if(app_qspi_mmap_cache_is_enabled(id) && (length < APP_QSPI_MMAP_CACHE_BYPASS_SIZE)) {
+        return app_qspi_mmap_read_block(id, address, buffer, length);
+    }
+#endif
+
     app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_0);
     APP_ASSERT_CHECK(p_qspi_env[id]->is_used_dma);
     app_qspi_mmap_set_prefetch(id, true);
@@ -1527,6 +1534,140 @@ SECTION_RAM_CODE uint16_t app_qspi_send_display_frame_simp(app_qspi_id_t screen_
 }
 
 
+uint16_t app_qspi_send_display_rect(app_qspi_id_t screen_id,
+                                    const app_qspi_screen_command_t *const p_screen_cmd,
+                                    const app_qspi_screen_info_t *const p_screen_info, const uint8_t * p_buff,
+                                    const app_qspi_rect_t *p_rect, app_qspi_screen_window_set_t set_window) {
+#if (QSPI_DMA_LLP_FEATUTE_SUPPORT > 0u)
+    app_qspi_command_t  app_scrn_cmd;
+    dma_llp_config_t    scrn_llp_config;
+    uint32_t beat_bytes = 0;
+    uint32_t line       = 0;
+    uint32_t bytes      = 0;
+    uint16_t ret        = APP_DRV_SUCCESS;
+
+    if(screen_id >= APP_QSPI_ID_MAX) {
+        return APP_DRV_ERR_INVALID_ID;
+    }
+
+    if((p_screen_cmd == NULL) || (p_screen_info == NULL) || (p_buff == NULL) || (p_rect == NULL) || (set_window == NULL)) {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if((p_qspi_env[screen_id] == NULL) || (p_qspi_env[screen_id]->qspi_state == APP_QSPI_INVALID)) {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if((p_rect->w == 0) || (p_rect->h == 0)) {
+        return APP_DRV_SUCCESS;
+    }
+
+    if((p_rect->x + p_rect->w > p_screen_info->scrn_pixel_width) ||
+       (p_rect->y + p_rect->h > p_screen_info->scrn_pixel_height)) {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    if(p_screen_cmd->data_size == QSPI_DATASIZE_08_BITS) {
+        beat_bytes = 1;
+    } else if(p_screen_cmd->data_size == QSPI_DATASIZE_16_BITS) {
+        beat_bytes = 2;
+    } else if(p_screen_cmd->data_size == QSPI_DATASIZE_32_BITS) {
+        beat_bytes = 4;
+    } else {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    /* every row must start and end on a beat */
+    if(((p_rect->w * p_screen_info->scrn_pixel_depth) % beat_bytes != 0) ||
+       ((p_screen_info->scrn_pixel_stride * p_screen_info->scrn_pixel_depth) % beat_bytes != 0) ||
+       (((uint32_t)p_buff + (p_rect->y * p_screen_info->scrn_pixel_stride + p_rect->x) * p_screen_info->scrn_pixel_depth) % beat_bytes != 0)) {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    if(p_qspi_env[screen_id]->start_flag) {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    ret = set_window(screen_id, p_rect->x, p_rect->y, p_rect->x + p_rect->w - 1, p_rect->y + p_rect->h - 1);
+    if(ret != APP_DRV_SUCCESS) {
+        return ret;
+    }
+
+    p_qspi_env[screen_id]->start_flag = true;
+
+    APP_ASSERT_CHECK(p_qspi_env[screen_id]->is_used_dma);
+    if(!app_qspi_switch_dma_mode(screen_id, false)) {
+        p_qspi_env[screen_id]->start_flag = false;
+        return APP_DRV_ERR_HAL;
+    }
+
+    scrn_llp_config.llp_src_writeback       = 1;
+    scrn_llp_config.llp_dst_writeback       = 1;
+    scrn_llp_config.llp_src_en              = DMA_LLP_SRC_ENABLE;
+    scrn_llp_config.llp_dst_en              = DMA_LLP_DST_DISABLE;
+    scrn_llp_config.head_lli                = &s_dma_llp_block[0];
+
+    app_scrn_cmd.instruction                = p_screen_cmd->instruction;
+    app_scrn_cmd.instruction_size           = p_screen_cmd->instruction_size;
+    app_scrn_cmd.address                    = p_screen_cmd->leading_address;
+    app_scrn_cmd.address_size               = p_screen_cmd->address_size;
+    app_scrn_cmd.dummy_cycles               = p_screen_cmd->dummy_cycles;
+    app_scrn_cmd.data_size                  = p_screen_cmd->data_size;
+    app_scrn_cmd.instruction_address_mode   = p_screen_cmd->instruction_address_mode;
+    app_scrn_cmd.data_mode                  = p_screen_cmd->data_mode;
+    app_scrn_cmd.length                     = 0x00;
+    app_scrn_cmd.clock_stretch_en           = 1;
+
+    while(line < p_rect->h) {
+        if(line > 0) {
+            app_scrn_cmd.address = p_screen_cmd->ongoing_address;
+        }
+
+        bytes = app_qspi_dirty_rect_llp_build(p_screen_info, p_rect, p_buff, beat_bytes, &line,
+                                              &s_dma_llp_block[0], sizeof(s_dma_llp_block) / sizeof(s_dma_llp_block[0]));
+        if(bytes == 0) {
+            ret = APP_DRV_ERR_INVALID_PARAM;
+            break;
+        }
+
+        app_scrn_cmd.length = bytes;
+        if(!app_qspi_cmd_llp_transmit(screen_id, &app_scrn_cmd, &scrn_llp_config, true)) {
+            ret = APP_DRV_ERR_HAL;
+            break;
+        }
+    }
+
+    p_qspi_env[screen_id]->start_flag = false;
+
+    return ret;
+#else
+    return APP_DRV_ERR_INVALID_PARAM;
+#endif
+}
+
+uint16_t app_qspi_send_display_dirty(app_qspi_id_t screen_id,
+                                     const app_qspi_screen_command_t *const p_screen_cmd,
+                                     const app_qspi_screen_info_t *const p_screen_info, const uint8_t * p_buff,
+                                     app_qspi_dirty_region_t *p_region, app_qspi_screen_window_set_t set_window) {
+    uint16_t ret = APP_DRV_SUCCESS;
+    uint32_t i   = 0;
+
+    if(p_region == NULL) {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    for(i = 0; i < p_region->rect_num; i++) {
+        ret = app_qspi_send_display_rect(screen_id, p_screen_cmd, p_screen_info, p_buff, &p_region->rect[i], set_window);
+        if(ret != APP_DRV_SUCCESS) {
+            return ret;
+        }
+    }
+
+    app_qspi_dirty_region_clear(p_region);
+
+    return APP_DRV_SUCCESS;
+}
+
 
 bool app_qspi_mmap_blit_image(app_qspi_id_t storage_id, blit_image_config_t * p_blit_config, blit_xfer_type_e xfer_type) {
 #if QSPI_BLIT_RECT_IMAGE_SUPPORT > 0u
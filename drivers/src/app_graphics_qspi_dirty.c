@@ -0,0 +1,264 @@
+/**
+  ****************************************************************************************
+  * @file    app_graphics_qspi_dirty.c
+  * @author  BLE Driver Team
+  * @brief   Dirty region partial refresh of the QSPI screen.
+  ****************************************************************************************
+  * @attention
+  #####Copyright (c) 2019 GOODIX
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+   * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+   * Neither the name of GOODIX nor the names of its contributors may be used
+     to endorse or promote products derived from this software without
+     specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE.
+  ****************************************************************************************
+  */
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "app_graphics_qspi.h"
+
+#if ((APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X))
+#ifdef HAL_QSPI_MODULE_ENABLED
+
+/*
+ * The dirty region and its LLP blocks only need the QSPI and DMA definitions, no HAL call,
+ * so this file builds on host as well.
+ */
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define APP_QSPI_LLP_BLOCK_MAX_BEATS        4092u
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static uint32_t app_qspi_rect_area(const app_qspi_rect_t *p_rect) {
+    return (uint32_t)p_rect->w * p_rect->h;
+}
+
+static void app_qspi_rect_union(const app_qspi_rect_t *p_a, const app_qspi_rect_t *p_b, app_qspi_rect_t *p_out) {
+    uint32_t x_start = p_a->x < p_b->x ? p_a->x : p_b->x;
+    uint32_t y_start = p_a->y < p_b->y ? p_a->y : p_b->y;
+    uint32_t x_end   = (p_a->x + p_a->w) > (p_b->x + p_b->w) ? (p_a->x + p_a->w) : (p_b->x + p_b->w);
+    uint32_t y_end   = (p_a->y + p_a->h) > (p_b->y + p_b->h) ? (p_a->y + p_a->h) : (p_b->y + p_b->h);
+
+    p_out->x = x_start;
+    p_out->y = y_start;
+    p_out->w = x_end - x_start;
+    p_out->h = y_end - y_start;
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+uint16_t app_qspi_dirty_region_init(app_qspi_dirty_region_t *p_region, uint16_t scrn_width, uint16_t scrn_height, uint16_t align) {
+    if(p_region == NULL) {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if(align == 0) {
+        align = 1;
+    }
+
+    if((align & (align - 1)) != 0) {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    p_region->rect_num    = 0;
+    p_region->scrn_width  = scrn_width;
+    p_region->scrn_height = scrn_height;
+    p_region->align       = align;
+
+    return APP_DRV_SUCCESS;
+}
+
+uint16_t app_qspi_dirty_region_add(app_qspi_dirty_region_t *p_region, const app_qspi_rect_t *p_rect) {
+    app_qspi_rect_t rect;
+    app_qspi_rect_t merged;
+    uint32_t x_end      = 0;
+    uint32_t y_end      = 0;
+    uint32_t growth     = 0;
+    uint32_t min_growth = 0;
+    uint32_t best       = 0;
+    uint32_t i          = 0;
+
+    if((p_region == NULL) || (p_rect == NULL)) {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if((p_rect->w == 0) || (p_rect->h == 0) ||
+       (p_rect->x >= p_region->scrn_width) || (p_rect->y >= p_region->scrn_height)) {
+        return APP_DRV_SUCCESS;
+    }
+
+    /* clip to the screen, then widen to the window alignment of the panel */
+    x_end = p_rect->x + p_rect->w;
+    y_end = p_rect->y + p_rect->h;
+    x_end = (x_end + p_region->align - 1) & ~(uint32_t)(p_region->align - 1);
+    y_end = (y_end + p_region->align - 1) & ~(uint32_t)(p_region->align - 1);
+    x_end = x_end > p_region->scrn_width  ? p_region->scrn_width  : x_end;
+    y_end = y_end > p_region->scrn_height ? p_region->scrn_height : y_end;
+
+    rect.x = p_rect->x & ~(p_region->align - 1);
+    rect.y = p_rect->y & ~(p_region->align - 1);
+    rect.w = x_end - rect.x;
+    rect.h = y_end - rect.y;
+
+    while(1) {
+        i = 0;
+        while(i < p_region->rect_num) {
+            app_qspi_rect_union(&rect, &p_region->rect[i], &merged);
+            if(app_qspi_rect_area(&merged) <= app_qspi_rect_area(&rect) + app_qspi_rect_area(&p_region->rect[i]) + APP_QSPI_DIRTY_RECT_OVERHEAD) {
+                /* the grown rectangle may now be worth merging with the ones checked before */
+                rect = merged;
+                p_region->rect[i] = p_region->rect[--p_region->rect_num];
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+
+        if(p_region->rect_num < APP_QSPI_DIRTY_RECT_MAX) {
+            break;
+        }
+
+        /* region is full: take in the rectangle whose bounding box adds the fewest pixels */
+        min_growth = 0xFFFFFFFF;
+        for(i = 0; i < p_region->rect_num; i++) {
+            app_qspi_rect_union(&rect, &p_region->rect[i], &merged);
+            growth = app_qspi_rect_area(&merged) - app_qspi_rect_area(&p_region->rect[i]);
+            if(growth < min_growth) {
+                min_growth = growth;
+                best       = i;
+            }
+        }
+        app_qspi_rect_union(&rect, &p_region->rect[best], &rect);
+        p_region->rect[best] = p_region->rect[--p_region->rect_num];
+    }
+
+    p_region->rect[p_region->rect_num++] = rect;
+
+    return APP_DRV_SUCCESS;
+}
+
+void app_qspi_dirty_region_clear(app_qspi_dirty_region_t *p_region) {
+    if(p_region != NULL) {
+        p_region->rect_num = 0;
+    }
+}
+
+uint32_t app_qspi_dirty_rect_llp_build(const app_qspi_screen_info_t *const p_screen_info, const app_qspi_rect_t *p_rect,
+                                       const uint8_t *p_buff, uint32_t beat_bytes, uint32_t *p_line,
+                                       dma_block_config_t *p_block, uint32_t block_num) {
+    dma_block_config_t * p_last = NULL;
+    uint32_t xfer_width  = 0;
+    uint32_t line        = 0;
+    uint32_t used        = 0;
+    uint32_t bytes       = 0;
+    uint32_t row_addr    = 0;
+    uint32_t row_beats   = 0;
+    uint32_t this_beats  = 0;
+    uint32_t need_blocks = 0;
+
+    if((p_screen_info == NULL) || (p_rect == NULL) || (p_buff == NULL) || (p_line == NULL) || (p_block == NULL)) {
+        return 0;
+    }
+
+    if(beat_bytes == 1) {
+        xfer_width = DMA_SDATAALIGN_BYTE | DMA_DDATAALIGN_BYTE;
+    } else if(beat_bytes == 2) {
+        xfer_width = DMA_SDATAALIGN_HALFWORD | DMA_DDATAALIGN_HALFWORD;
+    } else if(beat_bytes == 4) {
+        xfer_width = DMA_SDATAALIGN_WORD | DMA_DDATAALIGN_WORD;
+    } else {
+        return 0;
+    }
+
+    const uint32_t line_size = p_screen_info->scrn_pixel_stride * p_screen_info->scrn_pixel_depth;
+    const uint32_t row_bytes = p_rect->w * p_screen_info->scrn_pixel_depth;
+
+    if((row_bytes == 0) || (row_bytes % beat_bytes != 0)) {
+        return 0;
+    }
+    row_beats = row_bytes / beat_bytes;
+
+    for(line = *p_line; line < p_rect->h; line++) {
+        row_addr = (uint32_t)p_buff + (p_rect->y + line) * line_size + p_rect->x * p_screen_info->scrn_pixel_depth;
+
+        if(bytes + row_bytes > QSPI_MAX_XFER_SIZE_ONCE) {
+            break;
+        }
+
+        /* row follows the last block in the frame buffer (full stride rectangle): extend the block */
+        if((p_last != NULL) &&
+           (p_last->src_address + p_last->CTL_H * beat_bytes == row_addr) &&
+           (p_last->CTL_H + row_beats <= APP_QSPI_LLP_BLOCK_MAX_BEATS)) {
+            p_last->CTL_H += row_beats;
+            bytes         += row_bytes;
+            continue;
+        }
+
+        need_blocks = (row_beats + APP_QSPI_LLP_BLOCK_MAX_BEATS - 1) / APP_QSPI_LLP_BLOCK_MAX_BEATS;
+        if(used + need_blocks > block_num) {
+            break;
+        }
+
+        for(this_beats = 0; this_beats < row_beats; this_beats += p_last->CTL_H) {
+            p_last = &p_block[used];
+            p_last->src_address = row_addr + this_beats * beat_bytes;
+            p_last->dst_address = 0;
+            p_last->src_status  = 0x00;
+            p_last->dst_status  = 0x00;
+            p_last->CTL_L       = DMA_CTLL_INI_EN
+                                | DMA_SRC_INCREMENT
+                                | DMA_DST_NO_CHANGE
+                                | DMA_SRC_GATHER_DISABLE
+                                | DMA_DST_SCATTER_DISABLE
+                                | DMA_LLP_SRC_ENABLE
+                                | DMA_LLP_DST_DISABLE
+                                | DMA_MEMORY_TO_PERIPH
+                                | LL_DMA_SRC_BURST_LENGTH_8 | LL_DMA_DST_BURST_LENGTH_8
+                                | xfer_width;
+            p_last->CTL_H       = (row_beats - this_beats) < APP_QSPI_LLP_BLOCK_MAX_BEATS ? (row_beats - this_beats) : APP_QSPI_LLP_BLOCK_MAX_BEATS;
+            p_last->p_lli       = &p_block[used + 1];
+            used++;
+        }
+        bytes += row_bytes;
+    }
+
+    if(used > 0) {
+        p_block[used - 1].p_lli = NULL;
+    }
+    *p_line = line;
+
+    return bytes;
+}
+
+#endif
+#endif
@@ -241,11 +241,113 @@ static app_i2c_id_t i2c_get_id(i2c_handle_t *p_i2c)
     return APP_I2C_ID_MAX;
 }
 
+static uint16_t i2c_batch_xfer_start(app_i2c_id_t id, app_i2c_xfer_t *p_xfer)
+{
+    i2c_handle_t *p_handle = &p_i2c_env[id]->handle;
+    hal_status_t  err_code = HAL_ERROR;
+    bool          use_dma  = (p_i2c_env[id]->i2c_dma_state == APP_I2C_DMA_ACTIVITY) &&
+                             (p_handle->p_dmatx != NULL) && (p_handle->p_dmarx != NULL) &&
+                             (p_xfer->size >= APP_I2C_BATCH_DMA_MIN_SIZE);
+
+    p_i2c_env[id]->slv_dev_addr = p_xfer->dev_address;
+
+    GLOBAL_EXCEPTION_DISABLE();
+    switch (p_xfer->type)
+    {
+        case APP_I2C_XFER_WRITE:
+            err_code = use_dma ? hal_i2c_master_transmit_dma(p_handle, p_xfer->dev_address, p_xfer->p_data, p_xfer->size) :
+                                 hal_i2c_master_transmit_it(p_handle, p_xfer->dev_address, p_xfer->p_data, p_xfer->size);
+            break;
+
+        case APP_I2C_XFER_READ:
+            err_code = use_dma ? hal_i2c_master_receive_dma(p_handle, p_xfer->dev_address, p_xfer->p_data, p_xfer->size) :
+                                 hal_i2c_master_receive_it(p_handle, p_xfer->dev_address, p_xfer->p_data, p_xfer->size);
+            break;
+
+        case APP_I2C_XFER_MEM_WRITE:
+            err_code = use_dma ? hal_i2c_mem_write_dma(p_handle, p_xfer->dev_address, p_xfer->mem_address,
+                                                       p_xfer->mem_addr_size, p_xfer->p_data, p_xfer->size) :
+                                 hal_i2c_mem_write_it(p_handle, p_xfer->dev_address, p_xfer->mem_address,
+                                                      p_xfer->mem_addr_size, p_xfer->p_data, p_xfer->size);
+            break;
+
+        case APP_I2C_XFER_MEM_READ:
+            err_code = use_dma ? hal_i2c_mem_read_dma(p_handle, p_xfer->dev_address, p_xfer->mem_address,
+                                                      p_xfer->mem_addr_size, p_xfer->p_data, p_xfer->size) :
+                                 hal_i2c_mem_read_it(p_handle, p_xfer->dev_address, p_xfer->mem_address,
+                                                     p_xfer->mem_addr_size, p_xfer->p_data, p_xfer->size);
+            break;
+
+        default:
+            break;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return (uint16_t)err_code;
+}
+
+/* Start transactions from xfer_idx on, until one is running. Return false if none left. */
+static bool i2c_batch_run(app_i2c_id_t id)
+{
+    app_i2c_batch_t *p_batch = p_i2c_env[id]->p_batch;
+    app_i2c_xfer_t  *p_xfer;
+
+    while (p_batch->xfer_idx < p_batch->xfer_num)
+    {
+        p_xfer         = &p_batch->p_xfer[p_batch->xfer_idx];
+        p_batch->tick  = HAL_TIMEOUT_GET_TICK();
+        p_xfer->result = i2c_batch_xfer_start(id, p_xfer);
+        if (p_xfer->result == APP_DRV_SUCCESS)
+        {
+            return true;
+        }
+
+        p_xfer->latency_us = 0;
+        p_batch->err_num++;
+        p_batch->xfer_idx++;
+    }
+
+    return false;
+}
+
+static void i2c_batch_xfer_done(app_i2c_id_t id, app_i2c_evt_type_t evt_type)
+{
+    app_i2c_batch_t *p_batch = p_i2c_env[id]->p_batch;
+    app_i2c_xfer_t  *p_xfer  = &p_batch->p_xfer[p_batch->xfer_idx];
+
+    p_xfer->latency_us = (HAL_TIMEOUT_GET_TICK() - p_batch->tick) / (SystemCoreClock / 1000000);
+    if ((evt_type == APP_I2C_EVT_ERROR) || (evt_type == APP_I2C_ABORT))
+    {
+        p_xfer->result = APP_DRV_ERR_HAL;
+        p_batch->err_num++;
+    }
+    p_batch->xfer_idx++;
+
+    if (i2c_batch_run(id))
+    {
+        return;
+    }
+
+    hal_dwt_disable(p_batch->demcr_initial, p_batch->dwt_ctrl_initial);
+    p_i2c_env[id]->p_batch    = NULL;
+    p_i2c_env[id]->start_flag = false;
+    if (p_batch->cplt_cb != NULL)
+    {
+        p_batch->cplt_cb(p_batch);
+    }
+}
+
 static void app_i2c_event_call(i2c_handle_t *p_i2c, app_i2c_evt_type_t evt_type)
 {
     app_i2c_evt_t i2c_evt;
     app_i2c_id_t id = i2c_get_id(p_i2c);
 
+    if (p_i2c_env[id]->p_batch != NULL)
+    {
+        i2c_batch_xfer_done(id, evt_type);
+        return;
+    }
+
     i2c_evt.type = evt_type;
     if (evt_type == APP_I2C_EVT_ERROR)
     {
@@ -307,6 +409,7 @@ uint16_t app_i2c_init(app_i2c_params_t *p_params, app_i2c_evt_handler_t evt_hand
 
     p_params->i2c_dev.i2c_state = APP_I2C_ACTIVITY;
     p_params->i2c_dev.start_flag = false;
+    p_params->i2c_dev.p_batch = NULL;
 
     soc_register_nvic(I2C0_IRQn, (uint32_t)I2C0_IRQHandler);
     soc_register_nvic(I2C1_IRQn, (uint32_t)I2C1_IRQHandler);
@@ -901,6 +1004,73 @@ uint16_t app_i2c_master_abort_it(app_i2c_id_t id)
     return APP_DRV_SUCCESS;
 }
 
+uint16_t app_i2c_batch_start(app_i2c_id_t id, app_i2c_batch_t *p_batch)
+{
+    if (id >= APP_I2C_ID_MAX)
+    {
+        return APP_DRV_ERR_INVALID_ID;
+    }
+
+    if ((p_i2c_env[id] == NULL) || (p_i2c_env[id]->i2c_state == APP_I2C_INVALID))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if ((p_batch == NULL) || (p_batch->p_xfer == NULL) || (p_batch->xfer_num == 0) ||
+        (p_i2c_env[id]->role != APP_I2C_ROLE_MASTER))
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    for (uint16_t i = 0; i < p_batch->xfer_num; i++)
+    {
+        if ((p_batch->p_xfer[i].p_data == NULL) || (p_batch->p_xfer[i].size == 0))
+        {
+            return APP_DRV_ERR_INVALID_PARAM;
+        }
+    }
+
+#ifdef APP_DRIVER_WAKEUP_CALL_FUN
+    i2c_wake_up(id);
+#endif
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if (p_i2c_env[id]->start_flag == false)
+    {
+        p_i2c_env[id]->start_flag = true;
+        p_i2c_env[id]->p_batch    = p_batch;
+    }
+    else
+    {
+        p_batch = NULL;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (p_batch == NULL)
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+    p_batch->xfer_idx         = 0;
+    p_batch->err_num          = 0;
+    p_batch->demcr_initial    = CoreDebug->DEMCR;
+    p_batch->dwt_ctrl_initial = DWT->CTRL;
+    hal_dwt_enable(p_batch->demcr_initial, p_batch->dwt_ctrl_initial);
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if (!i2c_batch_run(id))
+    {
+        /* No transaction could be started. */
+        hal_dwt_disable(p_batch->demcr_initial, p_batch->dwt_ctrl_initial);
+        p_i2c_env[id]->p_batch    = NULL;
+        p_i2c_env[id]->start_flag = false;
+        p_batch = NULL;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return (p_batch == NULL) ? APP_DRV_ERR_HAL : APP_DRV_SUCCESS;
+}
+
 void hal_i2c_master_tx_cplt_callback(i2c_handle_t *p_i2c)
 {
     app_i2c_event_call(p_i2c, APP_I2C_EVT_TX_CPLT);
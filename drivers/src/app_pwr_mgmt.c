@@ -39,6 +39,37 @@
 #include "app_pwr_mgmt.h"
 #include "grx_hal.h"
 #include "grx_sys.h"
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#ifdef APP_PWR_MGMT_STATS_ENABLE
+#define PWR_STATS_TICK_START()                                    \
+    HAL_TIMEOUT_INIT();                                           \
+    uint32_t _pwr_tick = HAL_TIMEOUT_GET_TICK()
+#define PWR_STATS_TICK_STOP(count, cycles)                        \
+do {                                                              \
+    s_pwr_env.stats.count++;                                      \
+    s_pwr_env.stats.cycles += HAL_TIMEOUT_GET_TICK() - _pwr_tick; \
+    HAL_TIMEOUT_DEINIT();                                         \
+} while (0)
+#else
+#define PWR_STATS_TICK_START()
+#define PWR_STATS_TICK_STOP(count, cycles)
+#endif
+
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+#define PWR_PROFILE_BLOCKED(busy_mask)      pwr_profile_blocked(busy_mask)
+#define PWR_PROFILE_IDLE()                  pwr_profile_idle()
+#define PWR_PROFILE_WAKE()                  pwr_profile_wake()
+#define PWR_PROFILE_NO_DEADLINE             0xFFFFFFFFU
+#else
+#define PWR_PROFILE_BLOCKED(busy_mask)
+#define PWR_PROFILE_IDLE()
+#define PWR_PROFILE_WAKE()
+#endif
 
 /*
  * STRUCT DEFINE
@@ -48,6 +79,29 @@ struct pwr_env_t
 {
     app_sleep_callbacks_t *pwr_sleep_cb[APP_SLEEP_CB_MAX];
     wakeup_priority_t wakeup_priority[APP_SLEEP_CB_MAX];
+    uint32_t sleep_cb_mask;                                 /* IDs with app_prepare_for_sleep. */
+    uint32_t wake_cb_mask[WAKEUP_PRIORITY_HIGH + 1];        /* IDs with app_wake_up_ind, per wakeup priority. */
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+    uint32_t devices_backup_mask;                           /* Devices suspended at least once, to be resumed. */
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
+    uint32_t extra_devices_backup_mask;
+#endif
+#ifdef HAL_RECOVER_WHEN_USING
+    uint32_t devices_eager_mask;                            /* Devices resumed on wakeup, not on first use. */
+#endif
+#endif
+#ifdef APP_PWR_MGMT_STATS_ENABLE
+    app_pwr_mgmt_stats_t stats;
+#endif
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+    app_pwr_mgmt_profile_t profile;
+    uint32_t wake_tick;                                     /* DWT cycles at last wakeup. */
+    uint32_t idle_tick;                                     /* DWT cycles at last sleep check passed. */
+    uint32_t idle_deadline_us;                              /* Next app_timer deadline at last sleep check passed. */
+    uint32_t demcr_initial;                                 /* DEMCR before the DWT reference taken at last wakeup. */
+    uint32_t dwt_ctrl_initial;                              /* DWT->CTRL before the DWT reference taken at last wakeup. */
+    bool     wake_tick_valid;                               /* False until the first wakeup, then a DWT reference is held. */
+#endif
 };
 
 /*
@@ -57,6 +111,117 @@ struct pwr_env_t
 static bool is_pwr_callback_reg = false;
 struct pwr_env_t s_pwr_env;
 
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/* Index of the lowest bit set, which is cleared. */
+__STATIC_INLINE uint32_t pwr_mask_pop(uint32_t *p_mask)
+{
+    uint32_t mask = *p_mask;
+
+    *p_mask = mask & (mask - 1);
+
+    return 31 - __CLZ(mask & (~mask + 1));
+}
+
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+/* Log2 histogram bin of a duration. */
+__STATIC_INLINE uint32_t pwr_profile_bin(uint64_t us)
+{
+    uint32_t bin;
+
+    if (us > 0xFFFFFFFFU)
+    {
+        us = 0xFFFFFFFFU;
+    }
+    bin = (us > 1) ? (31 - __CLZ((uint32_t)us)) : 0;
+
+    return (bin < APP_PWR_MGMT_PROFILE_HIST_NUM) ? bin : (APP_PWR_MGMT_PROFILE_HIST_NUM - 1);
+}
+
+static void pwr_profile_blocked(uint32_t busy_mask)
+{
+    s_pwr_env.profile.attempt_count++;
+    s_pwr_env.profile.blocked_count++;
+
+    while (busy_mask)
+    {
+        s_pwr_env.profile.blocker_count[pwr_mask_pop(&busy_mask)]++;
+    }
+}
+
+/* Sample the sleep start, the last sample before sleep counts. */
+static void pwr_profile_idle(void)
+{
+    s_pwr_env.profile.attempt_count++;
+    s_pwr_env.idle_tick = DWT->CYCCNT;
+
+    /* The sleep timer is armed by app_timer for its earliest timer. */
+    if (hal_sleep_timer_status_get())
+    {
+        s_pwr_env.idle_deadline_us = (uint32_t)((uint64_t)hal_sleep_timer_get_current_value() * 1000000U /
+                                                hal_sleep_timer_get_clock_freq());
+    }
+    else
+    {
+        s_pwr_env.idle_deadline_us = PWR_PROFILE_NO_DEADLINE;
+    }
+}
+
+static void pwr_profile_wake(void)
+{
+    uint64_t us;
+
+    s_pwr_env.profile.sleep_count++;
+
+    /* Measured by the comm timer in low power clock cycles, as the core clock stops. */
+    us = (uint64_t)ll_pwr_get_comm_sleep_duration() * 1000000U / sys_lpclk_get();
+    s_pwr_env.profile.sleep_us += us;
+    s_pwr_env.profile.sleep_hist[pwr_profile_bin(us)]++;
+
+    if (s_pwr_env.wake_tick_valid)
+    {
+        us = (s_pwr_env.idle_tick - s_pwr_env.wake_tick) / (SystemCoreClock / 1000000U);
+        s_pwr_env.profile.awake_us += us;
+        s_pwr_env.profile.awake_hist[pwr_profile_bin(us)]++;
+    }
+
+    if (PWR_PROFILE_NO_DEADLINE == s_pwr_env.idle_deadline_us)
+    {
+        s_pwr_env.profile.no_deadline_count++;
+    }
+    else
+    {
+        s_pwr_env.profile.deadline_hist[pwr_profile_bin(s_pwr_env.idle_deadline_us)]++;
+    }
+
+    /* The awake time is counted by DWT till the next sleep, so one reference is held all along.
+     * It is taken again on every wakeup, as sleep may have reset the DWT registers. */
+    if (s_pwr_env.wake_tick_valid)
+    {
+        hal_dwt_disable(s_pwr_env.demcr_initial, s_pwr_env.dwt_ctrl_initial);
+    }
+    s_pwr_env.demcr_initial    = CoreDebug->DEMCR;
+    s_pwr_env.dwt_ctrl_initial = DWT->CTRL;
+    hal_dwt_enable(s_pwr_env.demcr_initial, s_pwr_env.dwt_ctrl_initial);
+
+    s_pwr_env.wake_tick       = DWT->CYCCNT;
+    s_pwr_env.idle_tick       = s_pwr_env.wake_tick;
+    s_pwr_env.wake_tick_valid = true;
+}
+
+static void pwr_profile_hist_print(app_pwr_mgmt_print_t print, const char *p_name, const uint32_t *p_hist)
+{
+    print("PWRP,%s", p_name);
+    for (uint32_t i = 0; i < APP_PWR_MGMT_PROFILE_HIST_NUM; i++)
+    {
+        print(",%u", (unsigned int)p_hist[i]);
+    }
+    print("\r\n");
+}
+#endif
+
 /*
  * GLOBAL FUNCTION DEFINITIONS
  ****************************************************************************************
@@ -65,6 +230,7 @@ struct pwr_env_t s_pwr_env;
 pwr_mgmt_dev_state_t pwr_enter_sleep_check_new(void)
 {
     uint32_t i;
+    uint32_t mask;
 
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5332X)
     if (g_devices_state == 0x0)
@@ -74,35 +240,39 @@ pwr_mgmt_dev_state_t pwr_enter_sleep_check_new(void)
     {
         if (g_devices_renew > 0)
         {
-            for (i = 0x0; i < MAX_PERIPH_DEVICE_NUM; i++)
+            PWR_STATS_TICK_START();
+
+            /* Visit only the devices used since last sleep. */
+            mask = g_devices_renew & ((1u << MAX_PERIPH_DEVICE_NUM) - 1);
+            while (mask)
             {
-                if (devices_suspend_cb[i] == NULL)
-                    continue;
+                i = pwr_mask_pop(&mask);
 
-                if (devices_handle[i] == NULL)
+                if ((devices_suspend_cb[i] == NULL) || (devices_handle[i] == NULL))
                     continue;
 
-                if (g_devices_renew & (1 << i))
-                {
-                    devices_suspend_cb[i](devices_handle[i]);
-                }
+                devices_suspend_cb[i](devices_handle[i]);
+                s_pwr_env.devices_backup_mask |= (1u << i);
             }
 
             g_devices_renew = ALL_DEVICES_BACKUP;
+
+            PWR_STATS_TICK_STOP(suspend_count, suspend_cycles);
         }
 
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
         if (g_extra_devices_renew > 0)
         {
-            for (i = 0x0; i < MAX_EXTRA_DEVICE_NUM; i++)
+            mask = g_extra_devices_renew & ((1u << MAX_EXTRA_DEVICE_NUM) - 1);
+            while (mask)
             {
+                i = pwr_mask_pop(&mask);
+
                 if (extra_devices_suspend_cb[i] == NULL)
                     continue;
 
-                if (g_extra_devices_renew & (1 << i))
-                {
-                    extra_devices_suspend_cb[i](extra_devices_handle[i]);
-                }
+                extra_devices_suspend_cb[i](extra_devices_handle[i]);
+                s_pwr_env.extra_devices_backup_mask |= (1u << i);
             }
 
             g_extra_devices_renew = ALL_DEVICES_BACKUP;
@@ -121,41 +291,133 @@ pwr_mgmt_dev_state_t pwr_enter_sleep_check_new(void)
         }
         else
         {
+            PWR_PROFILE_BLOCKED(g_devices_state);
             return DEVICE_BUSY;
         }
 
+        PWR_PROFILE_IDLE();
         return DEVICE_IDLE;
     }
 
+    PWR_PROFILE_BLOCKED(g_devices_state);
     return DEVICE_BUSY;
 }
 
 SECTION_RAM_CODE void pwr_wake_up_ind_new(void)
 {
     uint32_t i;
+    uint32_t mask;
 
+    PWR_PROFILE_WAKE();
+
+    PWR_STATS_TICK_START();
+
+    /* Only devices with a backup have something to restore. */
 #ifndef HAL_RECOVER_WHEN_USING
-    for (i = 0x0; i < MAX_PERIPH_DEVICE_NUM; i++)
+    mask = s_pwr_env.devices_backup_mask;
+#else
+    /* The others are restored by HAL on first use. */
+    mask = s_pwr_env.devices_backup_mask & s_pwr_env.devices_eager_mask;
+#endif
+    while (mask)
     {
-        if (devices_resume_cb[i] == NULL)
-            continue;
+        i = pwr_mask_pop(&mask);
 
-        if (devices_handle[i] == NULL)
+        if ((devices_resume_cb[i] == NULL) || (devices_handle[i] == NULL))
+        {
+            s_pwr_env.devices_backup_mask &= ~(1u << i);
             continue;
+        }
 
         devices_resume_cb[i](devices_handle[i]);
-    }
+#ifdef HAL_RECOVER_WHEN_USING
+        g_devices_sleep &= ~(1u << i);
 #endif
+    }
 
 #if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR5332X)
-    for (i = 0x0; i < MAX_EXTRA_DEVICE_NUM; i++)
+    mask = s_pwr_env.extra_devices_backup_mask;
+    while (mask)
     {
+        i = pwr_mask_pop(&mask);
+
         if (extra_devices_resume_cb[i] == NULL)
+        {
+            s_pwr_env.extra_devices_backup_mask &= ~(1u << i);
             continue;
+        }
 
         extra_devices_resume_cb[i](extra_devices_handle[i]);
     }
 #endif
+
+    PWR_STATS_TICK_STOP(resume_count, resume_cycles);
+}
+
+#ifdef HAL_RECOVER_WHEN_USING
+void app_pwr_mgmt_eager_resume_set(uint32_t devices_mask)
+{
+    s_pwr_env.devices_eager_mask = devices_mask;
+}
+#endif
+#endif
+
+#ifdef APP_PWR_MGMT_STATS_ENABLE
+void app_pwr_mgmt_stats_get(app_pwr_mgmt_stats_t *p_stats)
+{
+    GLOBAL_EXCEPTION_DISABLE();
+    *p_stats = s_pwr_env.stats;
+    GLOBAL_EXCEPTION_ENABLE();
+}
+
+void app_pwr_mgmt_stats_reset(void)
+{
+    GLOBAL_EXCEPTION_DISABLE();
+    memset(&s_pwr_env.stats, 0, sizeof(s_pwr_env.stats));
+    GLOBAL_EXCEPTION_ENABLE();
+}
+#endif
+
+#ifdef APP_PWR_MGMT_PROFILE_ENABLE
+void app_pwr_mgmt_profile_get(app_pwr_mgmt_profile_t *p_profile)
+{
+    GLOBAL_EXCEPTION_DISABLE();
+    *p_profile = s_pwr_env.profile;
+    GLOBAL_EXCEPTION_ENABLE();
+}
+
+void app_pwr_mgmt_profile_reset(void)
+{
+    GLOBAL_EXCEPTION_DISABLE();
+    memset(&s_pwr_env.profile, 0, sizeof(s_pwr_env.profile));
+    GLOBAL_EXCEPTION_ENABLE();
+}
+
+void app_pwr_mgmt_profile_dump(app_pwr_mgmt_print_t print)
+{
+    const app_pwr_mgmt_profile_t *p_profile = &s_pwr_env.profile;
+
+    if (NULL == print)
+    {
+        return;
+    }
+
+    /* Totals in ms, 64-bit printf is often left out of the C library. */
+    print("PWRP,begin,%u,%u\r\n", 1U, (unsigned int)APP_PWR_MGMT_PROFILE_HIST_NUM);
+    print("PWRP,count,%u,%u,%u,%u\r\n", (unsigned int)p_profile->attempt_count, (unsigned int)p_profile->blocked_count,
+          (unsigned int)p_profile->sleep_count, (unsigned int)p_profile->no_deadline_count);
+    print("PWRP,total_ms,%u,%u\r\n", (unsigned int)(p_profile->sleep_us / 1000U), (unsigned int)(p_profile->awake_us / 1000U));
+    for (uint32_t i = 0; i < APP_PWR_MGMT_PROFILE_DEV_NUM; i++)
+    {
+        if (p_profile->blocker_count[i])
+        {
+            print("PWRP,blocker,%u,%u\r\n", (unsigned int)i, (unsigned int)p_profile->blocker_count[i]);
+        }
+    }
+    pwr_profile_hist_print(print, "sleep", p_profile->sleep_hist);
+    pwr_profile_hist_print(print, "awake", p_profile->awake_hist);
+    pwr_profile_hist_print(print, "deadline", p_profile->deadline_hist);
+    print("PWRP,end\r\n");
 }
 #endif
 
@@ -183,9 +445,20 @@ pwr_id_t pwr_register_sleep_cb(const app_sleep_callbacks_t *p_cb, wakeup_priorit
         return PWR_ID_MAX;
     }
 
+    pwr_unregister_sleep_cb(id);
+
     s_pwr_env.pwr_sleep_cb[id] = (app_sleep_callbacks_t *)p_cb;
     s_pwr_env.wakeup_priority[id] = wakeup_priority;
 
+    if ((p_cb != NULL) && (p_cb->app_prepare_for_sleep != NULL))
+    {
+        s_pwr_env.sleep_cb_mask |= (1u << id);
+    }
+    if ((p_cb != NULL) && (p_cb->app_wake_up_ind != NULL))
+    {
+        s_pwr_env.wake_cb_mask[wakeup_priority] |= (1u << id);
+    }
+
     return id;
 }
 
@@ -194,49 +467,65 @@ void pwr_unregister_sleep_cb(pwr_id_t id)
     if(id < APP_SLEEP_CB_MAX)
     {
         s_pwr_env.pwr_sleep_cb[id] = NULL;
+        s_pwr_env.sleep_cb_mask &= ~(1u << id);
+        for (uint32_t priority = WAKEUP_PRIORITY_LOW; priority <= WAKEUP_PRIORITY_HIGH; priority++)
+        {
+            s_pwr_env.wake_cb_mask[priority] &= ~(1u << id);
+        }
     }
 }
 
 SECTION_RAM_CODE void pwr_wake_up_ind(void)
 {
-    app_sleep_callbacks_t *p_cb;
     uint32_t priority;
+    uint32_t mask;
 
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
      hal_init();
 #endif
 
+    PWR_PROFILE_WAKE();
+
+    PWR_STATS_TICK_START();
+
     for (priority = WAKEUP_PRIORITY_HIGH; priority != 0; priority--)
     {
-        for (uint32_t i = 0; i < APP_SLEEP_CB_MAX; i++)
+        mask = s_pwr_env.wake_cb_mask[priority];
+        while (mask)
         {
-            p_cb = s_pwr_env.pwr_sleep_cb[i];
-            if ((p_cb != NULL) && (p_cb->app_wake_up_ind != NULL) && (priority == s_pwr_env.wakeup_priority[i]))
-            {
-                p_cb->app_wake_up_ind();
-            }
+            s_pwr_env.pwr_sleep_cb[pwr_mask_pop(&mask)]->app_wake_up_ind();
         }
     }
+
+    PWR_STATS_TICK_STOP(resume_count, resume_cycles);
 }
 
 pwr_mgmt_dev_state_t pwr_enter_sleep_check(void)
 {
     pwr_mgmt_dev_state_t allow_entering_sleep = DEVICE_IDLE;
-    app_sleep_callbacks_t *p_cb;
+    uint32_t mask = s_pwr_env.sleep_cb_mask;
+    uint32_t id;
+
+    PWR_STATS_TICK_START();
 
-    for (uint32_t i = 0; i < APP_SLEEP_CB_MAX ; i++)
+    while (mask)
     {
-        p_cb = s_pwr_env.pwr_sleep_cb[i];
-        if ((p_cb != NULL) && (p_cb->app_prepare_for_sleep != NULL))
+        id = pwr_mask_pop(&mask);
+        if (!s_pwr_env.pwr_sleep_cb[id]->app_prepare_for_sleep())
         {
-            if (!p_cb->app_prepare_for_sleep())
-            {
-                allow_entering_sleep = DEVICE_BUSY;
-                break;
-            }
+            PWR_PROFILE_BLOCKED(1u << id);
+            allow_entering_sleep = DEVICE_BUSY;
+            break;
         }
     }
 
+    PWR_STATS_TICK_STOP(suspend_count, suspend_cycles);
+
+    if (DEVICE_IDLE == allow_entering_sleep)
+    {
+        PWR_PROFILE_IDLE();
+    }
+
     return allow_entering_sleep;
 }
 
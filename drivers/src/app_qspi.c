@@ -58,6 +58,27 @@
 
 #define APP_QSPI_EXCEPT_DEBUG_EN            1u
 
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X)
+#if APP_QSPI_MMAP_CACHE_ENABLE
+#define QSPI_CACHE_LINE_MASK                (APP_QSPI_MMAP_CACHE_LINE_SIZE - 1u)
+#define QSPI_CACHE_SET(tag)                 (((tag) / APP_QSPI_MMAP_CACHE_LINE_SIZE) & (APP_QSPI_MMAP_CACHE_SETS - 1u))
+#define QSPI_CACHE_FLAG_VALID               0x01u    /* line holds device data */
+#define QSPI_CACHE_FLAG_PREFETCH            0x02u    /* line read ahead and not used yet */
+
+/* tag is the line address with the QSPI ID in its low bits */
+typedef struct {
+    uint32_t                    tag[APP_QSPI_MMAP_CACHE_SETS][APP_QSPI_MMAP_CACHE_WAYS];
+    uint32_t                    stamp[APP_QSPI_MMAP_CACHE_SETS][APP_QSPI_MMAP_CACHE_WAYS];
+    uint8_t                     flag[APP_QSPI_MMAP_CACHE_SETS][APP_QSPI_MMAP_CACHE_WAYS];
+    uint32_t                    data[APP_QSPI_MMAP_CACHE_SETS][APP_QSPI_MMAP_CACHE_WAYS][APP_QSPI_MMAP_CACHE_LINE_SIZE / 4];
+    uint32_t                    tick;
+    uint32_t                    next_line[APP_QSPI_ID_MAX];    /* line following the last demand miss */
+    bool                        enabled[APP_QSPI_ID_MAX];
+    app_qspi_mmap_cache_stats_t stats;
+} qspi_mmap_cache_t;
+#endif
+#endif
+
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
 /********************************************************************
  * QUAD_WRITE_32b_PATCH : just exist in QUAD/DATASIZE_32BITS/DMA scene
@@ -355,6 +376,12 @@ static const uint32_t    s_qspi_instance[APP_QSPI_ID_MAX] = { QSPI0_BASE, QSPI1_
 
 qspi_env_t *p_qspi_env[APP_QSPI_ID_MAX];
 
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X)
+#if APP_QSPI_MMAP_CACHE_ENABLE
+static qspi_mmap_cache_t s_qspi_mmap_cache;
+#endif
+#endif
+
 static const app_sleep_callbacks_t qspi_sleep_cb =
 {
     .app_prepare_for_sleep = qspi_prepare_for_sleep,
@@ -502,6 +529,9 @@ uint16_t app_qspi_init(app_qspi_params_t *p_params, app_qspi_evt_handler_t evt_h
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X)
     p_qspi_env[id]->is_mmap_inited   = false;
     p_qspi_env[id]->is_mmap_prefetch_en = false;
+#if APP_QSPI_MMAP_CACHE_ENABLE
+    app_qspi_mmap_cache_enable(id, false);
+#endif
 #endif
 
     pwr_register_sleep_cb(&qspi_sleep_cb, APP_DRIVER_QSPI_WAKEUP_PRIORITY, QSPI_PWR_ID);
@@ -698,6 +728,9 @@ bool app_qspi_config_memory_mappped(app_qspi_id_t id, app_qspi_mmap_device_t dev
     }
 
     if(rRet) {
+#if APP_QSPI_MMAP_CACHE_ENABLE
+        app_qspi_mmap_cache_invalidate(id, 0, 0);
+#endif
         memcpy(&p_qspi_env[id]->mounted_mmap_device, &dev, sizeof(app_qspi_mmap_device_t));
         p_qspi_env[id]->is_mmap_inited   = true;
         p_qspi_env[id]->mmap_endian_mode = (app_qspi_mmap_endian_mode_e) mmap_rd_cmd->x_endian_mode;
@@ -1253,6 +1286,96 @@ bool app_qspi_mmap_set_prefetch(app_qspi_id_t id, bool prefetch_en) {
     return false;
 }
 
+#if APP_QSPI_MMAP_CACHE_ENABLE
+static int32_t qspi_mmap_cache_find(uint32_t tag) {
+    uint32_t set = QSPI_CACHE_SET(tag);
+
+    for(uint32_t way = 0; way < APP_QSPI_MMAP_CACHE_WAYS; way++) {
+        if((s_qspi_mmap_cache.flag[set][way] & QSPI_CACHE_FLAG_VALID) && (s_qspi_mmap_cache.tag[set][way] == tag)) {
+            return way;
+        }
+    }
+
+    return -1;
+}
+
+/* Read one line from the device into the least recently used way of its set. */
+static uint32_t *qspi_mmap_cache_fill(app_qspi_id_t id, uint32_t line_addr, bool is_prefetch) {
+    uint32_t tag    = line_addr | id;
+    uint32_t set    = QSPI_CACHE_SET(tag);
+    uint32_t victim = 0;
+
+    for(uint32_t way = 0; way < APP_QSPI_MMAP_CACHE_WAYS; way++) {
+        if(!(s_qspi_mmap_cache.flag[set][way] & QSPI_CACHE_FLAG_VALID)) {
+            victim = way;
+            break;
+        }
+        if(s_qspi_mmap_cache.stamp[set][way] < s_qspi_mmap_cache.stamp[set][victim]) {
+            victim = way;
+        }
+    }
+
+    memcpy(s_qspi_mmap_cache.data[set][victim], (void *)(ll_qspi_get_xip_base_address((qspi_regs_t*)s_qspi_instance[id]) + line_addr), APP_QSPI_MMAP_CACHE_LINE_SIZE);
+    s_qspi_mmap_cache.tag[set][victim]   = tag;
+    s_qspi_mmap_cache.flag[set][victim]  = QSPI_CACHE_FLAG_VALID | (is_prefetch ? QSPI_CACHE_FLAG_PREFETCH : 0);
+    s_qspi_mmap_cache.stamp[set][victim] = ++s_qspi_mmap_cache.tick;
+
+    return s_qspi_mmap_cache.data[set][victim];
+}
+
+/* Read ahead lines not cached yet, they fall in other sets than line_addr - 1 as long as count is less than the set number. */
+static void qspi_mmap_cache_prefetch(app_qspi_id_t id, uint32_t line_addr, uint32_t count) {
+    app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_0);
+    for(uint32_t i = 0; i < count; i++, line_addr += APP_QSPI_MMAP_CACHE_LINE_SIZE) {
+        if(qspi_mmap_cache_find(line_addr | id) < 0) {
+            qspi_mmap_cache_fill(id, line_addr, true);
+            s_qspi_mmap_cache.stats.prefetch++;
+        }
+    }
+}
+
+/* Return the cached line holding address, lines are read in endian mode 0 and keep the device byte order.
+ * Call with interrupts off, the line may be replaced by a read from another context once they are back on. */
+static const uint8_t *qspi_mmap_cache_get(app_qspi_id_t id, uint32_t address) {
+    uint32_t  line_addr = address & ~QSPI_CACHE_LINE_MASK;
+    uint32_t  tag       = line_addr | id;
+    uint32_t  set       = QSPI_CACHE_SET(tag);
+    int32_t   way       = qspi_mmap_cache_find(tag);
+    uint32_t *p_line;
+
+    if(way >= 0) {
+        s_qspi_mmap_cache.stats.hit++;
+        s_qspi_mmap_cache.stamp[set][way] = ++s_qspi_mmap_cache.tick;
+        if(s_qspi_mmap_cache.flag[set][way] & QSPI_CACHE_FLAG_PREFETCH) {
+            /* the stream reached a line read ahead, keep the window in front of it */
+            s_qspi_mmap_cache.flag[set][way] &= ~QSPI_CACHE_FLAG_PREFETCH;
+            s_qspi_mmap_cache.stats.prefetch_hit++;
+            qspi_mmap_cache_prefetch(id, line_addr + APP_QSPI_MMAP_CACHE_PREFETCH_LINES * APP_QSPI_MMAP_CACHE_LINE_SIZE, 1);
+        }
+        return (const uint8_t *)s_qspi_mmap_cache.data[set][way];
+    }
+
+    s_qspi_mmap_cache.stats.miss++;
+    app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_0);
+    p_line = qspi_mmap_cache_fill(id, line_addr, false);
+
+    /* misses on neighbouring lines start reading ahead */
+    if(APP_QSPI_MMAP_CACHE_PREFETCH_LINES && (line_addr == s_qspi_mmap_cache.next_line[id])) {
+        qspi_mmap_cache_prefetch(id, line_addr + APP_QSPI_MMAP_CACHE_LINE_SIZE, APP_QSPI_MMAP_CACHE_PREFETCH_LINES);
+    }
+    s_qspi_mmap_cache.next_line[id] = line_addr + APP_QSPI_MMAP_CACHE_LINE_SIZE;
+
+    return (const uint8_t *)p_line;
+}
+
+/* Copy bytes of one line, the lookup and fill run with interrupts off as the cache is shared by all contexts. */
+static void qspi_mmap_cache_read(app_qspi_id_t id, uint32_t address, uint8_t *buffer, uint32_t length) {
+    GLOBAL_EXCEPTION_DISABLE();
+    memcpy(buffer, qspi_mmap_cache_get(id, address) + (address & QSPI_CACHE_LINE_MASK), length);
+    GLOBAL_EXCEPTION_ENABLE();
+}
+#endif
+
 uint8_t app_qspi_mmap_read_u8(app_qspi_id_t id, uint32_t address) {
     if (id >= APP_QSPI_ID_MAX)
     {
@@ -1264,6 +1387,14 @@ uint8_t app_qspi_mmap_read_u8(app_qspi_id_t id, uint32_t address) {
         return 0;
     }
     //APP_ASSERT_CHECK(p_qspi_env[id]->is_mmap_inited);
+#if APP_QSPI_MMAP_CACHE_ENABLE
+    if(s_qspi_mmap_cache.enabled[id]) {
+        uint8_t data;
+
+        qspi_mmap_cache_read(id, address, &data, 1);
+        return data;
+    }
+#endif
     app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_0);
     return *((volatile uint8_t *)(ll_qspi_get_xip_base_address((qspi_regs_t*)s_qspi_instance[id]) + address));
 }
@@ -1280,6 +1411,14 @@ uint16_t app_qspi_mmap_read_u16(app_qspi_id_t id, uint32_t address) {
     }
     //APP_ASSERT_CHECK(p_qspi_env[id]->is_mmap_inited);
     APP_ASSERT_CHECK(!(address & 0x01));    /* U16 aligned */
+#if APP_QSPI_MMAP_CACHE_ENABLE
+    if(s_qspi_mmap_cache.enabled[id]) {
+        uint8_t data[2];
+
+        qspi_mmap_cache_read(id, address, data, sizeof(data));
+        return ((uint16_t)data[0] << 8) | data[1];
+    }
+#endif
     app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_1);
     return *((volatile uint16_t *)(ll_qspi_get_xip_base_address((qspi_regs_t*)s_qspi_instance[id]) + address));
 }
@@ -1296,6 +1435,14 @@ uint32_t app_qspi_mmap_read_u32(app_qspi_id_t id, uint32_t address) {
     }
     //APP_ASSERT_CHECK(p_qspi_env[id]->is_mmap_inited);
     APP_ASSERT_CHECK(!(address & 0x03));    /* U32 aligned */
+#if APP_QSPI_MMAP_CACHE_ENABLE
+    if(s_qspi_mmap_cache.enabled[id]) {
+        uint8_t data[4];
+
+        qspi_mmap_cache_read(id, address, data, sizeof(data));
+        return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+    }
+#endif
     app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_2);
     return *((volatile uint32_t *)(ll_qspi_get_xip_base_address((qspi_regs_t*)s_qspi_instance[id]) + address));
 }
@@ -1309,7 +1456,29 @@ bool app_qspi_mmap_read_block(app_qspi_id_t id, uint32_t address, uint8_t * buff
     }
     //APP_ASSERT_CHECK(p_qspi_env[id]->is_mmap_inited);
 
-    app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_2);
+#if APP_QSPI_MMAP_CACHE_ENABLE
+    if(s_qspi_mmap_cache.enabled[id]) {
+        if(length < APP_QSPI_MMAP_CACHE_BYPASS_SIZE) {
+            uint32_t copy_len;
+
+            while(length) {
+                copy_len = APP_QSPI_MMAP_CACHE_LINE_SIZE - (address & QSPI_CACHE_LINE_MASK);
+                copy_len = (copy_len > length) ? length : copy_len;
+                qspi_mmap_cache_read(id, address, buffer, copy_len);
+                address += copy_len;
+                buffer  += copy_len;
+                length  -= copy_len;
+            }
+            return ret;
+        }
+        GLOBAL_EXCEPTION_DISABLE();
+        s_qspi_mmap_cache.stats.bypass++;
+        GLOBAL_EXCEPTION_ENABLE();
+    }
+#endif
+
+    /* endian mode 0 keeps the device byte order whatever the access width of memcpy, as the cached lines do */
+    app_qspi_mmap_set_endian_mode(id, APP_QSPI_MMAP_ENDIAN_MODE_0);
     app_qspi_mmap_set_prefetch(id, false);
     memcpy(buffer, (void *)(ll_qspi_get_xip_base_address((qspi_regs_t*)s_qspi_instance[id]) + address), length);
     return ret;
@@ -1319,6 +1488,58 @@ uint32_t app_qspi_get_xip_base_address(app_qspi_id_t id) {
     return ll_qspi_get_xip_base_address((qspi_regs_t*)s_qspi_instance[id]);
 }
 
+#if APP_QSPI_MMAP_CACHE_ENABLE
+bool app_qspi_mmap_cache_enable(app_qspi_id_t id, bool enable) {
+    if (id >= APP_QSPI_ID_MAX)
+    {
+        return false;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if(!enable) {
+        app_qspi_mmap_cache_invalidate(id, 0, 0);
+    }
+    s_qspi_mmap_cache.next_line[id] = 0xFFFFFFFF;
+    s_qspi_mmap_cache.enabled[id]   = enable;
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return true;
+}
+
+bool app_qspi_mmap_cache_is_enabled(app_qspi_id_t id) {
+    return (id < APP_QSPI_ID_MAX) && s_qspi_mmap_cache.enabled[id];
+}
+
+void app_qspi_mmap_cache_invalidate(app_qspi_id_t id, uint32_t address, uint32_t length) {
+    uint32_t line_addr;
+
+    GLOBAL_EXCEPTION_DISABLE();
+    for(uint32_t set = 0; set < APP_QSPI_MMAP_CACHE_SETS; set++) {
+        for(uint32_t way = 0; way < APP_QSPI_MMAP_CACHE_WAYS; way++) {
+            if((s_qspi_mmap_cache.tag[set][way] & QSPI_CACHE_LINE_MASK) != (uint32_t)id) {
+                continue;
+            }
+            line_addr = s_qspi_mmap_cache.tag[set][way] & ~QSPI_CACHE_LINE_MASK;
+            if((0 == length) || ((line_addr < address + length) && (line_addr + APP_QSPI_MMAP_CACHE_LINE_SIZE > address))) {
+                s_qspi_mmap_cache.flag[set][way] = 0;
+            }
+        }
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+}
+
+void app_qspi_mmap_cache_stats_get(app_qspi_mmap_cache_stats_t *p_stats, bool reset) {
+    GLOBAL_EXCEPTION_DISABLE();
+    if(p_stats) {
+        memcpy(p_stats, &s_qspi_mmap_cache.stats, sizeof(app_qspi_mmap_cache_stats_t));
+    }
+    if(reset) {
+        memset(&s_qspi_mmap_cache.stats, 0, sizeof(app_qspi_mmap_cache_stats_t));
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+}
+#endif
+
 #endif
 /*
  * LOCAL FUNCTION DEFINITIONS
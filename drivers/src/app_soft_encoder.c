@@ -40,7 +40,7 @@
 #include "app_soft_encoder.h"
 #include "string.h"
 #include "app_pwr_mgmt.h"
-#include "gr55xx_delay.h"
+#include "grx_hal.h"
 #include "app_timer.h"
 #include "app_gpiote.h"
 
@@ -49,6 +49,14 @@
  *****************************************************************************************
  */
 #define SOFT_ENCODER_STOP_STATUS          0x00
+#define SOFT_ENCODER_ILLEGAL              2         /**< Both signals changed, a transition was missed. */
+#define SOFT_ENCODER_TICK_RING_SIZE       (APP_SOFT_ENCODER_VELOCITY_EDGES + 1)
+
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
+#define SOFT_ENCODER_STEPS_PER_COUNT      1         /**< Edge decode counts every configured edge. */
+#else
+#define SOFT_ENCODER_STEPS_PER_COUNT      APP_SOFT_ENCODER_STEPS_PER_COUNT
+#endif
 
 /*
  * LOCAL VARIABLE DEFINITIONS
@@ -59,17 +67,108 @@ static int s_cur_distance;                               /*<The current encoder
 
 static app_gpiote_param_t s_gpiote_info[APP_SOFT_ENCODER_SINGAL_NUMBER];
 
-static uint8_t s_singal_a_level;        /* <The current encoder signal io level>*/
-static uint8_t s_singal_b_level;        /* <The current encoder signal io level>*/
+static uint32_t s_illegal_count;        /* <Transitions with both signals changed>*/
 
 static app_soft_encoder_callback s_ext_callback;/**< the soft encoder current singal irq type A\B*/
 
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+static uint8_t  s_quad_state;           /* <Last signal levels, A << 1 | B>*/
+static int8_t   s_quad_sub_count;       /* <Transitions not yet counted in distance>*/
+
+/*
+ * Transition table indexed by last state << 2 | new state, state being A << 1 | B.
+ * A leading B (00 -> 10 -> 11 -> 01 -> 00) is positive.
+ */
+static const int8_t s_quad_table[16] =
+{
+    0,                   -1,                   1,                    SOFT_ENCODER_ILLEGAL,
+    1,                    0,                   SOFT_ENCODER_ILLEGAL, -1,
+    -1,                   SOFT_ENCODER_ILLEGAL, 0,                   1,
+    SOFT_ENCODER_ILLEGAL, 1,                   -1,                   0,
+};
+#endif
+
+/* Velocity estimation, enabled by app_soft_encoder_velocity_enable. */
+static app_soft_encoder_tick_get_t s_tick_get;
+static uint32_t s_tick_freq;
+static uint32_t s_edge_tick[SOFT_ENCODER_TICK_RING_SIZE];   /* <Ticks of last transitions in one direction>*/
+static uint8_t  s_edge_idx;
+static uint8_t  s_edge_num;
+static int8_t   s_edge_dir;
+static uint32_t s_velocity_tick;        /* <Tick of last velocity estimation>*/
+static float    s_velocity;             /* <Counts per second>*/
+static uint32_t s_accel_ref_tick;       /* <Tick of velocity one window before>*/
+static float    s_accel_ref_velocity;   /* <Velocity one window before>*/
+static uint8_t  s_accel_edge_num;       /* <Transitions since the reference velocity>*/
+static float    s_acceleration;         /* <Counts per second squared>*/
 
 /*
  * LOCAL FUNCTION DEFINITIONS
  *****************************************************************************************
  */
-static void app_soft_encoder_analy_dir(uint8_t singal_a,uint8_t singal_b)
+static void app_soft_encoder_velocity_update(int8_t step)
+{
+    uint32_t tick = s_tick_get();
+    uint32_t oldest;
+    float    velocity;
+
+    /* Period of the last transitions, restarted on reversal. */
+    if (step != s_edge_dir)
+    {
+        s_edge_dir     = step;
+        s_edge_num     = 0;
+        s_velocity     = 0;
+        s_acceleration = 0;
+        s_accel_edge_num = 0;
+    }
+
+    s_edge_tick[s_edge_idx] = tick;
+    s_edge_idx = (s_edge_idx + 1) % SOFT_ENCODER_TICK_RING_SIZE;
+    if (s_edge_num < SOFT_ENCODER_TICK_RING_SIZE)
+    {
+        s_edge_num++;
+    }
+
+    if (s_edge_num < 2)
+    {
+        s_velocity_tick = tick;
+        return;
+    }
+
+    oldest = s_edge_tick[(s_edge_idx + SOFT_ENCODER_TICK_RING_SIZE - s_edge_num) % SOFT_ENCODER_TICK_RING_SIZE];
+    if (tick == oldest)
+    {
+        return;
+    }
+
+    velocity = (float)step * (s_edge_num - 1) * s_tick_freq /
+               ((float)(tick - oldest) * SOFT_ENCODER_STEPS_PER_COUNT);
+
+    /* Velocities a whole window apart share no transition, so their difference is not just jitter. */
+    if (0 == s_accel_edge_num)
+    {
+        s_accel_ref_velocity = velocity;
+        s_accel_ref_tick     = tick;
+    }
+    else if (s_accel_edge_num >= APP_SOFT_ENCODER_VELOCITY_EDGES && tick != s_accel_ref_tick)
+    {
+        s_acceleration       = (velocity - s_accel_ref_velocity) * s_tick_freq / (float)(tick - s_accel_ref_tick);
+        s_accel_ref_velocity = velocity;
+        s_accel_ref_tick     = tick;
+        s_accel_edge_num     = 0;
+    }
+    s_accel_edge_num++;
+
+    s_velocity      = velocity;
+    s_velocity_tick = tick;
+}
+
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
+/*
+ * GR551x interrupts on one edge only, a transition table would see the signals move one way
+ * and never back. The level of the other signal at the configured edge gives the direction.
+ */
+static void app_soft_encoder_analy_dir(uint8_t singal_a, uint8_t singal_b)
 {
     if (singal_a == 1 && singal_b == 0)
     {
@@ -86,53 +185,87 @@ static void app_soft_encoder_analy_dir(uint8_t singal_a,uint8_t singal_b)
         return;
     }
 
-    s_ext_callback(s_cur_direction,s_cur_distance);
+    if (NULL != s_tick_get)
+    {
+        app_soft_encoder_velocity_update((APP_SOFT_ENCODER_POSITIVE == s_cur_direction) ? 1 : -1);
+    }
+
+    s_ext_callback(s_cur_direction, s_cur_distance);
 }
 
-static void app_soft_encoder_io_a_callback_t(app_io_evt_t *p_evt)
+static void app_soft_encoder_edge_decode(app_soft_encoder_signal_t signal)
 {
-    uint8_t a_io_level = 0;
+    uint8_t a_io_level = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].type, s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pin);
+    uint8_t b_io_level = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].type, s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pin);
+    uint8_t io_level   = (APP_SOFT_ENCODER_SIGNAL_A == signal) ? a_io_level : b_io_level;
 
-    delay_us(500);
-
-    a_io_level  = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].type,s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pin);
-
-    if (APP_IO_PIN_SET == a_io_level && APP_IO_MODE_IT_RISING == s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].mode)
-    {
-        s_singal_a_level = a_io_level;
-        s_singal_b_level = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].type,s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pin);
-        app_soft_encoder_analy_dir(s_singal_a_level,s_singal_b_level);
-    }
-    else if (APP_IO_PIN_RESET == a_io_level && APP_IO_MODE_IT_FALLING == s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].mode)
+    /* A level not matching the configured edge is bounce. */
+    if ((APP_IO_PIN_SET == io_level && APP_IO_MODE_IT_RISING == s_gpiote_info[signal].mode) ||
+        (APP_IO_PIN_RESET == io_level && APP_IO_MODE_IT_FALLING == s_gpiote_info[signal].mode))
     {
-        s_singal_a_level = a_io_level;
-        s_singal_b_level = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].type,s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pin);
-        app_soft_encoder_analy_dir(s_singal_a_level,s_singal_b_level);
+        app_soft_encoder_analy_dir(a_io_level, b_io_level);
     }
 }
 
+static void app_soft_encoder_io_a_callback_t(app_io_evt_t *p_evt)
+{
+    app_soft_encoder_edge_decode(APP_SOFT_ENCODER_SIGNAL_A);
+}
+
 static void app_soft_encoder_io_b_callback_t(app_io_evt_t *p_evt)
 {
-    uint8_t b_io_level = 0;
+    app_soft_encoder_edge_decode(APP_SOFT_ENCODER_SIGNAL_B);
+}
+#else
+static void app_soft_encoder_io_callback_t(app_io_evt_t *p_evt)
+{
+    uint8_t state;
+    int8_t  step;
+
+    /* Both signals sampled in one path, an edge of either one is decoded by table. */
+    state  = (app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].type, s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pin) << 1) |
+              app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].type, s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pin);
+    step   = s_quad_table[(s_quad_state << 2) | state];
+    s_quad_state = state;
 
-    delay_us(500);
+    if (0 == step)
+    {
+        return;
+    }
+
+    if (SOFT_ENCODER_ILLEGAL == step)
+    {
+        s_illegal_count++;
+        return;
+    }
 
-    b_io_level  = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].type,s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pin);
+    if (NULL != s_tick_get)
+    {
+        app_soft_encoder_velocity_update(step);
+    }
 
-    if (APP_IO_PIN_SET == b_io_level && APP_IO_MODE_IT_RISING == s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].mode)
+    /* Contact bounce moves back and forth, and cancels out here. */
+    s_quad_sub_count += step;
+    if (s_quad_sub_count >= APP_SOFT_ENCODER_STEPS_PER_COUNT)
     {
-        s_singal_b_level = b_io_level;
-        s_singal_a_level = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].type,s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pin);
-        app_soft_encoder_analy_dir(s_singal_a_level, s_singal_b_level);
+        s_quad_sub_count -= APP_SOFT_ENCODER_STEPS_PER_COUNT;
+        s_cur_direction   = APP_SOFT_ENCODER_POSITIVE;
+        s_cur_distance++;
     }
-    else if (APP_IO_PIN_RESET == b_io_level && APP_IO_MODE_IT_FALLING == s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].mode)
+    else if (s_quad_sub_count <= -APP_SOFT_ENCODER_STEPS_PER_COUNT)
     {
-        s_singal_b_level = b_io_level;
-        s_singal_a_level = app_io_read_pin(s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].type,s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pin);
-        app_soft_encoder_analy_dir(s_singal_a_level, s_singal_b_level);
+        s_quad_sub_count += APP_SOFT_ENCODER_STEPS_PER_COUNT;
+        s_cur_direction   = APP_SOFT_ENCODER_REVERSE;
+        s_cur_distance--;
+    }
+    else
+    {
+        return;
     }
 
+    s_ext_callback(s_cur_direction, s_cur_distance);
 }
+#endif
 
 /*
  * GLOBAL FUNCTION DEFINITIONS
@@ -147,6 +280,15 @@ uint16_t app_soft_encoder_init(app_soft_encoder_io_param_t *p_a_params, app_soft
         return APP_DRV_ERR_POINTER_NULL;
     }
 
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
+    /* The edge decoder needs the signals to interrupt on the rising or the falling edge. */
+    if ((APP_IO_MODE_IT_RISING != p_a_params->mode && APP_IO_MODE_IT_FALLING != p_a_params->mode) ||
+        (APP_IO_MODE_IT_RISING != p_b_params->mode && APP_IO_MODE_IT_FALLING != p_b_params->mode))
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+#endif
+
     s_ext_callback = evt_handler;
 
 
@@ -154,23 +296,90 @@ uint16_t app_soft_encoder_init(app_soft_encoder_io_param_t *p_a_params, app_soft
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pin         = p_a_params->pin;
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].mode        = p_a_params->mode;
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].pull        = p_a_params->pull;
-    s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].io_evt_cb   = app_soft_encoder_io_a_callback_t;
 
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].type        = p_b_params->type;
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pin         = p_b_params->pin;
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].mode        = p_b_params->mode;
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].pull        = p_b_params->pull;
+
+#if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR551X)
+    s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].io_evt_cb   = app_soft_encoder_io_a_callback_t;
     s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].io_evt_cb   = app_soft_encoder_io_b_callback_t;
+#else
+    /* The table decoder sees every transition. */
+    s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].io_evt_cb   = app_soft_encoder_io_callback_t;
+    s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_A].mode        = APP_IO_MODE_IT_BOTH_EDGE;
+    s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].io_evt_cb   = app_soft_encoder_io_callback_t;
+    s_gpiote_info[APP_SOFT_ENCODER_SIGNAL_B].mode        = APP_IO_MODE_IT_BOTH_EDGE;
+    s_quad_sub_count = 0;
+#endif
+
+    s_cur_direction  = APP_SOFT_ENCODER_STOP;
+    s_cur_distance   = 0;
+    s_illegal_count  = 0;
 
     error_code = app_gpiote_init(s_gpiote_info, APP_SOFT_ENCODER_SINGAL_NUMBER);
     APP_DRV_ERR_CODE_CHECK(error_code);
 
-    s_cur_direction = APP_SOFT_ENCODER_STOP;
-    s_cur_distance = 0;
+#if (APP_DRIVER_CHIP_TYPE != APP_DRIVER_GR551X)
+    s_quad_state = (app_io_read_pin(p_a_params->type, p_a_params->pin) << 1) |
+                    app_io_read_pin(p_b_params->type, p_b_params->pin);
+#endif
+
+    return APP_DRV_SUCCESS;
+}
+
+uint32_t app_soft_encoder_illegal_count_get(void)
+{
+    return s_illegal_count;
+}
+
+uint16_t app_soft_encoder_velocity_enable(app_soft_encoder_tick_get_t tick_get, uint32_t tick_freq_hz)
+{
+    if (NULL != tick_get && 0 == tick_freq_hz)
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    s_tick_get     = tick_get;
+    s_tick_freq    = tick_freq_hz;
+    s_edge_num       = 0;
+    s_edge_dir       = 0;
+    s_accel_edge_num = 0;
+    s_velocity     = 0;
+    s_acceleration = 0;
+    GLOBAL_EXCEPTION_ENABLE();
 
+    return APP_DRV_SUCCESS;
+}
 
-    s_singal_a_level = 0;
-    s_singal_b_level = 0;
+uint16_t app_soft_encoder_velocity_get(float *p_velocity, float *p_acceleration)
+{
+    uint32_t idle_ticks;
+
+    if (NULL == p_velocity || NULL == p_acceleration)
+    {
+        return APP_DRV_ERR_POINTER_NULL;
+    }
+
+    if (NULL == s_tick_get)
+    {
+        return APP_DRV_ERR_INVALID_MODE;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    *p_velocity     = s_velocity;
+    *p_acceleration = s_acceleration;
+    idle_ticks      = s_tick_get() - s_velocity_tick;
+    GLOBAL_EXCEPTION_ENABLE();
+
+    /* No transition for a while: stopped. */
+    if ((uint64_t)idle_ticks * 1000 > (uint64_t)s_tick_freq * APP_SOFT_ENCODER_VELOCITY_TIMEOUT_MS)
+    {
+        *p_velocity     = 0;
+        *p_acceleration = 0;
+    }
 
     return APP_DRV_SUCCESS;
 }
@@ -213,6 +213,16 @@ __WEAK uint16_t app_uart_dma_start_transmit_async(app_uart_id_t id)
     return 0;
 };
 
+__WEAK void app_uart_dma_rx_ring_cplt(app_uart_id_t id)
+{
+    return;
+};
+
+__WEAK void app_uart_dma_rx_ring_error(app_uart_id_t id)
+{
+    return;
+};
+
 static app_uart_id_t uart_get_id(uart_handle_t *p_uart)
 {
     for (uint32_t i = 0; i < APP_UART_ID_MAX; i++)
@@ -291,6 +301,70 @@ static uint16_t app_uart_start_transmit_async(app_uart_id_t id)
     return APP_DRV_SUCCESS;
 }
 
+/* Queue all segments back to back, then start sending if TX is idle. */
+uint16_t uart_tx_queue(app_uart_id_t id, const app_uart_iovec_t *p_iov, uint16_t iov_cnt, bool use_dma)
+{
+    uint16_t err_code   = APP_DRV_SUCCESS;
+    uint32_t total_size = 0;
+    bool     need_start = false;
+
+    if (p_iov == NULL || iov_cnt == 0)
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    for (uint16_t i = 0; i < iov_cnt; i++)
+    {
+        if (p_iov[i].p_data == NULL && p_iov[i].size != 0)
+        {
+            return APP_DRV_ERR_INVALID_PARAM;
+        }
+        total_size += p_iov[i].size;
+    }
+
+    if (total_size == 0 || total_size >= p_uart_env[id]->tx_ring_buffer.buffer_size)
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+#ifdef APP_DRIVER_WAKEUP_CALL_FUN
+    uart_wake_up(id);
+#endif
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if (ring_buffer_surplus_space_get(&p_uart_env[id]->tx_ring_buffer) < total_size)
+    {
+        err_code = APP_DRV_ERR_BUSY;
+    }
+    else
+    {
+        p_uart_env[id]->tx_abort_flag = false;
+        for (uint16_t i = 0; i < iov_cnt; i++)
+        {
+            ring_buffer_write(&p_uart_env[id]->tx_ring_buffer, p_iov[i].p_data, p_iov[i].size);
+        }
+
+        if ((p_uart_env[id]->start_tx_flag == false) && (p_uart_env[id]->start_flush_flag == false) &&
+            (p_uart_env[id]->uart_state == APP_UART_ACTIVITY))
+        {
+            p_uart_env[id]->start_tx_flag = true;
+            need_start = true;
+        }
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (need_start)
+    {
+        err_code = use_dma ? app_uart_dma_start_transmit_async(id) : app_uart_start_transmit_async(id);
+        if (err_code != APP_DRV_SUCCESS)
+        {
+            p_uart_env[id]->start_tx_flag = false;
+        }
+    }
+
+    return err_code;
+}
+
 /*
  * GLOBAL FUNCTION DEFINITIONS
  ****************************************************************************************
@@ -334,6 +408,8 @@ uint16_t app_uart_init(app_uart_params_t *p_params, app_uart_evt_handler_t evt_h
     p_uart_env[id]->start_flush_flag = false;
     p_uart_env[id]->tx_abort_flag = false;
     p_uart_env[id]->rx_abort_flag = false;
+    p_uart_env[id]->p_rx_ring = NULL;
+    p_uart_env[id]->rx_dma_len = 0;
 
     soc_register_nvic(UART0_IRQn, (uint32_t)UART0_IRQHandler);
     soc_register_nvic(UART1_IRQn, (uint32_t)UART1_IRQHandler);
@@ -499,7 +575,7 @@ uint16_t app_uart_receive_sync(app_uart_id_t id, uint8_t *p_data, uint16_t size,
 
 uint16_t app_uart_transmit_async(app_uart_id_t id, uint8_t *p_data, uint16_t size)
 {
-    uint16_t err_code;
+    app_uart_iovec_t iov;
 
     if (id >= APP_UART_ID_MAX)
     {
@@ -516,31 +592,25 @@ uint16_t app_uart_transmit_async(app_uart_id_t id, uint8_t *p_data, uint16_t siz
         return APP_DRV_ERR_INVALID_PARAM;
     }
 
-#ifdef APP_DRIVER_WAKEUP_CALL_FUN
-    uart_wake_up(id);
-#endif
+    iov.p_data = p_data;
+    iov.size   = size;
 
-    p_uart_env[id]->tx_abort_flag = false;
-    ring_buffer_write(&p_uart_env[id]->tx_ring_buffer, p_data, size);
+    return uart_tx_queue(id, &iov, 1, false);
+}
 
-    if ((p_uart_env[id]->start_tx_flag == false) && (p_uart_env[id]->start_flush_flag == false) &&
-        (p_uart_env[id]->uart_state == APP_UART_ACTIVITY))
+uint16_t app_uart_transmit_vec_async(app_uart_id_t id, const app_uart_iovec_t *p_iov, uint16_t iov_cnt)
+{
+    if (id >= APP_UART_ID_MAX)
     {
-        p_uart_env[id]->start_tx_flag = true;
-
-        err_code = app_uart_start_transmit_async(id);
-        if (err_code != APP_DRV_SUCCESS)
-        {
-            p_uart_env[id]->start_tx_flag = false;
-            return err_code;
-        }
+        return APP_DRV_ERR_INVALID_ID;
     }
-    else
+
+    if ((p_uart_env[id] == NULL) || (p_uart_env[id]->uart_state == APP_UART_INVALID))
     {
-        return APP_DRV_ERR_BUSY;
+        return APP_DRV_ERR_POINTER_NULL;
     }
 
-    return APP_DRV_SUCCESS;
+    return uart_tx_queue(id, p_iov, iov_cnt, false);
 }
 
 uint16_t app_uart_transmit_sync(app_uart_id_t id, uint8_t *p_data, uint16_t size, uint32_t timeout)
@@ -802,6 +872,12 @@ void hal_uart_rx_cplt_callback(uart_handle_t *p_uart)
     app_uart_evt_t uart_evt;
     app_uart_id_t id = uart_get_id(p_uart);
 
+    if (p_uart_env[id]->p_rx_ring != NULL)
+    {
+        app_uart_dma_rx_ring_cplt(id);
+        return;
+    }
+
     uart_evt.type = APP_UART_EVT_RX_DATA;
     uart_evt.data.size = p_uart->rx_xfer_size - p_uart->rx_xfer_count;
     APP_UART_CALLBACK(id, uart_evt);
@@ -812,6 +888,12 @@ void hal_uart_error_callback(uart_handle_t *p_uart)
     app_uart_evt_t uart_evt;
     app_uart_id_t id = uart_get_id(p_uart);
 
+    /* Errors abort a DMA reception, the RX ring would stay armed on a stopped channel. */
+    if ((p_uart_env[id]->p_rx_ring != NULL) && (p_uart->rx_state != HAL_UART_STATE_BUSY_RX))
+    {
+        app_uart_dma_rx_ring_error(id);
+    }
+
     uart_evt.type = APP_UART_EVT_ERROR;
     uart_evt.data.error_code = p_uart->error_code;
     p_uart_env[id]->start_tx_flag = false;
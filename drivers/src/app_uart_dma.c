@@ -48,6 +48,7 @@
  *****************************************************************************************
  */
 #define DMA_REQUEST_NULL                    (0x00)
+#define UART_DMA_RX_RING_SIZE_MAX           (2 * APP_DMA_BLOCK_MAX_LENGTH)
 
 /*
  * STRUCT DEFINE
@@ -135,12 +136,80 @@ extern uart_env_t *p_uart_env[APP_UART_ID_MAX];
 #ifdef APP_DRIVER_WAKEUP_CALL_FUN
 extern void uart_wake_up(app_uart_id_t id);
 #endif
+extern uint16_t uart_tx_queue(app_uart_id_t id, const app_uart_iovec_t *p_iov, uint16_t iov_cnt, bool use_dma);
 
 /*
  * LOCAL FUNCTION DECLARATION
  *****************************************************************************************
  */
 
+static void uart_dma_rx_ring_evt(app_uart_id_t id, app_uart_evt_type_t type)
+{
+    app_uart_evt_t uart_evt;
+
+    uart_evt.type      = type;
+    uart_evt.data.size = ring_buffer_items_count_get(p_uart_env[id]->p_rx_ring);
+
+    if (p_uart_env[id]->evt_handler != NULL)
+    {
+        p_uart_env[id]->evt_handler(&uart_evt);
+    }
+}
+
+/* Start DMA on the free space behind the write index, up to the half or the end of ring. */
+static uint16_t uart_dma_rx_ring_arm(app_uart_id_t id)
+{
+    ring_buffer_t *p_ring = p_uart_env[id]->p_rx_ring;
+    uint32_t       half   = p_ring->buffer_size >> 1;
+    uint32_t       wr_idx = p_ring->write_index;
+    uint32_t       limit  = (wr_idx < half) ? (half - wr_idx) : (p_ring->buffer_size - wr_idx);
+    uint8_t       *p_data;
+    uint32_t       length;
+
+    length = ring_buffer_write_span_get(p_ring, &p_data);
+    length = (length > limit) ? limit : length;
+
+    p_uart_env[id]->rx_dma_committed = 0;
+    p_uart_env[id]->rx_dma_len       = 0;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (hal_uart_receive_dma(&p_uart_env[id]->handle, p_data, length) != HAL_OK)
+    {
+        return 0;
+    }
+    p_uart_env[id]->rx_dma_len = length;
+
+    return length;
+}
+
+/* Commit the items written by DMA so far in the running chunk, true if there were new ones. */
+static bool uart_dma_rx_ring_commit(app_uart_id_t id)
+{
+    dma_handle_t *p_dma = p_uart_env[id]->handle.p_dmarx;
+    uint32_t      done  = 0;
+
+    if (p_uart_env[id]->rx_dma_len != 0)
+    {
+        done = ll_dma_get_block_size(p_dma->p_instance, p_dma->channel);
+        done = (done > p_uart_env[id]->rx_dma_len) ? p_uart_env[id]->rx_dma_len : done;
+    }
+
+    if (done <= p_uart_env[id]->rx_dma_committed)
+    {
+        return false;
+    }
+
+    ring_buffer_write_commit(p_uart_env[id]->p_rx_ring, done - p_uart_env[id]->rx_dma_committed);
+    p_uart_env[id]->rx_dma_committed = done;
+    p_uart_env[id]->rx_idle_pending  = true;
+
+    return true;
+}
+
 static uint16_t app_uart_config_dma_tx(app_uart_params_t *p_params)
 {
     app_dma_params_t tx_dma_params = { 0 };
@@ -419,7 +488,7 @@ uint16_t app_uart_dma_start_transmit_async(app_uart_id_t id)
 
 uint16_t app_uart_dma_transmit_async(app_uart_id_t id, uint8_t *p_data, uint16_t size)
 {
-    uint16_t err_code;
+    app_uart_iovec_t iov;
 
     if (id >= APP_UART_ID_MAX)
     {
@@ -436,31 +505,25 @@ uint16_t app_uart_dma_transmit_async(app_uart_id_t id, uint8_t *p_data, uint16_t
         return APP_DRV_ERR_INVALID_PARAM;
     }
 
-#ifdef APP_DRIVER_WAKEUP_CALL_FUN
-    uart_wake_up(id);
-#endif
+    iov.p_data = p_data;
+    iov.size   = size;
 
-    p_uart_env[id]->tx_abort_flag = false;
-    ring_buffer_write(&p_uart_env[id]->tx_ring_buffer, p_data, size);
+    return uart_tx_queue(id, &iov, 1, true);
+}
 
-    if ((p_uart_env[id]->start_tx_flag == false) && (p_uart_env[id]->start_flush_flag == false) &&
-        (p_uart_env[id]->uart_state == APP_UART_ACTIVITY))
+uint16_t app_uart_dma_transmit_vec_async(app_uart_id_t id, const app_uart_iovec_t *p_iov, uint16_t iov_cnt)
+{
+    if (id >= APP_UART_ID_MAX)
     {
-        p_uart_env[id]->start_tx_flag = true;
-
-        err_code = app_uart_dma_start_transmit_async(id);
-        if (err_code != APP_DRV_SUCCESS)
-        {
-            p_uart_env[id]->start_tx_flag = false;
-            return err_code;
-        }
+        return APP_DRV_ERR_INVALID_ID;
     }
-    else
+
+    if ((p_uart_env[id] == NULL) || (p_uart_env[id]->uart_dma_state == APP_UART_DMA_INVALID))
     {
-        return APP_DRV_ERR_BUSY;
+        return APP_DRV_ERR_NOT_INIT;
     }
 
-    return APP_DRV_SUCCESS;
+    return uart_tx_queue(id, p_iov, iov_cnt, true);
 }
 
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X)
@@ -552,3 +615,168 @@ uint16_t app_uart_receive_dma_sg_llp(app_uart_id_t id, uint8_t *p_data, uint16_t
 
 #endif
 
+uint16_t app_uart_dma_rx_ring_start(app_uart_id_t id, ring_buffer_t *p_ring)
+{
+    uint16_t err_code = APP_DRV_SUCCESS;
+
+    if (id >= APP_UART_ID_MAX)
+    {
+        return APP_DRV_ERR_INVALID_ID;
+    }
+
+    if ((p_uart_env[id] == NULL) || (p_uart_env[id]->uart_dma_state == APP_UART_DMA_INVALID) ||
+        (p_uart_env[id]->handle.p_dmarx == NULL))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    if ((p_ring == NULL) || (p_ring->p_buffer == NULL) ||
+        (p_ring->buffer_size < 2) || (p_ring->buffer_size > UART_DMA_RX_RING_SIZE_MAX))
+    {
+        return APP_DRV_ERR_INVALID_PARAM;
+    }
+
+    if (p_uart_env[id]->p_rx_ring != NULL)
+    {
+        return APP_DRV_ERR_BUSY;
+    }
+
+#ifdef APP_DRIVER_WAKEUP_CALL_FUN
+    uart_wake_up(id);
+#endif
+
+    if (p_uart_env[id]->rx_abort_flag == true)
+    {
+        p_uart_env[id]->rx_abort_flag = false;
+        /* Clear rx_fifo */
+        ll_uart_flush_rx_fifo(p_uart_env[id]->handle.p_instance);
+        /* Clear TIMEOUT interrupt flag bit */
+        ll_uart_receive_data8(p_uart_env[id]->handle.p_instance);
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    p_uart_env[id]->p_rx_ring       = p_ring;
+    p_uart_env[id]->rx_idle_pending = false;
+    if (uart_dma_rx_ring_arm(id) == 0)
+    {
+        p_uart_env[id]->p_rx_ring = NULL;
+        err_code = APP_DRV_ERR_HAL;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return err_code;
+}
+
+uint16_t app_uart_dma_rx_ring_poll(app_uart_id_t id)
+{
+    bool is_idle = false;
+
+    if (id >= APP_UART_ID_MAX)
+    {
+        return APP_DRV_ERR_INVALID_ID;
+    }
+
+    if ((p_uart_env[id] == NULL) || (p_uart_env[id]->p_rx_ring == NULL))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if (!uart_dma_rx_ring_commit(id) && p_uart_env[id]->rx_idle_pending)
+    {
+        p_uart_env[id]->rx_idle_pending = false;
+        is_idle = true;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (is_idle)
+    {
+        uart_dma_rx_ring_evt(id, APP_UART_EVT_RX_IDLE);
+    }
+
+    return APP_DRV_SUCCESS;
+}
+
+uint16_t app_uart_dma_rx_ring_release(app_uart_id_t id, uint32_t length)
+{
+    uint16_t err_code = APP_DRV_SUCCESS;
+
+    if (id >= APP_UART_ID_MAX)
+    {
+        return APP_DRV_ERR_INVALID_ID;
+    }
+
+    if ((p_uart_env[id] == NULL) || (p_uart_env[id]->p_rx_ring == NULL))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    ring_buffer_skip(p_uart_env[id]->p_rx_ring, length);
+    if ((p_uart_env[id]->rx_dma_len == 0) && (uart_dma_rx_ring_arm(id) == 0) &&
+        (ring_buffer_surplus_space_get(p_uart_env[id]->p_rx_ring) != 0))
+    {
+        err_code = APP_DRV_ERR_HAL;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return err_code;
+}
+
+uint16_t app_uart_dma_rx_ring_stop(app_uart_id_t id)
+{
+    if (id >= APP_UART_ID_MAX)
+    {
+        return APP_DRV_ERR_INVALID_ID;
+    }
+
+    if ((p_uart_env[id] == NULL) || (p_uart_env[id]->p_rx_ring == NULL))
+    {
+        return APP_DRV_ERR_NOT_INIT;
+    }
+
+    GLOBAL_EXCEPTION_DISABLE();
+    uart_dma_rx_ring_commit(id);
+    p_uart_env[id]->rx_idle_pending = false;
+    p_uart_env[id]->p_rx_ring       = NULL;
+    p_uart_env[id]->rx_dma_len      = 0;
+    GLOBAL_EXCEPTION_ENABLE();
+
+    /* The ring is detached, the abort may complete in interrupt. */
+    return app_uart_abort_receive(id);
+}
+
+void app_uart_dma_rx_ring_cplt(app_uart_id_t id)
+{
+    ring_buffer_t *p_ring = p_uart_env[id]->p_rx_ring;
+    uint32_t       wr_idx;
+
+    ring_buffer_write_commit(p_ring, p_uart_env[id]->rx_dma_len - p_uart_env[id]->rx_dma_committed);
+    p_uart_env[id]->rx_idle_pending = true;
+    wr_idx = p_ring->write_index;
+
+    /* Start the next chunk before reporting, the handler may take long. */
+    if (uart_dma_rx_ring_arm(id) == 0)
+    {
+        uart_dma_rx_ring_evt(id, APP_UART_EVT_RX_OVERFLOW);
+    }
+
+    if (wr_idx == (p_ring->buffer_size >> 1))
+    {
+        uart_dma_rx_ring_evt(id, APP_UART_EVT_RX_HALF);
+    }
+    else if (wr_idx == 0)
+    {
+        uart_dma_rx_ring_evt(id, APP_UART_EVT_RX_FULL);
+    }
+}
+
+void app_uart_dma_rx_ring_error(app_uart_id_t id)
+{
+    /* DMA reception was aborted by the error, keep what it received and go on with a new chunk. */
+    uart_dma_rx_ring_commit(id);
+    if (uart_dma_rx_ring_arm(id) == 0)
+    {
+        uart_dma_rx_ring_evt(id, APP_UART_EVT_RX_OVERFLOW);
+    }
+}
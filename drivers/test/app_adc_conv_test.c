@@ -0,0 +1,194 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_adc_conv_test.c
+ *
+ * @brief Host test of the app_adc float and fixed point conversion kernels.
+ *
+ * @details The HAL conversion is replaced by a reference model in double precision, with
+ *          the trim slope and offset of a single ended, a differential and an external
+ *          reference setup. Over every ADC code, app_adc_conv_f32() and app_adc_conv_uv()
+ *          must stay within a microvolt of app_adc_voltage_intern() or
+ *          app_adc_voltage_extern(), and app_adc_conv_coef_get() must refuse a HAL
+ *          conversion that is not linear.
+ *
+ *****************************************************************************************
+ */
+#include "app_adc.h"
+#include "app_pwr_mgmt.h"
+#include "grx_sys.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_CODE_NUM           4096
+#define TEST_F32_TOL_UV         1.0     /* Microvolt, float kernel against double. */
+#define TEST_UV_TOL_UV          1.0     /* Microvolt, fixed point kernel against double. */
+#define TEST_BOW_V              0.0005  /* Volt added at mid scale by the nonlinear model. */
+
+typedef struct
+{
+    const char *name;
+    uint32_t    input_mode;
+    double      ref;                    /* External reference, 0 for internal. */
+    double      slope;                  /* Codes per volt, or per unit of ref. */
+    double      offset;                 /* Code at 0 V. */
+} test_case_t;
+
+uint32_t g_host_primask;
+
+static double s_slope;
+static double s_offset;
+static double s_bow;
+
+static uint16_t s_code[TEST_CODE_NUM];
+static double   s_volt[TEST_CODE_NUM];
+static float    s_f32[TEST_CODE_NUM];
+static int32_t  s_uv[TEST_CODE_NUM];
+
+/*
+ * HAL AND SYSTEM FAKES
+ *****************************************************************************************
+ */
+static double test_hal_volt(uint16_t code)
+{
+    double x = ((double)code - 2048.0) / 2048.0;
+
+    return ((double)code - s_offset) / s_slope + s_bow * (1.0 - x * x);
+}
+
+void hal_adc_voltage_intern(adc_handle_t *hadc, uint16_t *inbuf, double *outbuf, uint32_t buflen)
+{
+    for (uint32_t i = 0; i < buflen; i++)
+    {
+        outbuf[i] = test_hal_volt(inbuf[i]);
+    }
+}
+
+void hal_adc_voltage_extern(adc_handle_t *hadc, double vref, uint16_t *inbuf, double *outbuf, uint32_t buflen)
+{
+    for (uint32_t i = 0; i < buflen; i++)
+    {
+        outbuf[i] = test_hal_volt(inbuf[i]) * vref;
+    }
+}
+
+hal_status_t hal_adc_init(adc_handle_t *p_adc)                                      { return HAL_OK; }
+hal_status_t hal_adc_deinit(adc_handle_t *p_adc)                                    { return HAL_OK; }
+hal_adc_state_t hal_adc_get_state(adc_handle_t *p_adc)                              { return HAL_ADC_STATE_READY; }
+hal_status_t hal_adc_poll_for_conversion(adc_handle_t *p_adc, uint16_t *p_data, uint32_t length) { return HAL_OK; }
+hal_status_t hal_adc_start_dma(adc_handle_t *p_adc, uint16_t *p_data, uint32_t length) { return HAL_OK; }
+hal_status_t hal_adc_stop_dma(adc_handle_t *p_adc)                                  { return HAL_OK; }
+hal_status_t hal_adc_suspend_reg(adc_handle_t *p_adc)                               { return HAL_OK; }
+hal_status_t hal_adc_resume_reg(adc_handle_t *p_adc)                                { return HAL_OK; }
+void hal_adc_temperature_conv(adc_handle_t *hadc, uint16_t *inbuf, double *outbuf, uint32_t buflen) {}
+void hal_adc_vbat_conv(adc_handle_t *hadc, uint16_t *inbuf, double *outbuf, uint32_t buflen) {}
+uint16_t sys_adc_trim_get(adc_trim_info_t *p_adc_trim)                              { return 0; }
+uint16_t app_io_init(app_io_type_t type, app_io_init_t *p_init)                     { return APP_DRV_SUCCESS; }
+pwr_id_t pwr_register_sleep_cb(const app_sleep_callbacks_t *p_cb, wakeup_priority_t wakeup_priority, pwr_id_t id) { return id; }
+void pwr_unregister_sleep_cb(pwr_id_t id) {}
+
+/*
+ * TEST FUNCTIONS
+ *****************************************************************************************
+ */
+static bool test_kernels(const test_case_t *p_case)
+{
+    app_adc_params_t    params;
+    app_adc_conv_coef_t coef;
+    uint16_t            ret;
+    double              f32_err = 0;
+    double              uv_err  = 0;
+
+    memset(&params, 0, sizeof(params));
+    params.init.input_mode = p_case->input_mode;
+    params.init.ref_source = ADC_REF_SRC_BUF_INT;
+    app_adc_init(&params, NULL);
+
+    s_slope  = p_case->slope;
+    s_offset = p_case->offset;
+    s_bow    = 0;
+    ret = app_adc_conv_coef_get(p_case->ref, &coef);
+    if (ret != APP_DRV_SUCCESS)
+    {
+        printf("%-20s FAIL coef_get 0x%x\n", p_case->name, ret);
+        return false;
+    }
+
+    if (p_case->ref == 0)
+    {
+        app_adc_voltage_intern(s_code, s_volt, TEST_CODE_NUM);
+    }
+    else
+    {
+        app_adc_voltage_extern(p_case->ref, s_code, s_volt, TEST_CODE_NUM);
+    }
+
+    // Every tail length of the unrolled loops, then the whole code range.
+    for (uint32_t len = 1; len <= 4; len++)
+    {
+        memset(s_f32, 0, sizeof(s_f32));
+        memset(s_uv, 0, sizeof(s_uv));
+        app_adc_conv_f32(&coef, s_code, s_f32, TEST_CODE_NUM - len);
+        app_adc_conv_uv(&coef, s_code, s_uv, TEST_CODE_NUM - len);
+        if ((s_f32[TEST_CODE_NUM - len] != 0) || (s_uv[TEST_CODE_NUM - len] != 0))
+        {
+            printf("%-20s FAIL written past length %u\n", p_case->name, (unsigned)(TEST_CODE_NUM - len));
+            return false;
+        }
+    }
+    app_adc_conv_f32(&coef, s_code, s_f32, TEST_CODE_NUM);
+    app_adc_conv_uv(&coef, s_code, s_uv, TEST_CODE_NUM);
+
+    for (uint32_t i = 0; i < TEST_CODE_NUM; i++)
+    {
+        f32_err = fmax(f32_err, fabs((s_f32[i] - s_volt[i]) * 1000000.0));
+        uv_err  = fmax(uv_err, fabs(s_uv[i] - s_volt[i] * 1000000.0));
+    }
+
+    bool ok = (f32_err <= TEST_F32_TOL_UV) && (uv_err <= TEST_UV_TOL_UV);
+    printf("%-20s %s max error f32 %.3f uV, uv %.3f uV\n", p_case->name, ok ? "PASS" : "FAIL", f32_err, uv_err);
+
+    // The same setup with a bowed conversion must be refused.
+    s_bow = TEST_BOW_V;
+    ret = app_adc_conv_coef_get(p_case->ref, &coef);
+    if (ret != APP_DRV_ERR_HAL)
+    {
+        printf("%-20s FAIL nonlinear conversion accepted\n", p_case->name);
+        ok = false;
+    }
+
+    app_adc_deinit();
+    return ok;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] =
+    {
+        { "intern single",  ADC_INPUT_SINGLE,       0,   2409.4,  61.3   },
+        { "intern diff",    ADC_INPUT_DIFFERENTIAL, 0,   1023.7,  2047.6 },
+        { "extern single",  ADC_INPUT_SINGLE,       3.3, 4001.2,  12.9   },
+    };
+    app_adc_conv_coef_t coef;
+    bool ok = true;
+
+    for (uint32_t i = 0; i < TEST_CODE_NUM; i++)
+    {
+        s_code[i] = (uint16_t)i;
+    }
+
+    if (app_adc_conv_coef_get(0, &coef) != APP_DRV_ERR_NOT_INIT)
+    {
+        printf("FAIL coef_get before init\n");
+        ok = false;
+    }
+
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        ok &= test_kernels(&cases[i]);
+    }
+
+    return ok ? 0 : 1;
+}
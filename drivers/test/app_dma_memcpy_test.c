@@ -0,0 +1,208 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_dma_memcpy_test.c
+ *
+ * @brief Host test of the app_dma memcpy threshold and CPU copy.
+ *
+ * @details The driver source is included to reach its local functions. Cycle counts of
+ *          the calibration sizes are drawn from linear CPU and DMA cost models, and
+ *          dma_memcpy_threshold_calc() must return the size where the two lines cross, or
+ *          the CPU only value when DMA never catches up or could not be timed. The CPU
+ *          copy must match memcpy() for every alignment of source and destination, and
+ *          the public copy must fall back to it while no channel is initialized.
+ *
+ *****************************************************************************************
+ */
+#include "../src/app_dma.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_MODEL_RUNS         20000
+#define TEST_COPY_LEN_MAX       96
+#define TEST_COPY_GUARD         8
+#define TEST_GUARD_BYTE         0xEE
+
+uint32_t g_host_primask;
+
+/*
+ * HAL AND SYSTEM FAKES
+ *****************************************************************************************
+ */
+hal_status_t hal_dma_init(dma_handle_t *p_dma)                                      { return HAL_OK; }
+hal_status_t hal_dma_deinit(dma_handle_t *p_dma)                                    { return HAL_OK; }
+hal_status_t hal_dma_start_it(dma_handle_t *p_dma, uint32_t src_address, uint32_t dst_address, uint32_t data_length) { return HAL_OK; }
+void hal_dma_irq_handler(dma_handle_t *p_dma)                                       {}
+hal_dma_state_t hal_dma_get_state(dma_handle_t *p_dma)                              { return HAL_DMA_STATE_READY; }
+hal_status_t hal_dma_suspend_reg(dma_handle_t *p_dma)                               { return HAL_OK; }
+hal_status_t hal_dma_resume_reg(dma_handle_t *p_dma)                                { return HAL_OK; }
+void hal_dwt_enable(uint32_t _demcr_initial, uint32_t _dwt_ctrl_initial)            {}
+void hal_dwt_disable(uint32_t _demcr_initial, uint32_t _dwt_ctrl_initial)           {}
+void hal_nvic_enable_irq(IRQn_Type IRQn)                                            {}
+void hal_nvic_disable_irq(IRQn_Type IRQn)                                           {}
+void hal_nvic_clear_pending_irq(IRQn_Type IRQn)                                     {}
+void soc_register_nvic(IRQn_Type indx, uint32_t func)                               {}
+pwr_id_t pwr_register_sleep_cb(const app_sleep_callbacks_t *p_cb, wakeup_priority_t wakeup_priority, pwr_id_t id) { return id; }
+void pwr_unregister_sleep_cb(pwr_id_t id) {}
+
+/*
+ * TEST FUNCTIONS
+ *****************************************************************************************
+ */
+static const uint32_t s_size[2] = {DMA_MEMCPY_CALIB_MIN, APP_DMA_MEMCPY_CALIB_SIZE};
+
+static double test_rand(double min, double max)
+{
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+static bool test_threshold(const char *p_name, const uint32_t cpu[2], const uint32_t dma[2], uint32_t expect)
+{
+    uint32_t threshold = dma_memcpy_threshold_calc(s_size, cpu, dma);
+    bool     ok = (threshold == expect);
+
+    printf("%-24s %s threshold %u expected %u\n", p_name, ok ? "PASS" : "FAIL",
+           (unsigned)threshold, (unsigned)expect);
+    return ok;
+}
+
+/* Random cost models: the threshold is the crossing of the lines through the two samples. */
+static bool test_threshold_models(void)
+{
+    uint32_t fails = 0;
+
+    srand(1);
+    for (uint32_t run = 0; run < TEST_MODEL_RUNS; run++)
+    {
+        double   cpu_setup = test_rand(10, 100);
+        double   cpu_byte  = test_rand(0.3, 4.0);
+        double   dma_setup = cpu_setup + test_rand(1, 5000);
+        double   dma_byte  = test_rand(0.05, cpu_byte - 0.01);
+        uint32_t cpu[2];
+        uint32_t dma[2];
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            cpu[i] = (uint32_t)lround(cpu_setup + cpu_byte * s_size[i]);
+            dma[i] = (uint32_t)lround(dma_setup + dma_byte * s_size[i]);
+        }
+
+        double   d0 = (double)dma[0] - cpu[0];
+        double   d1 = (double)dma[1] - cpu[1];
+        uint32_t expect;
+
+        if (d0 <= 0)
+        {
+            expect = s_size[0];
+        }
+        else if (d1 >= d0)
+        {
+            expect = DMA_MEMCPY_CPU_ONLY;
+        }
+        else
+        {
+            expect = (uint32_t)floor(s_size[0] + d0 * (s_size[1] - s_size[0]) / (d0 - d1));
+        }
+
+        uint32_t threshold = dma_memcpy_threshold_calc(s_size, cpu, dma);
+        if (threshold != expect)
+        {
+            if (fails++ < 4)
+            {
+                printf("    cpu %u %u dma %u %u threshold %u expected %u\n", (unsigned)cpu[0], (unsigned)cpu[1],
+                       (unsigned)dma[0], (unsigned)dma[1], (unsigned)threshold, (unsigned)expect);
+            }
+        }
+    }
+
+    printf("%-24s %s %u of %u models\n", "random models", fails ? "FAIL" : "PASS",
+           (unsigned)(TEST_MODEL_RUNS - fails), (unsigned)TEST_MODEL_RUNS);
+    return 0 == fails;
+}
+
+static bool test_cpu_copy(void)
+{
+    uint8_t  src[TEST_COPY_LEN_MAX + 2 * TEST_COPY_GUARD];
+    uint8_t  dst[TEST_COPY_LEN_MAX + 2 * TEST_COPY_GUARD] __attribute__((aligned(8)));
+    uint8_t  ref[TEST_COPY_LEN_MAX + 2 * TEST_COPY_GUARD];
+    uint32_t fails = 0;
+    uint32_t runs  = 0;
+
+    for (uint32_t i = 0; i < sizeof(src); i++)
+    {
+        src[i] = (uint8_t)(i * 7 + 1);
+    }
+
+    for (uint32_t src_ofs = 0; src_ofs < TEST_COPY_GUARD; src_ofs++)
+    {
+        for (uint32_t dst_ofs = 0; dst_ofs < TEST_COPY_GUARD; dst_ofs++)
+        {
+            for (uint32_t len = 0; len <= TEST_COPY_LEN_MAX; len++)
+            {
+                memset(dst, TEST_GUARD_BYTE, sizeof(dst));
+                memset(ref, TEST_GUARD_BYTE, sizeof(ref));
+                memcpy(ref + dst_ofs, src + src_ofs, len);
+                dma_memcpy_cpu(dst + dst_ofs, src + src_ofs, len);
+                fails += (0 != memcmp(dst, ref, sizeof(dst)));
+                runs++;
+            }
+        }
+    }
+
+    printf("%-24s %s %u of %u copies\n", "cpu copy", fails ? "FAIL" : "PASS",
+           (unsigned)(runs - fails), (unsigned)runs);
+    return 0 == fails;
+}
+
+static bool test_copy_not_init(void)
+{
+    uint8_t src[64];
+    uint8_t dst[64];
+    bool    ok;
+
+    for (uint32_t i = 0; i < sizeof(src); i++)
+    {
+        src[i] = (uint8_t)(0xA0 + i);
+    }
+    memset(dst, 0, sizeof(dst));
+
+    // Even a zero threshold copies on the CPU while the channel is not initialized.
+    app_dma_memcpy_threshold_set(0);
+    ok  = (APP_DRV_SUCCESS == app_dma_memcpy_sync(dst + 1, src + 3, sizeof(src) - 3));
+    ok &= (0 == memcmp(dst + 1, src + 3, sizeof(src) - 3));
+    ok &= (APP_DRV_ERR_POINTER_NULL == app_dma_memcpy_sync(NULL, src, sizeof(src)));
+
+    printf("%-24s %s\n", "copy not initialized", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+int main(void)
+{
+    static const uint32_t cpu[2]        = { 40, 280 };              /* 1 cycle per byte. */
+    static const uint32_t dma_cross[2]  = { 140, 200 };             /* Crosses at 16 + 100 * 240 / 180. */
+    static const uint32_t dma_late[2]   = { 1040, 1100 };           /* Crosses past the calibration size. */
+    static const uint32_t dma_fast[2]   = { 30, 100 };
+    static const uint32_t dma_equal[2]  = { 40, 100 };
+    static const uint32_t dma_slow[2]   = { 100, 400 };
+    static const uint32_t dma_par[2]    = { 100, 340 };             /* Same slope, never crosses. */
+    static const uint32_t dma_fail[2]   = { 140, DMA_MEMCPY_CPU_ONLY };
+    static const uint32_t cpu_irq[2]    = { 40, 280 };
+    static const uint32_t dma_irq[2]    = { 1000040, 200 };         /* Interrupt in the small DMA timing. */
+    bool ok = true;
+
+    ok &= test_threshold("crossing",         cpu, dma_cross, 16 + 100 * 240 / 180);
+    ok &= test_threshold("crossing late",    cpu, dma_late,  16 + 1000 * 240 / 180);
+    ok &= test_threshold("dma always faster", cpu, dma_fast,  DMA_MEMCPY_CALIB_MIN);
+    ok &= test_threshold("dma equal at min", cpu, dma_equal, DMA_MEMCPY_CALIB_MIN);
+    ok &= test_threshold("dma never faster", cpu, dma_slow,  DMA_MEMCPY_CPU_ONLY);
+    ok &= test_threshold("dma same slope",   cpu, dma_par,   DMA_MEMCPY_CPU_ONLY);
+    ok &= test_threshold("dma not timed",    cpu, dma_fail,  DMA_MEMCPY_CPU_ONLY);
+    ok &= test_threshold("large difference", cpu_irq, dma_irq, 16 + 1000000ULL * 240 / 1000080);
+    ok &= test_threshold_models();
+    ok &= test_cpu_copy();
+    ok &= test_copy_not_init();
+
+    return ok ? 0 : 1;
+}
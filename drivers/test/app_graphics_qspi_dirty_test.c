@@ -0,0 +1,317 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_graphics_qspi_dirty_test.c
+ *
+ * @brief Host test of the QSPI screen dirty region merge and its LLP chain builder.
+ *
+ * @details Built for GR5526 on the GR5525/GR5526 HAL subset of stub/. The merge is checked
+ *          on hand picked rectangles, then on random ones against a pixel map: every added
+ *          pixel is covered, rectangles stay aligned and on the screen, the region never
+ *          overflows and no two rectangles are left that the merge rule would join. The
+ *          LLP chains of a rectangle must send exactly its rows in frame buffer order,
+ *          within the block, beat and transfer size limits.
+ *
+ *****************************************************************************************
+ */
+#include "app_graphics_qspi.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_SCRN_W             240
+#define TEST_SCRN_H             200
+#define TEST_RANDOM_RUNS        2000
+#define TEST_BLOCK_NUM          64
+#define TEST_BLOCK_MAX_BEATS    4092u
+#define TEST_FRAME_ADDR         0x20000000u     /* Never read, only chained. */
+
+uint32_t g_host_primask;
+
+static uint8_t            s_pixel[TEST_SCRN_H][TEST_SCRN_W];
+static dma_block_config_t s_block[TEST_BLOCK_NUM];
+
+/*
+ * DIRTY REGION
+ *****************************************************************************************
+ */
+static bool test_rect_is(const app_qspi_rect_t *p_rect, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    return (p_rect->x == x) && (p_rect->y == y) && (p_rect->w == w) && (p_rect->h == h);
+}
+
+static void test_add(app_qspi_dirty_region_t *p_region, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    app_qspi_rect_t rect = { x, y, w, h };
+
+    app_qspi_dirty_region_add(p_region, &rect);
+}
+
+static uint32_t test_area(const app_qspi_rect_t *p_rect)
+{
+    return (uint32_t)p_rect->w * p_rect->h;
+}
+
+static uint32_t test_union_area(const app_qspi_rect_t *p_a, const app_qspi_rect_t *p_b)
+{
+    uint32_t x0 = p_a->x < p_b->x ? p_a->x : p_b->x;
+    uint32_t y0 = p_a->y < p_b->y ? p_a->y : p_b->y;
+    uint32_t x1 = (p_a->x + p_a->w) > (p_b->x + p_b->w) ? (p_a->x + p_a->w) : (p_b->x + p_b->w);
+    uint32_t y1 = (p_a->y + p_a->h) > (p_b->y + p_b->h) ? (p_a->y + p_a->h) : (p_b->y + p_b->h);
+
+    return (x1 - x0) * (y1 - y0);
+}
+
+static bool test_merge_cases(void)
+{
+    app_qspi_dirty_region_t region;
+    bool ok = true;
+
+    ok &= (APP_DRV_ERR_INVALID_PARAM == app_qspi_dirty_region_init(&region, TEST_SCRN_W, TEST_SCRN_H, 3));
+    app_qspi_dirty_region_init(&region, TEST_SCRN_W, TEST_SCRN_H, 2);
+
+    // Aligned to the panel window granularity.
+    test_add(&region, 1, 1, 3, 3);
+    ok &= (1 == region.rect_num) && test_rect_is(&region.rect[0], 0, 0, 4, 4);
+
+    // Empty and off screen rectangles are ignored, the others clipped.
+    test_add(&region, 10, 10, 0, 5);
+    test_add(&region, TEST_SCRN_W, 0, 5, 5);
+    test_add(&region, TEST_SCRN_W - 6, TEST_SCRN_H - 6, 50, 50);
+    ok &= (2 == region.rect_num) && test_rect_is(&region.rect[1], TEST_SCRN_W - 6, TEST_SCRN_H - 6, 6, 6);
+
+    // A neighbour is merged, a far rectangle is kept apart.
+    test_add(&region, 4, 0, 4, 4);
+    ok &= (2 == region.rect_num);
+    ok &= test_rect_is(&region.rect[0], 0, 0, 8, 4) || test_rect_is(&region.rect[1], 0, 0, 8, 4);
+
+    // A rectangle bridging two apart ones merges all three.
+    app_qspi_dirty_region_clear(&region);
+    test_add(&region, 0, 100, 40, 40);
+    test_add(&region, 100, 100, 40, 40);
+    ok &= (2 == region.rect_num);
+    test_add(&region, 30, 100, 80, 40);
+    ok &= (1 == region.rect_num) && test_rect_is(&region.rect[0], 0, 100, 140, 40);
+
+    printf("%-24s %s\n", "merge cases", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+static bool test_merge_random(void)
+{
+    app_qspi_dirty_region_t region;
+    uint32_t max_num = 0;
+
+    srand(1);
+    for (uint32_t run = 0; run < TEST_RANDOM_RUNS; run++)
+    {
+        uint16_t align = (uint16_t)(1u << (rand() % 3));
+        uint32_t adds  = 1 + rand() % 24;
+
+        memset(s_pixel, 0, sizeof(s_pixel));
+        app_qspi_dirty_region_init(&region, TEST_SCRN_W, TEST_SCRN_H, align);
+
+        for (uint32_t n = 0; n < adds; n++)
+        {
+            app_qspi_rect_t rect;
+
+            rect.x = rand() % (TEST_SCRN_W + 10);
+            rect.y = rand() % (TEST_SCRN_H + 10);
+            rect.w = rand() % 60;
+            rect.h = rand() % 60;
+            app_qspi_dirty_region_add(&region, &rect);
+
+            for (uint32_t y = rect.y; (y < rect.y + rect.h) && (y < TEST_SCRN_H); y++)
+            {
+                for (uint32_t x = rect.x; (x < rect.x + rect.w) && (x < TEST_SCRN_W); x++)
+                {
+                    s_pixel[y][x] = 1;
+                }
+            }
+        }
+
+        if (region.rect_num > APP_QSPI_DIRTY_RECT_MAX)
+        {
+            printf("%-24s FAIL run %u: %u rectangles\n", "merge random", (unsigned)run, region.rect_num);
+            return false;
+        }
+        max_num = region.rect_num > max_num ? region.rect_num : max_num;
+
+        for (uint32_t i = 0; i < region.rect_num; i++)
+        {
+            const app_qspi_rect_t *p_rect = &region.rect[i];
+            uint32_t x_end = p_rect->x + p_rect->w;
+            uint32_t y_end = p_rect->y + p_rect->h;
+
+            if ((0 == p_rect->w) || (0 == p_rect->h) || (x_end > TEST_SCRN_W) || (y_end > TEST_SCRN_H) ||
+                (p_rect->x % align) || (p_rect->y % align) ||
+                ((x_end % align) && (x_end != TEST_SCRN_W)) || ((y_end % align) && (y_end != TEST_SCRN_H)))
+            {
+                printf("%-24s FAIL run %u: bad rectangle %u,%u %ux%u\n", "merge random", (unsigned)run,
+                       p_rect->x, p_rect->y, p_rect->w, p_rect->h);
+                return false;
+            }
+
+            for (uint32_t y = p_rect->y; y < y_end; y++)
+            {
+                memset(&s_pixel[y][p_rect->x], 0, p_rect->w);
+            }
+
+            for (uint32_t j = i + 1; j < region.rect_num; j++)
+            {
+                if (test_union_area(p_rect, &region.rect[j]) <=
+                    test_area(p_rect) + test_area(&region.rect[j]) + APP_QSPI_DIRTY_RECT_OVERHEAD)
+                {
+                    printf("%-24s FAIL run %u: rectangles %u and %u left apart\n", "merge random",
+                           (unsigned)run, (unsigned)i, (unsigned)j);
+                    return false;
+                }
+            }
+        }
+
+        for (uint32_t y = 0; y < TEST_SCRN_H; y++)
+        {
+            if (NULL != memchr(s_pixel[y], 1, TEST_SCRN_W))
+            {
+                printf("%-24s FAIL run %u: row %u not covered\n", "merge random", (unsigned)run, (unsigned)y);
+                return false;
+            }
+        }
+    }
+
+    printf("%-24s PASS %u runs, up to %u rectangles\n", "merge random", TEST_RANDOM_RUNS, (unsigned)max_num);
+    return true;
+}
+
+/*
+ * LLP CHAIN
+ *****************************************************************************************
+ */
+/* Chain the whole rectangle, checking every chain against the rows it claims to send. */
+static bool test_llp(const char *p_name, uint32_t stride, uint32_t depth, const app_qspi_rect_t *p_rect,
+                     uint32_t beat_bytes, uint32_t block_num, uint32_t expect_chains)
+{
+    app_qspi_screen_info_t info = { stride, stride, TEST_SCRN_H, depth };
+    uint32_t line   = 0;
+    uint32_t chains = 0;
+    uint32_t blocks = 0;
+    uint32_t row_bytes = p_rect->w * depth;
+
+    while (line < p_rect->h)
+    {
+        uint32_t first = line;
+        uint32_t bytes = app_qspi_dirty_rect_llp_build(&info, p_rect, (const uint8_t *)(uintptr_t)TEST_FRAME_ADDR,
+                                                       beat_bytes, &line, s_block, block_num);
+        uint32_t row   = first;
+        uint32_t off   = 0;
+        uint32_t used  = 0;
+
+        if ((0 == bytes) || (bytes != (line - first) * row_bytes) || (bytes > QSPI_MAX_XFER_SIZE_ONCE))
+        {
+            printf("%-24s FAIL chain %u: %u bytes for rows %u..%u\n", p_name, (unsigned)chains,
+                   (unsigned)bytes, (unsigned)first, (unsigned)line);
+            return false;
+        }
+
+        for (dma_block_config_t *p_block = &s_block[0]; NULL != p_block; p_block = p_block->p_lli)
+        {
+            uint32_t len = p_block->CTL_H * beat_bytes;
+
+            if ((++used > block_num) || (0 == p_block->CTL_H) || (p_block->CTL_H > TEST_BLOCK_MAX_BEATS) ||
+                !(p_block->CTL_L & DMA_LLP_SRC_ENABLE) || (p_block->CTL_L & DMA_LLP_DST_ENABLE))
+            {
+                printf("%-24s FAIL chain %u: bad block %u\n", p_name, (unsigned)chains, (unsigned)used);
+                return false;
+            }
+
+            // The block must carry on the rows from where the previous one stopped.
+            while (len > 0)
+            {
+                uint32_t addr = TEST_FRAME_ADDR + (p_rect->y + row) * stride * depth + p_rect->x * depth + off;
+                uint32_t part = row_bytes - off;
+
+                if (p_block->src_address + p_block->CTL_H * beat_bytes - len != addr)
+                {
+                    printf("%-24s FAIL chain %u: row %u not in order\n", p_name, (unsigned)chains, (unsigned)row);
+                    return false;
+                }
+                part = part < len ? part : len;
+                len -= part;
+                off += part;
+                if (off == row_bytes)
+                {
+                    row++;
+                    off = 0;
+                }
+            }
+        }
+
+        if ((row != line) || (0 != off))
+        {
+            printf("%-24s FAIL chain %u: rows %u..%u sent up to %u\n", p_name, (unsigned)chains,
+                   (unsigned)first, (unsigned)line, (unsigned)row);
+            return false;
+        }
+        chains++;
+        blocks += used;
+    }
+
+    bool ok = (chains == expect_chains);
+    printf("%-24s %s %u chains, %u blocks\n", p_name, ok ? "PASS" : "FAIL", (unsigned)chains, (unsigned)blocks);
+    return ok;
+}
+
+static bool test_llp_cases(void)
+{
+    app_qspi_screen_info_t info = { 400, 390, TEST_SCRN_H, 2 };
+    app_qspi_rect_t part   = { 10, 20, 100, 5 };
+    app_qspi_rect_t full   = { 0, 0, 390, 25 };
+    app_qspi_rect_t wide   = { 0, 0, 5000, 6 };
+    app_qspi_rect_t tall   = { 0, 0, 400, 100 };
+    app_qspi_rect_t odd    = { 0, 0, 3, 2 };
+    uint32_t line = 0;
+    bool ok = true;
+
+    // One block per row of a partial rectangle.
+    ok &= test_llp("partial rows", 400, 2, &part, 2, TEST_BLOCK_NUM, 1);
+    line = 0;
+    app_qspi_dirty_rect_llp_build(&info, &part, (const uint8_t *)(uintptr_t)TEST_FRAME_ADDR, 2, &line, s_block, TEST_BLOCK_NUM);
+    ok &= (NULL == s_block[4].p_lli) && (&s_block[1] == s_block[0].p_lli) && (100 == s_block[0].CTL_H);
+
+    // Full stride rows share blocks up to the beat limit: 10 rows of 390 beats a block.
+    ok &= test_llp("full stride", 390, 2, &full, 2, TEST_BLOCK_NUM, 1);
+    line = 0;
+    info.scrn_pixel_stride = 390;
+    app_qspi_dirty_rect_llp_build(&info, &full, (const uint8_t *)(uintptr_t)TEST_FRAME_ADDR, 2, &line, s_block, TEST_BLOCK_NUM);
+    ok &= (3900 == s_block[0].CTL_H) && (3900 == s_block[1].CTL_H) && (1950 == s_block[2].CTL_H) && (NULL == s_block[2].p_lli);
+
+    // Rows longer than a block are split, three 20000 byte rows a chain.
+    ok &= test_llp("long rows", 5000, 4, &wide, 4, TEST_BLOCK_NUM, 2);
+
+    // Out of blocks: the rest goes in the next chains.
+    ok &= test_llp("few blocks", 400, 2, &part, 2, 2, 3);
+
+    // Chains stop at the QSPI transfer size: 80000 bytes in two chains.
+    ok &= test_llp("transfer size", 400, 2, &tall, 4, TEST_BLOCK_NUM, 2);
+
+    // Beats not dividing a row, or of a bad size, chain nothing.
+    line = 0;
+    ok &= (0 == app_qspi_dirty_rect_llp_build(&info, &odd, (const uint8_t *)(uintptr_t)TEST_FRAME_ADDR, 4, &line, s_block, TEST_BLOCK_NUM));
+    ok &= (0 == app_qspi_dirty_rect_llp_build(&info, &part, (const uint8_t *)(uintptr_t)TEST_FRAME_ADDR, 3, &line, s_block, TEST_BLOCK_NUM));
+
+    printf("%-24s %s\n", "llp cases", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+int main(void)
+{
+    bool ok = true;
+
+    ok &= test_merge_cases();
+    ok &= test_merge_random();
+    ok &= test_llp_cases();
+
+    return ok ? 0 : 1;
+}
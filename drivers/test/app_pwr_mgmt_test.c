@@ -0,0 +1,373 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_pwr_mgmt_test.c
+ *
+ * @brief Host test of the app_pwr_mgmt bit mask dispatch.
+ *
+ * @details Mock devices and sleep callbacks record every call. Random registrations,
+ *          device tables, usage and busy states are run through the sleep check and the
+ *          wakeup of app_pwr_mgmt, and the calls must come in the order of a reference
+ *          that scans every slot: sleep callbacks by ID until the first busy one, wakeup
+ *          callbacks by priority high to low then by ID, and devices by number. Built a
+ *          second time with HAL_RECOVER_WHEN_USING for the eager resume mask.
+ *
+ *****************************************************************************************
+ */
+#include "app_pwr_mgmt.h"
+#include "grx_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RUNS               20000
+#define TEST_TRACE_MAX          128
+#define TEST_DEV_NUM            MAX_PERIPH_DEVICE_NUM
+
+#define TEST_TRACE_SLEEP        0x100   /* app_prepare_for_sleep of an ID. */
+#define TEST_TRACE_WAKE         0x200   /* app_wake_up_ind of an ID. */
+#define TEST_TRACE_SUSPEND      0x300   /* Suspend of a device. */
+#define TEST_TRACE_RESUME       0x400   /* Resume of a device. */
+
+typedef struct
+{
+    uint16_t entry[TEST_TRACE_MAX];
+    uint32_t num;
+} test_trace_t;
+
+uint32_t g_host_primask;
+
+volatile uint32_t     g_devices_state;
+volatile uint32_t     g_devices_renew;
+#ifdef HAL_RECOVER_WHEN_USING
+volatile uint32_t     g_devices_sleep;
+#endif
+p_device_suspend_func devices_suspend_cb[MAX_PERIPH_DEVICE_NUM];
+p_device_resume_func  devices_resume_cb[MAX_PERIPH_DEVICE_NUM];
+void                 *devices_handle[MAX_PERIPH_DEVICE_NUM];
+
+/* Registered to the power manager by app_pwr_mgmt_init(), not in a header. */
+pwr_mgmt_dev_state_t pwr_enter_sleep_check_new(void);
+void pwr_wake_up_ind_new(void);
+
+static periph_func_t        s_wake_up_ind;
+static pwr_dev_check_func_t s_sleep_check;
+
+static test_trace_t s_trace;
+static bool         s_busy[APP_SLEEP_CB_MAX];
+static uint8_t      s_dev[TEST_DEV_NUM];
+
+/*
+ * HAL AND SYSTEM FAKES
+ *****************************************************************************************
+ */
+void pwr_mgmt_dev_init(periph_func_t p_periph_init)
+{
+    s_wake_up_ind = p_periph_init;
+}
+
+void pwr_mgmt_set_callback(pwr_dev_check_func_t dev_check_fun, pwr_before_sleep_func_t before_sleep_fun)
+{
+    s_sleep_check = dev_check_fun;
+}
+
+/*
+ * TEST FUNCTIONS
+ *****************************************************************************************
+ */
+static void test_trace_add(test_trace_t *p_trace, uint16_t entry)
+{
+    if (p_trace->num < TEST_TRACE_MAX)
+    {
+        p_trace->entry[p_trace->num++] = entry;
+    }
+}
+
+static hal_status_t test_dev_suspend(void *p_handle)
+{
+    test_trace_add(&s_trace, TEST_TRACE_SUSPEND | (uint16_t)((uint8_t *)p_handle - s_dev));
+    return HAL_OK;
+}
+
+static hal_status_t test_dev_resume(void *p_handle)
+{
+    test_trace_add(&s_trace, TEST_TRACE_RESUME | (uint16_t)((uint8_t *)p_handle - s_dev));
+    return HAL_OK;
+}
+
+#define TEST_CB_DEFINE(id)                                            \
+static bool test_sleep_##id(void)                                     \
+{                                                                     \
+    test_trace_add(&s_trace, TEST_TRACE_SLEEP | id);                  \
+    return !s_busy[id];                                               \
+}                                                                     \
+static void test_wake_##id(void)                                      \
+{                                                                     \
+    test_trace_add(&s_trace, TEST_TRACE_WAKE | id);                   \
+}
+
+TEST_CB_DEFINE(0) TEST_CB_DEFINE(1) TEST_CB_DEFINE(2) TEST_CB_DEFINE(3) TEST_CB_DEFINE(4)
+TEST_CB_DEFINE(5) TEST_CB_DEFINE(6) TEST_CB_DEFINE(7) TEST_CB_DEFINE(8) TEST_CB_DEFINE(9)
+
+#define TEST_CB(id)     {{ test_sleep_##id, test_wake_##id }, { test_sleep_##id, NULL }, { NULL, test_wake_##id }, { NULL, NULL }}
+
+/* Per ID: both callbacks, sleep only, wakeup only, none. */
+static const app_sleep_callbacks_t s_cb[][4] =
+{
+    TEST_CB(0), TEST_CB(1), TEST_CB(2), TEST_CB(3), TEST_CB(4),
+    TEST_CB(5), TEST_CB(6), TEST_CB(7), TEST_CB(8), TEST_CB(9),
+};
+
+/* Reference of the sleep callbacks, every slot scanned. */
+static const app_sleep_callbacks_t *s_ref_cb[APP_SLEEP_CB_MAX];
+static wakeup_priority_t            s_ref_priority[APP_SLEEP_CB_MAX];
+
+static pwr_mgmt_dev_state_t test_ref_sleep_check(test_trace_t *p_trace)
+{
+    for (uint32_t i = 0; i < APP_SLEEP_CB_MAX; i++)
+    {
+        if ((s_ref_cb[i] != NULL) && (s_ref_cb[i]->app_prepare_for_sleep != NULL))
+        {
+            test_trace_add(p_trace, TEST_TRACE_SLEEP | i);
+            if (s_busy[i])
+            {
+                return DEVICE_BUSY;
+            }
+        }
+    }
+    return DEVICE_IDLE;
+}
+
+static void test_ref_wake_up(test_trace_t *p_trace)
+{
+    for (uint32_t priority = WAKEUP_PRIORITY_HIGH; priority != 0; priority--)
+    {
+        for (uint32_t i = 0; i < APP_SLEEP_CB_MAX; i++)
+        {
+            if ((s_ref_cb[i] != NULL) && (s_ref_cb[i]->app_wake_up_ind != NULL) && (priority == s_ref_priority[i]))
+            {
+                test_trace_add(p_trace, TEST_TRACE_WAKE | i);
+            }
+        }
+    }
+}
+
+/* Reference of the devices, every device number scanned. */
+static uint32_t s_ref_backup;
+
+static pwr_mgmt_dev_state_t test_ref_dev_sleep_check(test_trace_t *p_trace, uint32_t renew)
+{
+    if (g_devices_state != 0)
+    {
+        return DEVICE_BUSY;
+    }
+
+    for (uint32_t i = 0; i < TEST_DEV_NUM; i++)
+    {
+        if ((renew & (1u << i)) && (devices_suspend_cb[i] != NULL) && (devices_handle[i] != NULL))
+        {
+            test_trace_add(p_trace, TEST_TRACE_SUSPEND | i);
+            s_ref_backup |= (1u << i);
+        }
+    }
+    return DEVICE_IDLE;
+}
+
+static void test_ref_dev_wake_up(test_trace_t *p_trace, uint32_t eager)
+{
+    for (uint32_t i = 0; i < TEST_DEV_NUM; i++)
+    {
+        if (!(s_ref_backup & eager & (1u << i)))
+        {
+            continue;
+        }
+        if ((devices_resume_cb[i] != NULL) && (devices_handle[i] != NULL))
+        {
+            test_trace_add(p_trace, TEST_TRACE_RESUME | i);
+        }
+        else
+        {
+            s_ref_backup &= ~(1u << i);
+        }
+    }
+}
+
+static bool test_trace_equal(const test_trace_t *p_ref)
+{
+    return (s_trace.num == p_ref->num) && (0 == memcmp(s_trace.entry, p_ref->entry, s_trace.num * sizeof(uint16_t)));
+}
+
+static void test_trace_print(const char *p_name, const test_trace_t *p_trace)
+{
+    printf("    %-8s", p_name);
+    for (uint32_t i = 0; i < p_trace->num; i++)
+    {
+        printf(" %03x", p_trace->entry[i]);
+    }
+    printf("\n");
+}
+
+static bool test_callbacks(void)
+{
+    test_trace_t ref;
+    uint32_t     fails = 0;
+
+    srand(1);
+    for (uint32_t run = 0; run < TEST_RUNS; run++)
+    {
+        pwr_id_t          id       = (pwr_id_t)(rand() % (APP_SLEEP_CB_MAX + 1));
+        wakeup_priority_t priority = (wakeup_priority_t)(rand() % (WAKEUP_PRIORITY_HIGH + 2));
+        uint32_t          op       = rand() % 8;
+        bool              valid    = (id < PWR_ID_MAX) && (priority >= WAKEUP_PRIORITY_LOW) &&
+                                     (priority <= WAKEUP_PRIORITY_HIGH);
+        bool              ok       = true;
+
+        if (op < 5)
+        {
+            const app_sleep_callbacks_t *p_cb = (id < PWR_ID_MAX) && (op < 4) ? &s_cb[id][op] : NULL;
+
+            ok &= (pwr_register_sleep_cb(p_cb, priority, id) == (valid ? id : PWR_ID_MAX));
+            if (valid)
+            {
+                s_ref_cb[id]       = p_cb;
+                s_ref_priority[id] = priority;
+            }
+        }
+        else if (op == 5)
+        {
+            pwr_unregister_sleep_cb(id);
+            if (id < PWR_ID_MAX)
+            {
+                s_ref_cb[id] = NULL;
+            }
+        }
+
+        for (uint32_t i = 0; i < APP_SLEEP_CB_MAX; i++)
+        {
+            s_busy[i] = (0 == rand() % 6);
+        }
+
+        memset(&s_trace, 0, sizeof(s_trace));
+        memset(&ref, 0, sizeof(ref));
+        ok &= (pwr_enter_sleep_check() == test_ref_sleep_check(&ref));
+        ok &= test_trace_equal(&ref);
+
+        memset(&s_trace, 0, sizeof(s_trace));
+        memset(&ref, 0, sizeof(ref));
+        pwr_wake_up_ind();
+        test_ref_wake_up(&ref);
+        ok &= test_trace_equal(&ref);
+
+        if (!ok && (fails++ < 4))
+        {
+            printf("    run %u id %d priority %d op %u\n", (unsigned)run, id, priority, (unsigned)op);
+            test_trace_print("driver", &s_trace);
+            test_trace_print("expected", &ref);
+        }
+    }
+
+    printf("%-24s %s %u of %u runs\n", "sleep callbacks", fails ? "FAIL" : "PASS",
+           (unsigned)(TEST_RUNS - fails), (unsigned)TEST_RUNS);
+    return 0 == fails;
+}
+
+static bool test_devices(void)
+{
+    test_trace_t ref;
+    uint32_t     eager = 0xFFFFFFFF;
+    uint32_t     fails = 0;
+
+    srand(2);
+#ifdef HAL_RECOVER_WHEN_USING
+    app_pwr_mgmt_eager_resume_set(eager);
+#endif
+    for (uint32_t run = 0; run < TEST_RUNS; run++)
+    {
+        uint32_t             renew = (uint32_t)rand() & ((1u << TEST_DEV_NUM) - 1);
+        pwr_mgmt_dev_state_t state;
+        bool                 ok = true;
+
+        // Drivers come and go, with a callback or a handle missing now and then.
+        for (uint32_t i = 0; i < TEST_DEV_NUM; i++)
+        {
+            if (0 == rand() % 8)
+            {
+                devices_suspend_cb[i] = (rand() % 6) ? test_dev_suspend : NULL;
+                devices_resume_cb[i]  = (rand() % 6) ? test_dev_resume : NULL;
+                devices_handle[i]     = (rand() % 6) ? &s_dev[i] : NULL;
+            }
+        }
+        g_devices_state = (0 == rand() % 4) ? (1u << (rand() % TEST_DEV_NUM)) : 0;
+        g_devices_renew = renew;
+#ifdef HAL_RECOVER_WHEN_USING
+        if (0 == rand() % 16)
+        {
+            eager = (uint32_t)rand();
+            app_pwr_mgmt_eager_resume_set(eager);
+        }
+#endif
+
+        memset(&s_trace, 0, sizeof(s_trace));
+        memset(&ref, 0, sizeof(ref));
+        state = test_ref_dev_sleep_check(&ref, renew);
+        ok &= (s_sleep_check() == state);
+        ok &= test_trace_equal(&ref);
+        ok &= (g_devices_renew == ((DEVICE_IDLE == state) ? ALL_DEVICES_BACKUP : renew));
+#ifdef HAL_RECOVER_WHEN_USING
+        if (DEVICE_IDLE == state)
+        {
+            ok &= (g_devices_sleep == ALL_DEVICES_SLEEP);
+        }
+#endif
+
+        if (DEVICE_IDLE == state)
+        {
+            memset(&s_trace, 0, sizeof(s_trace));
+            memset(&ref, 0, sizeof(ref));
+            s_wake_up_ind();
+            test_ref_dev_wake_up(&ref, eager);
+            ok &= test_trace_equal(&ref);
+#ifdef HAL_RECOVER_WHEN_USING
+            // Devices resumed at wakeup are no longer left to HAL.
+            for (uint32_t i = 0; i < ref.num; i++)
+            {
+                ok &= !(g_devices_sleep & (1u << (ref.entry[i] & 0xFF)));
+            }
+#endif
+        }
+
+        if (!ok && (fails++ < 4))
+        {
+            printf("    run %u renew 0x%05x state 0x%05x\n", (unsigned)run, (unsigned)renew, (unsigned)g_devices_state);
+            test_trace_print("driver", &s_trace);
+            test_trace_print("expected", &ref);
+        }
+    }
+
+    printf("%-24s %s %u of %u runs\n", "devices", fails ? "FAIL" : "PASS",
+           (unsigned)(TEST_RUNS - fails), (unsigned)TEST_RUNS);
+    return 0 == fails;
+}
+
+int main(void)
+{
+    bool ok = true;
+
+    app_pwr_mgmt_init();
+    if ((pwr_wake_up_ind_new != s_wake_up_ind) || (pwr_enter_sleep_check_new != s_sleep_check))
+    {
+        printf("FAIL device dispatch not registered\n");
+        return 1;
+    }
+    if (sizeof(s_cb) / sizeof(s_cb[0]) != APP_SLEEP_CB_MAX)
+    {
+        printf("FAIL %u callback sets for %u IDs\n", (unsigned)(sizeof(s_cb) / sizeof(s_cb[0])), (unsigned)APP_SLEEP_CB_MAX);
+        return 1;
+    }
+
+    ok &= test_callbacks();
+    ok &= test_devices();
+
+    return ok ? 0 : 1;
+}
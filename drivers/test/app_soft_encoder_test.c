@@ -0,0 +1,201 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_soft_encoder_test.c
+ *
+ * @brief Host test of the app_soft_encoder quadrature transition table.
+ *
+ * @details The GPIOTE and IO drivers are replaced by two simulated signal levels. Every
+ *          change of a level raises the interrupt of its signal, like the both edge mode
+ *          the driver configures. Edge sequences in both directions, with contact bounce,
+ *          illegal transitions and spurious interrupts, must give the expected distance,
+ *          direction, callbacks, illegal transition count and velocity.
+ *
+ *****************************************************************************************
+ */
+#include "app_soft_encoder.h"
+#include "app_gpiote.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PIN_A              APP_IO_PIN_1
+#define TEST_PIN_B              APP_IO_PIN_2
+#define TEST_TICK_FREQ          1000000
+#define TEST_TICK_PER_EDGE      1000
+#define TEST_STEPS              APP_SOFT_ENCODER_STEPS_PER_COUNT
+
+uint32_t g_host_primask;
+
+static app_gpiote_param_t s_gpiote[APP_SOFT_ENCODER_SINGAL_NUMBER];
+static uint8_t  s_level_a;
+static uint8_t  s_level_b;
+static uint32_t s_tick;
+
+static app_soft_encoder_direction_t s_direction;
+static int      s_distance;
+static uint32_t s_callbacks;
+
+/*
+ * IO AND GPIOTE FAKES
+ *****************************************************************************************
+ */
+uint16_t app_gpiote_init(const app_gpiote_param_t *p_params, uint8_t table_cnt)
+{
+    memcpy(s_gpiote, p_params, sizeof(app_gpiote_param_t) * table_cnt);
+    return APP_DRV_SUCCESS;
+}
+
+app_io_pin_state_t app_io_read_pin(app_io_type_t type, uint32_t pin)
+{
+    if (TEST_PIN_A == pin)
+    {
+        return s_level_a ? APP_IO_PIN_SET : APP_IO_PIN_RESET;
+    }
+    return s_level_b ? APP_IO_PIN_SET : APP_IO_PIN_RESET;
+}
+
+/*
+ * TEST FUNCTIONS
+ *****************************************************************************************
+ */
+static uint32_t test_tick_get(void)
+{
+    return s_tick;
+}
+
+static void test_callback(app_soft_encoder_direction_t direction, int distance)
+{
+    s_direction = direction;
+    s_distance  = distance;
+    s_callbacks++;
+}
+
+/* Drive the signals to state A << 1 | B, raising the interrupt of every signal that changed. */
+static void test_state_set(uint8_t state)
+{
+    uint8_t a = (state >> 1) & 1;
+    uint8_t b = state & 1;
+    bool    a_changed = (a != s_level_a);
+    bool    b_changed = (b != s_level_b);
+
+    s_level_a = a;
+    s_level_b = b;
+    s_tick   += TEST_TICK_PER_EDGE;
+    if (a_changed)
+    {
+        s_gpiote[APP_SOFT_ENCODER_SIGNAL_A].io_evt_cb(NULL);
+    }
+    if (b_changed)
+    {
+        s_gpiote[APP_SOFT_ENCODER_SIGNAL_B].io_evt_cb(NULL);
+    }
+}
+
+static void test_sequence(const uint8_t *p_states, uint32_t num)
+{
+    for (uint32_t i = 0; i < num; i++)
+    {
+        test_state_set(p_states[i]);
+    }
+}
+
+static bool test_check(const char *p_name, int distance, app_soft_encoder_direction_t direction,
+                       uint32_t callbacks, uint32_t illegal)
+{
+    bool ok = (s_distance == distance) && (s_direction == direction) &&
+              (s_callbacks == callbacks) && (app_soft_encoder_illegal_count_get() == illegal);
+
+    printf("%-24s %s distance %d direction %d callbacks %u illegal %u\n", p_name, ok ? "PASS" : "FAIL",
+           s_distance, s_direction, (unsigned)s_callbacks, (unsigned)app_soft_encoder_illegal_count_get());
+    return ok;
+}
+
+int main(void)
+{
+    /* A leading B is positive: 00 -> 10 -> 11 -> 01 -> 00. */
+    static const uint8_t forward[]  = { 2, 3, 1, 0 };
+    static const uint8_t backward[] = { 1, 3, 2, 0 };
+    /* One forward cycle with A bouncing on its rising edge and B on its falling edge. */
+    static const uint8_t bounce[]   = { 2, 0, 2, 0, 2, 3, 1, 3, 1, 0 };
+    app_soft_encoder_io_param_t a = { APP_IO_TYPE_NORMAL, TEST_PIN_A, APP_IO_MODE_IT_RISING, APP_IO_NOPULL };
+    app_soft_encoder_io_param_t b = { APP_IO_TYPE_NORMAL, TEST_PIN_B, APP_IO_MODE_IT_RISING, APP_IO_NOPULL };
+    float velocity;
+    float acceleration;
+    bool  ok = true;
+
+    s_level_a = 0;
+    s_level_b = 0;
+    if (APP_DRV_SUCCESS != app_soft_encoder_init(&a, &b, test_callback))
+    {
+        printf("FAIL init\n");
+        return 1;
+    }
+    if ((APP_IO_MODE_IT_BOTH_EDGE != s_gpiote[APP_SOFT_ENCODER_SIGNAL_A].mode) ||
+        (APP_IO_MODE_IT_BOTH_EDGE != s_gpiote[APP_SOFT_ENCODER_SIGNAL_B].mode))
+    {
+        printf("FAIL signals not on both edges\n");
+        ok = false;
+    }
+
+    // Three cycles each way, one count per cycle.
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        test_sequence(forward, sizeof(forward));
+    }
+    ok &= test_check("forward", 3 * 4 / TEST_STEPS, APP_SOFT_ENCODER_POSITIVE, 3 * 4 / TEST_STEPS, 0);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        test_sequence(backward, sizeof(backward));
+    }
+    ok &= test_check("backward", 0, APP_SOFT_ENCODER_REVERSE, 6 * 4 / TEST_STEPS, 0);
+
+    // Bounce cancels out, the cycle still counts once.
+    test_sequence(bounce, sizeof(bounce));
+    ok &= test_check("bounce", 4 / TEST_STEPS, APP_SOFT_ENCODER_POSITIVE, 7 * 4 / TEST_STEPS, 0);
+
+    // Half a cycle forward and back is bounce too.
+    test_sequence(forward, 2);
+    test_state_set(2);
+    test_state_set(0);
+    ok &= test_check("half cycle back", 4 / TEST_STEPS, APP_SOFT_ENCODER_POSITIVE, 7 * 4 / TEST_STEPS, 0);
+
+    // Both signals changing between two samples is counted as illegal, and not as a step.
+    s_level_a = 1;
+    s_level_b = 1;
+    s_gpiote[APP_SOFT_ENCODER_SIGNAL_A].io_evt_cb(NULL);
+    s_level_a = 0;
+    s_level_b = 0;
+    s_gpiote[APP_SOFT_ENCODER_SIGNAL_B].io_evt_cb(NULL);
+    ok &= test_check("illegal", 4 / TEST_STEPS, APP_SOFT_ENCODER_POSITIVE, 7 * 4 / TEST_STEPS, 2);
+
+    // An interrupt with no level change does nothing.
+    s_gpiote[APP_SOFT_ENCODER_SIGNAL_A].io_evt_cb(NULL);
+    s_gpiote[APP_SOFT_ENCODER_SIGNAL_B].io_evt_cb(NULL);
+    ok &= test_check("spurious", 4 / TEST_STEPS, APP_SOFT_ENCODER_POSITIVE, 7 * 4 / TEST_STEPS, 2);
+
+    // The sequence carries on after an illegal transition.
+    test_sequence(backward, sizeof(backward));
+    ok &= test_check("after illegal", 0, APP_SOFT_ENCODER_REVERSE, 8 * 4 / TEST_STEPS, 2);
+
+    // Velocity over steady transitions, then stopped after the timeout.
+    app_soft_encoder_velocity_enable(test_tick_get, TEST_TICK_FREQ);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        test_sequence(forward, sizeof(forward));
+    }
+    app_soft_encoder_velocity_get(&velocity, &acceleration);
+    float expect = (float)TEST_TICK_FREQ / (TEST_TICK_PER_EDGE * TEST_STEPS);
+    bool  v_ok   = (fabsf(velocity - expect) < 0.01f) && (fabsf(acceleration) < 0.01f);
+
+    s_tick += TEST_TICK_FREQ / 1000 * (APP_SOFT_ENCODER_VELOCITY_TIMEOUT_MS + 1);
+    app_soft_encoder_velocity_get(&velocity, &acceleration);
+    v_ok &= (0 == velocity);
+    printf("%-24s %s expected %.2f counts/s\n", "velocity", v_ok ? "PASS" : "FAIL", expect);
+    ok &= v_ok;
+
+    return ok ? 0 : 1;
+}
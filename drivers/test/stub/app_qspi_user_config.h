@@ -0,0 +1,19 @@
+/**
+ *****************************************************************************************
+ *
+ * @file app_qspi_user_config.h
+ *
+ * @brief QSPI app driver features for the driver host tests.
+ *
+ *****************************************************************************************
+ */
+#ifndef __APP_QSPI_USER_CONFIG_H__
+#define __APP_QSPI_USER_CONFIG_H__
+
+#define QSPI_DMA_LLP_FEATUTE_SUPPORT                1u
+#define QSPI_SYNC_SCROLL_DRAW_SCREEN_SUPPORT        0u
+#define QSPI_ASYNC_SCROLL_DRAW_SCREEN_SUPPORT       0u
+#define QSPI_ASYNC_VERI_LINK_DRAW_SCREEN_SUPPORT    0u
+#define QSPI_BLIT_RECT_IMAGE_SUPPORT                0u
+
+#endif
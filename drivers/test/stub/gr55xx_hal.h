@@ -0,0 +1,63 @@
+/**
+ *****************************************************************************************
+ *
+ * @file gr55xx_hal.h
+ *
+ * @brief Host subset of the GR5525/GR5526 HAL for the driver host tests.
+ *
+ * @details This tree carries the GR533x HAL only. The QSPI graphics drivers also need the
+ *          QSPI handle types, and the DMA LLP block and control bits of the GR5525/GR5526
+ *          DMA, given here with the layout and values of that HAL.
+ *
+ *****************************************************************************************
+ */
+#ifndef __GR55XX_HAL_H__
+#define __GR55XX_HAL_H__
+
+#include <stdint.h>
+
+#define HAL_QSPI_MODULE_ENABLED
+
+#define DMA_SRC_GATHER_DISABLE      (0x0U)
+#define DMA_SRC_GATHER_ENABLE       (0x1U << 17)
+#define DMA_DST_SCATTER_DISABLE     (0x0U)
+#define DMA_DST_SCATTER_ENABLE      (0x1U << 18)
+#define DMA_LLP_DST_DISABLE         (0x0U)
+#define DMA_LLP_DST_ENABLE          (0x1U << 27)
+#define DMA_LLP_SRC_DISABLE         (0x0U)
+#define DMA_LLP_SRC_ENABLE          (0x1U << 28)
+
+typedef struct _dma_block_config
+{
+    uint32_t                    src_address;
+    uint32_t                    dst_address;
+    struct _dma_block_config   *p_lli;
+    uint32_t                    CTL_L;
+    uint32_t                    CTL_H;
+    uint32_t                    src_status;
+    uint32_t                    dst_status;
+} dma_block_config_t;
+
+typedef struct
+{
+    dma_block_config_t         *head_lli;
+} dma_sg_llp_config_t;
+
+typedef struct
+{
+    uint32_t                    clock_prescaler;
+} qspi_init_t;
+
+typedef struct
+{
+    qspi_init_t                 init;
+} qspi_handle_t;
+
+typedef struct
+{
+    uint32_t                    instruction;
+    uint32_t                    address;
+    uint32_t                    length;
+} qspi_command_t;
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ *****************************************************************************************
+ *
+ * @file host_cmsis.h
+ *
+ * @brief Host replacement of cmsis_gcc.h for the driver host tests.
+ *
+ * @details Forced in front of every driver source, so that the real SDK headers compile
+ *          for the host: the compiler attributes are kept and the core intrinsics become
+ *          plain C. PRIMASK is a variable the tests can look at.
+ *
+ *****************************************************************************************
+ */
+#ifndef __HOST_CMSIS_H__
+#define __HOST_CMSIS_H__
+
+#include <stdint.h>
+
+#define __CMSIS_GCC_H
+
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __STATIC_INLINE         static inline
+#define __STATIC_FORCEINLINE    static inline
+#define __NO_RETURN             __attribute__((__noreturn__))
+#define __USED                  __attribute__((used))
+#define __WEAK                  __attribute__((weak))
+#define __PACKED                __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT         struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION          union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#define __RESTRICT              __restrict
+#define __COMPILER_BARRIER()    __asm volatile("":::"memory")
+
+#define __NOP()
+#define __WFI()
+#define __WFE()
+#define __SEV()
+#define __DSB()
+#define __ISB()
+#define __DMB()
+
+extern uint32_t g_host_primask;
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return g_host_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    g_host_primask = primask;
+}
+
+static inline void __disable_irq(void)
+{
+    g_host_primask = 1;
+}
+
+static inline void __enable_irq(void)
+{
+    g_host_primask = 0;
+}
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (uint32_t i = 0; i < 32U; i++)
+    {
+        result = (result << 1) | ((value >> i) & 1U);
+    }
+    return result;
+}
+
+#endif
@@ -263,6 +263,8 @@ SECTION_RAM_CODE static void bootloader_dfu_fw_copy(uint32_t dst_addr, uint32_t
     bootloader_wdt_refresh();
 
     security_disable();
+    // Erase the whole destination at once, so that the whole blocks in it are erased by block erase.
+    hal_flash_erase(dst_addr, copy_page * DFU_FLASH_SECTOR_SIZE);
     for (uint16_t i = 0; i < copy_page; i++)
     {
         if (i == copy_page - 1 && remain)
@@ -273,7 +275,6 @@ SECTION_RAM_CODE static void bootloader_dfu_fw_copy(uint32_t dst_addr, uint32_t
         {
             copy_size = DFU_FLASH_SECTOR_SIZE;
         }
-        hal_flash_erase(dst_addr + i * DFU_FLASH_SECTOR_SIZE, DFU_FLASH_SECTOR_SIZE);
         hal_flash_read(src_addr + i * DFU_FLASH_SECTOR_SIZE, s_flash_read_buff, copy_size);
         hal_flash_write(dst_addr + i * DFU_FLASH_SECTOR_SIZE, s_flash_read_buff, copy_size);
     }
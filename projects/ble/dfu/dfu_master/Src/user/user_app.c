@@ -72,8 +72,6 @@
 
 uint16_t fast_dfu_program_one_size = 0;
 
-extern uint8_t ble_send_cplt_flag;
-
 /*
  * LOCAL VARIABLE DEFINITIONS
  *****************************************************************************************
@@ -176,9 +174,6 @@ static bool user_otas_uuid_find(const uint8_t *p_data, const uint16_t length)
 
 static void otas_c_evt_process(otas_c_evt_t *p_evt)
 {
-    extern uint8_t fast_dfu_mode;
-    extern uint32_t program_size;
-
     switch (p_evt->evt_type)
     {
         case OTAS_C_EVT_DISCOVERY_COMPLETE:
@@ -195,14 +190,11 @@ static void otas_c_evt_process(otas_c_evt_t *p_evt)
             break;
 
         case OTAS_C_EVT_TX_CPLT:
-            if (fast_dfu_mode == FAST_DFU_MODE_DISABLE)
-            {
-                dfu_m_send_data_cmpl_process();
-            }
-            else if (fast_dfu_mode == FAST_DFU_MODE_ENABLE && program_size != 0)
-            {
-                ble_send_cplt_flag = 1;
-            }
+            dfu_m_send_data_cmpl_process();
+            break;
+
+        case OTAS_C_EVT_WRITE_OP_ERR:
+            dfu_m_send_data_fail_process();
             break;
 
         case OTAS_C_EVT_PEER_DATA_RECEIVE:
@@ -201,6 +201,60 @@ void app_dma1_memory_to_memory(void)
 }
 #endif
 
+void app_dma_memcpy_benchmark(void)
+{
+    const uint32_t size[] = {16, 64, 256, 1024, DMA_DATA_LEN};
+    uint32_t cpu_cycles;
+    uint32_t dma_cycles;
+    uint32_t tick;
+    uint32_t i;
+    uint32_t j;
+
+    if (APP_DRV_SUCCESS != app_dma_memcpy_init(DMA0, DMA_Channel1))
+    {
+        printf("app_dma_memcpy_init fail\r\n");
+        return;
+    }
+    printf("app_dma_memcpy threshold: %d bytes\r\n", app_dma_memcpy_threshold_get());
+
+    HAL_TIMEOUT_INIT();
+    for (i = 0; i < sizeof(size) / sizeof(size[0]); i++)
+    {
+        dma_test_data_init();
+        tick = HAL_TIMEOUT_GET_TICK();
+        memcpy(g_dst_data, g_src_data, size[i]);
+        cpu_cycles = HAL_TIMEOUT_GET_TICK() - tick;
+
+        dma_test_data_init();
+        tick = HAL_TIMEOUT_GET_TICK();
+        app_dma_memcpy_sync(g_dst_data, g_src_data, size[i]);
+        dma_cycles = HAL_TIMEOUT_GET_TICK() - tick;
+
+        printf("%4d bytes: memcpy %5d cycles, app_dma_memcpy_sync %5d cycles %s\r\n", size[i], cpu_cycles, dma_cycles,
+               memcmp(g_src_data, g_dst_data, size[i]) ? "fail" : "success");
+    }
+
+    printf("app_dma_memset threshold: %d bytes\r\n", app_dma_memset_threshold_get());
+    for (i = 0; i < sizeof(size) / sizeof(size[0]); i++)
+    {
+        tick = HAL_TIMEOUT_GET_TICK();
+        memset(g_dst_data, 0x00, size[i]);
+        cpu_cycles = HAL_TIMEOUT_GET_TICK() - tick;
+
+        tick = HAL_TIMEOUT_GET_TICK();
+        app_dma_memset_sync(g_dst_data, 0xA5, size[i]);
+        dma_cycles = HAL_TIMEOUT_GET_TICK() - tick;
+
+        for (j = 0; (j < size[i]) && (0xA5 == g_dst_data[j]); j++);
+        printf("%4d bytes: memset %5d cycles, app_dma_memset_sync %5d cycles %s\r\n", size[i], cpu_cycles, dma_cycles,
+               (j < size[i]) ? "fail" : "success");
+    }
+    HAL_TIMEOUT_DEINIT();
+
+    app_dma_memcpy_deinit();
+    return;
+}
+
 int main(void)
 {
     board_init();
@@ -214,6 +268,7 @@ int main(void)
     printf("******************************************************\r\n");
 
     app_dma0_memory_to_memory();
+    app_dma_memcpy_benchmark();
 
 #if (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5526X) || (APP_DRIVER_CHIP_TYPE == APP_DRIVER_GR5525X)
     app_dma1_memory_to_memory();
@@ -43,6 +43,7 @@
 #include <string.h>
 #include "app_uart.h"
 #include "app_uart_dma.h"
+#include "app_log.h"
 #include "board_SK.h"
 
 /*
@@ -52,6 +53,11 @@
 #define UART_DATA_LEN                       (512)
 #define UART_ID                             APP_UART_ID
 
+#ifndef APP_LOG_BENCH_ENABLE
+#define APP_LOG_BENCH_ENABLE                0          /**< Print text vs binary app_log cost before the echo demo. */
+#endif
+#define LOG_BENCH_LINES                     (100)
+
 /*
  * GLOBAL VARIABLE DEFINITIONS
  *****************************************************************************************
@@ -64,6 +70,9 @@ uint8_t g_message_1[] = "Input:\r\n";
 volatile uint16_t rlen = 0;
 volatile uint8_t g_tdone = 0;
 volatile uint8_t g_rdone = 0;
+#if APP_LOG_BENCH_ENABLE
+uint32_t g_log_bench_bytes = 0;
+#endif
 
 app_uart_params_t uart_params = {
     .id      = UART_ID,
@@ -115,6 +124,69 @@ void app_uart_callback(app_uart_evt_t *p_evt)
     }
 }
 
+#if APP_LOG_BENCH_ENABLE
+void app_log_bench_trans(uint8_t *p_data, uint16_t length)
+{
+    g_log_bench_bytes += length;
+}
+
+/* Cycles and UART bytes of text lines against binary frames, for the same log statement. */
+void app_log_format_benchmark(void)
+{
+    app_log_init_t log_init = {0};
+    const char    *mode[2]  = {"text", "binary"};
+    char           report[128];
+    uint32_t       cycles;
+    uint32_t       tick;
+    uint32_t       i;
+    uint32_t       j;
+    uint32_t       lines_per_sec;
+    int            len;
+
+    log_init.filter.level                 = APP_LOG_LVL_DEBUG;
+    log_init.fmt_set[APP_LOG_LVL_ERROR]   = APP_LOG_FMT_ALL & (~APP_LOG_FMT_TAG);
+    log_init.fmt_set[APP_LOG_LVL_WARNING] = APP_LOG_FMT_LVL;
+    log_init.fmt_set[APP_LOG_LVL_INFO]    = APP_LOG_FMT_LVL;
+    log_init.fmt_set[APP_LOG_LVL_DEBUG]   = APP_LOG_FMT_LVL;
+    app_log_init(&log_init, app_log_bench_trans, NULL);
+
+    HAL_TIMEOUT_INIT();
+    for (j = 0; j < 2; j++)
+    {
+        g_log_bench_bytes = 0;
+        tick = HAL_TIMEOUT_GET_TICK();
+        for (i = 0; i < LOG_BENCH_LINES; i++)
+        {
+            if (0 == j)
+            {
+                app_log_output(APP_LOG_LVL_INFO, "UART", __FILE__, __FUNCTION__, __LINE__,
+                               "rx %d bytes, status 0x%08x, %s", i, 0x5A5A0000 | i, "done");
+            }
+            else
+            {
+                app_log_binary_output(APP_LOG_LVL_INFO, "rx %d bytes, status 0x%08x, %s", i, 0x5A5A0000 | i, "done");
+            }
+        }
+        cycles = HAL_TIMEOUT_GET_TICK() - tick;
+
+        lines_per_sec = 0;
+        if (g_log_bench_bytes)
+        {
+            lines_per_sec = (uart_params.init.baud_rate / 10) * LOG_BENCH_LINES / g_log_bench_bytes;
+        }
+
+        len = snprintf(report, sizeof(report), "app_log %-6s: %4lu cycles/line, %3lu bytes/line, %4lu lines/s at %lu baud\r\n",
+                       mode[j], (unsigned long)(cycles / LOG_BENCH_LINES), (unsigned long)(g_log_bench_bytes / LOG_BENCH_LINES),
+                       (unsigned long)lines_per_sec, (unsigned long)uart_params.init.baud_rate);
+        app_uart_transmit_sync(UART_ID, (uint8_t *)report, len, 5000);
+    }
+    HAL_TIMEOUT_DEINIT();
+
+    /* app_log is not set up by this example, put it back as it was before the benchmark. */
+    app_log_init(NULL, NULL, NULL);
+}
+#endif
+
 void app_uart_demo(void)
 {
     uint16_t ret = 0;
@@ -127,6 +199,9 @@ void app_uart_demo(void)
     {
         return;
     }
+#if APP_LOG_BENCH_ENABLE
+    app_log_format_benchmark();
+#endif
     app_uart_transmit_sync(UART_ID, g_message_0, sizeof(g_message_0), 5000);
     app_uart_transmit_sync(UART_ID, g_message_1, sizeof(g_message_1), 5000);
 